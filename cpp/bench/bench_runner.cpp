@@ -0,0 +1,617 @@
+/*
+ * Loreline C++ Library — Benchmark Runner
+ *
+ * Loads the .lor test corpus and a story file, then measures through the C++
+ * API: parse time, auto-advance playback throughput, choice presentation
+ * latency, save/restore time and size, and the process memory high-water.
+ *
+ * Given --compiled with the story compiled by `loreline compile`, also measures
+ * Loreline_loadCompiled against Loreline_parse of the story, and the first
+ * playback of the loaded script (where its function code gets compiled).
+ *
+ * Runs single-threaded by default, or with Loreline_createThread when given
+ * --thread (the threading mode has to be chosen before any other Loreline
+ * work, so each mode runs in its own process).
+ *
+ * Usage:
+ *   bench_runner <test-directory> [--story <file.lor>] [--compiled <file.lorc>]
+ *                [--thread] [--iterations <n>] [--json <file>|-]
+ *
+ * Compile with C++17 (for std::filesystem):
+ *   clang++ -std=c++17 -O2 -o bench_runner bench_runner.cpp \
+ *     -Icpp/include -L<builddir> -lLoreline -Wl,-rpath,@executable_path
+ */
+
+#include "Loreline.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace fs = std::filesystem;
+
+typedef std::chrono::steady_clock Clock;
+
+/* ── Settings ───────────────────────────────────────────────────────────── */
+
+/* Playback stops after that many choices or dialogues, for looping stories */
+#define BENCH_MAX_CHOICES 500
+#define BENCH_MAX_DIALOGUES 100000
+
+/* Playback stops if it is still waiting after that many seconds (timers, async functions) */
+#define BENCH_PLAY_TIMEOUT 10.0
+
+/* Save data kept from the story playback to measure restores */
+#define BENCH_MAX_RESTORES 50
+
+static bool threaded = false;
+
+/* ── Utility ────────────────────────────────────────────────────────────── */
+
+static std::string readFile(const std::string& path) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f.is_open()) return "";
+    std::ostringstream ss;
+    ss << f.rdbuf();
+    return ss.str();
+}
+
+static bool endsWith(const std::string& s, const std::string& suffix) {
+    if (suffix.size() > s.size()) return false;
+    return s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+static double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static int countLines(const std::string& content) {
+    if (content.empty()) return 0;
+    int lines = (int)std::count(content.begin(), content.end(), '\n');
+    if (content.back() != '\n') lines++;
+    return lines;
+}
+
+/* Peak resident memory of the process, in bytes */
+static long long peakMemoryBytes() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return (long long)counters.PeakWorkingSetSize;
+    }
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+    return (long long)usage.ru_maxrss;
+#else
+    return (long long)usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+/* Same rules as the test runner: every .lor file, except translation files (*.xx.lor) */
+static std::vector<std::string> collectLorFiles(const std::string& dir) {
+    std::vector<std::string> files;
+    for (const auto& entry : fs::directory_iterator(dir)) {
+        std::string name = entry.path().filename().string();
+        if (entry.is_directory()) {
+            auto sub = collectLorFiles(entry.path().string());
+            files.insert(files.end(), sub.begin(), sub.end());
+        } else if (endsWith(name, ".lor")) {
+            size_t dotLor = name.size() - 4;
+            if (dotLor >= 3 && name[dotLor - 3] == '.' &&
+                std::isalpha((unsigned char)name[dotLor - 2]) && std::isalpha((unsigned char)name[dotLor - 1])) {
+                continue;
+            }
+            files.push_back(entry.path().string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+/* Beats and choices to play, from the <test> blocks of a corpus file */
+struct BenchItem {
+    std::string beat;
+    std::vector<int> choices;
+};
+
+static std::string trim(const std::string& s) {
+    size_t start = s.find_first_not_of(" \t\r\n");
+    if (start == std::string::npos) return "";
+    size_t end = s.find_last_not_of(" \t\r\n");
+    return s.substr(start, end - start + 1);
+}
+
+/* Only reads the `beat` and `choices` keys, the rest of a test item is not needed here */
+static std::vector<BenchItem> extractItems(const std::string& content) {
+    std::vector<BenchItem> items;
+    size_t pos = 0;
+    while ((pos = content.find("<test>", pos)) != std::string::npos) {
+        size_t end = content.find("</test>", pos);
+        if (end == std::string::npos) break;
+
+        std::istringstream stream(content.substr(pos + 6, end - pos - 6));
+        std::string line;
+        while (std::getline(stream, line)) {
+            std::string trimmed = trim(line);
+            if (trimmed.compare(0, 2, "- ") == 0) {
+                items.emplace_back();
+                trimmed = trim(trimmed.substr(2));
+            }
+            if (items.empty()) continue;
+            if (trimmed.compare(0, 5, "beat:") == 0) {
+                items.back().beat = trim(trimmed.substr(5));
+            } else if (trimmed.compare(0, 8, "choices:") == 0) {
+                std::string list = trim(trimmed.substr(8));
+                std::replace(list.begin(), list.end(), '[', ' ');
+                std::replace(list.begin(), list.end(), ']', ' ');
+                std::replace(list.begin(), list.end(), ',', ' ');
+                std::istringstream values(list);
+                int value;
+                while (values >> value) items.back().choices.push_back(value);
+            }
+        }
+        pos = end + 7;
+    }
+    if (items.empty()) items.emplace_back();
+    return items;
+}
+
+/* ── Stats ──────────────────────────────────────────────────────────────── */
+
+struct Samples {
+    std::vector<double> values;
+
+    void add(double value) { values.push_back(value); }
+
+    double total() const {
+        double sum = 0;
+        for (double v : values) sum += v;
+        return sum;
+    }
+
+    double mean() const {
+        return values.empty() ? 0.0 : total() / values.size();
+    }
+
+    double percentile(double p) const {
+        if (values.empty()) return 0.0;
+        std::vector<double> sorted(values);
+        std::sort(sorted.begin(), sorted.end());
+        size_t index = (size_t)(p * (sorted.size() - 1) + 0.5);
+        return sorted[index];
+    }
+
+    double max() const {
+        return values.empty() ? 0.0 : *std::max_element(values.begin(), values.end());
+    }
+};
+
+/* ── File handler for Loreline_parse ────────────────────────────────────── */
+
+static void fileHandler(Loreline_String path, Loreline_FileRequest* request, void* userData) {
+    std::string content = readFile(path.c_str());
+    if (content.empty()) {
+        Loreline_provideFile(request, Loreline_String());
+    } else {
+        Loreline_provideFile(request, Loreline_String(content.c_str()));
+    }
+}
+
+/* ── Playback ───────────────────────────────────────────────────────────── */
+
+struct PlayContext {
+    /* Choices to select, in order. When empty, the first enabled option is selected */
+    std::vector<int> plan;
+    bool followPlan = false;
+    size_t planIndex = 0;
+
+    int dialogues = 0;
+    int choices = 0;
+    bool done = false;
+
+    /* Time of the last continuation (play, advance or select) */
+    Clock::time_point lastContinue;
+    Samples* choiceLatencies = nullptr;
+
+    /* When set, save data is measured and kept at each choice */
+    bool measureSaves = false;
+    Samples* saveMs = nullptr;
+    Samples* saveBytes = nullptr;
+    Samples* saveBinaryMs = nullptr;
+    Samples* saveBinaryBytes = nullptr;
+    std::vector<Loreline_String>* saves = nullptr;
+};
+
+static void benchDialogue(
+    Loreline_Interpreter* interp,
+    Loreline_String character,
+    Loreline_String text,
+    const Loreline_TextTag* tags,
+    int tagCount,
+    void (*advance)(void),
+    void* userData
+) {
+    PlayContext* ctx = (PlayContext*)userData;
+    ctx->dialogues++;
+    if (ctx->dialogues >= BENCH_MAX_DIALOGUES) {
+        ctx->done = true;
+        return;
+    }
+    ctx->lastContinue = Clock::now();
+    Loreline_advance(interp);
+}
+
+static void benchChoice(
+    Loreline_Interpreter* interp,
+    const Loreline_ChoiceOption* options,
+    int optionCount,
+    void (*select)(int index),
+    void* userData
+) {
+    PlayContext* ctx = (PlayContext*)userData;
+    if (ctx->choiceLatencies) ctx->choiceLatencies->add(elapsedMs(ctx->lastContinue));
+    ctx->choices++;
+
+    if (ctx->measureSaves) {
+        Clock::time_point start = Clock::now();
+        Loreline_String save = Loreline_save(interp);
+        ctx->saveMs->add(elapsedMs(start));
+        ctx->saveBytes->add((double)save.length());
+
+        start = Clock::now();
+        Loreline_String binary = Loreline_saveBinary(interp);
+        ctx->saveBinaryMs->add(elapsedMs(start));
+        ctx->saveBinaryBytes->add((double)binary.length());
+
+        if (ctx->saves->size() < BENCH_MAX_RESTORES) ctx->saves->push_back(save);
+    }
+
+    int index = -1;
+    if (ctx->followPlan) {
+        if (ctx->planIndex < ctx->plan.size()) index = ctx->plan[ctx->planIndex++];
+    } else if (ctx->choices < BENCH_MAX_CHOICES) {
+        for (int i = 0; i < optionCount; i++) {
+            if (options[i].enabled) {
+                index = i;
+                break;
+            }
+        }
+    }
+
+    if (index < 0) {
+        ctx->done = true;
+        return;
+    }
+
+    ctx->lastContinue = Clock::now();
+    Loreline_select(interp, index);
+}
+
+static void benchFinish(Loreline_Interpreter* interp, void* userData) {
+    PlayContext* ctx = (PlayContext*)userData;
+    ctx->done = true;
+}
+
+/* Pump callbacks until the playback is done (they are only delivered by
+ * Loreline_update in threaded mode, or when timers are pending). */
+static void waitUntilDone(PlayContext* ctx) {
+    Clock::time_point start = Clock::now();
+    Clock::time_point last = start;
+    while (!ctx->done) {
+        Clock::time_point now = Clock::now();
+        Loreline_update(std::chrono::duration<double>(now - last).count());
+        last = now;
+        if (std::chrono::duration<double>(now - start).count() > BENCH_PLAY_TIMEOUT) {
+            ctx->done = true;
+            break;
+        }
+        if (!ctx->done) std::this_thread::yield();
+    }
+}
+
+/* Plays the script and returns the elapsed time in milliseconds */
+static double play(Loreline_Script* script, const std::string& beat, PlayContext* ctx) {
+    Clock::time_point start = Clock::now();
+    ctx->lastContinue = start;
+    Loreline_Interpreter* interp = Loreline_play(
+        script, benchDialogue, benchChoice, benchFinish,
+        beat.empty() ? Loreline_String() : Loreline_String(beat.c_str()),
+        NULL, ctx);
+    waitUntilDone(ctx);
+    double ms = elapsedMs(start);
+    if (interp) Loreline_releaseInterpreter(interp);
+    return ms;
+}
+
+/* Restores stop at the first event: its handlers only record that it happened */
+static void restoreDialogue(Loreline_Interpreter* interp, Loreline_String character, Loreline_String text,
+                            const Loreline_TextTag* tags, int tagCount, void (*advance)(void), void* userData) {
+    ((PlayContext*)userData)->done = true;
+}
+
+static void restoreChoice(Loreline_Interpreter* interp, const Loreline_ChoiceOption* options, int optionCount,
+                          void (*select)(int index), void* userData) {
+    ((PlayContext*)userData)->done = true;
+}
+
+/* ── Results ────────────────────────────────────────────────────────────── */
+
+struct ParseResult {
+    int files = 0;
+    long long bytes = 0;
+    long long lines = 0;
+    int failures = 0;
+    Samples ms;
+};
+
+struct PlayResult {
+    int runs = 0;
+    long long lines = 0;
+    long long choices = 0;
+    double ms = 0;
+};
+
+static ParseResult benchParse(const std::vector<std::string>& files, int iterations) {
+    ParseResult result;
+    for (const auto& filePath : files) {
+        std::string content = readFile(filePath);
+        result.files++;
+        result.bytes += (long long)content.size();
+        result.lines += countLines(content);
+        for (int i = 0; i < iterations; i++) {
+            Clock::time_point start = Clock::now();
+            Loreline_Script* script = Loreline_parse(content.c_str(), filePath.c_str(), fileHandler, nullptr);
+            result.ms.add(elapsedMs(start));
+            if (script) {
+                Loreline_releaseScript(script);
+            } else if (i == 0) {
+                result.failures++;
+            }
+        }
+    }
+    return result;
+}
+
+/* ── JSON output ────────────────────────────────────────────────────────── */
+
+static void writeParse(FILE* out, const char* name, const ParseResult& r, int iterations, bool last) {
+    double totalMs = r.ms.total();
+    double seconds = totalMs / 1000.0;
+    fprintf(out, "    \"%s\": {\"files\": %d, \"failures\": %d, \"bytes\": %lld, \"lines\": %lld, "
+                 "\"totalMs\": %.3f, \"meanMs\": %.4f, \"p95Ms\": %.4f, \"linesPerSecond\": %.1f, \"mbPerSecond\": %.3f}%s\n",
+            name, r.files, r.failures, r.bytes, r.lines, totalMs, r.ms.mean(), r.ms.percentile(0.95),
+            seconds > 0 ? (double)(r.lines * iterations) / seconds : 0.0,
+            seconds > 0 ? (double)(r.bytes * iterations) / (1024.0 * 1024.0) / seconds : 0.0,
+            last ? "" : ",");
+}
+
+static void writePlay(FILE* out, const char* name, const PlayResult& r, bool last) {
+    double seconds = r.ms / 1000.0;
+    fprintf(out, "    \"%s\": {\"runs\": %d, \"lines\": %lld, \"choices\": %lld, \"totalMs\": %.3f, \"linesPerSecond\": %.1f}%s\n",
+            name, r.runs, r.lines, r.choices, r.ms, seconds > 0 ? (double)r.lines / seconds : 0.0, last ? "" : ",");
+}
+
+static void writeSamples(FILE* out, const char* name, const Samples& s, const char* indent, bool last) {
+    fprintf(out, "%s\"%s\": {\"samples\": %d, \"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"max\": %.4f}%s\n",
+            indent, name, (int)s.values.size(), s.mean(), s.percentile(0.5), s.percentile(0.95), s.max(), last ? "" : ",");
+}
+
+/* ── Main ───────────────────────────────────────────────────────────────── */
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: bench_runner <test-directory> [--story <file.lor>] [--compiled <file.lorc>] [--thread] [--iterations <n>] [--json <file>|-]\n");
+        return 1;
+    }
+
+    std::string testDir = argv[1];
+    std::string storyPath;
+    std::string compiledPath;
+    std::string jsonPath;
+    int iterations = 5;
+
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--thread") {
+            threaded = true;
+        } else if (arg == "--story" && i + 1 < argc) {
+            storyPath = argv[++i];
+        } else if (arg == "--compiled" && i + 1 < argc) {
+            compiledPath = argv[++i];
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--json" && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else {
+            fprintf(stderr, "Unknown argument: %s\n", arg.c_str());
+            return 1;
+        }
+    }
+
+    /* With JSON on stdout, the summary goes to stderr */
+    FILE* log = jsonPath == "-" ? stderr : stdout;
+
+    if (threaded) Loreline_createThread();
+    Loreline_init();
+
+    auto corpus = collectLorFiles(testDir);
+    if (corpus.empty()) {
+        fprintf(stderr, "No test files found in %s\n", testDir.c_str());
+        Loreline_dispose();
+        return 1;
+    }
+
+    std::vector<std::string> storyFiles;
+    if (!storyPath.empty()) storyFiles.push_back(storyPath);
+
+    /* Parse */
+    ParseResult corpusParse = benchParse(corpus, iterations);
+    ParseResult storyParse = benchParse(storyFiles, iterations);
+
+    /* Corpus playback: the beats and choices of each test item */
+    PlayResult corpusPlay;
+    Samples choiceLatency;
+    for (const auto& filePath : corpus) {
+        std::string content = readFile(filePath);
+        Loreline_Script* script = Loreline_parse(content.c_str(), filePath.c_str(), fileHandler, nullptr);
+        if (!script) continue;
+        for (const auto& item : extractItems(content)) {
+            for (int i = 0; i < iterations; i++) {
+                PlayContext ctx;
+                ctx.plan = item.choices;
+                ctx.followPlan = true;
+                ctx.choiceLatencies = &choiceLatency;
+                corpusPlay.ms += play(script, item.beat, &ctx);
+                corpusPlay.runs++;
+                corpusPlay.lines += ctx.dialogues;
+                corpusPlay.choices += ctx.choices;
+            }
+        }
+        Loreline_releaseScript(script);
+    }
+
+    /* Story playback, always selecting the first enabled option, then saves and restores */
+    PlayResult storyPlay;
+    Samples saveMs, saveBytes, saveBinaryMs, saveBinaryBytes, restoreMs;
+    if (!storyPath.empty()) {
+        std::string content = readFile(storyPath);
+        Loreline_Script* script = Loreline_parse(content.c_str(), storyPath.c_str(), fileHandler, nullptr);
+        if (script) {
+            for (int i = 0; i < iterations; i++) {
+                PlayContext ctx;
+                ctx.choiceLatencies = &choiceLatency;
+                storyPlay.ms += play(script, "", &ctx);
+                storyPlay.runs++;
+                storyPlay.lines += ctx.dialogues;
+                storyPlay.choices += ctx.choices;
+            }
+
+            std::vector<Loreline_String> saves;
+            PlayContext ctx;
+            ctx.measureSaves = true;
+            ctx.saveMs = &saveMs;
+            ctx.saveBytes = &saveBytes;
+            ctx.saveBinaryMs = &saveBinaryMs;
+            ctx.saveBinaryBytes = &saveBinaryBytes;
+            ctx.saves = &saves;
+            play(script, "", &ctx);
+
+            /* Restore time: until the restored interpreter presents its first event */
+            for (const auto& save : saves) {
+                PlayContext restoreCtx;
+                Clock::time_point start = Clock::now();
+                Loreline_Interpreter* interp = Loreline_resume(
+                    script, restoreDialogue, restoreChoice, benchFinish, save, Loreline_String(), NULL, &restoreCtx);
+                waitUntilDone(&restoreCtx);
+                restoreMs.add(elapsedMs(start));
+                if (interp) Loreline_releaseInterpreter(interp);
+            }
+
+            Loreline_releaseScript(script);
+        } else {
+            fprintf(stderr, "Error parsing story %s\n", storyPath.c_str());
+        }
+    }
+
+    /* Compiled story: load time, compared with parsing the story, then a first playback */
+    Samples loadCompiledMs, compiledPlayMs;
+    if (!compiledPath.empty()) {
+        std::string data = readFile(compiledPath);
+        for (int i = 0; i < iterations; i++) {
+            Clock::time_point start = Clock::now();
+            Loreline_Script* script = Loreline_loadCompiled(data.data(), data.size());
+            loadCompiledMs.add(elapsedMs(start));
+            if (!script) {
+                fprintf(stderr, "Error loading compiled story %s\n", compiledPath.c_str());
+                break;
+            }
+            PlayContext ctx;
+            compiledPlayMs.add(play(script, "", &ctx));
+            Loreline_releaseScript(script);
+        }
+    }
+
+    long long peakMemory = peakMemoryBytes();
+
+    /* Summary */
+    const char* mode = threaded ? "thread" : "single";
+    fprintf(log, "Loreline C++ benchmark (%s, %d iterations)\n", mode, iterations);
+    fprintf(log, "  parse corpus:    %d files, %.3f ms mean, %.3f ms total\n",
+            corpusParse.files, corpusParse.ms.mean(), corpusParse.ms.total());
+    if (!storyPath.empty()) {
+        fprintf(log, "  parse story:     %.3f ms mean\n", storyParse.ms.mean());
+    }
+    fprintf(log, "  play corpus:     %lld lines in %.3f ms\n", corpusPlay.lines, corpusPlay.ms);
+    if (!storyPath.empty()) {
+        fprintf(log, "  play story:      %lld lines in %.3f ms\n", storyPlay.lines, storyPlay.ms);
+        fprintf(log, "  save:            %.4f ms mean, %.0f bytes mean (binary: %.4f ms, %.0f bytes)\n",
+                saveMs.mean(), saveBytes.mean(), saveBinaryMs.mean(), saveBinaryBytes.mean());
+        fprintf(log, "  restore:         %.4f ms mean\n", restoreMs.mean());
+    }
+    if (!compiledPath.empty()) {
+        fprintf(log, "  load compiled:   %.3f ms mean (parse story: %.3f ms), first play %.3f ms\n",
+                loadCompiledMs.mean(), storyParse.ms.mean(), compiledPlayMs.mean());
+    }
+    fprintf(log, "  choice latency:  %.4f ms mean, %.4f ms p95\n", choiceLatency.mean(), choiceLatency.percentile(0.95));
+    fprintf(log, "  memory peak:     %.1f MB\n", peakMemory / (1024.0 * 1024.0));
+
+    /* JSON */
+    if (!jsonPath.empty()) {
+        FILE* out = jsonPath == "-" ? stdout : fopen(jsonPath.c_str(), "w");
+        if (!out) {
+            fprintf(stderr, "Cannot write %s\n", jsonPath.c_str());
+            Loreline_dispose();
+            return 1;
+        }
+
+        fprintf(out, "{\n");
+        fprintf(out, "  \"mode\": \"%s\",\n", mode);
+        fprintf(out, "  \"iterations\": %d,\n", iterations);
+        fprintf(out, "  \"parse\": {\n");
+        writeParse(out, "corpus", corpusParse, iterations, storyPath.empty());
+        if (!storyPath.empty()) writeParse(out, "story", storyParse, iterations, true);
+        fprintf(out, "  },\n");
+        fprintf(out, "  \"playback\": {\n");
+        writePlay(out, "corpus", corpusPlay, storyPath.empty());
+        if (!storyPath.empty()) writePlay(out, "story", storyPlay, true);
+        fprintf(out, "  },\n");
+        writeSamples(out, "choiceLatencyMs", choiceLatency, "  ", false);
+        fprintf(out, "  \"save\": {\n");
+        writeSamples(out, "jsonMs", saveMs, "    ", false);
+        writeSamples(out, "jsonBytes", saveBytes, "    ", false);
+        writeSamples(out, "binaryMs", saveBinaryMs, "    ", false);
+        writeSamples(out, "binaryBytes", saveBinaryBytes, "    ", true);
+        fprintf(out, "  },\n");
+        writeSamples(out, "restoreMs", restoreMs, "  ", false);
+        fprintf(out, "  \"compiled\": {\n");
+        writeSamples(out, "loadMs", loadCompiledMs, "    ", false);
+        writeSamples(out, "firstPlayMs", compiledPlayMs, "    ", true);
+        fprintf(out, "  },\n");
+        fprintf(out, "  \"memoryPeakBytes\": %lld\n", peakMemory);
+        fprintf(out, "}\n");
+
+        if (out != stdout) fclose(out);
+    }
+
+    Loreline_dispose();
+
+    return 0;
+}
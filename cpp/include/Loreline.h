@@ -5,6 +5,8 @@
  * Link against libLoreline.dylib / libLoreline.so / Loreline.dll.
  *
  * All Loreline_String values are ref-counted and auto-managed.
+ * Strings coming from the runtime may share its memory instead of owning a
+ * copy; c_str() stays valid for as long as any copy of the string is alive.
  * Only Script and Interpreter handles require explicit release.
  */
 
@@ -46,6 +48,7 @@ struct Loreline_StringData;
 
 class LORELINE_PUBLIC Loreline_String {
     Loreline_StringData* ptr;
+    friend struct Loreline_StringAccess;
 public:
     Loreline_String();
     Loreline_String(const char* s);
@@ -69,6 +72,7 @@ typedef struct Loreline_Interpreter Loreline_Interpreter;
 typedef struct Loreline_Translations Loreline_Translations;
 typedef struct Loreline_InterpreterOptions Loreline_InterpreterOptions;
 typedef struct Loreline_AsyncResolve Loreline_AsyncResolve;
+typedef struct Loreline_ParseCache Loreline_ParseCache;
 
 /* Opaque file-load request token. Passed to the host's Loreline_FileHandler;
  * the host calls Loreline_provideFile(request, content) — sync or async — to
@@ -127,8 +131,26 @@ struct Loreline_ChoiceOption {
     bool enabled;
 };
 
+/* A line predicted by Loreline_peekUpcoming */
+struct Loreline_UpcomingLine {
+    Loreline_String nodeId;    /* id of the text or dialogue statement node */
+    Loreline_String character; /* null for narrative text */
+    Loreline_String text;
+    const Loreline_TextTag* tags;
+    int tagCount;
+};
+
 /* ── Callback typedefs ──────────────────────────────────────────────────── */
 
+/* The advance/select pointers given to the dialogue and choice handlers act on
+ * the interpreter being dispatched and must be called before another handler
+ * fires. To keep several interpreters suspended and continue them in any order,
+ * use Loreline_advance(interpreter) / Loreline_select(interpreter, index).
+ *
+ * The tags and options arrays are reused for later callbacks: they are only
+ * valid until the handler returns. Copy the Loreline_String values inside them
+ * to keep them longer. */
+
 typedef void (*Loreline_DialogueHandler)(
     Loreline_Interpreter* interpreter,
     Loreline_String character,
@@ -152,6 +174,13 @@ typedef void (*Loreline_FinishHandler)(
     void* userData
 );
 
+typedef void (*Loreline_StateChangedHandler)(
+    Loreline_Interpreter* interpreter,
+    Loreline_String path,
+    Loreline_Value value,
+    void* userData
+);
+
 /* File handler is async-capable: the host receives an opaque request token and
  * MUST call Loreline_provideFile(request, content) exactly once — synchronously
  * inside the handler, or later from any thread. Pass NULL content to signal
@@ -203,14 +232,63 @@ LORELINE_PUBLIC void Loreline_dispose(void);
 LORELINE_PUBLIC void Loreline_gc(void);
 
 /* Update — call from the host's main loop.
- * Flushes pending callbacks and runs periodic GC. */
+ * Flushes pending callbacks and runs periodic GC (see Loreline_setGcPolicy). */
 LORELINE_PUBLIC void Loreline_update(double delta);
 
+/* Garbage collection policy — when Loreline_update collects on its own. */
+enum Loreline_GcMode {
+    Loreline_GcInterval = 0, /* every `value` seconds of update deltas (default: 15) */
+    Loreline_GcGrowth,       /* once `value` bytes were allocated since the last collection */
+    Loreline_GcManual        /* never: call Loreline_gc or Loreline_gcStep yourself */
+};
+
+LORELINE_PUBLIC void Loreline_setGcPolicy(Loreline_GcMode mode, double value);
+
+/* Budgeted collection — call once per frame with the time left in the frame,
+ * in seconds. Collects only once the memory allocated since the last
+ * collection reaches the step threshold (see Loreline_setGcStepThreshold), and
+ * only if the collection should fit in `budget`: a collection can't be split,
+ * its cost is estimated from the last one (about 1 ms per MB in use until one
+ * was timed). Returns true if it collected. Blocks until done. */
+LORELINE_PUBLIC bool Loreline_gcStep(double budget);
+
+/* Step threshold of Loreline_gcStep, as a ratio of the memory in use after the
+ * last collection (default: 0.5, that is once the heap grew by half), with a
+ * floor of 1 MB. */
+LORELINE_PUBLIC void Loreline_setGcStepThreshold(double growthRatio);
+
+/* Memory statistics, in bytes. Byte counts come from the GC and cover the
+ * whole Haxe heap; each script and interpreter handle keeps its objects (and
+ * everything they reference) alive until released. */
+typedef struct Loreline_MemoryStats {
+    double heapSize;           /* memory reserved by the GC */
+    double liveBytes;          /* memory in use after the last collection */
+    double currentBytes;       /* memory in use now, garbage included */
+    double largeBytes;         /* part of currentBytes held by large allocations */
+    int scripts;               /* live Loreline_Script handles */
+    int interpreters;          /* live Loreline_Interpreter handles */
+    int collections;           /* collections run by Loreline so far */
+    double lastCollectionTime; /* duration of the last collection, in seconds */
+} Loreline_MemoryStats;
+
+LORELINE_PUBLIC Loreline_MemoryStats Loreline_memoryStats(void);
+
 /* Threading — creates a dedicated internal thread for Loreline.
  * When active, incoming calls route to the internal thread;
  * callbacks are dispatched on the caller's thread via Loreline_update(). */
 LORELINE_PUBLIC void Loreline_createThread(void);
 
+/* Thread pool — same as Loreline_createThread, with several workers. Each
+ * interpreter is pinned to one worker for its whole life, so independent
+ * interpreters run in parallel. Parsing, translations and other calls not
+ * bound to an interpreter run on the first worker. Callbacks are still
+ * dispatched on the caller's thread via Loreline_update(). Imported files
+ * delivered with Loreline_provideFile during a parse are lexed on the other
+ * workers, concurrently, and the script is parsed once all of them are lexed.
+ * Call once, before any other Loreline work; Loreline_createThreadPool(1)
+ * equals Loreline_createThread(). */
+LORELINE_PUBLIC void Loreline_createThreadPool(int workers);
+
 /* File handler — deliver content (or NULL for "not found") to a request token.
  * Must be called exactly once per token. Safe to call from any thread. */
 LORELINE_PUBLIC void Loreline_provideFile(
@@ -245,6 +323,48 @@ LORELINE_PUBLIC void Loreline_parseAsync(
     void* completionHandlerData
 );
 
+/* Parse cache — opt-in cache of lexed files, shared by any number of parse
+ * calls. Files are keyed by resolved path and content: a root script or import
+ * read again with the same content reuses its tokens instead of being lexed
+ * again, and a file whose content changed replaces its previous entry. The file
+ * handler is still called for every import, as content is needed to detect
+ * changes. Imported files are still parsed for every script (node ids depend on
+ * where a file sits in each import tree), only lexing is skipped. */
+LORELINE_PUBLIC Loreline_ParseCache* Loreline_createParseCache(void);
+LORELINE_PUBLIC void Loreline_clearParseCache(Loreline_ParseCache* cache);
+LORELINE_PUBLIC void Loreline_releaseParseCache(Loreline_ParseCache* cache);
+
+/* Parsing with a cache — same as Loreline_parse / Loreline_parseAsync, going
+ * through `cache` (may be NULL). The root script is only cached when
+ * `filePath` is provided. */
+LORELINE_PUBLIC Loreline_Script* Loreline_parseWithCache(
+    Loreline_String input,
+    Loreline_String filePath,
+    Loreline_FileHandler fileHandler,
+    void* fileHandlerData,
+    Loreline_ParseCache* cache
+);
+
+LORELINE_PUBLIC void Loreline_parseAsyncWithCache(
+    Loreline_String input,
+    Loreline_String filePath,
+    Loreline_FileHandler fileHandler,
+    void* fileHandlerData,
+    Loreline_ParseCache* cache,
+    Loreline_ParseCompletionCallback completionHandler,
+    void* completionHandlerData
+);
+
+/* Preparation — builds, once, the data every interpreter of this script would
+ * otherwise rebuild on creation (node lookups, parent links, parsed function
+ * code). Interpreters created with Loreline_play / Loreline_resume /
+ * Loreline_forkInterpreter share it. The prepared data stays alive as long as
+ * the script or any interpreter using it does. Scripts returned by
+ * Loreline_parse, Loreline_scriptFromJson and Loreline_loadCompiled are already
+ * prepared, so that interpreters running on different threads never prepare a
+ * shared script concurrently: calling this is then a no-op. */
+LORELINE_PUBLIC void Loreline_prepareScript(Loreline_Script* script);
+
 /* Translations — extract from a script for localized playback */
 LORELINE_PUBLIC Loreline_Translations* Loreline_extractTranslations(Loreline_Script* script);
 LORELINE_PUBLIC void Loreline_releaseTranslations(Loreline_Translations* translations);
@@ -268,7 +388,10 @@ LORELINE_PUBLIC Loreline_Translations* Loreline_loadLocale(
 );
 
 /* Translations — async variant of Loreline_loadLocale. Returns immediately;
- * completion fires with the resulting handle (or NULL on error). */
+ * completion fires with the resulting handle (or NULL on error).
+ * Every translation file of the import tree is requested up front: a file
+ * handler resolving asynchronously (see Loreline_AsyncResolve) loads them
+ * concurrently, and each file is merged as soon as it is resolved. */
 typedef void (*Loreline_LoadLocaleCallback)(
     Loreline_Translations* translations,
     void* userData
@@ -284,6 +407,14 @@ LORELINE_PUBLIC void Loreline_loadLocaleAsync(
     void* completionHandlerData
 );
 
+/* Translations — switch the translations of a live interpreter (NULL to go back
+ * to the original text). Takes effect for the next text, choice or dialogue it
+ * evaluates, without restarting or restoring it. The interpreter keeps its own
+ * reference: `translations` can be released right after this call.
+ * Synchronous: waits for the interpreter's worker to apply the change. */
+LORELINE_PUBLIC void Loreline_setInterpreterTranslations(
+    Loreline_Interpreter* interp, Loreline_Translations* translations);
+
 /* Enable or disable runtime support for an alternate translation file format.
  *
  * By default, only `.<locale>.lor` files are tried by Loreline_loadLocale.
@@ -318,6 +449,29 @@ LORELINE_PUBLIC void Loreline_optionsSetStrictAccess(
     Loreline_InterpreterOptions* options, bool strict);
 LORELINE_PUBLIC void Loreline_optionsSetTranslations(
     Loreline_InterpreterOptions* options, Loreline_Translations* translations);
+/* State change subscription — `handler` is called, on the host thread, when
+ * the script or the host assigns a field of the top level state (path "name")
+ * or of a character (path "character.name"). Changes are coalesced: the handler
+ * gets the latest value of each path changed since it last ran, once per
+ * Loreline_update() after the first one. When `filterCount` > 0, only paths
+ * equal to one of `filters`, or starting with a filter and a dot (a character
+ * name matches all its fields), are reported. Nested objects modified in place,
+ * scoped states and restoring save data are not reported. Pass a NULL handler
+ * to unsubscribe. */
+LORELINE_PUBLIC void Loreline_optionsOnStateChanged(
+    Loreline_InterpreterOptions* options,
+    Loreline_StateChangedHandler handler,
+    const Loreline_String* filters,
+    int filterCount);
+/* Execution budget — limits how much script logic runs in one go between two
+ * dialogues or choices: after `maxSteps` evaluation steps or `maxMicroseconds`
+ * (whichever comes first, 0 for no limit), the interpreter yields and continues
+ * on the next Loreline_update(), so a heavy beat is spread across frames instead
+ * of blocking one. Requires the Loreline_update() loop: without it, budgets are
+ * ignored. A single lorscript function call is never split. Avoid saving an
+ * interpreter while it is yielding; releasing it is safe, it won't resume. */
+LORELINE_PUBLIC void Loreline_optionsSetStepBudget(
+    Loreline_InterpreterOptions* options, int maxSteps, double maxMicroseconds);
 LORELINE_PUBLIC void Loreline_optionsAddFunction(
     Loreline_InterpreterOptions* options,
     Loreline_String name,
@@ -368,11 +522,78 @@ LORELINE_PUBLIC Loreline_Interpreter* Loreline_resume(
     Loreline_UserDataRelease release = NULL
 );
 
+/* Fork — creates an independent interpreter at the same point of execution as
+ * `interp`, to look ahead at what follows (e.g. after picking a given option)
+ * without affecting it. The fork is copied from an in-memory snapshot (no save
+ * string involved) and shares the prepared script data with `interp`; it then
+ * resumes right away, presenting a pending choice again to its own handlers.
+ * Options are not inherited: pass them again to give the fork custom functions
+ * or translations. The fork runs on the worker of `interp` and must be released
+ * with Loreline_releaseInterpreter. */
+LORELINE_PUBLIC Loreline_Interpreter* Loreline_forkInterpreter(
+    Loreline_Interpreter* interp,
+    Loreline_DialogueHandler onDialogue,
+    Loreline_ChoiceHandler onChoice,
+    Loreline_FinishHandler onFinish,
+    Loreline_InterpreterOptions* options = NULL,
+    void* userData = NULL,
+    Loreline_UserDataRetain retain = NULL,
+    Loreline_UserDataRelease release = NULL
+);
+
+/* Look-ahead — predicts up to `max` lines that `interp` will display after the
+ * current one, so that their assets (voice over, portraits...) can be prefetched
+ * before the dialogue handler fires. Meant to be called from the dialogue handler.
+ * Lines are evaluated by a throwaway fork: the state of `interp` is untouched.
+ * Looking ahead stops at the next choice, the end of the script, the first async
+ * call and the first call of a host function (which may have side effects).
+ * Lines depending on random values may differ from the ones actually displayed.
+ * Fills `outLines` and returns the number of predicted lines. The tags arrays
+ * stay valid until the next Loreline_peekUpcoming call on the same interpreter.
+ * Every call forks `interp` anew, snapshotting its whole state like
+ * Loreline_forkInterpreter, then runs the fork for up to `max` lines: call it
+ * once per displayed line and keep the result rather than polling it.
+ * Synchronous: runs on the worker of `interp`. */
+LORELINE_PUBLIC int Loreline_peekUpcoming(
+    Loreline_Interpreter* interp, Loreline_UpcomingLine* outLines, int max);
+
 /* Interpreter methods */
+
+/* Continuations — resume an interpreter waiting on a dialogue (advance) or a
+ * choice (select). Safe to call at any time from any thread, for any number of
+ * suspended interpreters; does nothing if the interpreter is not waiting, or is
+ * waiting on the other kind (advance on a pending choice, select on a pending
+ * dialogue), which can then still be resumed by the right call. */
+LORELINE_PUBLIC void Loreline_advance(Loreline_Interpreter* interp);
+LORELINE_PUBLIC void Loreline_select(Loreline_Interpreter* interp, int index);
+
 LORELINE_PUBLIC void Loreline_start(Loreline_Interpreter* interp, Loreline_String beatName);
 LORELINE_PUBLIC Loreline_String Loreline_save(Loreline_Interpreter* interp);
 LORELINE_PUBLIC void Loreline_restore(Loreline_Interpreter* interp, Loreline_String saveData);
 
+/* Binary saves — same content as Loreline_save, in a compact binary encoding
+ * (varint node ids, interned strings, typed values) that is smaller and faster
+ * to produce and parse than JSON. The returned string holds raw bytes: read it
+ * with c_str() + length(), not as a NUL-terminated string. Loreline_restore and
+ * Loreline_resume also accept binary saves, detected by their header. */
+LORELINE_PUBLIC Loreline_String Loreline_saveBinary(Loreline_Interpreter* interp);
+LORELINE_PUBLIC void Loreline_restoreBinary(Loreline_Interpreter* interp, Loreline_String saveData);
+
+/* Delta saves — every Loreline_save / Loreline_saveDelta call is a checkpoint
+ * identified by a token (Loreline_saveToken, also the "token" field of the
+ * JSON). Loreline_saveDelta returns, as JSON, only the state, character and
+ * node state fields changed since the given token, which must be the latest
+ * checkpoint (returns a null string otherwise). Loreline_applySaveDeltas merges
+ * a full save (JSON or binary) with the chain of deltas created since it into
+ * a full JSON save, usable with Loreline_restore / Loreline_resume. */
+LORELINE_PUBLIC Loreline_String Loreline_saveDelta(Loreline_Interpreter* interp, int sinceToken);
+LORELINE_PUBLIC int Loreline_saveToken(Loreline_Interpreter* interp);
+LORELINE_PUBLIC Loreline_String Loreline_applySaveDeltas(
+    Loreline_String saveData,
+    const Loreline_String* deltas,
+    int deltaCount
+);
+
 /* Character access */
 LORELINE_PUBLIC Loreline_Value Loreline_getCharacterField(
     Loreline_Interpreter* interp, Loreline_String character, Loreline_String field);
@@ -391,15 +612,95 @@ LORELINE_PUBLIC Loreline_Value Loreline_getTopLevelStateField(
 LORELINE_PUBLIC void Loreline_setTopLevelStateField(
     Loreline_Interpreter* interp, Loreline_String field, Loreline_Value value);
 
+/* Batched field access — same as the calls above for a whole batch of fields,
+ * in a single crossing onto the interpreter's thread. Getters fill
+ * `outValues[i]` with the value of `fields[i]` and block until done. Setters
+ * copy the batch and, like the single-field setters, may return before it is
+ * applied; fields are set in order. */
+LORELINE_PUBLIC void Loreline_getStateFields(
+    Loreline_Interpreter* interp, const Loreline_String* fields, int count, Loreline_Value* outValues);
+LORELINE_PUBLIC void Loreline_setStateFields(
+    Loreline_Interpreter* interp, const Loreline_String* fields, const Loreline_Value* values, int count);
+LORELINE_PUBLIC void Loreline_getCharacterFields(
+    Loreline_Interpreter* interp, Loreline_String character,
+    const Loreline_String* fields, int count, Loreline_Value* outValues);
+LORELINE_PUBLIC void Loreline_setCharacterFields(
+    Loreline_Interpreter* interp, Loreline_String character,
+    const Loreline_String* fields, const Loreline_Value* values, int count);
+
+/* Character snapshot — every field of a character in one call. Fills up to
+ * `capacity` entries of `outFields` / `outValues` (either may be NULL) and
+ * returns the total number of fields, so a first call with a capacity of 0
+ * tells how much room to make. Returns 0 if the character doesn't exist. */
+LORELINE_PUBLIC int Loreline_getCharacterSnapshot(
+    Loreline_Interpreter* interp, Loreline_String character,
+    Loreline_String* outFields, Loreline_Value* outValues, int capacity);
+
 /* Current node — returns info about the node being executed.
  * Returns a Loreline_Node with type set to null if no node is current. */
 LORELINE_PUBLIC Loreline_Node Loreline_currentNode(Loreline_Interpreter* interp);
 
+/* Profiler — opt-in, disabled by default. Once enabled, every interpreter
+ * created afterwards records call counts and wall time per statement type,
+ * expression type, beat, function and host handler (dialogue, choice, finish).
+ * Times are self times: nested statements, expressions and the host handlers
+ * are not counted in the time of the statement that evaluated them.
+ *
+ * Loreline_profilerSnapshot returns what an interpreter recorded so far, as JSON:
+ *   {"nodes": [...], "expressions": [...], "beats": [...], "functions": [...], "handlers": [...]}
+ * where each entry is {"name", "calls", "time"} (time in milliseconds), sorted by
+ * decreasing time. Returns a null string if the interpreter is not profiled. */
+LORELINE_PUBLIC void Loreline_setProfilerEnabled(bool enabled);
+LORELINE_PUBLIC Loreline_String Loreline_profilerSnapshot(Loreline_Interpreter* interp, bool pretty = false);
+LORELINE_PUBLIC void Loreline_resetProfiler(Loreline_Interpreter* interp);
+
+/* Simulation — plays a script `runs` times without calling any handler, picking
+ * choices with a built-in policy: "random", "weighted" (favours the options taken
+ * the least so far) or "exhaustive" (depth first, stops once every path has been
+ * played). Built-in random functions are seeded from `seed` for every playthrough,
+ * so the same arguments always give the same results. wait() returns immediately.
+ *
+ * Random and weighted playthroughs are split across `threads` threads (0 means
+ * one per hardware thread). Each thread weights options from its own counts, so
+ * weighted results also depend on the number of threads: pass an explicit count,
+ * not 0, to reproduce them on another machine. A playthrough stops after
+ * `maxSteps` dialogues and choices.
+ *
+ * Blocks until every playthrough is done. The simulation itself runs on the
+ * Loreline thread (the first worker of a pool), which it keeps busy meanwhile:
+ * calls that run there, including interpreters pinned to it, wait until it
+ * returns. Returns, as JSON:
+ *   {"policy", "seed", "runs", "exhausted",
+ *    "endings": {"finished", "deadEnd", "stepLimit", "suspended", "error"},
+ *    "deadEnds": [{"line", "count"}], "errors": {message: count},
+ *    "steps": {"total", "min", "max", "average"},
+ *    "beats": [{"name", "line", "visits", "runs"}], "unvisitedBeats": [...],
+ *    "choices": [{"line", "text", "offered", "taken"}], "untakenChoices": [...]}
+ * Returns a null string on error, such as an invalid policy. */
+LORELINE_PUBLIC Loreline_String Loreline_simulate(
+    Loreline_Script* script,
+    const char* policy,
+    int runs,
+    int seed,
+    int threads = 0,
+    int maxSteps = 10000,
+    bool pretty = false
+);
+
 /* Utility */
 LORELINE_PUBLIC Loreline_String Loreline_printScript(Loreline_Script* script);
 LORELINE_PUBLIC Loreline_String Loreline_scriptToJson(Loreline_Script* script, bool pretty);
 LORELINE_PUBLIC Loreline_Script* Loreline_scriptFromJson(Loreline_String json);
 
+/* Loads a script compiled with `loreline compile` (a .lorc file, starting with
+ * the "LRLS" magic). Imports are already embedded, so no file handler is
+ * needed, and the script comes back prepared for interpreters: the code of
+ * each function is stored parsed, and only decoded and compiled the first
+ * time the function is called. The data is copied: the caller may free or
+ * unmap it as soon as this returns.
+ * Returns NULL if the data is not a valid compiled script. */
+LORELINE_PUBLIC Loreline_Script* Loreline_loadCompiled(const void* data, size_t length);
+
 /* Resource release — only needed for Script and Interpreter handles.
  * Strings and Values are auto-managed via ref counting. */
 LORELINE_PUBLIC void Loreline_releaseScript(Loreline_Script* script);
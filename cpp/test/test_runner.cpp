@@ -37,6 +37,9 @@ static int failCount = 0;
 static int fileCount = 0;
 static int fileFailCount = 0;
 
+/* Shared by every parse of the prepared pass, so files are parsed again from cached tokens */
+static Loreline_ParseCache* parseCache = nullptr;
+
 /* ── ANSI color helpers ─────────────────────────────────────────────────── */
 
 #define CLR_BOLD_GREEN "\x1b[1m\x1b[32m"
@@ -413,11 +416,17 @@ struct TestContext {
     std::string expected;
     int saveAtChoice;
     int saveAtDialogue;
+    bool binarySave;
+    bool deltaSave;
     int choiceCount;
     int dialogueCount;
     TestResult* result;
     Loreline_Script* parsedScript;
 
+    /* For delta saves: full save at the first event, then one delta per event */
+    Loreline_String baseSave;
+    std::vector<Loreline_String> deltas;
+
     /* For save/restore */
     std::string restoreInput;
     std::string filePath;
@@ -438,6 +447,25 @@ static void testFinish(
     void* userData
 );
 
+/* Checkpoint the interpreter at each event when testing delta saves */
+static void trackDelta(TestContext* ctx, Loreline_Interpreter* interp) {
+    if (!ctx->deltaSave) return;
+    if (ctx->baseSave.isNull()) {
+        ctx->baseSave = Loreline_save(interp);
+    } else {
+        ctx->deltas.push_back(Loreline_saveDelta(interp, Loreline_saveToken(interp)));
+    }
+}
+
+/* Save data for a save/restore test, in the format being tested */
+static Loreline_String takeSave(TestContext* ctx, Loreline_Interpreter* interp) {
+    if (ctx->binarySave) return Loreline_saveBinary(interp);
+    if (ctx->deltaSave) {
+        return Loreline_applySaveDeltas(ctx->baseSave, ctx->deltas.data(), (int)ctx->deltas.size());
+    }
+    return Loreline_save(interp);
+}
+
 static void testDialogue(
     Loreline_Interpreter* interp,
     Loreline_String character,
@@ -450,6 +478,8 @@ static void testDialogue(
     TestContext* ctx = (TestContext*)userData;
     bool multiline = text.c_str() && strchr(text.c_str(), '\n') != nullptr;
 
+    trackDelta(ctx, interp);
+
     if (!character.isNull()) {
         Loreline_Value nameVal = Loreline_getCharacterField(interp, character, "name");
         const char* charName = (nameVal.type == Loreline_StringValue && !nameVal.stringValue.isNull())
@@ -469,7 +499,7 @@ static void testDialogue(
     /* Save/restore test at dialogue */
     if (ctx->saveAtDialogue >= 0 && ctx->dialogueCount == ctx->saveAtDialogue) {
         ctx->dialogueCount++;
-        Loreline_String saveData = Loreline_save(interp);
+        Loreline_String saveData = takeSave(ctx, interp);
 
         if (!ctx->restoreInput.empty()) {
             Loreline_Script* restoreScript = Loreline_parse(
@@ -517,6 +547,8 @@ static void testChoice(
 ) {
     TestContext* ctx = (TestContext*)userData;
 
+    trackDelta(ctx, interp);
+
     for (int i = 0; i < optionCount; i++) {
         const char* prefix = options[i].enabled ? "+" : "-";
         bool multiline = options[i].text.c_str() && strchr(options[i].text.c_str(), '\n') != nullptr;
@@ -529,7 +561,7 @@ static void testChoice(
     /* Save/restore test */
     if (ctx->saveAtChoice >= 0 && ctx->choiceCount == ctx->saveAtChoice) {
         ctx->choiceCount++;
-        Loreline_String saveData = Loreline_save(interp);
+        Loreline_String saveData = takeSave(ctx, interp);
 
         if (!ctx->restoreInput.empty()) {
             Loreline_Script* restoreScript = Loreline_parse(
@@ -567,7 +599,8 @@ static void testChoice(
 }
 
 static TestResult runTest(const std::string& filePath, const std::string& rawContent,
-                          const TestItem& item, bool crlf) {
+                          const TestItem& item, bool crlf, bool prepare = false,
+                          bool binarySave = false, bool deltaSave = false) {
     /* Normalize line endings */
     std::string content = replaceAll(rawContent, "\r\n", "\n");
     if (crlf) {
@@ -602,6 +635,8 @@ static TestResult runTest(const std::string& filePath, const std::string& rawCon
     ctx.expected = item.expected;
     ctx.saveAtChoice = item.saveAtChoice;
     ctx.saveAtDialogue = item.saveAtDialogue;
+    ctx.binarySave = binarySave;
+    ctx.deltaSave = deltaSave;
     ctx.choiceCount = 0;
     ctx.dialogueCount = 0;
     ctx.result = &result;
@@ -611,8 +646,13 @@ static TestResult runTest(const std::string& filePath, const std::string& rawCon
     ctx.options = options;
 
     /* Parse and play */
-    Loreline_Script* script = Loreline_parse(content.c_str(), filePath.c_str(), fileHandler, nullptr);
+    Loreline_Script* script = Loreline_parseWithCache(
+        content.c_str(), filePath.c_str(), fileHandler, nullptr, prepare ? parseCache : nullptr);
     if (script) {
+        if (prepare) {
+            Loreline_prepareScript(script);
+        }
+
         /* Load translations after parse: walks the import tree and loads .<locale>.lor for each file */
         if (!item.translation.empty()) {
             translations = Loreline_loadLocale(
@@ -649,6 +689,593 @@ static TestResult runTest(const std::string& filePath, const std::string& rawCon
     return result;
 }
 
+/* ── API tests ──────────────────────────────────────────────────────────── */
+
+/* Tests of C API calls not covered by the .lor fixtures, on inline scripts */
+
+static void reportApiTest(const std::string& name, bool passed, const std::string& error) {
+    std::string label = "api ~ " + name;
+    if (passed) {
+        passCount++;
+        printf(CLR_BOLD_GREEN "PASS" CLR_RESET " - " CLR_GRAY "%s" CLR_RESET "\n", label.c_str());
+    } else {
+        failCount++;
+        printf(CLR_BOLD_RED "FAIL" CLR_RESET " - " CLR_GRAY "%s" CLR_RESET "\n", label.c_str());
+        if (!error.empty()) {
+            printf("  Error: %s\n", error.c_str());
+        }
+    }
+}
+
+/* Records what an interpreter displays. Dialogues are advanced right away
+ * unless `holdDialogues` is set; choices are always left pending. */
+struct ApiRecorder {
+    std::vector<std::string> lines;
+    std::vector<std::pair<std::string, Loreline_Value>> stateChanges;
+    bool holdDialogues = false;
+    bool waitingDialogue = false;
+    bool waitingChoice = false;
+    bool finished = false;
+};
+
+static void apiDialogue(
+    Loreline_Interpreter* interp,
+    Loreline_String character,
+    Loreline_String text,
+    const Loreline_TextTag* tags,
+    int tagCount,
+    void (*advance)(void),
+    void* userData
+) {
+    ApiRecorder* rec = (ApiRecorder*)userData;
+    std::string line = character.isNull() ? "~ " : std::string(character.c_str()) + ": ";
+    rec->lines.push_back(line + text.c_str());
+    if (rec->holdDialogues) {
+        rec->waitingDialogue = true;
+    } else {
+        advance();
+    }
+}
+
+static void apiChoice(
+    Loreline_Interpreter* interp,
+    const Loreline_ChoiceOption* options,
+    int optionCount,
+    void (*select)(int index),
+    void* userData
+) {
+    ApiRecorder* rec = (ApiRecorder*)userData;
+    for (int i = 0; i < optionCount; i++) {
+        rec->lines.push_back(std::string("+ ") + options[i].text.c_str());
+    }
+    rec->waitingChoice = true;
+}
+
+static void apiFinish(Loreline_Interpreter* interp, void* userData) {
+    ((ApiRecorder*)userData)->finished = true;
+}
+
+static void apiStateChanged(
+    Loreline_Interpreter* interp,
+    Loreline_String path,
+    Loreline_Value value,
+    void* userData
+) {
+    ((ApiRecorder*)userData)->stateChanges.push_back(std::make_pair(std::string(path.c_str()), value));
+}
+
+static std::string joinLines(const std::vector<std::string>& lines) {
+    std::string result;
+    for (size_t i = 0; i < lines.size(); i++) {
+        if (i > 0) result += " | ";
+        result += lines[i];
+    }
+    return result;
+}
+
+static Loreline_Script* parseApiScript(const char* source) {
+    return Loreline_parse(source, "api-test.lor", fileHandler, nullptr);
+}
+
+/* A lorscript function assigning declared state fields must report each of them */
+static void testApiStateChangedFromFunction() {
+    const char* source =
+        "state\n"
+        "  score: 0\n"
+        "  bonus: 1\n"
+        "\n"
+        "function reward(n)\n"
+        "  score += n\n"
+        "  bonus = bonus * 2\n"
+        "  score++\n"
+        "\n"
+        "reward(5)\n"
+        "Score is $score.\n";
+
+    Loreline_Script* script = parseApiScript(source);
+    if (!script) {
+        reportApiTest("state-changed-from-function", false, "Error parsing script");
+        return;
+    }
+
+    ApiRecorder rec;
+    Loreline_InterpreterOptions* options = Loreline_createOptions();
+    Loreline_optionsOnStateChanged(options, apiStateChanged, nullptr, 0);
+    Loreline_Interpreter* interp = Loreline_play(
+        script, apiDialogue, apiChoice, apiFinish, Loreline_String(), options, &rec);
+    Loreline_update(0);
+
+    int score = -1;
+    int bonus = -1;
+    for (const auto& change : rec.stateChanges) {
+        if (change.second.type != Loreline_Int) continue;
+        if (change.first == "score") score = change.second.intValue;
+        if (change.first == "bonus") bonus = change.second.intValue;
+    }
+
+    bool passed = rec.finished && score == 6 && bonus == 2 &&
+        joinLines(rec.lines) == "~ Score is 6.";
+    reportApiTest("state-changed-from-function", passed, passed ? "" :
+        "Got score=" + std::to_string(score) + ", bonus=" + std::to_string(bonus) +
+        ", lines: " + joinLines(rec.lines));
+
+    if (interp) Loreline_releaseInterpreter(interp);
+    Loreline_releaseOptions(options);
+    Loreline_releaseScript(script);
+}
+
+/* Calls Loreline_update() until the interpreter finishes, returns the number of calls */
+static int updateUntilFinished(ApiRecorder& rec, int maxUpdates) {
+    int updates = 0;
+    while (!rec.finished && updates < maxUpdates) {
+        Loreline_update(0);
+        updates++;
+    }
+    return updates;
+}
+
+/* A beat of 24 assignments, evaluated in place by the interpreter */
+static std::string budgetScriptSource() {
+    std::string source = "state\n  count: 0\n\n";
+    for (int i = 0; i < 24; i++) {
+        source += "count += 1\n";
+    }
+    source += "Count is $count.\n";
+    return source;
+}
+
+/* With a step budget, statements run in place are spread across updates
+ * and the story still ends the same way */
+static void testApiStepBudget() {
+    Loreline_Script* script = parseApiScript(budgetScriptSource().c_str());
+    if (!script) {
+        reportApiTest("step-budget", false, "Error parsing script");
+        return;
+    }
+
+    /* Budgets need the update loop */
+    Loreline_update(0);
+
+    ApiRecorder unbudgeted;
+    Loreline_Interpreter* reference = Loreline_play(
+        script, apiDialogue, apiChoice, apiFinish, Loreline_String(), nullptr, &unbudgeted);
+    int referenceUpdates = updateUntilFinished(unbudgeted, 100);
+
+    ApiRecorder rec;
+    Loreline_InterpreterOptions* options = Loreline_createOptions();
+    Loreline_optionsSetStepBudget(options, 4, 0);
+    Loreline_Interpreter* interp = Loreline_play(
+        script, apiDialogue, apiChoice, apiFinish, Loreline_String(), options, &rec);
+    bool linesBeforeUpdate = !rec.lines.empty();
+    int updates = updateUntilFinished(rec, 100);
+
+    bool passed = rec.finished && !linesBeforeUpdate &&
+        updates > referenceUpdates + 3 &&
+        joinLines(rec.lines) == "~ Count is 24." &&
+        joinLines(rec.lines) == joinLines(unbudgeted.lines);
+    reportApiTest("step-budget", passed, passed ? "" :
+        "Got " + std::to_string(updates) + " updates (" + std::to_string(referenceUpdates) +
+        " without budget), lines: " + joinLines(rec.lines));
+
+    if (reference) Loreline_releaseInterpreter(reference);
+    if (interp) Loreline_releaseInterpreter(interp);
+    Loreline_releaseOptions(options);
+    Loreline_releaseScript(script);
+}
+
+/* Releasing an interpreter while it yields on its budget must not resume it */
+static void testApiStepBudgetRelease() {
+    Loreline_Script* script = parseApiScript(budgetScriptSource().c_str());
+    if (!script) {
+        reportApiTest("step-budget-release", false, "Error parsing script");
+        return;
+    }
+
+    Loreline_update(0);
+
+    ApiRecorder rec;
+    Loreline_InterpreterOptions* options = Loreline_createOptions();
+    Loreline_optionsSetStepBudget(options, 4, 0);
+    Loreline_Interpreter* interp = Loreline_play(
+        script, apiDialogue, apiChoice, apiFinish, Loreline_String(), options, &rec);
+    Loreline_update(0);
+    if (interp) Loreline_releaseInterpreter(interp);
+    updateUntilFinished(rec, 20);
+
+    bool passed = interp && rec.lines.empty() && !rec.finished;
+    reportApiTest("step-budget-release", passed, passed ? "" :
+        "Released interpreter resumed, lines: " + joinLines(rec.lines));
+
+    Loreline_releaseOptions(options);
+    Loreline_releaseScript(script);
+}
+
+/* Calls Loreline_update() until the interpreter presents a choice */
+static void updateUntilChoice(ApiRecorder& rec, int maxUpdates) {
+    for (int i = 0; i < maxUpdates && !rec.waitingChoice; i++) {
+        Loreline_update(0);
+    }
+}
+
+static int intStateField(Loreline_Interpreter* interp, const char* field) {
+    Loreline_Value value = Loreline_getStateField(interp, field);
+    return value.type == Loreline_Int ? value.intValue : -1;
+}
+
+/* A fork continues on its own: its choices and state never affect the source */
+static void testApiForkIndependence() {
+    const char* source =
+        "state\n"
+        "  coins: 1\n"
+        "\n"
+        "Start with $coins.\n"
+        "choice\n"
+        "  Spend\n"
+        "    coins = 0\n"
+        "    Spent, $coins left.\n"
+        "  Keep\n"
+        "    Kept $coins.\n";
+
+    Loreline_Script* script = parseApiScript(source);
+    if (!script) {
+        reportApiTest("fork-independence", false, "Error parsing script");
+        return;
+    }
+
+    ApiRecorder rec;
+    Loreline_Interpreter* interp = Loreline_play(
+        script, apiDialogue, apiChoice, apiFinish, Loreline_String(), nullptr, &rec);
+    updateUntilChoice(rec, 20);
+
+    ApiRecorder forkRec;
+    Loreline_Interpreter* fork = interp ? Loreline_forkInterpreter(
+        interp, apiDialogue, apiChoice, apiFinish, nullptr, &forkRec) : nullptr;
+    if (fork) {
+        updateUntilChoice(forkRec, 20);
+        Loreline_select(fork, 0);
+        updateUntilFinished(forkRec, 20);
+    }
+
+    int coinsAfterFork = interp ? intStateField(interp, "coins") : -1;
+    int forkCoins = fork ? intStateField(fork, "coins") : -1;
+
+    if (interp) {
+        Loreline_select(interp, 1);
+        updateUntilFinished(rec, 20);
+    }
+
+    bool passed = fork && forkRec.finished && rec.finished &&
+        coinsAfterFork == 1 && forkCoins == 0 &&
+        joinLines(forkRec.lines) == "+ Spend | + Keep | ~ Spent, 0 left." &&
+        joinLines(rec.lines) == "~ Start with 1. | + Spend | + Keep | ~ Kept 1.";
+    reportApiTest("fork-independence", passed, passed ? "" :
+        "Got coins=" + std::to_string(coinsAfterFork) + ", fork coins=" + std::to_string(forkCoins) +
+        ", lines: " + joinLines(rec.lines) + ", fork lines: " + joinLines(forkRec.lines));
+
+    if (fork) Loreline_releaseInterpreter(fork);
+    if (interp) Loreline_releaseInterpreter(interp);
+    Loreline_releaseScript(script);
+}
+
+/* Right after a collection, a step has nothing worth collecting, whatever the budget */
+static void testApiGcStepThreshold() {
+    Loreline_gc();
+    int collections = Loreline_memoryStats().collections;
+    bool collected = Loreline_gcStep(1.0);
+    bool passed = !collected && Loreline_memoryStats().collections == collections;
+    reportApiTest("gc-step-threshold", passed, passed ? "" : "Collected without enough growth");
+}
+
+static bool isIntValue(const Loreline_Value& value, int expected) {
+    return value.type == Loreline_Int && value.intValue == expected;
+}
+
+static bool isStringValue(const Loreline_Value& value, const char* expected) {
+    return value.type == Loreline_StringValue && std::string(value.stringValue.c_str()) == expected;
+}
+
+/* Batched setters apply their fields in order and copy the batch, which can be
+ * overwritten right after the call; batched getters read them back */
+static void testApiBatchedFields() {
+    const char* source =
+        "state\n"
+        "  coins: 0\n"
+        "  title: \"none\"\n"
+        "\n"
+        "character hero\n"
+        "  level: 1\n"
+        "  mood: \"calm\"\n"
+        "\n"
+        "hero: Ready.\n";
+
+    Loreline_Script* script = parseApiScript(source);
+    if (!script) {
+        reportApiTest("batched-fields", false, "Error parsing script");
+        return;
+    }
+
+    ApiRecorder rec;
+    rec.holdDialogues = true;
+    Loreline_Interpreter* interp = Loreline_play(
+        script, apiDialogue, apiChoice, apiFinish, Loreline_String(), nullptr, &rec);
+    for (int i = 0; i < 20 && !rec.waitingDialogue; i++) {
+        Loreline_update(0);
+    }
+
+    Loreline_Value stateValues[3];
+    Loreline_Value heroValues[2];
+    if (interp) {
+        {
+            std::vector<Loreline_String> fields = { "coins", "title", "coins" };
+            std::vector<Loreline_Value> values = {
+                Loreline_Value::from_int(3),
+                Loreline_Value::from_string("gold"),
+                Loreline_Value::from_int(5)
+            };
+            Loreline_setStateFields(interp, fields.data(), values.data(), (int)fields.size());
+
+            std::vector<Loreline_String> heroFields = { "level", "mood" };
+            std::vector<Loreline_Value> heroUpdates = {
+                Loreline_Value::from_int(2),
+                Loreline_Value::from_string("happy")
+            };
+            Loreline_setCharacterFields(interp, "hero", heroFields.data(), heroUpdates.data(), (int)heroFields.size());
+
+            /* The setters may not have run yet on the interpreter's worker */
+            fields.assign(fields.size(), Loreline_String("coins"));
+            values.assign(values.size(), Loreline_Value::from_int(-1));
+            heroFields.assign(heroFields.size(), Loreline_String("level"));
+            heroUpdates.assign(heroUpdates.size(), Loreline_Value::from_int(-1));
+        }
+
+        const Loreline_String stateFields[3] = { "coins", "title", Loreline_String() };
+        Loreline_getStateFields(interp, stateFields, 3, stateValues);
+
+        const Loreline_String heroFields[2] = { "level", "mood" };
+        Loreline_getCharacterFields(interp, "hero", heroFields, 2, heroValues);
+    }
+
+    bool passed = interp && rec.waitingDialogue &&
+        isIntValue(stateValues[0], 5) && isStringValue(stateValues[1], "gold") &&
+        stateValues[2].type == Loreline_Null &&
+        isIntValue(heroValues[0], 2) && isStringValue(heroValues[1], "happy") &&
+        intStateField(interp, "coins") == 5 &&
+        isIntValue(Loreline_getCharacterField(interp, "hero", "level"), 2);
+    reportApiTest("batched-fields", passed, passed ? "" :
+        "Batched fields did not round trip, lines: " + joinLines(rec.lines));
+
+    if (interp) Loreline_releaseInterpreter(interp);
+    Loreline_releaseScript(script);
+}
+
+/* Advances held dialogues until the interpreter presents a choice */
+static void advanceUntilChoice(Loreline_Interpreter* interp, ApiRecorder& rec, int maxUpdates) {
+    for (int i = 0; i < maxUpdates && !rec.waitingChoice; i++) {
+        if (rec.waitingDialogue) {
+            rec.waitingDialogue = false;
+            Loreline_advance(interp);
+        }
+        Loreline_update(0);
+    }
+}
+
+/* Looking ahead predicts the next lines without moving or changing the live interpreter */
+static void testApiPeekUpcoming() {
+    const char* source =
+        "state\n"
+        "  coins: 0\n"
+        "\n"
+        "First line.\n"
+        "coins += 1\n"
+        "Second line with $coins.\n"
+        "Third line.\n"
+        "choice\n"
+        "  Go\n"
+        "    Done.\n";
+
+    Loreline_Script* script = parseApiScript(source);
+    if (!script) {
+        reportApiTest("peek-upcoming", false, "Error parsing script");
+        return;
+    }
+
+    ApiRecorder rec;
+    rec.holdDialogues = true;
+    Loreline_Interpreter* interp = Loreline_play(
+        script, apiDialogue, apiChoice, apiFinish, Loreline_String(), nullptr, &rec);
+    for (int i = 0; i < 20 && !rec.waitingDialogue; i++) {
+        Loreline_update(0);
+    }
+
+    std::vector<std::string> predicted;
+    bool positionKept = false;
+    int coinsAfterPeek = -1;
+    if (interp && rec.waitingDialogue) {
+        Loreline_Node before = Loreline_currentNode(interp);
+
+        Loreline_UpcomingLine upcoming[4];
+        int count = Loreline_peekUpcoming(interp, upcoming, 4);
+        for (int i = 0; i < count; i++) {
+            std::string line = upcoming[i].character.isNull() ? "~ " : std::string(upcoming[i].character.c_str()) + ": ";
+            predicted.push_back(line + upcoming[i].text.c_str());
+        }
+
+        Loreline_Node after = Loreline_currentNode(interp);
+        positionKept = !before.type.isNull() && !after.type.isNull() &&
+            std::string(before.type.c_str()) == after.type.c_str() &&
+            before.offset == after.offset && before.length == after.length;
+        coinsAfterPeek = intStateField(interp, "coins");
+    }
+    std::string linesAfterPeek = joinLines(rec.lines);
+
+    if (interp) advanceUntilChoice(interp, rec, 20);
+
+    bool passed = positionKept && coinsAfterPeek == 0 &&
+        joinLines(predicted) == "~ Second line with 1. | ~ Third line." &&
+        linesAfterPeek == "~ First line." &&
+        joinLines(rec.lines) == "~ First line. | ~ Second line with 1. | ~ Third line. | + Go";
+    reportApiTest("peek-upcoming", passed, passed ? "" :
+        "Got coins=" + std::to_string(coinsAfterPeek) + (positionKept ? "" : ", position moved") +
+        ", predicted: " + joinLines(predicted) + ", lines: " + joinLines(rec.lines));
+
+    if (interp) Loreline_releaseInterpreter(interp);
+    Loreline_releaseScript(script);
+}
+
+/* With a fixed seed and a single thread, a weighted simulation always gives the same results */
+static void testApiSimulateDeterministic() {
+    const char* source =
+        "state\n"
+        "  roll: 0\n"
+        "\n"
+        "roll = random(1, 6)\n"
+        "choice\n"
+        "  Left\n"
+        "    -> Left\n"
+        "  Right if roll > 3\n"
+        "    -> Right\n"
+        "\n"
+        "beat Left\n"
+        "  Left side.\n"
+        "\n"
+        "beat Right\n"
+        "  Right side.\n";
+
+    Loreline_Script* script = parseApiScript(source);
+    if (!script) {
+        reportApiTest("simulate-deterministic", false, "Error parsing script");
+        return;
+    }
+
+    Loreline_String first = Loreline_simulate(script, "weighted", 40, 1234, 1);
+    Loreline_String second = Loreline_simulate(script, "weighted", 40, 1234, 1);
+    Loreline_String randomFirst = Loreline_simulate(script, "random", 40, 1234, 1);
+    Loreline_String randomSecond = Loreline_simulate(script, "random", 40, 1234, 1);
+
+    bool passed = !first.isNull() && !randomFirst.isNull() &&
+        std::string(first.c_str()).find("\"runs\":40") != std::string::npos &&
+        std::string(first.c_str()) == (second.isNull() ? "" : second.c_str()) &&
+        std::string(randomFirst.c_str()) == (randomSecond.isNull() ? "" : randomSecond.c_str());
+    reportApiTest("simulate-deterministic", passed, passed ? "" :
+        std::string("Got ") + (first.isNull() ? "null" : first.c_str()) +
+        " then " + (second.isNull() ? "null" : second.c_str()));
+
+    Loreline_releaseScript(script);
+}
+
+/* Interpreters suspended on a choice can be continued in any order with Loreline_select,
+ * which does nothing once the interpreter is no longer waiting, and the wrong
+ * continuation call leaves a pending dialogue or choice resumable */
+static void testApiSelect() {
+    const char* source =
+        "Pick a door.\n"
+        "choice\n"
+        "  Red\n"
+        "    Red room.\n"
+        "  Blue\n"
+        "    Blue room.\n";
+
+    Loreline_Script* script = parseApiScript(source);
+    if (!script) {
+        reportApiTest("select", false, "Error parsing script");
+        return;
+    }
+
+    ApiRecorder first;
+    ApiRecorder second;
+    Loreline_Interpreter* firstInterp = Loreline_play(
+        script, apiDialogue, apiChoice, apiFinish, Loreline_String(), nullptr, &first);
+    Loreline_Interpreter* secondInterp = Loreline_play(
+        script, apiDialogue, apiChoice, apiFinish, Loreline_String(), nullptr, &second);
+    updateUntilChoice(first, 20);
+    updateUntilChoice(second, 20);
+
+    /* Advancing a pending choice must leave it waiting for a selection */
+    if (firstInterp) Loreline_advance(firstInterp);
+    for (int i = 0; i < 5; i++) {
+        Loreline_update(0);
+    }
+    std::string afterWrongAdvance = joinLines(first.lines);
+
+    /* Continue the last suspended interpreter first */
+    if (secondInterp) Loreline_select(secondInterp, 1);
+    if (firstInterp) Loreline_select(firstInterp, 0);
+    updateUntilFinished(first, 20);
+    updateUntilFinished(second, 20);
+
+    /* Not waiting on a choice anymore */
+    if (firstInterp) Loreline_select(firstInterp, 1);
+    for (int i = 0; i < 5; i++) {
+        Loreline_update(0);
+    }
+
+    /* Selecting on a pending dialogue must leave it waiting to be advanced */
+    ApiRecorder held;
+    held.holdDialogues = true;
+    Loreline_Interpreter* heldInterp = Loreline_play(
+        script, apiDialogue, apiChoice, apiFinish, Loreline_String(), nullptr, &held);
+    for (int i = 0; i < 20 && !held.waitingDialogue; i++) {
+        Loreline_update(0);
+    }
+    if (heldInterp) Loreline_select(heldInterp, 0);
+    for (int i = 0; i < 5; i++) {
+        Loreline_update(0);
+    }
+    std::string afterWrongSelect = joinLines(held.lines);
+    if (heldInterp) {
+        held.waitingDialogue = false;
+        Loreline_advance(heldInterp);
+        updateUntilChoice(held, 20);
+    }
+
+    bool passed = first.finished && second.finished && held.waitingChoice &&
+        afterWrongAdvance == "~ Pick a door. | + Red | + Blue" &&
+        afterWrongSelect == "~ Pick a door." &&
+        joinLines(held.lines) == "~ Pick a door. | + Red | + Blue" &&
+        joinLines(first.lines) == "~ Pick a door. | + Red | + Blue | ~ Red room." &&
+        joinLines(second.lines) == "~ Pick a door. | + Red | + Blue | ~ Blue room.";
+    reportApiTest("select", passed, passed ? "" :
+        "Got lines: " + joinLines(first.lines) + ", then: " + joinLines(second.lines) +
+        ", held: " + joinLines(held.lines));
+
+    if (heldInterp) Loreline_releaseInterpreter(heldInterp);
+    if (secondInterp) Loreline_releaseInterpreter(secondInterp);
+    if (firstInterp) Loreline_releaseInterpreter(firstInterp);
+    Loreline_releaseScript(script);
+}
+
+static void runApiTests() {
+    testApiStateChangedFromFunction();
+    testApiStepBudget();
+    testApiStepBudgetRelease();
+    testApiForkIndependence();
+    testApiGcStepThreshold();
+    testApiBatchedFields();
+    testApiPeekUpcoming();
+    testApiSimulateDeterministic();
+    testApiSelect();
+}
+
 /* ── Main ───────────────────────────────────────────────────────────────── */
 
 int main(int argc, char* argv[]) {
@@ -669,6 +1296,8 @@ int main(int argc, char* argv[]) {
     Loreline_translationFormat(Loreline_String("xliff"), true);
     Loreline_translationFormat(Loreline_String("csv"), true);
 
+    parseCache = Loreline_createParseCache();
+
     auto testFiles = collectTestFiles(testDir);
     if (testFiles.empty()) {
         fprintf(stderr, "No test files found in %s\n", testDir.c_str());
@@ -716,6 +1345,69 @@ int main(int argc, char* argv[]) {
             }
         }
 
+        /* Prepared script test: same items, interpreters sharing prepared data */
+        {
+            std::string label = filePath + " ~ LF ~ prepared";
+
+            bool allPassed = true;
+            TestResult firstFailure;
+
+            for (const auto& item : testItems) {
+                auto result = runTest(filePath, rawContent, item, false, true);
+                if (!result.passed && allPassed) {
+                    allPassed = false;
+                    firstFailure = result;
+                }
+            }
+
+            if (allPassed) {
+                passCount++;
+                printf(CLR_BOLD_GREEN "PASS" CLR_RESET " - " CLR_GRAY "%s" CLR_RESET "\n", label.c_str());
+            } else {
+                failCount++;
+                printf(CLR_BOLD_RED "FAIL" CLR_RESET " - " CLR_GRAY "%s" CLR_RESET "\n", label.c_str());
+                if (!firstFailure.error.empty()) {
+                    printf("  Error: %s\n", firstFailure.error.c_str());
+                }
+                showDiff(firstFailure.expected, firstFailure.actual);
+            }
+        }
+
+        /* Binary and delta save tests: same items, saving with Loreline_saveBinary,
+           or with Loreline_saveDelta at every event and merging the chain */
+        for (int format = 0; format < 2; format++) {
+            bool delta = (format == 1);
+            std::string label = filePath + (delta ? " ~ LF ~ delta-save" : " ~ LF ~ binary-save");
+
+            bool allPassed = true;
+            bool hasSave = false;
+            TestResult firstFailure;
+
+            for (const auto& item : testItems) {
+                if (item.saveAtChoice < 0 && item.saveAtDialogue < 0) continue;
+                hasSave = true;
+                auto result = runTest(filePath, rawContent, item, false, false, !delta, delta);
+                if (!result.passed && allPassed) {
+                    allPassed = false;
+                    firstFailure = result;
+                }
+            }
+
+            if (!hasSave) {
+                /* Nothing saved in this file */
+            } else if (allPassed) {
+                passCount++;
+                printf(CLR_BOLD_GREEN "PASS" CLR_RESET " - " CLR_GRAY "%s" CLR_RESET "\n", label.c_str());
+            } else {
+                failCount++;
+                printf(CLR_BOLD_RED "FAIL" CLR_RESET " - " CLR_GRAY "%s" CLR_RESET "\n", label.c_str());
+                if (!firstFailure.error.empty()) {
+                    printf("  Error: %s\n", firstFailure.error.c_str());
+                }
+                showDiff(firstFailure.expected, firstFailure.actual);
+            }
+        }
+
         /* Roundtrip tests for each mode (LF, CRLF) */
         for (int mode = 0; mode < 2; mode++) {
             bool crlf = (mode == 1);
@@ -878,6 +1570,8 @@ int main(int argc, char* argv[]) {
         if (failCount > failBefore) fileFailCount++;
     }
 
+    runApiTests();
+
     int total = passCount + failCount;
     printf("\n");
     if (failCount == 0) {
@@ -886,6 +1580,7 @@ int main(int argc, char* argv[]) {
         printf(CLR_BOLD_RED "  %d of %d tests failed (%d of %d files)" CLR_RESET "\n", failCount, total, fileFailCount, fileCount);
     }
 
+    Loreline_releaseParseCache(parseCache);
     Loreline_dispose();
 
     return failCount > 0 ? 1 : 0;
@@ -320,9 +320,11 @@ class AstUtils {
      * Extract translations from a parsed translation file.
      * Returns a map of localization key → NStringLiteral.
      * Looks for hash comments (#key) on text/dialogue nodes.
+     * When `into` is provided, entries are added to that map instead of a new one,
+     * with their key prefixed by `keyPrefix` (if any).
      */
-    public static function extractTranslations(node:AstNode):Map<String, NStringLiteral> {
-        final result = new Map<String, NStringLiteral>();
+    public static function extractTranslations(node:AstNode, ?into:Map<String, NStringLiteral>, ?keyPrefix:String):Map<String, NStringLiteral> {
+        final result = into ?? new Map<String, NStringLiteral>();
         node.each((child, _) -> {
             var str:NStringLiteral = null;
             var astNode:AstNode = null;
@@ -332,7 +334,7 @@ class AstUtils {
             if (str != null && astNode != null) {
                 final hashId = findHashComment(astNode, str);
                 if (hashId != null) {
-                    result.set(hashId, str);
+                    result.set(keyPrefix != null ? keyPrefix + hashId : hashId, str);
                 }
             }
         });
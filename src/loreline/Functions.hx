@@ -864,7 +864,7 @@ class Functions {
      * ```
      */
     public function map_set(map:Any, key:String, value:Any):Dynamic {
-        Objects.setField(interpreter, map, key, value);
+        interpreter.assignField(map, key, value);
         return null;
     }
 
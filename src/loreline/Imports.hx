@@ -12,6 +12,8 @@ typedef ImportsErrorHandler = (error:Error)->Void;
 
 typedef ImportsCallback = (hasErrors:Bool, resolvedImports:Map<String,Tokens>)->Void;
 
+typedef ImportsLexHandler = (path:String, data:String, callback:(lexed:ParseCacheEntry)->Void)->Void;
+
 @:structInit
 @:allow(loreline.Imports)
 private class ImportsLoopInfo {
@@ -78,6 +80,15 @@ class Imports {
         return path;
     }
 
+    /**
+     * If provided, imported files are lexed through this handler instead of inline.
+     * The handler can lex the file on another thread (with `ParseCache.lex()`),
+     * but must invoke the callback on the thread that called `resolve()`.
+     * Files are then lexed concurrently while waiting for the others to be
+     * delivered, and parsing starts once every import is lexed.
+     */
+    public static var lexHandler:ImportsLexHandler = null;
+
     var handleFile:ImportsFileHandler;
 
     var handleError:ImportsErrorHandler;
@@ -88,6 +99,12 @@ class Imports {
 
     public var autoAddExtension:Bool = true;
 
+    /**
+     * If provided, imported files are lexed through this cache,
+     * reusing the tokens of files that did not change.
+     */
+    public var cache:ParseCache = null;
+
     var resolvedImports(default, null):Map<String,Tokens> = null;
 
     var done:ImportsCallback = null;
@@ -145,49 +162,73 @@ class Imports {
     function handleItemInLoop(item:String, loopInfo:ImportsLoopInfo, toImport:Array<String>, visitedImports:Map<String,Bool>, resolvedImports:Map<String,Tokens>) {
 
         handleFile(item, data -> {
-            pendingImports--;
             if (data != null) {
-                try {
-                    final lexer = new Lexer(data);
-                    final tokens = lexer.tokenize();
-
-                    final lexerErrors = lexer.getErrors();
-                    if (lexerErrors != null && lexerErrors.length > 0) {
-                        handleError(lexerErrors[0]);
-                    }
-
-                    resolvedImports.set(item, tokens);
-
-                    extractImports(Path.directory(item), tokens, toImport, visitedImports);
-
-                    // If still in the while loop, new imports will be processed in the current loop anyway
-                    if (loopInfo.finished) {
-                        // But if not, then we are asynchronous, let's explicitly process imports
-                        processImports(toImport, visitedImports, resolvedImports);
-                    }
+                final cached = cache?.get(item, data);
+                if (cached != null) {
+                    handleTokens(item, cached.tokens, cached.errors, loopInfo, toImport, visitedImports, resolvedImports);
+                }
+                else if (lexHandler != null) {
+                    lexHandler(item, data, lexed -> {
+                        cache?.store(item, lexed);
+                        handleTokens(item, lexed.tokens, lexed.errors, loopInfo, toImport, visitedImports, resolvedImports);
+                    });
                 }
-                catch (e:Any) {
-                    hasErrors = true;
-                    if (e is Error) {
-                        handleError(e);
-                    }
-                    else {
-                        throw e;
-                    }
+                else {
+                    final lexed = ParseCache.lex(data);
+                    cache?.store(item, lexed);
+                    handleTokens(item, lexed.tokens, lexed.errors, loopInfo, toImport, visitedImports, resolvedImports);
                 }
             }
             else {
+                pendingImports--;
                 hasErrors = true;
-            }
-            if (loopInfo.finished && pendingImports == 0 && done != null) {
-                this.resolvedImports = resolvedImports;
-                done(hasErrors, resolvedImports);
-                done = null;
+                checkDone(loopInfo, resolvedImports);
             }
         });
 
     }
 
+    function handleTokens(item:String, tokens:Tokens, lexerErrors:Array<LexerError>, loopInfo:ImportsLoopInfo, toImport:Array<String>, visitedImports:Map<String,Bool>, resolvedImports:Map<String,Tokens>) {
+
+        pendingImports--;
+        try {
+            if (lexerErrors != null && lexerErrors.length > 0) {
+                handleError(lexerErrors[0]);
+            }
+
+            resolvedImports.set(item, tokens);
+
+            extractImports(Path.directory(item), tokens, toImport, visitedImports);
+
+            // If still in the while loop, new imports will be processed in the current loop anyway
+            if (loopInfo.finished) {
+                // But if not, then we are asynchronous, let's explicitly process imports
+                processImports(toImport, visitedImports, resolvedImports);
+            }
+        }
+        catch (e:Any) {
+            hasErrors = true;
+            if (e is Error) {
+                handleError(e);
+            }
+            else {
+                throw e;
+            }
+        }
+        checkDone(loopInfo, resolvedImports);
+
+    }
+
+    function checkDone(loopInfo:ImportsLoopInfo, resolvedImports:Map<String,Tokens>) {
+
+        if (loopInfo.finished && pendingImports == 0 && done != null) {
+            this.resolvedImports = resolvedImports;
+            done(hasErrors, resolvedImports);
+            done = null;
+        }
+
+    }
+
     function extractImports(cwd:String, tokens:Tokens, toImport:Array<String>, visitedImports:Map<String,Bool>) {
 
         // Tokens are enough to extract imports, as they are
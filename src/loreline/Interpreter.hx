@@ -8,7 +8,9 @@ import loreline.Lens;
 import loreline.Lexer;
 import loreline.Node;
 import loreline.Objects;
+import loreline.Profiler;
 import loreline.SaveData;
+import loreline.ShapedFields;
 
 using StringTools;
 using loreline.Utf8;
@@ -39,6 +41,19 @@ class RuntimeState {
      */
     public var originalFields(default, null):Any;
 
+    /**
+     * Whether this state may have changed since the last save checkpoint.
+     * Set whenever its fields are accessed by the script or the host, as values
+     * read from it (arrays, objects) can then be modified in place.
+     */
+    @:noCompletion public var dirty:Bool = true;
+
+    /**
+     * Serialized fields of this state at the last save checkpoint, if any.
+     * Used by `saveDelta()` to only emit fields that changed.
+     */
+    @:noCompletion public var savedFields:Dynamic = null;
+
     /**
      * Creates a new runtime state with optional initial field values.
      *
@@ -57,7 +72,7 @@ class RuntimeState {
             this.originalFields = originalFields;
         }
         else {
-            createOriginalFields();
+            createOriginalFields(interpreter, node);
         }
     }
 
@@ -69,10 +84,11 @@ class RuntimeState {
     }
 
     /**
-     * Creates empty original fields.
+     * Creates empty original fields, with the field shape of the node if it has one.
      */
-    function createOriginalFields():Void {
-        this.originalFields = Objects.createFields();
+    function createOriginalFields(interpreter:Interpreter, node:Node):Void {
+        final shape = interpreter != null && node != null ? interpreter.fieldShape(node) : null;
+        this.originalFields = shape != null ? new ShapedFields(shape) : Objects.createFields();
     }
 
 }
@@ -256,6 +272,61 @@ class RuntimeInsertion {
 
 }
 
+/**
+ * A part of a compiled string template.
+ */
+enum RuntimeStringPart {
+
+    /**
+     * Static text, already trimmed, stripped of comments and indents, and unescaped.
+     *
+     * @param text The text to output
+     * @param length The length of the source text, used to compute tag offsets
+     */
+    Segment(text:String, length:Int);
+
+    /**
+     * An interpolated expression.
+     *
+     * @param expr The expression to evaluate
+     * @param access The same expression if it is an access (that may reference a character), or null
+     */
+    Interpolated(expr:NExpr, access:NAccess);
+
+    /**
+     * A text tag.
+     *
+     * @param closing Whether this is a closing tag
+     * @param content The tag content
+     */
+    TagMark(closing:Bool, content:NStringLiteral);
+
+}
+
+/**
+ * A string literal compiled once for evaluation: string literal processors are
+ * applied and everything that only depends on the literal itself (whitespace
+ * trimming, comments and indents stripping, escapes) is resolved ahead of time.
+ */
+class RuntimeStringTemplate {
+
+    /**
+     * The parts to concatenate, with adjacent static text merged.
+     */
+    public final parts:Array<RuntimeStringPart>;
+
+    /**
+     * Whether the template has tags (thus needs text offsets to be computed).
+     */
+    public final hasTags:Bool;
+
+    public function new(parts:Array<RuntimeStringPart>, hasTags:Bool) {
+        this.parts = parts;
+        this.hasTags = hasTags;
+    }
+
+}
+
 /**
  * Represents a tag in text content, which can be used for styling or other purposes.
  */
@@ -280,6 +351,32 @@ class TextTag {
     public var offset:Int;
 }
 
+/**
+ * A dialogue or text line predicted by `Interpreter.peekUpcoming()`.
+ */
+@:structInit
+class UpcomingLine {
+    /**
+     * The text or dialogue statement node of the line.
+     */
+    public var node:AstNode;
+
+    /**
+     * The character speaking, or null for narrative text.
+     */
+    public var character:String;
+
+    /**
+     * The text of the line.
+     */
+    public var text:String;
+
+    /**
+     * Any tags associated with the text.
+     */
+    public var tags:Array<TextTag>;
+}
+
 /**
  * Represents a choice option presented to the user.
  */
@@ -451,9 +548,27 @@ typedef InterpreterOptions = {
     /**
      * Optional translations map (localization key → translated string literal).
      * When set, evaluateString() substitutes tagged text with translated versions.
+     * Can be replaced at any time to switch locale: text evaluated afterwards
+     * uses the new translations, without restarting or restoring the interpreter.
      */
     public var translations:Null<Map<String, NStringLiteral>>;
 
+    /**
+     * Translated string literals by node id, resolved from `translations`.
+     */
+    var translationIndex:NodeIdMap<NStringLiteral> = null;
+
+    /**
+     * The translations `translationIndex` has been resolved from.
+     */
+    var translationIndexSource:Map<String, NStringLiteral> = null;
+
+    /**
+     * Whether `translationIndex` covers every translated node (nodes missing from it have no translation),
+     * or is filled as nodes are evaluated (nodes without translation are mapped to their original literal).
+     */
+    var translationIndexComplete:Bool = false;
+
     /**
      * User-defined dialogue handler,
      * which takes care of displaying the dialogues.
@@ -484,6 +599,12 @@ typedef InterpreterOptions = {
      */
     final topLevelCharacters:Map<String, RuntimeCharacter> = new Map();
 
+    /**
+     * Names of the top level characters, by their fields object. Filled by `addTopLevelCharacter()`
+     * so that `assignField()` can tell which character a field belongs to without a search.
+     */
+    final characterNamesByFields:haxe.ds.ObjectMap<Dynamic, String> = new haxe.ds.ObjectMap();
+
     /**
      * All the top level beats available, by beat name (their identifier in the script).
      */
@@ -517,6 +638,17 @@ typedef InterpreterOptions = {
      */
     public var stringLiteralProcessors:Array<(str:NStringLiteral) -> NStringLiteral> = [];
 
+    /**
+     * Compiled string templates, by string literal.
+     */
+    final stringTemplates:Map<NStringLiteral, RuntimeStringTemplate> = new Map();
+
+    /**
+     * Number of string literal processors when templates were compiled,
+     * to invalidate them if processors are added afterwards.
+     */
+    var stringTemplatesProcessors:Int = -1;
+
     /**
      * The current execution stack, which consists of scopes added on top of one another.
      * Each scope can have its own local beats and temporary states.
@@ -528,12 +660,28 @@ typedef InterpreterOptions = {
      */
     final lens:Lens;
 
+    /**
+     * The prepared data shared with other interpreters of the same script, if any.
+     */
+    final prepared:PreparedScript;
+
+    /**
+     * Field shapes built by this interpreter when its script is not prepared.
+     */
+    var localFieldShapes:NodeIdMap<FieldShape> = null;
+
     /**
      * Tells whether access is strict or not. If set to true,
      * trying to read or write an undefined variable will throw an error.
      */
     final strictAccess:Bool;
 
+    /**
+     * The profiler recording this interpreter evaluation,
+     * if `Profiler.enabled` was set when the interpreter got created.
+     */
+    public final profiler:Null<Profiler>;
+
     /**
      * Current scope associated with current execution state.
      */
@@ -582,10 +730,83 @@ typedef InterpreterOptions = {
      */
     var nextInsertionId:Int = 1;
 
+    /**
+     * Token of the latest save checkpoint (`save()` or `saveDelta()`), 0 if none.
+     * A delta can only be created since the latest checkpoint.
+     */
+    public var saveToken(default, null):Int = 0;
+
+    /**
+     * Called after the script or the host assigns a field of the top level state
+     * (path: `name`) or of a character (path: `character.name`), with the path and
+     * the new value. Other states, nested objects modified in place, initialization
+     * of declarations and restoring save data are not reported.
+     */
+    public var onStateChange:(interpreter:Interpreter, path:String, value:Any)->Void = null;
+
+    /**
+     * Maximum number of evaluation steps run in one go, 0 for no limit.
+     * Once reached, the interpreter yields and continues on the next tick:
+     * the next `Timer.update()` on sys targets (when the host runs an update
+     * loop), the next event loop turn on JS. A single function call is never split.
+     */
+    public var stepBudget:Int = 0;
+
+    /**
+     * Maximum time, in seconds, spent running in one go, 0 for no limit.
+     * Works like `stepBudget`, whichever limit is reached first.
+     */
+    public var timeBudget:Float = 0;
+
+    /**
+     * Whether a yielded `flush()` is waiting to continue on the next tick.
+     */
+    var flushScheduled:Bool = false;
+
+    /**
+     * Whether steps are being counted against the budget. Opened by the first
+     * step spent, closed when the outer `flush()` completes or yields.
+     */
+    var budgetOpen:Bool = false;
+
+    /**
+     * Steps run since the budget was opened, including the statements
+     * evaluated in place by `evalNodeBody()`.
+     */
+    var budgetSteps:Int = 0;
+
+    /**
+     * Time stamp at which the open budget runs out of time, 0 for none.
+     */
+    var budgetDeadline:Float = 0;
+
+    /**
+     * Whether `dispose()` was called: a pending flush is then dropped.
+     */
+    var disposed:Bool = false;
+
+    /**
+     * Whether `save()` creates a save checkpoint. Disabled while forking,
+     * so that forks don't affect the deltas of this interpreter.
+     */
+    var checkpointing:Bool = true;
+
     /**
      * List of pending callbacks that should be run synchronously.
      */
-    var syncCallbacks:Array<()->Void> = [];
+    final syncCallbacks:Array<()->Void> = [];
+
+    /**
+     * Callbacks waiting to be run by `flush()`, in reverse order:
+     * the next callback to run is always the last one.
+     */
+    final flushQueue:Array<()->Void> = [];
+
+    /**
+     * Continuation given to statements which always complete synchronously
+     * when evaluated in place by `evalNodeBody()`.
+     */
+    static final syncNext:()->Void = () -> {};
 
     /**
      * Internal flag to know if we are currently flushing sync callbacks
@@ -654,10 +875,12 @@ typedef InterpreterOptions = {
         this.handleChoice = handleChoice;
         this.handleFinish = handleFinish;
 
-        this.lens = new Lens(script);
+        this.prepared = script.prepared;
+        this.lens = prepared != null ? prepared.lens : new Lens(script);
 
         this.strictAccess = options?.strictAccess ?? false;
         this.translations = options?.translations;
+        this.profiler = Profiler.enabled ? new Profiler() : null;
 
         #if ((loreline_cs_api || loreline_jvm_api) && !macro)
         this.wrapper = options?.wrapper;
@@ -786,6 +1009,7 @@ typedef InterpreterOptions = {
      * Saves the current state of the interpreter.
      * This includes all state variables, character states, and execution stack,
      * allowing execution to be resumed later from the exact same point.
+     * Also creates a save checkpoint that `saveDelta()` can start from.
      *
      * @return A SaveData object containing the serialized state
      */
@@ -798,7 +1022,7 @@ typedef InterpreterOptions = {
             stack: [
                 for (scope in stack) serializeScope(scope, insertions)
             ],
-            state: serializeState(topLevelState),
+            state: checkpointState(topLevelState, serializeState(topLevelState)),
             characters: serializeCharacters(),
             nodeStates: serializeNodeStates()
         };
@@ -806,27 +1030,212 @@ typedef InterpreterOptions = {
         // Save pending choice options (from choices with insertions awaiting user input).
         // Must be serialized before the insertions length check, since serializing
         // options may populate the insertions map.
-        if (pendingChoiceOptions != null) {
-            result.pendingChoiceOptions = [
-                for (opt in pendingChoiceOptions) serializeChoiceOption(opt, insertions)
-            ];
+        final pendingOptions = serializePendingChoiceOptions(insertions);
+        if (pendingOptions != null) {
+            result.pendingChoiceOptions = pendingOptions;
         }
 
         // Save choice evaluation context if inside a choice option body
-        if (_choiceEvalTexts.length > 0) {
-            result.choiceEvalContext = [
-                for (i in 0..._choiceEvalTexts.length) {
-                    final entry:SaveDataChoiceOption = { text: _choiceEvalTexts[i] };
-                    if (!_choiceEvalEnabled[i]) entry.disabled = true;
-                    entry;
+        final choiceEvalContext = serializeChoiceEvalContext();
+        if (choiceEvalContext != null) {
+            result.choiceEvalContext = choiceEvalContext;
+        }
+
+        if (Reflect.fields(insertions).length > 0) {
+            result.insertions = insertions;
+        }
+
+        if (checkpointing) {
+            result.token = ++saveToken;
+        }
+
+        return result;
+
+    }
+
+    /**
+     * Creates an independent copy of this interpreter, at the same point of execution,
+     * to explore what happens next (for instance after picking a given choice option)
+     * without affecting this interpreter.
+     *
+     * The copy is restored from an in-memory snapshot, no serialization involved,
+     * and shares the prepared data of the script (lens, compiled functions) with
+     * this interpreter and its other forks. Call `resume()` on the fork to continue
+     * its execution: a pending choice is then presented again to its handlers.
+     *
+     * @param handleDialogue Function to call when the fork displays dialogue text
+     * @param handleChoice Function to call when the fork presents choices
+     * @param handleFinish Function to call when the fork finishes
+     * @param options Options of the fork (custom functions, translations...), not inherited from this interpreter
+     * @return The fork, ready to be resumed
+     */
+    public function fork(handleDialogue:DialogueHandler, handleChoice:ChoiceHandler, handleFinish:FinishHandler, ?options:InterpreterOptions):Interpreter {
+
+        // Forks share the same prepared data instead of building their own lens
+        PreparedScript.prepare(script);
+
+        final forked = new Interpreter(script, handleDialogue, handleChoice, handleFinish, options);
+
+        checkpointing = false;
+        final saveData = try {
+            save();
+        }
+        catch (e:Any) {
+            checkpointing = true;
+            throw e;
+        }
+        checkpointing = true;
+
+        forked.restore(saveData);
+
+        return forked;
+
+    }
+
+    /**
+     * Predicts the lines this interpreter is about to display after the current one,
+     * so that the host can prefetch their assets (voice over, portraits...).
+     *
+     * Lines are evaluated ahead by a fork of this interpreter, which is then discarded:
+     * the state of this interpreter is left untouched. The fork doesn't have the host
+     * functions, so looking ahead stops at the first choice, at the end of the script,
+     * at the first asynchronous call (like `wait()`) and at the first call of a host
+     * function, since it may have side effects. Lines that depend on random values
+     * may not match the ones that will actually be displayed.
+     *
+     * Meant to be called from the dialogue handler, while the current line is displayed.
+     * Each call creates a new fork, so it costs about as much as `fork()` plus running
+     * the predicted lines: call it once per line instead of repeatedly.
+     *
+     * @param max The maximum number of lines to predict
+     * @return The predicted lines, in display order
+     */
+    public function peekUpcoming(max:Int):Array<UpcomingLine> {
+
+        final result:Array<UpcomingLine> = [];
+        if (max <= 0 || stack.length == 0) return result;
+
+        final current = currentNode();
+        var first = true;
+        var done = false;
+
+        final forked = fork(
+            (interpreter, character, text, tags, callback) -> {
+                if (done) return;
+                final node = interpreter.currentNode();
+                if (first) {
+                    // The fork displays the current line again first
+                    first = false;
+                    if (node == current) {
+                        callback();
+                        return;
+                    }
+                }
+                result.push({
+                    node: node,
+                    character: character,
+                    text: text,
+                    tags: tags
+                });
+                if (result.length >= max) {
+                    done = true;
+                    return;
                 }
-            ];
+                callback();
+            },
+            (interpreter, options, callback) -> done = true,
+            interpreter -> done = true,
+            {
+                strictAccess: strictAccess,
+                translations: translations
+            }
+        );
+        forked.stringLiteralProcessors = stringLiteralProcessors.copy();
+        forked.topLevelFunctions.set("wait", (seconds:Float) -> new Async(_ -> done = true));
+
+        try {
+            forked.resume();
+        }
+        catch (e:Any) {
+            // Most likely a host function, not available to the fork
+        }
+        done = true;
+
+        return result;
+
+    }
+
+    /**
+     * Saves what changed since a previous save checkpoint.
+     * Only state, character and node state fields that may have changed since then
+     * are serialized (states that were not accessed are skipped entirely), while the
+     * execution stack is always complete. The result can be applied onto the full
+     * save data of the chain with `SaveDelta.apply()` or `restoreDeltas()`.
+     *
+     * @param sinceToken The token of the latest checkpoint (`token` of the last `save()` or `saveDelta()` result)
+     * @return A SaveDataDelta object, which creates a new checkpoint
+     * @throws RuntimeError If `sinceToken` is not the latest checkpoint
+     */
+    public function saveDelta(sinceToken:Int):SaveDataDelta {
+
+        if (saveToken == 0 || sinceToken != saveToken) {
+            throw new RuntimeError('Cannot save delta since token $sinceToken: the latest save checkpoint is $saveToken', script.pos);
+        }
+
+        final insertions:Dynamic<SaveDataInsertion> = {};
+
+        final result:SaveDataDelta = {
+            version: 1,
+            since: sinceToken,
+            token: 0,
+            stack: [
+                for (scope in stack) serializeScope(scope, insertions)
+            ],
+            characters: {},
+            nodeStates: {}
+        };
+
+        if (topLevelState.dirty) {
+            final changes = serializeStateDelta(topLevelState, serializeState(topLevelState));
+            if (changes != null) {
+                result.state = changes;
+            }
+        }
+
+        for (name => character in topLevelCharacters) {
+            if (character.dirty) {
+                final changes = serializeStateDelta(character, serializeCharacter(character));
+                if (changes != null) {
+                    Reflect.setField(result.characters, name, changes);
+                }
+            }
+        }
+
+        for (id => state in nodeStates) {
+            if (state.dirty) {
+                final changes = serializeStateDelta(state, serializeState(state));
+                if (changes != null) {
+                    Reflect.setField(result.nodeStates, id.toString(), changes);
+                }
+            }
+        }
+
+        final pendingOptions = serializePendingChoiceOptions(insertions);
+        if (pendingOptions != null) {
+            result.pendingChoiceOptions = pendingOptions;
+        }
+
+        final choiceEvalContext = serializeChoiceEvalContext();
+        if (choiceEvalContext != null) {
+            result.choiceEvalContext = choiceEvalContext;
         }
 
         if (Reflect.fields(insertions).length > 0) {
             result.insertions = insertions;
         }
 
+        result.token = ++saveToken;
+
         return result;
 
     }
@@ -845,6 +1254,13 @@ typedef InterpreterOptions = {
             throw new RuntimeError("Unsupported save version: " + saveData.version, script.pos);
         }
 
+        // Restored save data becomes the latest checkpoint
+        saveToken = saveData.token ?? 0;
+        resetCheckpoint(topLevelState);
+        for (character in topLevelCharacters) {
+            resetCheckpoint(character);
+        }
+
         // Clear current state
         stack.resize(0);
         nodeStates.clear();
@@ -856,6 +1272,7 @@ typedef InterpreterOptions = {
 
         // Restore top level state
         restoreState(topLevelState, saveData.state);
+        topLevelState.savedFields = saveData.state?.fields;
 
         // Restore character states
         restoreCharacters(saveData.characters);
@@ -891,6 +1308,47 @@ typedef InterpreterOptions = {
 
     }
 
+    /**
+     * Restores the interpreter state from a full save data and a chain of deltas
+     * created since it with `saveDelta()`.
+     *
+     * @param saveData The full save data the chain starts from
+     * @param deltas The deltas to apply, in order
+     * @throws Error If a delta does not follow the previous checkpoint of the chain
+     */
+    public function restoreDeltas(saveData:SaveData, deltas:Array<SaveDataDelta>):Void {
+
+        restore(SaveDelta.apply(saveData, deltas));
+
+    }
+
+    /**
+     * Saves the current state of the interpreter in the compact binary format.
+     * Contains the same data as `save()` and creates a save checkpoint as well,
+     * but is written directly from the runtime state, without building save data.
+     *
+     * @return The encoded save data
+     */
+    public function saveBinary():haxe.io.Bytes {
+
+        return SaveBinary.save(this);
+
+    }
+
+    /**
+     * Restores the interpreter state from binary save data produced by `saveBinary()`
+     * (or `SaveBinary.encode()`), read directly into the runtime state.
+     *
+     * @param bytes The encoded save data
+     * @throws Error If the bytes are not valid binary save data, in which case
+     *               the interpreter is left untouched
+     */
+    public function restoreBinary(bytes:haxe.io.Bytes):Void {
+
+        SaveBinary.restore(this, bytes);
+
+    }
+
     /**
      * Resumes execution after restoring state.
      * This should be called after restore() to continue execution.
@@ -938,7 +1396,12 @@ typedef InterpreterOptions = {
      */
     public function getCharacter(name:String):Any {
 
-        return topLevelCharacters.get(name)?.fields;
+        final character = topLevelCharacters.get(name);
+        if (character != null) {
+            character.dirty = true;
+            return character.fields;
+        }
+        return null;
 
     }
 
@@ -951,9 +1414,10 @@ typedef InterpreterOptions = {
      */
     public function getCharacterField(character:String, name:String):Any {
 
-        final fields = topLevelCharacters.get(character)?.fields;
-        if (fields != null) {
-            return Objects.getField(this, fields, name);
+        final state = topLevelCharacters.get(character);
+        if (state != null) {
+            state.dirty = true;
+            return Objects.getField(this, state.fields, name);
         }
         return null;
 
@@ -968,8 +1432,9 @@ typedef InterpreterOptions = {
      */
     public function setCharacterField(character:String, name:String, value:Any):Void {
 
-        final fields = topLevelCharacters.get(character).fields;
-        Objects.setField(this, fields, name, value);
+        final state = topLevelCharacters.get(character);
+        state.dirty = true;
+        assignField(state.fields, name, value);
 
     }
 
@@ -999,6 +1464,7 @@ typedef InterpreterOptions = {
                 final stateInNode = nodeStates.get(scope.node.id);
                 if (stateInNode != null) {
                     if (Objects.fieldExists(this, stateInNode.fields, name)) {
+                        stateInNode.dirty = true;
                         return Objects.getField(this, stateInNode.fields, name);
                     }
                 }
@@ -1009,6 +1475,7 @@ typedef InterpreterOptions = {
 
         // Fall back to top-level state
         if (Objects.fieldExists(this, topLevelState.fields, name)) {
+            topLevelState.dirty = true;
             return Objects.getField(this, topLevelState.fields, name);
         }
 
@@ -1043,6 +1510,7 @@ typedef InterpreterOptions = {
                 final stateInNode = nodeStates.get(scope.node.id);
                 if (stateInNode != null) {
                     if (Objects.fieldExists(this, stateInNode.fields, name)) {
+                        stateInNode.dirty = true;
                         Objects.setField(this, stateInNode.fields, name, value);
                         return;
                     }
@@ -1053,7 +1521,8 @@ typedef InterpreterOptions = {
         }
 
         // Fall back to top-level state
-        Objects.setField(this, topLevelState.fields, name, value);
+        topLevelState.dirty = true;
+        assignField(topLevelState.fields, name, value);
 
     }
 
@@ -1065,6 +1534,7 @@ typedef InterpreterOptions = {
      */
     public function getTopLevelStateField(name:String):Any {
 
+        topLevelState.dirty = true;
         return Objects.getField(this, topLevelState.fields, name);
 
     }
@@ -1077,7 +1547,35 @@ typedef InterpreterOptions = {
      */
     public function setTopLevelStateField(name:String, value:Any):Void {
 
-        Objects.setField(this, topLevelState.fields, name, value);
+        topLevelState.dirty = true;
+        assignField(topLevelState.fields, name, value);
+
+    }
+
+    /**
+     * Sets a field of a fields object on behalf of the script or the host,
+     * reporting the change to `onStateChange` when it is a field of the
+     * top level state or of a character.
+     *
+     * @param fields The fields object to modify
+     * @param name The name of the field to set
+     * @param value The value to set
+     */
+    @:noCompletion public function assignField(fields:Any, name:String, value:Any):Void {
+
+        Objects.setField(this, fields, name, value);
+
+        if (onStateChange != null) {
+            if (fields == topLevelState.fields) {
+                onStateChange(this, name, value);
+            }
+            else {
+                final characterName = characterNamesByFields.get(fields);
+                if (characterName != null) {
+                    onStateChange(this, characterName + '.' + name, value);
+                }
+            }
+        }
 
     }
 
@@ -1244,7 +1742,7 @@ typedef InterpreterOptions = {
 
         final result:Dynamic<SaveDataCharacter> = {};
         for (name => character in topLevelCharacters) {
-            final serialized = serializeCharacter(character);
+            final serialized = checkpointState(character, serializeCharacter(character));
             if (Reflect.fields(serialized.fields).length > 0) {
                 Reflect.setField(result, name, serialized);
             }
@@ -1262,7 +1760,7 @@ typedef InterpreterOptions = {
 
         final result:Dynamic<SaveDataState> = {};
         for (id => state in nodeStates) {
-            final serialized = serializeState(state);
+            final serialized = checkpointState(state, serializeState(state));
             if (Reflect.fields(serialized.fields).length > 0) {
                 Reflect.setField(result, id.toString(), serialized);
             }
@@ -1271,6 +1769,90 @@ typedef InterpreterOptions = {
 
     }
 
+    /**
+     * Records serialized fields of a state as its value at the new save checkpoint.
+     *
+     * @param state The serialized state
+     * @param serialized Its serialized fields
+     * @return The serialized fields
+     */
+    function checkpointState(state:RuntimeState, serialized:SaveDataFields):SaveDataFields {
+
+        if (!checkpointing) return serialized;
+
+        state.savedFields = serialized.fields;
+        state.dirty = false;
+        return serialized;
+
+    }
+
+    /**
+     * Computes the changes of a state since the last save checkpoint,
+     * and records its serialized fields as its value at the new checkpoint.
+     *
+     * @param state The serialized state
+     * @param serialized Its serialized fields
+     * @return The changes, or null if nothing changed
+     */
+    function serializeStateDelta(state:RuntimeState, serialized:SaveDataFields):SaveDataFieldsDelta {
+
+        final changes = SaveDelta.diffFields(state.savedFields, serialized.fields);
+        if (changes != null && serialized.type != null) {
+            changes.type = serialized.type;
+        }
+
+        checkpointState(state, serialized);
+        return changes;
+
+    }
+
+    /**
+     * Forgets the value of a state at the last save checkpoint.
+     *
+     * @param state The state to reset
+     */
+    function resetCheckpoint(state:RuntimeState):Void {
+
+        state.savedFields = null;
+        state.dirty = true;
+
+    }
+
+    /**
+     * Serializes pending choice options, if any.
+     *
+     * @param insertions The insertions map to populate
+     * @return The serialized options or null
+     */
+    function serializePendingChoiceOptions(insertions:Dynamic<SaveDataInsertion>):Array<SaveDataChoiceOption> {
+
+        if (pendingChoiceOptions == null) return null;
+
+        return [
+            for (opt in pendingChoiceOptions) serializeChoiceOption(opt, insertions)
+        ];
+
+    }
+
+    /**
+     * Serializes the choice evaluation context, if inside a choice option body.
+     *
+     * @return The serialized context or null
+     */
+    function serializeChoiceEvalContext():Array<SaveDataChoiceOption> {
+
+        if (_choiceEvalTexts.length == 0) return null;
+
+        return [
+            for (i in 0..._choiceEvalTexts.length) {
+                final entry:SaveDataChoiceOption = { text: _choiceEvalTexts[i] };
+                if (!_choiceEvalEnabled[i]) entry.disabled = true;
+                entry;
+            }
+        ];
+
+    }
+
     /**
      * Serializes a beat reference for save data.
      *
@@ -1279,6 +1861,22 @@ typedef InterpreterOptions = {
      */
     function serializeBeatReference(beat:NBeatDecl):SaveDataBeat {
 
+        return {
+            id: beat.id.toString(),
+            path: beatPath(beat)
+        };
+
+    }
+
+    /**
+     * Resolves the path of a beat, as stored in save data: its name,
+     * prefixed with the names of its parent beats.
+     *
+     * @param beat The beat
+     * @return The path of the beat
+     */
+    function beatPath(beat:NBeatDecl):String {
+
         var path = beat.name;
         var parentBeat = beat;
 
@@ -1290,10 +1888,7 @@ typedef InterpreterOptions = {
         }
         while (parentBeat != null);
 
-        return {
-            id: beat.id.toString(),
-            path: path
-        };
+        return path;
 
     }
 
@@ -1334,13 +1929,19 @@ typedef InterpreterOptions = {
      */
     function serializeFields(fields:Any, ?originalFields:Any):SaveDataFields {
 
-        var type:String = null;
+        final type = serializedFieldsType(fields);
         final result:Dynamic = {};
 
-        if (fields is Fields) {
-            final cls = Type.getClass(fields);
-            if (cls != null)
-                type = Type.getClassName(cls);
+        if (fields is ShapedFields) {
+            final shaped:ShapedFields = cast fields;
+            for (key in shaped.keys()) {
+                final value = shaped.get(key);
+                if (originalFields == null || !Objects.fieldExists(this, originalFields, key) || !Equal.equal(this, Objects.getField(this, originalFields, key), value)) {
+                    Reflect.setField(result, key, serializeValue(value));
+                }
+            }
+        }
+        else if (fields is Fields) {
             final fieldMap:Fields = cast fields;
             for (key in fieldMap.lorelineFields(this)) {
                 Reflect.setField(result, key, serializeValue(fieldMap.lorelineGet(this, key)));
@@ -1357,7 +1958,6 @@ typedef InterpreterOptions = {
         }
         #if (loreline_cs_api && !macro)
         else if (Objects.isCsDict(fields)) {
-            type = null;
             final keys = Objects.getCsDictKeys(fields);
             for (key in keys) {
                 Reflect.setField(result, key, serializeValue(Objects.getCsDictField(fields, key)));
@@ -1365,7 +1965,6 @@ typedef InterpreterOptions = {
         }
         #elseif (loreline_jvm_api && !macro)
         else if (Objects.isJavaMap(fields)) {
-            type = null;
             final keys = Objects.getJavaMapKeys(fields);
             for (key in keys) {
                 Reflect.setField(result, key, serializeValue(Objects.getJavaMapField(fields, key)));
@@ -1373,9 +1972,6 @@ typedef InterpreterOptions = {
         }
         #end
         else {
-            final cls = Type.getClass(fields);
-            if (cls != null)
-                type = Type.getClassName(cls);
             for (field in Reflect.fields(fields)) {
                 final value = Reflect.getProperty(fields, field);
                 if (originalFields == null || !Objects.fieldExists(this, originalFields, field) || !Equal.equal(this, Objects.getField(this, originalFields, field), value)) {
@@ -1398,6 +1994,33 @@ typedef InterpreterOptions = {
 
     }
 
+    /**
+     * Resolves the type stored with serialized fields by `serializeFields()`:
+     * the class name of custom fields objects, null for maps and shaped fields.
+     *
+     * @param fields The fields to serialize
+     * @return The type, or null
+     */
+    function serializedFieldsType(fields:Any):String {
+
+        if (fields is ShapedFields || fields is StringMap) {
+            return null;
+        }
+        #if (loreline_cs_api && !macro)
+        if (Objects.isCsDict(fields)) {
+            return null;
+        }
+        #elseif (loreline_jvm_api && !macro)
+        if (Objects.isJavaMap(fields)) {
+            return null;
+        }
+        #end
+
+        final cls = Type.getClass(fields);
+        return cls != null ? Type.getClassName(cls) : null;
+
+    }
+
     /**
      * Serializes a value for save data.
      * Handles recursive serialization of objects and arrays.
@@ -1533,48 +2156,65 @@ typedef InterpreterOptions = {
 
         // Then iterate through each child node in the body
         var moveNext:()->Void = null;
+        var steps:EvalNext = null;
         moveNext = () -> {
 
-            if (currentInsertion?.options != null) {
-                // Insertion's choice has collected options — stop body evaluation.
-                // Same early-exit as evalNodeBody uses.
-                pop();
-                next();
-            }
-            // Check if we are in the resuming index
-            else if (index != -1 && index == resumeIndex) {
+            while (true) {
 
-                // That's the one
-                final childNode = body[index];
-                index++;
-                final done = wrapNext(moveNext);
-                resumeNode(childNode, scopeLevel + 1, done.cb);
-                done.sync = false;
+                if (currentInsertion?.options != null) {
+                    // Insertion's choice has collected options — stop body evaluation.
+                    // Same early-exit as evalNodeBody uses.
+                    pop();
+                    next();
+                    return;
+                }
+                // Check if we are in the resuming index
+                else if (index != -1 && index == resumeIndex) {
 
-            }
-            // Or check if we still have a node to evaluate
-            else if (index < body.length) {
+                    // That's the one
+                    final childNode = body[index];
+                    index++;
+                    steps.sync = true;
+                    resumeNode(childNode, scopeLevel + 1, steps.cb);
+                    steps.sync = false;
+                    return;
 
-                // Yes, do it
-                final childNode = body[index];
-                currentScope.head = childNode;
-                index++;
-                final done = wrapNext(moveNext);
-                evalNode(childNode, done.cb);
-                done.sync = false;
+                }
+                // Or check if we still have a node to evaluate
+                else if (index < body.length) {
 
-            }
-            else {
+                    // Yes, do it
+                    final childNode = body[index];
+                    currentScope.head = childNode;
+                    index++;
+
+                    // Same in place evaluation as evalNodeBody
+                    if (completesSynchronously(childNode) && !spendStep()) {
+                        evalNode(childNode, syncNext);
+                        continue;
+                    }
+
+                    steps.sync = true;
+                    evalNode(childNode, steps.cb);
+                    steps.sync = false;
+                    return;
+
+                }
+                else {
+
+                    // We are done, pop node scope
+                    // and finish that node body evaluation
+                    pop();
+                    next();
+                    return;
+                }
 
-                // We are done, pop node scope
-                // and finish that node body evaluation
-                pop();
-                next();
             }
 
         }
 
         // Start evaluating the body
+        steps = wrapSteps(moveNext);
         moveNext();
 
     }
@@ -2014,23 +2654,30 @@ typedef InterpreterOptions = {
      */
     function restoreBeatToResume(savedStack:Array<SaveDataScope>):NBeatDecl {
 
-        var beat:NBeatDecl = null;
+        if (savedStack.length == 0) return null;
 
-        if (savedStack.length > 0) {
-            final savedScope = savedStack[0];
-            beat = restoreBeat(savedScope.beat);
+        // Ensure we get the top level beat from what has been resolved
+        return topLevelBeatOf(restoreBeat(savedStack[0].beat));
 
-            // Ensure we get the top level beat from what has been resolved
-            if (beat != null) {
-                var parentBeat = beat;
-                do {
-                    parentBeat = lens.getFirstParentOfType(parentBeat, NBeatDecl);
-                    if (parentBeat != null) {
-                        beat = parentBeat;
-                    }
+    }
+
+    /**
+     * Resolves the top-level beat containing the given beat.
+     *
+     * @param beat The beat, or null
+     * @return The top-level beat (the beat itself if it is top-level), or null
+     */
+    function topLevelBeatOf(beat:NBeatDecl):NBeatDecl {
+
+        if (beat != null) {
+            var parentBeat = beat;
+            do {
+                parentBeat = lens.getFirstParentOfType(parentBeat, NBeatDecl);
+                if (parentBeat != null) {
+                    beat = parentBeat;
                 }
-                while (parentBeat != null);
             }
+            while (parentBeat != null);
         }
 
         return beat;
@@ -2047,12 +2694,24 @@ typedef InterpreterOptions = {
      */
     function restoreNode(savedNode:SaveDataNode, savedBeatId:NodeId, beat:NBeatDecl):AstNode {
 
+        return restoreNodeById(NodeId.fromString(savedNode.id), savedNode.type, savedBeatId, beat);
+
+    }
+
+    /**
+     * Restores a node from its saved id and type.
+     *
+     * @param nodeId The saved node id
+     * @param type The saved node type
+     * @param savedBeatId The ID of the beat in the saved data
+     * @param beat The restored beat
+     * @return The restored node, or null if it couldn't be found
+     */
+    function restoreNodeById(nodeId:NodeId, type:String, savedBeatId:NodeId, beat:NBeatDecl):AstNode {
+
         // Resolve beat id offset, if any
         final sectionOffset = beat.id.section - savedBeatId.section;
 
-        // Get node id
-        var nodeId = NodeId.fromString(savedNode.id);
-
         // Check if that node id is actually the same as the beat id
         if (nodeId == savedBeatId) {
             // If so, return the resolved beat!
@@ -2064,7 +2723,7 @@ typedef InterpreterOptions = {
 
         // Try resolve the node from that
         final node = lens.getNodeById(nodeId);
-        if (node != null && node.type() == savedNode.type) {
+        if (node != null && node.type() == type) {
             return cast node;
         }
 
@@ -2113,12 +2772,13 @@ typedef InterpreterOptions = {
         for (name in Reflect.fields(data)) {
             final characterData:SaveDataCharacter = Reflect.field(data, name);
             if (topLevelCharacters.exists(name)) {
-                restoreCharacter(topLevelCharacters.get(name), characterData);
+                restoreCharacter(topLevelCharacters.get(name), characterData).savedFields = characterData.fields;
             }
             else {
                 // Character no longer exists in script, create it?
                 final newCharacter = restoreCharacter(null, characterData);
-                topLevelCharacters.set(name, newCharacter);
+                newCharacter.savedFields = characterData.fields;
+                addTopLevelCharacter(name, newCharacter);
             }
         }
 
@@ -2136,6 +2796,7 @@ typedef InterpreterOptions = {
             final stateData:SaveDataState = Reflect.field(data, idStr);
 
             final nodeState = restoreState(null, stateData);
+            nodeState.savedFields = stateData.fields;
             nodeStates.set(id, nodeState);
         }
 
@@ -2269,37 +2930,19 @@ typedef InterpreterOptions = {
 
         if (func.name != null) {
             if (!func.external || !topLevelFunctions.exists(func.name)) {
-                final codeToLorscript = new CodeToLorscript();
-                try {
-                    final expr = codeToLorscript.process(func.code + (func.external ? " {}" : ""));
-                    #if loreline_debug_functions
-                    final offsets = @:privateAccess codeToLorscript.posOffsets;
-                    trace('\n'+func.code);
-                    trace('\n'+expr);
-                    trace(offsets.length + ' / ' + expr.uLength());
-                    trace(offsets.join(" "));
-                    var chars = [];
-                    var origChars = [];
-                    for (i in 0...expr.uLength()) {
-                        chars.push(expr.uCharAt(i).replace("\n", " "));
-                        origChars.push(func.code.uCharAt(i - offsets[i]).replace("\n", " "));
-                    }
-                    trace(origChars.join(" "));
-                    trace(chars.join(" "));
-                    #end
-                    final parser = new loreline.lorscript.Parser();
-                    parser.allowJSON = true;
-                    parser.allowTypes = true;
-                    final ast = parser.parseString(expr);
-                    final interp = new loreline.lorscript.Interp(this);
-                    final value:Dynamic = interp.execute(ast);
-                    topLevelFunctions.set(func.name, value);
+                if (prepared != null && prepared.isFunctionPending(func)) {
+                    // Code stored in a compiled image: only decode and
+                    // compile it if the function gets called
+                    var bound:Dynamic = null;
+                    topLevelFunctions.set(func.name, Reflect.makeVarArgs(args -> {
+                        if (bound == null) {
+                            bound = bindTopLevelFunction(func);
+                        }
+                        return Reflect.callMethod(null, bound, args);
+                    }));
                 }
-                catch (e:Any) {
-                    #if loreline_debug_functions
-                    trace(codeToLorscript.output.toString());
-                    #end
-                    throw new RuntimeError('Failed to parse function code: $e', func.pos);
+                else {
+                    topLevelFunctions.set(func.name, bindTopLevelFunction(func));
                 }
             }
         }
@@ -2309,6 +2952,27 @@ typedef InterpreterOptions = {
 
     }
 
+    /**
+     * Parses (or reuses the prepared code of) a top level function
+     * and binds it to this interpreter.
+     *
+     * @param func The function declaration
+     * @return The callable function value
+     */
+    function bindTopLevelFunction(func:NFunctionDecl):Dynamic {
+
+        try {
+            final ast = prepared != null ? prepared.functionExpr(func) : PreparedScript.parseFunction(func);
+            final compiled = prepared != null ? prepared.compiledFunction(func) : loreline.lorscript.Compiler.compileFunction(ast);
+            final interp = new loreline.lorscript.Interp(this);
+            return compiled != null ? compiled.bind(interp) : interp.execute(ast);
+        }
+        catch (e:Any) {
+            throw new RuntimeError('Failed to parse function code: $e', func.pos);
+        }
+
+    }
+
     /**
      * Wraps a callback function to control whether it executes synchronously or asynchronously.
      * This is crucial for managing the execution flow of the script.
@@ -2322,68 +2986,177 @@ typedef InterpreterOptions = {
 
         wrapped.sync = true;
 
-        wrapped.cb = () -> {
-            if (wrapped.sync) {
-                if (syncCallbacks == null) {
-                    syncCallbacks = [];
-                }
-                syncCallbacks.push(wrapped.cb);
-            }
-            else {
-                cb();
-                flush();
-                wrapped.cb = null;
-                if (finishTrigger == wrapped) {
-                    finish();
-                }
-            }
+        wrapped.cb = () -> {
+            if (wrapped.sync) {
+                syncCallbacks.push(wrapped.cb);
+            }
+            else {
+                cb();
+                flush();
+                wrapped.cb = null;
+                if (finishTrigger == wrapped) {
+                    finish();
+                }
+            }
+        };
+
+        return wrapped;
+
+    }
+
+    /**
+     * Like `wrapNext()`, for the loop of a body evaluating its children one after
+     * the other: the same EvalNext is given to every child instead of allocating
+     * a new one at each step. Set `sync` to `true` while evaluating a child and
+     * back to `false` once its evaluation returns. A child only calls it once,
+     * before the next one is evaluated.
+     *
+     * @param cb The callback moving to the next child
+     * @return An EvalNext object reused for every step of the body
+     */
+    function wrapSteps(cb:()->Void):EvalNext {
+
+        final wrapped = new EvalNext();
+
+        wrapped.sync = false;
+
+        wrapped.cb = () -> {
+            if (wrapped.sync) {
+                syncCallbacks.push(cb);
+            }
+            else {
+                cb();
+                flush();
+            }
+        };
+
+        return wrapped;
+
+    }
+
+    /**
+     * Flushes all pending synchronous callbacks.
+     * This ensures that all pending operations are completed before continuing.
+     */
+    function flush() {
+
+        if (flushing || disposed) return;
+        flushing = true;
+
+        try {
+            queueSyncCallbacks();
+            while (flushQueue.length > 0) {
+
+                // Out of budget: leave the rest of the queue for the next tick
+                if (spendStep()) {
+                    scheduleFlush();
+                    break;
+                }
+
+                // Flush next synchronous callback to execute,
+                // and allow to stack new callbacks that may
+                // be triggered from that parent callback
+                final cb = flushQueue.pop();
+
+                cb();
+
+                // If new callbacks were added during execution,
+                // they run before the rest of the queue
+                queueSyncCallbacks();
+            }
+        }
+        catch (e:Any) {
+            flushQueue.resize(0);
+            flushing = false;
+            budgetOpen = false;
+            throw e;
+        }
+
+        flushing = false;
+        budgetOpen = false;
+
+    }
+
+    /**
+     * Counts one step against the execution budget, if any.
+     * @return `true` if the budget is exhausted and the interpreter should yield
+     */
+    function spendStep():Bool {
+
+        if (stepBudget <= 0 && timeBudget <= 0) return false;
+        if (!budgetOpen) {
+            if (!canYield()) return false;
+            budgetOpen = true;
+            budgetSteps = 0;
+            budgetDeadline = timeBudget > 0 ? haxe.Timer.stamp() + timeBudget : 0.0;
+        }
+        budgetSteps++;
+        return (stepBudget > 0 && budgetSteps > stepBudget) || (budgetDeadline > 0 && haxe.Timer.stamp() >= budgetDeadline);
+
+    }
+
+    /**
+     * Stops this interpreter for good: a flush scheduled after running out of budget
+     * won't continue, and pending callbacks are dropped. Call it when the interpreter
+     * is discarded while it may still be yielding.
+     */
+    public function dispose():Void {
+
+        disposed = true;
+        syncCallbacks.resize(0);
+        flushQueue.resize(0);
+
+    }
+
+    /**
+     * Whether the interpreter can continue a flush on a later tick.
+     */
+    inline function canYield():Bool {
+
+        #if js
+        return true;
+        #elseif sys
+        return Timer.deferredMode;
+        #else
+        return false;
+        #end
+
+    }
+
+    /**
+     * Continues the flush queue on the next tick, after running out of budget.
+     */
+    function scheduleFlush() {
+
+        if (flushScheduled) return;
+        flushScheduled = true;
+
+        final next = () -> {
+            flushScheduled = false;
+            if (disposed) return;
+            flush();
         };
 
-        return wrapped;
+        #if js
+        haxe.Timer.delay(next, 0);
+        #else
+        Timer.register(0, next);
+        #end
 
     }
 
     /**
-     * Flushes all pending synchronous callbacks.
-     * This ensures that all pending operations are completed before continuing.
+     * Moves the pending synchronous callbacks to the end of the flush queue,
+     * so that they run next, in the order they were added.
      */
-    function flush() {
-
-        if (flushing) return;
-        flushing = true;
+    function queueSyncCallbacks() {
 
-        try {
-            if (syncCallbacks != null) {
-                while (syncCallbacks.length > 0) {
-
-                    // Flush next synchronous callback to execute,
-                    // and allow to stack new callbacks that may
-                    // be triggered from that parent callback
-                    var cb = syncCallbacks.shift();
-                    var prevSyncCallbacks = syncCallbacks;
-                    syncCallbacks = null;
-
-                    cb();
-
-                    // If new callbacks were added during execution,
-                    // they get prepended to the existing queue
-                    if (syncCallbacks != null) {
-                        var i = syncCallbacks.length - 1;
-                        while (i >= 0) {
-                            prevSyncCallbacks.unshift(syncCallbacks[i]);
-                            i--;
-                        }
-                    }
-                    syncCallbacks = prevSyncCallbacks;
-                }
-            }
-        }
-        catch (e:Any) {
-            flushing = false;
-            throw e;
+        var i = syncCallbacks.length - 1;
+        while (i >= 0) {
+            flushQueue.push(syncCallbacks[i]);
+            i--;
         }
-
-        flushing = false;
+        syncCallbacks.resize(0);
 
     }
 
@@ -2415,6 +3188,36 @@ typedef InterpreterOptions = {
 
     }
 
+    /**
+     * Returns the field shape of the states created from the given node,
+     * shared with the other interpreters of the script when it is prepared.
+     *
+     * @param node The script (for the top level state), or a character or state declaration
+     * @return The field shape, or null if the node doesn't declare fields
+     */
+    @:noCompletion public function fieldShape(node:Node):Null<FieldShape> {
+
+        if (prepared != null) {
+            return prepared.fieldShape(node);
+        }
+
+        if (!(node is NCharacterDecl || node is NStateDecl || node == script)) {
+            return null;
+        }
+
+        if (localFieldShapes == null) {
+            localFieldShapes = new NodeIdMap();
+        }
+
+        var shape = localFieldShapes.get(node.id);
+        if (shape == null) {
+            shape = FieldShape.ofNode(node);
+            localFieldShapes.set(node.id, shape);
+        }
+        return shape;
+
+    }
+
     /**
      * Initializes a top-level state declaration.
      * Evaluates all fields and stores their values.
@@ -2459,6 +3262,19 @@ typedef InterpreterOptions = {
 
     }
 
+    /**
+     * Adds a top level character, and records its name for its fields object.
+     *
+     * @param name The name of the character
+     * @param character The character state
+     */
+    function addTopLevelCharacter(name:String, character:RuntimeCharacter):Void {
+
+        topLevelCharacters.set(name, character);
+        characterNamesByFields.set(character.fields, name);
+
+    }
+
     /**
      * Initializes a top-level character declaration.
      * Creates a new character state and evaluates all fields.
@@ -2475,7 +3291,7 @@ typedef InterpreterOptions = {
 
         // Create new character state
         final characterState = new RuntimeCharacter(this, character, null, null);
-        topLevelCharacters.set(character.name, characterState);
+        addTopLevelCharacter(character.name, characterState);
 
         // Evaluate character values
         for (field in character.fields) {
@@ -2516,6 +3332,7 @@ typedef InterpreterOptions = {
         for (field in state.fields) {
             if (!Objects.fieldExists(this, runtimeState.fields, field.name)) {
                 final evaluated = evaluateExpression(field.value);
+                runtimeState.dirty = true;
                 Objects.setField(this, runtimeState.fields, field.name, evaluated);
                 if (!state.temporary && isOriginalScriptExpression(field.value)) {
                     Objects.setField(this, runtimeState.originalFields, field.name, evaluated);
@@ -2533,7 +3350,9 @@ typedef InterpreterOptions = {
         finishTrigger = null;
 
         if (handleFinish != null) {
+            final depth = profiler != null ? profiler.enter(profiler.handler('finish'), null) : -1;
             handleFinish(this);
+            if (profiler != null) profiler.exit(depth);
         }
 
     }
@@ -2580,6 +3399,29 @@ typedef InterpreterOptions = {
      */
     function evalNode(node:AstNode, next:()->Void) {
 
+        if (profiler == null) {
+            evalNodeOfType(node, next);
+            return;
+        }
+
+        final depth = profiler.enter(profiler.node(node), profilerBeat());
+        evalNodeOfType(node, next);
+        profiler.exit(depth);
+
+    }
+
+    /**
+     * Returns the profiler entry of the beat being evaluated, if any.
+     */
+    function profilerBeat():Null<ProfilerEntry> {
+
+        final beat = currentScope?.beat;
+        return beat != null ? profiler.beat(beat) : null;
+
+    }
+
+    function evalNodeOfType(node:AstNode, next:()->Void) {
+
         switch Type.getClass(node) {
 
             case NBeatDecl:
@@ -2645,6 +3487,10 @@ typedef InterpreterOptions = {
     /**
      * Evaluates a node body by creating a new scope and executing each node in sequence.
      *
+     * Evaluation stays continuation based: the scope stack and its reading heads are what
+     * saves are made of. Declarations and assignments take a synchronous fast path, run in
+     * place in a loop, while every other child shares the single continuation of the body.
+     *
      * @param beat The parent beat
      * @param node The node containing the body
      * @param body The body to execute
@@ -2663,46 +3509,76 @@ typedef InterpreterOptions = {
         // Then iterate through each child node in the body
         var index = 0;
         var moveNext:()->Void = null;
+        var steps:EvalNext = null;
         final currentInsertion = this.currentInsertion;
         moveNext = () -> {
 
-            if (currentInsertion?.options != null) {
-                // At each iteration, check if we are within an insertion with completed choice options.
-                // If that's the case, we should pause this stack execution for now and return
-                pop();
-                next();
-
-            }
-            else {
-                // Check if we still have a node to evaluate
-                if (index < body.length) {
-
-                    // Yes, do it
-                    final childNode = body[index];
-                    currentScope.head = childNode;
-                    index++;
+            while (true) {
 
-                    final done = wrapNext(moveNext);
-                    evalNode(childNode, done.cb);
-                    done.sync = false;
+                if (currentInsertion?.options != null) {
+                    // At each iteration, check if we are within an insertion with completed choice options.
+                    // If that's the case, we should pause this stack execution for now and return
+                    pop();
+                    next();
+                    return;
 
                 }
                 else {
+                    // Check if we still have a node to evaluate
+                    if (index < body.length) {
+
+                        // Yes, do it
+                        final childNode = body[index];
+                        currentScope.head = childNode;
+                        index++;
+
+                        // Assignments and declarations always complete synchronously:
+                        // evaluate them in place, without allocating a wrapped callback.
+                        // They still count against the budget: once it is exhausted,
+                        // they are queued like any other node so that the flush yields
+                        if (completesSynchronously(childNode) && !spendStep()) {
+                            evalNode(childNode, syncNext);
+                            continue;
+                        }
 
-                    // We are done, pop node scope
-                    // and finish that node body evaluation
-                    pop();
-                    next();
+                        steps.sync = true;
+                        evalNode(childNode, steps.cb);
+                        steps.sync = false;
+                        return;
+
+                    }
+                    else {
+
+                        // We are done, pop node scope
+                        // and finish that node body evaluation
+                        pop();
+                        next();
+                        return;
+                    }
                 }
+
             }
 
         }
 
         // Start evaluating the body
+        steps = wrapSteps(moveNext);
         moveNext();
 
     }
 
+    /**
+     * Tells whether evaluating the given node always calls its `next` callback
+     * synchronously, and only once, without running anything else after it.
+     * Those nodes (assignments, state and beat declarations) are the synchronous
+     * fast path of `evalNodeBody()` and `resumeNodeBody()`.
+     */
+    inline function completesSynchronously(node:AstNode):Bool {
+
+        return node is NAssign || node is NStateDecl || node is NBeatDecl;
+
+    }
+
     /**
      * Evaluates a beat by executing its body.
      *
@@ -2712,6 +3588,7 @@ typedef InterpreterOptions = {
     function evalBeatRun(beat:NBeatDecl, next:()->Void) {
 
         incrementBeatVisitCount(beat);
+        if (profiler != null) profiler.beat(beat).calls++;
         evalNodeBody(beat, beat, beat.body, next);
 
     }
@@ -2759,7 +3636,9 @@ typedef InterpreterOptions = {
         // Then call the user-defined dialogue handler.
         // The execution will be "paused" until the callback
         // is called, either synchronously or asynchronously
+        final depth = profiler != null ? profiler.enter(profiler.handler('dialogue'), null) : -1;
         handleDialogue(this, null, content.text, content.tags, next);
+        if (profiler != null) profiler.exit(depth);
 
     }
 
@@ -2786,7 +3665,9 @@ typedef InterpreterOptions = {
         // Then call the user-defined dialogue handler.
         // The execution will be "paused" until the callback
         // is called, either synchronously or asynchronously
+        final depth = profiler != null ? profiler.enter(profiler.handler('dialogue'), null) : -1;
         handleDialogue(this, dialogue.character, content.text, content.tags, next);
+        if (profiler != null) profiler.exit(depth);
 
     }
 
@@ -2921,10 +3802,12 @@ typedef InterpreterOptions = {
                 next();
             }
         });
+        final depth = profiler != null ? profiler.enter(profiler.handler('choice'), null) : -1;
         handleChoice(this, options, function(index_:Int) {
             index = index_;
             choiceCallback.cb();
         });
+        if (profiler != null) profiler.exit(depth);
         choiceCallback.sync = false;
 
     }
@@ -2941,78 +3824,84 @@ typedef InterpreterOptions = {
         // Then iterate through each child node in the body
         var index = startIndex != null ? startIndex : 0;
         var moveNext:()->Void = null;
+        var steps:EvalNext = null;
         var insertion:RuntimeInsertion = null;
         moveNext = () -> {
 
-            // Look for collection options in previous step (from an insertion)
-            if (insertion != null && insertion.options != null) {
-                for (i in 0...insertion.options.length) {
-                    final opt = insertion.options[i];
-                    result.push(opt);
-                    _choiceEvalTexts.push(opt.text);
-                    _choiceEvalEnabled.push(opt.enabled);
+            while (true) {
+
+                // Look for collection options in previous step (from an insertion)
+                if (insertion != null && insertion.options != null) {
+                    for (i in 0...insertion.options.length) {
+                        final opt = insertion.options[i];
+                        result.push(opt);
+                        _choiceEvalTexts.push(opt.text);
+                        _choiceEvalEnabled.push(opt.enabled);
+                    }
+                    insertion = null;
                 }
-                insertion = null;
-            }
 
-            // Check if we still have an option to evaluate
-            if (index < options.length) {
+                // Check if we still have an option to evaluate
+                if (index < options.length) {
 
-                // Yes, do it
-                final option = options[index];
-                index++;
-
-                // Once-only options that have been chosen are kept in the list but disabled,
-                // NOT removed. This preserves stable indices for the host application and
-                // is consistent with how conditional options (e.g. "Option if false") work.
-                final onceDisabled = option.once && isChoiceOptionChosen(option);
-                final enabled = !onceDisabled && (option.condition == null || evaluateCondition(option.condition));
-                if (option.text != null) {
-                    final done = wrapNext(moveNext);
-                    final str = getTranslatedString(option, option.text);
-                    final content = evaluateString(str);
-                    result.push({
-                        text: content.text,
-                        tags: content.tags,
-                        enabled: enabled,
-                        node: option,
-                        insertion: currentInsertion
-                    });
-                    _choiceEvalTexts.push(content.text);
-                    _choiceEvalEnabled.push(enabled);
-                    done.cb();
-                    done.sync = false;
-                }
-                else if (option.insertion != null) {
-                    final done = wrapNext(moveNext);
-                    if (!enabled) {
-                        // Condition is false — skip this insertion entirely
-                        done.cb();
-                    } else {
+                    // Yes, do it
+                    final option = options[index];
+                    index++;
+
+                    // Once-only options that have been chosen are kept in the list but disabled,
+                    // NOT removed. This preserves stable indices for the host application and
+                    // is consistent with how conditional options (e.g. "Option if false") work.
+                    final onceDisabled = option.once && isChoiceOptionChosen(option);
+                    final enabled = !onceDisabled && (option.condition == null || evaluateCondition(option.condition));
+                    if (option.text != null) {
+                        // Text options are collected in place
+                        final str = getTranslatedString(option, option.text);
+                        final content = evaluateString(str);
+                        result.push({
+                            text: content.text,
+                            tags: content.tags,
+                            enabled: enabled,
+                            node: option,
+                            insertion: currentInsertion
+                        });
+                        _choiceEvalTexts.push(content.text);
+                        _choiceEvalEnabled.push(enabled);
+                        continue;
+                    }
+                    else if (option.insertion != null) {
+                        if (!enabled) {
+                            // Condition is false — skip this insertion entirely
+                            continue;
+                        }
                         insertion = new RuntimeInsertion(nextInsertionId++, option.insertion);
                         // Save partial Phase 1 state on the insertion for save/restore.
                         // If save happens during this insertion's body evaluation,
                         // these allow Phase 1 to continue from the right point on restore.
                         insertion.parentPartialOptions = [].concat(result);
                         insertion.parentNextOptionIndex = index;
-                        evalInsertion(insertion, done.cb);
+                        steps.sync = true;
+                        evalInsertion(insertion, steps.cb);
+                        steps.sync = false;
+                        return;
+                    }
+                    else {
+                        throw new RuntimeError('Invalid choice option', option.pos);
                     }
-                    done.sync = false;
+
                 }
                 else {
-                    throw new RuntimeError('Invalid choice option', option.pos);
-                }
 
-            }
-            else {
+                    // We are done, finish that evaluation
+                    next();
+                    return;
+                }
 
-                // We are done, finish that evaluation
-                next();
             }
 
         }
 
         // Start evaluating the body
+        steps = wrapSteps(moveNext);
         moveNext();
 
     }
@@ -3046,6 +3935,7 @@ typedef InterpreterOptions = {
             throw new RuntimeError('Beat $beatName not found', script.pos);
         }
 
+        if (profiler != null) profiler.beat(resolvedBeat).calls++;
         evalNodeBody(resolvedBeat, resolvedBeat, resolvedBeat.body, insertion, next);
 
     }
@@ -3182,6 +4072,7 @@ typedef InterpreterOptions = {
             nodeStates.set(beat.id, state);
         }
         final count:Int = cast(Objects.getField(this, state.fields, "_visitCount") ?? 0);
+        state.dirty = true;
         Objects.setField(this, state.fields, "_visitCount", count + 1);
     }
 
@@ -3205,6 +4096,7 @@ typedef InterpreterOptions = {
             state = new RuntimeState(this, alt, null, null);
             nodeStates.set(alt.id, state);
         }
+        state.dirty = true;
         Objects.setField(this, state.fields, "_visitCount", count);
     }
 
@@ -3228,6 +4120,7 @@ typedef InterpreterOptions = {
             state = new RuntimeState(this, option, null, null);
             nodeStates.set(option.id, state);
         }
+        state.dirty = true;
         Objects.setField(this, state.fields, "_chosen", true);
     }
 
@@ -3471,29 +4364,28 @@ typedef InterpreterOptions = {
     /**
      * If translations are available, checks for a hash comment on the node and returns
      * the translated string literal if found. Otherwise returns the original string.
-     *
-     * Walks the import ancestor chain from the node's own file up to root,
-     * trying each scoped key in turn. A translation defined in an ancestor's
-     * `.<lang>.lor` file applies to descendants that don't translate the same
-     * key themselves. Siblings (non-ancestor files) never share translations.
+     * Translations are resolved once per node (see `PreparedScript.resolveTranslation()`),
+     * then looked up by node id.
      */
     function getTranslatedString(node:AstNode, str:NStringLiteral):NStringLiteral {
-        if (translations != null) {
-            final id = findHashCommentId(node, str);
-            if (id != null && script.filePath != null) {
-                for (relPath in lens.getNodeAncestorFilePaths(node)) {
-                    final scoped = translations.get(relPath + '#' + id);
-                    if (scoped != null) {
-                        return scoped;
-                    }
-                }
-            }
+        if (translations == null) return str;
+
+        if (translationIndexSource != translations) {
+            // Prepared scripts share a complete index per translations map,
+            // otherwise nodes are resolved and indexed as they are evaluated
+            translationIndexSource = translations;
+            translationIndexComplete = (prepared != null);
+            translationIndex = prepared != null ? prepared.translationIndex(translations) : new NodeIdMap();
+        }
+
+        final indexed = translationIndex.get(node.id);
+        if (indexed != null || translationIndexComplete) {
+            return indexed ?? str;
         }
-        return str;
-    }
 
-    function findHashCommentId(node:AstNode, str:NStringLiteral):Null<String> {
-        return AstUtils.findHashComment(node, str);
+        final resolved = PreparedScript.resolveTranslation(script, lens, translations, node, str) ?? str;
+        translationIndex.set(node.id, resolved);
+        return resolved;
     }
 
     /**
@@ -3504,15 +4396,145 @@ typedef InterpreterOptions = {
      * @return Object containing the evaluated text and any tags
      */
     function evaluateString(str:NStringLiteral):{text:String, tags:Array<TextTag>} {
-        // Run string literal processors (e.g. plural pipe syntax)
-        for (i in 0...stringLiteralProcessors.length) {
-            str = stringLiteralProcessors[i](str);
+
+        if (profiler == null) {
+            return evaluateStringTemplate(str);
+        }
+
+        final depth = profiler.enter(profiler.expression(str), profilerBeat());
+        final result = evaluateStringTemplate(str);
+        profiler.exit(depth);
+        return result;
+
+    }
+
+    function evaluateStringTemplate(str:NStringLiteral):{text:String, tags:Array<TextTag>} {
+
+        final template = stringTemplate(str);
+        final parts = template.parts;
+        final numParts = parts.length;
+
+        // Plain text: nothing to evaluate
+        if (numParts <= 1 && !template.hasTags) {
+            if (numParts == 0) {
+                return {
+                    text: "",
+                    tags: []
+                };
+            }
+            switch parts[0] {
+                case Segment(text, _):
+                    return {
+                        text: text,
+                        tags: []
+                    };
+                case _:
+            }
         }
 
         final buf = new loreline.Utf8.Utf8Buf();
         final tags:Array<TextTag> = [];
         var offset = 0;
 
+        for (i in 0...numParts) {
+            switch parts[i] {
+                case Segment(text, length):
+                    buf.add(text);
+                    offset += length;
+
+                case Interpolated(expr, access):
+                    var text:String;
+                    if (access != null) {
+                        // When providing a character object,
+                        // implicitly read the character's `name` field
+                        final resolved = resolveAccess(access, access.target, access.name);
+                        switch resolved {
+                            case CharacterAccess(_, name):
+                                final characterFields = evaluateExpression(expr);
+                                text = valueToString(Objects.getField(this, characterFields, 'name') ?? name);
+
+                            case _:
+                                text = valueToString(evaluateExpression(expr));
+                        }
+                    }
+                    else {
+                        text = valueToString(evaluateExpression(expr));
+                    }
+                    if (template.hasTags) {
+                        offset += text.uLength();
+                    }
+                    buf.add(text);
+
+                case TagMark(closing, content):
+                    final tagValue = evaluateString(content).text;
+                    tags.push({
+                        closing: closing,
+                        value: tagValue,
+                        offset: offset
+                    });
+            }
+        }
+
+        return {
+            text: buf.toString(),
+            tags: tags
+        };
+
+    }
+
+    /**
+     * Returns the compiled template of a string literal, compiling it the first time.
+     *
+     * @param str The string literal
+     * @return The compiled template
+     */
+    function stringTemplate(str:NStringLiteral):RuntimeStringTemplate {
+
+        if (stringTemplatesProcessors != stringLiteralProcessors.length) {
+            stringTemplates.clear();
+            stringTemplatesProcessors = stringLiteralProcessors.length;
+        }
+
+        var template = stringTemplates.get(str);
+        if (template == null) {
+            template = compileStringTemplate(str);
+            stringTemplates.set(str, template);
+        }
+
+        return template;
+
+    }
+
+    /**
+     * Compiles a string literal into a template.
+     * This handles string literal processors, whitespace trimming,
+     * comments and indents stripping, and escape sequences.
+     *
+     * @param str The string literal to compile
+     * @return The compiled template
+     */
+    function compileStringTemplate(str:NStringLiteral):RuntimeStringTemplate {
+
+        // Run string literal processors (e.g. plural pipe syntax)
+        for (i in 0...stringLiteralProcessors.length) {
+            str = stringLiteralProcessors[i](str);
+        }
+
+        final parts:Array<RuntimeStringPart> = [];
+        var hasTags = false;
+
+        // Static text pending to be merged into a single segment
+        var segmentBuf:loreline.Utf8.Utf8Buf = null;
+        var segmentLength = 0;
+
+        inline function flushSegment() {
+            if (segmentBuf != null) {
+                parts.push(Segment(segmentBuf.toString(), segmentLength));
+                segmentBuf = null;
+                segmentLength = 0;
+            }
+        }
+
         final numParts = str.parts.length;
 
         var keepWhitespace = (str.quotes != Unquoted);
@@ -3555,7 +4577,12 @@ typedef InterpreterOptions = {
                         text = stripStringIndent(text);
                     }
                     final len = text.uLength();
-                    if (len > 0) keepWhitespace = true;
+                    if (len == 0) continue;
+                    keepWhitespace = true;
+                    if (segmentBuf == null) {
+                        segmentBuf = new loreline.Utf8.Utf8Buf();
+                    }
+                    final buf = segmentBuf;
                     var prevIsDollar:Bool = false;
                     var prevIsHash:Bool = false;
                     var escaped:Bool = false;
@@ -3616,51 +4643,23 @@ typedef InterpreterOptions = {
                     if (prevIsHash) {
                         buf.addChar("#".code);
                     }
-                    offset += len;
+                    segmentLength += len;
 
                 case Expr(expr):
                     keepWhitespace = true;
-                    if (expr is NAccess) {
-                        // When providing a character object,
-                        // implicitly read the character's `name` field
-                        final access:NAccess = cast expr;
-                        final resolved = resolveAccess(access, access.target, access.name);
-                        switch resolved {
-                            case CharacterAccess(_, name):
-                                final characterFields = evaluateExpression(expr);
-                                final value = Objects.getField(this, characterFields, 'name') ?? name;
-                                final text = valueToString(value);
-                                offset += text.uLength();
-                                buf.add(text);
-
-                            case _:
-                                final value = evaluateExpression(expr);
-                                final text = valueToString(value);
-                                offset += text.uLength();
-                                buf.add(text);
-                        }
-                    }
-                    else {
-                        final value = evaluateExpression(expr);
-                        final text = valueToString(value);
-                        offset += text.uLength();
-                        buf.add(text);
-                    }
+                    flushSegment();
+                    parts.push(Interpolated(expr, expr is NAccess ? cast expr : null));
 
                 case Tag(closing, expr):
-                    final tagValue = evaluateString(expr).text;
-                    tags.push({
-                        closing: closing,
-                        value: tagValue,
-                        offset: offset
-                    });
+                    hasTags = true;
+                    flushSegment();
+                    parts.push(TagMark(closing, expr));
             }
         }
 
-        return {
-            text: buf.toString(),
-            tags: tags
-        };
+        flushSegment();
+
+        return new RuntimeStringTemplate(parts, hasTags);
 
     }
 
@@ -3987,6 +4986,32 @@ typedef InterpreterOptions = {
      */
     function evaluateFunctionCall(call:NCall, next:()->Void):Any {
 
+        if (profiler == null) {
+            return callFunction(call, next);
+        }
+
+        final depth = profiler.enter(profiler.func(profilerFunctionName(call)), profilerBeat());
+        final result = callFunction(call, next);
+        profiler.exit(depth);
+        return result;
+
+    }
+
+    /**
+     * Name of the function called, as recorded by the profiler.
+     */
+    function profilerFunctionName(call:NCall):String {
+
+        if (call.target is NAccess) {
+            final access:NAccess = cast call.target;
+            return access.target == null ? access.name : '.' + access.name;
+        }
+        return '?';
+
+    }
+
+    function callFunction(call:NCall, next:()->Void):Any {
+
         // If target is a simple identifier, it might be a nested beat call
         if (call.target is NAccess) {
             final access:NAccess = cast call.target;
@@ -4172,6 +5197,20 @@ typedef InterpreterOptions = {
      */
     function evaluateExpression(expr:NExpr):Any {
 
+        // Strings are recorded by evaluateString()
+        if (profiler == null || expr is NStringLiteral) {
+            return evaluateExpressionOfType(expr);
+        }
+
+        final depth = profiler.enter(profiler.expression(expr), profilerBeat());
+        final result = evaluateExpressionOfType(expr);
+        profiler.exit(depth);
+        return result;
+
+    }
+
+    function evaluateExpressionOfType(expr:NExpr):Any {
+
         return switch (Type.getClass(expr)) {
 
             case NLiteral:
@@ -4316,7 +5355,9 @@ typedef InterpreterOptions = {
 
             case CharacterAccess(pos, name):
                 if (topLevelCharacters.exists(name)) {
-                    topLevelCharacters.get(name).fields;
+                    final character = topLevelCharacters.get(name);
+                    character.dirty = true;
+                    character.fields;
                 }
                 else {
                     throw new RuntimeError('Character not found: $name', pos);
@@ -4353,7 +5394,7 @@ typedef InterpreterOptions = {
                 if (obj == null) {
                     throw new RuntimeError('Cannot set field \'$name\' of null', pos);
                 }
-                Objects.setField(this, obj, name, value);
+                assignField(obj, name, value);
 
             case ArrayAccess(pos, array, index):
                 Arrays.arraySet(array, index, value);
@@ -4439,7 +5480,8 @@ typedef InterpreterOptions = {
         }
 
         // Iterate through scopes to identify a matching state field or character name
-        var i = stack.length - 1;
+        // (skipped for accesses bound to top level declarations when preparing the script)
+        var i = (access != null && access.binding == AccessBinding.TopLevel) ? -1 : stack.length - 1;
         while (i >= 0) {
             final scope = stack[i];
 
@@ -4460,6 +5502,7 @@ typedef InterpreterOptions = {
                 final stateInNode = nodeStates.get(scope.node.id);
                 if (stateInNode != null) {
                     if (Objects.fieldExists(this, stateInNode.fields, name)) {
+                        stateInNode.dirty = true;
                         return FieldAccess(
                             access?.pos ?? currentScope?.node?.pos ?? script.pos,
                             stateInNode.fields,
@@ -4474,6 +5517,7 @@ typedef InterpreterOptions = {
 
         // Look for state fields
         if (Objects.fieldExists(this, topLevelState.fields, name)) {
+            topLevelState.dirty = true;
             return FieldAccess(
                 access?.pos ?? currentScope?.node?.pos ?? script.pos,
                 topLevelState.fields,
@@ -4508,6 +5552,7 @@ typedef InterpreterOptions = {
 
         if (!strictAccess) {
             // When variable is not resolved, write to top level state
+            topLevelState.dirty = true;
             return FieldAccess(
                 access?.pos ?? currentScope?.node?.pos ?? script.pos,
                 topLevelState.fields,
@@ -499,7 +499,7 @@ class JsonToAst {
         }
     }
 
-    static function tokenTypeFromString(s:String):TokenType {
+    @:noCompletion public static function tokenTypeFromString(s:String):TokenType {
         return switch s {
             case "OpAssign": OpAssign;
             case "OpPlusAssign": OpPlusAssign;
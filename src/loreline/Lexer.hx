@@ -570,6 +570,15 @@ class Token {
      *  variable access instead of unquoted text. Used by LSP for code completion. */
     public var keepOrphanExpressions:Bool = false;
 
+    /** Memoized results of `isIfStart()`, by position */
+    var ifStartCache:Map<Int, Bool>;
+
+    /** Memoized results of `isCallStart()`, by position */
+    var callStartCache:Map<Int, Bool>;
+
+    /** Memoized results of `isAssignStart()`, by position and strict flag (lowest bit) */
+    var assignStartCache:Map<Int, Bool>;
+
     /**
      * Creates a new lexer for the given input.
      * @param input The source code to lex
@@ -597,6 +606,24 @@ class Token {
         this.indentLevel = 0;
         this.indentStack = [0];
         this.indentTokens = [];
+        this.ifStartCache = new Map();
+        this.callStartCache = new Map();
+        this.assignStartCache = new Map();
+    }
+
+    /**
+     * Returns the character code at the given position of the input, or -1 if out of bounds.
+     * On targets where strings are indexed by code unit, this reads the input directly
+     * instead of going through the nullable `charCodeAt()`, which is boxed on C++.
+     * @param pos Position to read at
+     * @return The character code, or -1
+     */
+    inline function codeAt(pos:Int):Int {
+        #if (neko || python)
+        return input.uCharCodeAt(pos);
+        #else
+        return (pos >= 0 && pos < length) ? StringTools.fastCodeAt(input, pos) : -1;
+        #end
     }
 
     /**
@@ -685,7 +712,7 @@ class Token {
 
         startLine = line;
         startColumn = column;
-        final c = input.uCharCodeAt(pos);
+        final c = codeAt(pos);
 
         if (c == "\n".code || c == "\r".code) {
             final lineBreakToken = readLineBreak();
@@ -867,7 +894,7 @@ class Token {
                         makeToken(Question);
 
                     case "#".code:
-                        final nextC = pos + 1 < length ? input.uCharCodeAt(pos + 1) : 0;
+                        final nextC = pos + 1 < length ? codeAt(pos + 1) : 0;
                         if (isIdentifierPart(nextC) || nextC == "-".code) {
                             return readHashComment();
                         }
@@ -890,7 +917,7 @@ class Token {
 
         // Count spaces/tabs
         while (pos < length) {
-            final c = input.uCharCodeAt(pos);
+            final c = codeAt(pos);
             if (c == " ".code) {
                 spaces++;
             } else if (c == "\t".code) {
@@ -902,7 +929,7 @@ class Token {
         }
 
         // Check if line is empty or only whitespace
-        if (pos >= length || input.uCharCodeAt(pos) == "\n".code || input.uCharCodeAt(pos) == "\r".code) {
+        if (pos >= length || codeAt(pos) == "\n".code || codeAt(pos) == "\r".code) {
             // Return previous indentation level for empty lines
             return indentStack[indentStack.length - 1];
         }
@@ -970,9 +997,9 @@ class Token {
      */
     function readLineBreak():Token {
         final start = makePosition();
-        if (input.uCharCodeAt(pos) == "\r".code) {
+        if (codeAt(pos) == "\r".code) {
             advance();
-            if (pos < length && input.uCharCodeAt(pos) == "\n".code) {
+            if (pos < length && codeAt(pos) == "\n".code) {
                 advance();
             }
         }
@@ -1003,7 +1030,7 @@ class Token {
         }
 
         // Check if the first character is a valid identifier start
-        if (!isIdentifierStart(input.uCharCodeAt(pos))) {
+        if (!isIdentifierStart(codeAt(pos))) {
             return null;
         }
 
@@ -1013,7 +1040,7 @@ class Token {
         // Check subsequent characters until we find an invalid one
         // or reach the end of the string
         while (identifierLength < this.length) {
-            if (!isIdentifierPart(input.uCharCodeAt(pos + identifierLength))) {
+            if (!isIdentifierPart(codeAt(pos + identifierLength))) {
                 break;
             }
             identifierLength++;
@@ -1049,26 +1076,26 @@ class Token {
             var foundContent = false;
             while (pos < this.length) {
                 // Skip whitespace
-                while (pos < this.length && (input.uCharCodeAt(pos) == " ".code || input.uCharCodeAt(pos) == "\t".code)) {
+                while (pos < this.length && (codeAt(pos) == " ".code || codeAt(pos) == "\t".code)) {
                     pos++;
                     foundContent = true;
                 }
 
                 // Check for comments
                 if (pos < this.length - 1) {
-                    if (input.uCharCodeAt(pos) == "/".code) {
-                        if (input.uCharCodeAt(pos + 1) == "/".code) {
+                    if (codeAt(pos) == "/".code) {
+                        if (codeAt(pos + 1) == "/".code) {
                             // Single line comment - invalid in single line
                             pos = startPos;
                             return pos;
                         }
-                        else if (input.uCharCodeAt(pos + 1) == "*".code) {
+                        else if (codeAt(pos + 1) == "*".code) {
                             // Multi-line comment
                             pos += 2;
                             foundContent = true;
                             var commentClosed = false;
                             while (pos < this.length - 1) {
-                                if (input.uCharCodeAt(pos) == "*".code && input.uCharCodeAt(pos + 1) == "/".code) {
+                                if (codeAt(pos) == "*".code && codeAt(pos + 1) == "/".code) {
                                     pos += 2;
                                     commentClosed = true;
                                     break;
@@ -1096,7 +1123,7 @@ class Token {
         while (pos < this.length) {
             // Skip whitespace including newlines
             while (pos < this.length) {
-                final c = input.uCharCodeAt(pos);
+                final c = codeAt(pos);
                 if (c == " ".code || c == "\t".code || c == "\r".code || (!isNextLine && c == "\n".code)) {
                     if (c == "\n".code) {
                         isNextLine = true;
@@ -1111,23 +1138,23 @@ class Token {
 
             // Check for comments
             if (pos < this.length - 1 && !isNextLine) {
-                if (input.uCharCodeAt(pos) == "/".code) {
-                    if (input.uCharCodeAt(pos + 1) == "/".code) {
+                if (codeAt(pos) == "/".code) {
+                    if (codeAt(pos + 1) == "/".code) {
                         // Single line comment - skip until end of line
                         pos += 2; // Skip //
                         foundContent = true;
-                        while (pos < this.length && input.uCharCodeAt(pos) != "\n".code && input.uCharCodeAt(pos) != "\r".code) {
+                        while (pos < this.length && codeAt(pos) != "\n".code && codeAt(pos) != "\r".code) {
                             pos++;
                         }
                         continue; // Continue to process potential newline after comment
                     }
-                    else if (input.uCharCodeAt(pos + 1) == "*".code) {
+                    else if (codeAt(pos + 1) == "*".code) {
                         // Multi-line comment
                         pos += 2; // Skip /*
                         foundContent = true;
                         var commentClosed = false;
                         while (pos < this.length - 1) {
-                            if (input.uCharCodeAt(pos) == "*".code && input.uCharCodeAt(pos + 1) == "/".code) {
+                            if (codeAt(pos) == "*".code && codeAt(pos + 1) == "/".code) {
                                 pos += 2; // Skip */
                                 commentClosed = true;
                                 break;
@@ -1156,13 +1183,21 @@ class Token {
      * @return True if an if condition starts at the position, false otherwise
      */
     function isIfStart(pos:Int):Bool {
+        final cached = ifStartCache.get(pos);
+        if (cached != null) return cached;
+        final result = _isIfStart(pos);
+        ifStartCache.set(pos, result);
+        return result;
+    }
+
+    function _isIfStart(pos:Int):Bool {
         pos = skipWhitespaceAndComments(pos);
 
         // Check "if" literal first
-        if (input.uCharCodeAt(pos) != "i".code) return false;
+        if (codeAt(pos) != "i".code) return false;
         pos++;
 
-        if (input.uCharCodeAt(pos) != "f".code) return false;
+        if (codeAt(pos) != "f".code) return false;
         pos++;
 
         // Save initial position to restore it later
@@ -1176,14 +1211,14 @@ class Token {
             if (pos >= len) {
                 result = false;
             }
-            else if (pos + 1 < len && input.uCharCodeAt(pos) == "o".code && input.uCharCodeAt(pos + 1) == "r".code && (pos + 2 >= len || !isIdentifierStart(input.uCharCodeAt(pos + 2)))) {
+            else if (pos + 1 < len && codeAt(pos) == "o".code && codeAt(pos + 1) == "r".code && (pos + 2 >= len || !isIdentifierStart(codeAt(pos + 2)))) {
                 result = false;
             }
-            else if (pos + 2 < len && input.uCharCodeAt(pos) == "a".code && input.uCharCodeAt(pos + 1) == "n".code && input.uCharCodeAt(pos + 2) == "d".code && (pos + 3 >= len || !isIdentifierStart(input.uCharCodeAt(pos + 3)))) {
+            else if (pos + 2 < len && codeAt(pos) == "a".code && codeAt(pos + 1) == "n".code && codeAt(pos + 2) == "d".code && (pos + 3 >= len || !isIdentifierStart(codeAt(pos + 3)))) {
                 result = false;
             }
             else {
-                var c = input.uCharCodeAt(pos);
+                var c = codeAt(pos);
 
                 // First char must be letter or underscore
                 if (!isIdentifierStart(c)) {
@@ -1194,7 +1229,7 @@ class Token {
 
                     // Continue reading identifier chars
                     while (pos < this.length) {
-                        c = input.uCharCodeAt(pos);
+                        c = codeAt(pos);
                         if (!isIdentifierPart(c)) break;
                         pos++;
                     }
@@ -1207,28 +1242,28 @@ class Token {
         pos = skipWhitespaceAndComments(pos);
 
         // Handle optional ! for negation
-        if (pos < this.length && input.uCharCodeAt(pos) == "!".code) {
+        if (pos < this.length && codeAt(pos) == "!".code) {
             pos++;
             pos = skipWhitespaceAndComments(pos);
         }
 
         // If directly followed with (, that's a valid if
-        if (input.uCharCodeAt(pos) == "(".code) {
+        if (codeAt(pos) == "(".code) {
             return true;
         }
 
         // If "if" is directly followed by an identifier start (without space), that's not a if
-        if (pos == startPos && startPos < this.length && isIdentifierStart(input.uCharCodeAt(startPos))) {
+        if (pos == startPos && startPos < this.length && isIdentifierStart(codeAt(startPos))) {
             return false;
         }
 
         // Must start with identifier or opening parenthesis
-        if (pos >= this.length || !isIdentifierStart(input.uCharCodeAt(pos))) {
+        if (pos >= this.length || !isIdentifierStart(codeAt(pos))) {
             return false;
         }
 
         while (pos < this.length) {
-            if (input.uCharCodeAt(pos) == "(".code) {
+            if (codeAt(pos) == "(".code) {
                 // Function call
                 return true;
             } else {
@@ -1242,7 +1277,7 @@ class Token {
                 return true;
             }
 
-            var c = input.uCharCodeAt(pos);
+            var c = codeAt(pos);
 
             // Handle dot access
             if (c == ".".code) {
@@ -1255,7 +1290,7 @@ class Token {
                 if (pos >= this.length) {
                     return true;
                 }
-                c = input.uCharCodeAt(pos);
+                c = codeAt(pos);
             }
 
             // Handle bracket access
@@ -1263,7 +1298,7 @@ class Token {
                 pos++;
                 var bracketLevel = 1;
                 while (pos < this.length && bracketLevel > 0) {
-                    c = input.uCharCodeAt(pos);
+                    c = codeAt(pos);
                     if (c == "[".code) bracketLevel++;
                     if (c == "]".code) bracketLevel--;
                     pos++;
@@ -1272,21 +1307,21 @@ class Token {
                 if (pos >= this.length) {
                     return true;
                 }
-                c = input.uCharCodeAt(pos);
+                c = codeAt(pos);
             }
 
             // Check for and delimiter
-            if (c == "a".code && input.uCharCodeAt(pos + 1) == "n".code && input.uCharCodeAt(pos + 2) == "d".code && (pos + 3 >= this.length || !isIdentifierStart(input.uCharCodeAt(pos + 3)))) {
+            if (c == "a".code && codeAt(pos + 1) == "n".code && codeAt(pos + 2) == "d".code && (pos + 3 >= this.length || !isIdentifierStart(codeAt(pos + 3)))) {
                 return true;
             }
 
             // Check for or delimiter
-            if (c == "o".code && input.uCharCodeAt(pos + 1) == "r".code && (pos + 2 >= this.length || !isIdentifierStart(input.uCharCodeAt(pos + 2)))) {
+            if (c == "o".code && codeAt(pos + 1) == "r".code && (pos + 2 >= this.length || !isIdentifierStart(codeAt(pos + 2)))) {
                 return true;
             }
 
             // Check for various delimiters typical from if condition
-            if (c == "(".code || c == "&".code || c == "|".code || ((input.uCharCodeAt(pos + 1) == "=".code) && c == "=".code) || c == ">".code || c == "<".code || (c == "!".code && input.uCharCodeAt(pos + 1) == "=".code) || (input.uCharCodeAt(pos + 1) != "=".code && (c == "+".code || c == "-".code || c == "*".code || c == "/".code || c == "{".code))) {
+            if (c == "(".code || c == "&".code || c == "|".code || ((codeAt(pos + 1) == "=".code) && c == "=".code) || c == ">".code || c == "<".code || (c == "!".code && codeAt(pos + 1) == "=".code) || (codeAt(pos + 1) != "=".code && (c == "+".code || c == "-".code || c == "*".code || c == "/".code || c == "{".code))) {
                 return true;
             }
 
@@ -1299,8 +1334,8 @@ class Token {
             // If we're at whitespace before a // comment, treat as end of line
             if (isWhitespace(c)) {
                 var p = pos;
-                while (p < this.length && isWhitespace(input.uCharCodeAt(p))) p++;
-                if (p + 1 < this.length && input.uCharCodeAt(p) == "/".code && input.uCharCodeAt(p + 1) == "/".code) {
+                while (p < this.length && isWhitespace(codeAt(p))) p++;
+                if (p + 1 < this.length && codeAt(p) == "/".code && codeAt(p + 1) == "/".code) {
                     return true;
                 }
             }
@@ -1330,7 +1365,7 @@ class Token {
             }
             else {
                 var isUnderscore:Bool = false;
-                var c = input.uCharCodeAt(pos);
+                var c = codeAt(pos);
                 isUnderscore = (c == "_".code);
 
                 // First char must be letter or underscore
@@ -1343,7 +1378,7 @@ class Token {
                     // Continue reading identifier chars
                     while (pos < this.length) {
                         final wasUnderscore = isUnderscore;
-                        c = input.uCharCodeAt(pos);
+                        c = codeAt(pos);
                         isUnderscore = (c == "_".code);
                         if (!isIdentifierPart(c)) break;
                         if (lowercaseIdentOnly && wasUnderscore && !isUnderscore && !isLowerCase(c)) {
@@ -1366,7 +1401,7 @@ class Token {
         }
 
         // Check for function call
-        if (input.uCharCodeAt(pos) == "(".code) {
+        if (codeAt(pos) == "(".code) {
             return true;
         }
 
@@ -1382,7 +1417,7 @@ class Token {
                 return true;
             }
 
-            var c = input.uCharCodeAt(pos);
+            var c = codeAt(pos);
 
             // If we hit a non-special char after identifier,
             // and it's not a dot or bracket, expression is invalid
@@ -1394,8 +1429,8 @@ class Token {
             // End of line or comment is valid
             if (c == "\n".code || c == "\r".code ||
                 (c == "/".code && pos + 1 < this.length &&
-                 (input.uCharCodeAt(pos + 1) == "/".code ||
-                  input.uCharCodeAt(pos + 1) == "*".code))) {
+                 (codeAt(pos + 1) == "/".code ||
+                  codeAt(pos + 1) == "*".code))) {
                 return true;
             }
 
@@ -1422,7 +1457,7 @@ class Token {
                 pos++;
                 var bracketLevel = 1;
                 while (pos < this.length && bracketLevel > 0) {
-                    c = input.uCharCodeAt(pos);
+                    c = codeAt(pos);
                     if (c == '"'.code) {
                         pos = scanStringEnd(pos, false);
                         if (pos == -1) return false;
@@ -1458,7 +1493,7 @@ class Token {
     function isTransitionStart(pos:Int):Bool {
 
         // Check for ->
-        if (input.uCharCodeAt(pos) != "-".code || pos >= this.length - 1 || input.uCharCodeAt(pos + 1) != ">".code) {
+        if (codeAt(pos) != "-".code || pos >= this.length - 1 || codeAt(pos + 1) != ">".code) {
             return false;
         }
         pos += 2;
@@ -1471,15 +1506,15 @@ class Token {
             return false;
         }
 
-        final char = input.uCharCodeAt(pos);
+        final char = codeAt(pos);
         if (char == ".".code) {
             // Move past dot
             pos++;
         }
-        else if (isIdentifierPart(input.uCharCodeAt(pos))) {
+        else if (isIdentifierPart(codeAt(pos))) {
             // Move past identifier
             pos++;
-            while (pos < this.length && isIdentifierPart(input.uCharCodeAt(pos))) {
+            while (pos < this.length && isIdentifierPart(codeAt(pos))) {
                 pos++;
             }
         }
@@ -1492,7 +1527,7 @@ class Token {
 
         // Check that we're at end of line, end of input, or only have whitespace/comments/hash left
         if (pos < this.length) {
-            var c = input.uCharCodeAt(pos);
+            var c = codeAt(pos);
             if (c != "\n".code && c != "\r".code && c != " ".code && c != "\t".code && c != "/".code && c != "#".code) {
                 return false;
             }
@@ -1505,7 +1540,7 @@ class Token {
     function isInsertionStart(pos:Int):Bool {
 
         // Check for +
-        if (input.uCharCodeAt(pos) != "+".code) {
+        if (codeAt(pos) != "+".code) {
             return false;
         }
         pos += 1;
@@ -1518,15 +1553,15 @@ class Token {
             return false;
         }
 
-        final char = input.uCharCodeAt(pos);
+        final char = codeAt(pos);
         if (char == ".".code) {
             // Move past dot
             pos++;
         }
-        else if (isIdentifierPart(input.uCharCodeAt(pos))) {
+        else if (isIdentifierPart(codeAt(pos))) {
             // Move past identifier
             pos++;
-            while (pos < this.length && isIdentifierPart(input.uCharCodeAt(pos))) {
+            while (pos < this.length && isIdentifierPart(codeAt(pos))) {
                 pos++;
             }
         }
@@ -1540,11 +1575,11 @@ class Token {
         // Check that we're at end of line, end of input, or only have whitespace/comments left
         // Also allow trailing "if" condition (e.g., + BeatName if condition)
         if (pos < this.length) {
-            var c = input.uCharCodeAt(pos);
+            var c = codeAt(pos);
             // Allow trailing "if" keyword (conditional insertion)
-            if (c == "i".code && pos + 1 < this.length && input.uCharCodeAt(pos + 1) == "f".code) {
+            if (c == "i".code && pos + 1 < this.length && codeAt(pos + 1) == "f".code) {
                 // Make sure "if" is followed by a non-identifier char (word boundary)
-                if (pos + 2 >= this.length || !isIdentifierPart(input.uCharCodeAt(pos + 2))) {
+                if (pos + 2 >= this.length || !isIdentifierPart(codeAt(pos + 2))) {
                     return true;
                 }
             }
@@ -1562,12 +1597,12 @@ class Token {
         if (!inChoiceRoot()) return false;
 
         // Check for -
-        if (input.uCharCodeAt(pos) != "-".code) return false;
+        if (codeAt(pos) != "-".code) return false;
         pos += 1;
 
         // Must be followed by a space (to distinguish from -> or -= etc.)
         if (pos >= this.length) return false;
-        if (input.uCharCodeAt(pos) != " ".code) return false;
+        if (codeAt(pos) != " ".code) return false;
 
         return true;
     }
@@ -1582,7 +1617,7 @@ class Token {
         pos = skipWhitespaceAndComments(pos);
 
         // Check if we have a valid identifier
-        if (!isIdentifierStart(input.uCharCodeAt(pos))) {
+        if (!isIdentifierStart(codeAt(pos))) {
             return false;
         }
 
@@ -1591,17 +1626,17 @@ class Token {
 
         // Read through identifier characters
         pos++;
-        while (pos < length && isIdentifierPart(input.uCharCodeAt(pos))) {
+        while (pos < length && isIdentifierPart(codeAt(pos))) {
             pos++;
         }
 
         // Skip whitespace between identifier and colon
-        while (pos < length && isWhitespace(input.uCharCodeAt(pos))) {
+        while (pos < length && isWhitespace(codeAt(pos))) {
             pos++;
         }
 
         // Must end with a colon
-        if (pos >= length || input.uCharCodeAt(pos) != ":".code) {
+        if (pos >= length || codeAt(pos) != ":".code) {
             return false;
         }
 
@@ -1620,6 +1655,14 @@ class Token {
      * @return True if a function call starts at the position, false otherwise
      */
     function isCallStart(pos:Int):Bool {
+        final cached = callStartCache.get(pos);
+        if (cached != null) return cached;
+        final result = _isCallStart(pos);
+        callStartCache.set(pos, result);
+        return result;
+    }
+
+    function _isCallStart(pos:Int):Bool {
 
         // Save initial position to restore it later
         var startPos = pos;
@@ -1632,7 +1675,7 @@ class Token {
                 result = false;
             }
             else {
-                var c = input.uCharCodeAt(pos);
+                var c = codeAt(pos);
 
                 // First char must be letter or underscore
                 if (!isIdentifierStart(c)) {
@@ -1643,7 +1686,7 @@ class Token {
 
                     // Continue reading identifier chars
                     while (pos < this.length) {
-                        c = input.uCharCodeAt(pos);
+                        c = codeAt(pos);
                         if (!isIdentifierPart(c)) break;
                         pos++;
                     }
@@ -1668,7 +1711,7 @@ class Token {
                 return false;
             }
 
-            var c = input.uCharCodeAt(pos);
+            var c = codeAt(pos);
 
             // Found opening parenthesis - success!
             if (c == "(".code) {
@@ -1691,7 +1734,7 @@ class Token {
             if (c == "[".code) {
                 pos++;
                 while (pos < this.length) {
-                    final bc = input.uCharCodeAt(pos);
+                    final bc = codeAt(pos);
                     if (bc == '"'.code) {
                         pos = scanStringEnd(pos, false);
                         if (pos == -1) {
@@ -1725,6 +1768,15 @@ class Token {
      * @return True if an assignment starts at the position, false otherwise
      */
     function isAssignStart(pos:Int, strict:Bool):Bool {
+        final key = (pos << 1) | (strict ? 1 : 0);
+        final cached = assignStartCache.get(key);
+        if (cached != null) return cached;
+        final result = _isAssignStart(pos, strict);
+        assignStartCache.set(key, result);
+        return result;
+    }
+
+    function _isAssignStart(pos:Int, strict:Bool):Bool {
 
         // Helper function to read identifier
         inline function readIdent():Bool {
@@ -1735,7 +1787,7 @@ class Token {
                 result = false;
             }
             else {
-                var c = input.uCharCodeAt(pos);
+                var c = codeAt(pos);
 
                 // First char must be letter or underscore
                 if (!isIdentifierStart(c)) {
@@ -1746,14 +1798,14 @@ class Token {
 
                     // Continue reading identifier chars
                     while (pos < this.length) {
-                        c = input.uCharCodeAt(pos);
+                        c = codeAt(pos);
                         if (!isIdentifierPart(c)) break;
                         pos++;
                     }
                 }
             }
 
-            if (pos == startPos + 2 && input.uCharCodeAt(startPos) == "i".code && input.uCharCodeAt(startPos + 1) == "f".code) {
+            if (pos == startPos + 2 && codeAt(startPos) == "i".code && codeAt(startPos + 1) == "f".code) {
                 // `if` keyword isn't valid here
                 return false;
             }
@@ -1775,11 +1827,11 @@ class Token {
                 return false;
             }
 
-            var c = input.uCharCodeAt(pos);
+            var c = codeAt(pos);
 
             // Found assign operator (but not comparison operators ==, !=, <=, >=)
-            if (!isEscape && ((c == "=".code && (pos + 1 >= this.length || input.uCharCodeAt(pos + 1) != "=".code)) ||
-                (input.uCharCodeAt(pos + 1) == "=".code && (c == "+".code || c == "-".code || c == "*".code || c == "/".code || c == ":".code)))) {
+            if (!isEscape && ((c == "=".code && (pos + 1 >= this.length || codeAt(pos + 1) != "=".code)) ||
+                (codeAt(pos + 1) == "=".code && (c == "+".code || c == "-".code || c == "*".code || c == "/".code || c == ":".code)))) {
                 return true;
             }
 
@@ -1798,7 +1850,7 @@ class Token {
                 if (c == "[".code) {
                     pos++;
                     while (pos < this.length) {
-                        final bc = input.uCharCodeAt(pos);
+                        final bc = codeAt(pos);
                         if (bc == '"'.code) {
                             pos = scanStringEnd(pos, false);
                             if (pos == -1) return false;
@@ -1835,7 +1887,7 @@ class Token {
                 }
                 else {
                     // Skip two-char comparison operators so their trailing = isn't matched as assignment
-                    if ((c == "=".code || c == "!".code || c == "<".code || c == ">".code) && pos + 1 < this.length && input.uCharCodeAt(pos + 1) == "=".code) {
+                    if ((c == "=".code || c == "!".code || c == "<".code || c == ">".code) && pos + 1 < this.length && codeAt(pos + 1) == "=".code) {
                         pos += 2;
                     } else {
                         pos++;
@@ -1857,12 +1909,12 @@ class Token {
     function isColon(pos:Int, skipWhitespaces:Bool = true):Bool {
 
         if (skipWhitespaces) {
-            while (pos < this.length && (input.uCharCodeAt(pos) == " ".code || input.uCharCodeAt(pos) == "\t".code)) {
+            while (pos < this.length && (codeAt(pos) == " ".code || codeAt(pos) == "\t".code)) {
                 pos++;
             }
         }
 
-        return pos < this.length && input.uCharCodeAt(pos) == ":".code;
+        return pos < this.length && codeAt(pos) == ":".code;
 
     }
 
@@ -1915,7 +1967,7 @@ class Token {
 
         // Trim leading whitespace
         while (pos < length) {
-            final c = input.uCharCodeAt(pos);
+            final c = codeAt(pos);
             if (c == " ".code || c == "\t".code) {
                 pos++;
             } else {
@@ -1925,7 +1977,7 @@ class Token {
 
         // Check if there's any content besides tags and whitespace on the first line
         while (pos < length) {
-            final c = input.uCharCodeAt(pos);
+            final c = codeAt(pos);
 
             // Found end of first line
             if (c == "\n".code || c == "\r".code) {
@@ -1934,7 +1986,7 @@ class Token {
 
             // Handle comments
             if (c == "/".code && pos + 1 < length) {
-                final next = input.uCharCodeAt(pos + 1);
+                final next = codeAt(pos + 1);
                 if (next == "/".code) {
                     // Single-line comment, skip to end of line
                     break;
@@ -1942,9 +1994,9 @@ class Token {
                     // Skip multiline comment
                     pos += 2; // Skip /*
                     while (pos < length) {
-                        if (input.uCharCodeAt(pos) == "*".code &&
+                        if (codeAt(pos) == "*".code &&
                             pos + 1 < length &&
-                            input.uCharCodeAt(pos + 1) == "/".code) {
+                            codeAt(pos + 1) == "/".code) {
                                 pos += 2; // Skip */
                             break;
                         }
@@ -1971,7 +2023,7 @@ class Token {
         // If the first line has text content (not just tags),
         // skip to end of the first line and still check if next line is an indented continuation
         if (!onlyTagsOnFirstLine) {
-            while (pos < length && input.uCharCodeAt(pos) != "\n".code && input.uCharCodeAt(pos) != "\r".code) {
+            while (pos < length && codeAt(pos) != "\n".code && codeAt(pos) != "\r".code) {
                 pos++;
             }
         }
@@ -1986,7 +2038,7 @@ class Token {
         // Compute indent
         var indent = 0;
         var tmpPos = pos;
-        while (tmpPos > 0 && (input.uCharCodeAt(tmpPos-1) == " ".code || input.uCharCodeAt(tmpPos-1) == "\t".code)) {
+        while (tmpPos > 0 && (codeAt(tmpPos-1) == " ".code || codeAt(tmpPos-1) == "\t".code)) {
             indent++;
             tmpPos--;
         }
@@ -1998,7 +2050,7 @@ class Token {
 
         // Check that there is content in this line
         pos = skipWhitespaceAndComments(pos, false);
-        if (isWhitespace(input.uCharCodeAt(pos)) || (input.uCharCodeAt(pos) == "/".code && input.uCharCodeAt(pos+1) == "/".code)) {
+        if (isWhitespace(codeAt(pos)) || (codeAt(pos) == "/".code && codeAt(pos+1) == "/".code)) {
             return -1;
         }
 
@@ -2008,17 +2060,17 @@ class Token {
 
     function isContinuingMultilineText(pos:Int, indent:Int):Bool {
 
-        if (input.uCharCodeAt(pos) == "/".code && input.uCharCodeAt(pos+1) == "/".code) {
-            while (pos < length && input.uCharCodeAt(pos) != "\r".code && input.uCharCodeAt(pos) != "\n".code) {
+        if (codeAt(pos) == "/".code && codeAt(pos+1) == "/".code) {
+            while (pos < length && codeAt(pos) != "\r".code && codeAt(pos) != "\n".code) {
                 pos++;
             }
         }
 
-        if (input.uCharCodeAt(pos) == "\r".code) {
+        if (codeAt(pos) == "\r".code) {
             pos++;
         }
 
-        if (input.uCharCodeAt(pos) == "\n".code) {
+        if (codeAt(pos) == "\n".code) {
             pos++;
         }
         else {
@@ -2026,7 +2078,7 @@ class Token {
         }
 
         var computedIndent = 0;
-        while (input.uCharCodeAt(pos) == " ".code || input.uCharCodeAt(pos) == "\t".code) {
+        while (codeAt(pos) == " ".code || codeAt(pos) == "\t".code) {
             computedIndent++;
             pos++;
         }
@@ -2037,7 +2089,7 @@ class Token {
 
         // Check that there is content in this line
         pos = skipWhitespaceAndComments(pos, false);
-        if (isWhitespace(input.uCharCodeAt(pos)) || input.uCharCodeAt(pos) == "\r".code || input.uCharCodeAt(pos) == "\n".code || (input.uCharCodeAt(pos) == "/".code && input.uCharCodeAt(pos+1) == "/".code)) {
+        if (isWhitespace(codeAt(pos)) || codeAt(pos) == "\r".code || codeAt(pos) == "\n".code || (codeAt(pos) == "/".code && codeAt(pos+1) == "/".code)) {
             return false;
         }
 
@@ -2335,17 +2387,17 @@ class Token {
         else {
             final buf = new Utf8Buf();
             while (pos < length) {
-                final cc = input.uCharCodeAt(pos);
+                final cc = codeAt(pos);
                 if (cc == "\n".code) {
                     break;
                 }
                 // Stop before comment delimiters
                 if (cc == "/".code && pos + 1 < length) {
-                    final next = input.uCharCodeAt(pos + 1);
+                    final next = codeAt(pos + 1);
                     if (next == "/".code || next == "*".code) break;
                 }
                 if (cc == "#".code && pos + 1 < length) {
-                    final next = input.uCharCodeAt(pos + 1);
+                    final next = codeAt(pos + 1);
                     if (isIdentifierPart(next) || next == "-".code) break;
                 }
                 buf.addChar(cc);
@@ -2372,7 +2424,7 @@ class Token {
         var p = startPos + 1; // skip opening "
         var inTag = false;    // mirrors readString()'s tagStart != -1
         while (p < length) {
-            final c = input.uCharCodeAt(p);
+            final c = codeAt(p);
             // Escape: \ + any char (even \<newline> is a valid escape, not multiline)
             // Must be checked before the \n test so \<newline> is consumed, not rejected
             if (c == '\\'.code) { p += 2; continue; }
@@ -2382,11 +2434,11 @@ class Token {
             if (c == '"'.code && !inTag) return p + 1;
             // Tag open: guarded by allowTags, exactly like readString()
             if (allowTags && c == '<'.code && !inTag) {
-                final nc = p + 1 < length ? input.uCharCodeAt(p + 1) : 0;
+                final nc = p + 1 < length ? codeAt(p + 1) : 0;
                 final isClosing = nc == '/'.code;
                 final checkPos = p + (isClosing ? 2 : 1);
                 if (checkPos < length) {
-                    final ns = input.uCharCodeAt(checkPos);
+                    final ns = codeAt(checkPos);
                     if (isIdentifierStart(ns) || ns == '_'.code || ns == '$'.code ||
                         (isClosing && ns == '>'.code)) inTag = true;
                 }
@@ -2396,25 +2448,25 @@ class Token {
             if (c == '>'.code && inTag) inTag = false;
             // Interpolation (no escaped guard needed — \ already consumed by p+=2 above)
             if (c == '$'.code && p + 1 < length) {
-                final next = input.uCharCodeAt(p + 1);
+                final next = codeAt(p + 1);
                 if (next == '{'.code) {
                     // ${...}: mirrors readComplexInterpolation() which uses nextToken()
                     // nextToken() skips // and /* */ comments, so we must too
                     p += 2;
                     var depth = 1;
                     while (p < length && depth > 0) {
-                        final ic = input.uCharCodeAt(p);
+                        final ic = codeAt(p);
                         if (ic == '\\'.code) { p += 2; continue; }
                         if (ic == '\n'.code) return -1;
                         // // line comment always leads to \n → multiline → reject immediately
-                        if (ic == '/'.code && p + 1 < length && input.uCharCodeAt(p + 1) == '/'.code) return -1;
+                        if (ic == '/'.code && p + 1 < length && codeAt(p + 1) == '/'.code) return -1;
                         // /* */ block comment: skip entirely, reject if it spans a line
-                        if (ic == '/'.code && p + 1 < length && input.uCharCodeAt(p + 1) == '*'.code) {
+                        if (ic == '/'.code && p + 1 < length && codeAt(p + 1) == '*'.code) {
                             p += 2;
                             while (true) {
                                 if (p >= length) return -1;
-                                if (input.uCharCodeAt(p) == '\n'.code) return -1;
-                                if (p + 1 < length && input.uCharCodeAt(p) == '*'.code && input.uCharCodeAt(p + 1) == '/'.code) {
+                                if (codeAt(p) == '\n'.code) return -1;
+                                if (p + 1 < length && codeAt(p) == '*'.code && codeAt(p + 1) == '/'.code) {
                                     p += 2; break;
                                 }
                                 p++;
@@ -2436,7 +2488,7 @@ class Token {
                 if (next == '$'.code) { p += 2; continue; }  // $$: literal dollar
                 if (isIdentifierStart(next)) {
                     p++;  // skip $
-                    while (p < length && isIdentifierPart(input.uCharCodeAt(p))) p++;
+                    while (p < length && isIdentifierPart(codeAt(p))) p++;
                     p = scanAccessorChain(p, allowTags);
                     if (p == -1) return -1;
                     continue;
@@ -2457,11 +2509,11 @@ class Token {
      */
     function scanAccessorChain(p:Int, allowTags:Bool):Int {
         while (p < length) {
-            final c = input.uCharCodeAt(p);
+            final c = codeAt(p);
             // .field
-            if (c == '.'.code && p + 1 < length && isIdentifierStart(input.uCharCodeAt(p + 1))) {
+            if (c == '.'.code && p + 1 < length && isIdentifierStart(codeAt(p + 1))) {
                 p++;
-                while (p < length && isIdentifierPart(input.uCharCodeAt(p))) p++;
+                while (p < length && isIdentifierPart(codeAt(p))) p++;
             }
             // [expr] or (args): mirrors readFieldAccessInterpolation()'s bracket/paren loops
             else if (c == '['.code || c == '('.code) {
@@ -2469,16 +2521,16 @@ class Token {
                 p++;
                 var depth = 1;
                 while (p < length && depth > 0) {
-                    final ic = input.uCharCodeAt(p);
+                    final ic = codeAt(p);
                     if (ic == '\\'.code) { p += 2; continue; }
                     if (ic == '\n'.code) return -1;
-                    if (ic == '/'.code && p + 1 < length && input.uCharCodeAt(p + 1) == '/'.code) return -1;
-                    if (ic == '/'.code && p + 1 < length && input.uCharCodeAt(p + 1) == '*'.code) {
+                    if (ic == '/'.code && p + 1 < length && codeAt(p + 1) == '/'.code) return -1;
+                    if (ic == '/'.code && p + 1 < length && codeAt(p + 1) == '*'.code) {
                         p += 2;
                         while (true) {
                             if (p >= length) return -1;
-                            if (input.uCharCodeAt(p) == '\n'.code) return -1;
-                            if (p + 1 < length && input.uCharCodeAt(p) == '*'.code && input.uCharCodeAt(p + 1) == '/'.code) {
+                            if (codeAt(p) == '\n'.code) return -1;
+                            if (p + 1 < length && codeAt(p) == '*'.code && codeAt(p + 1) == '/'.code) {
                                 p += 2; break;
                             }
                             p++;
@@ -2512,12 +2564,12 @@ class Token {
         if (isStrict()) return null;
 
         // Look ahead to validate if this could be an unquoted string start
-        final c = input.uCharCodeAt(pos);
+        final c = codeAt(pos);
         final cc = peek();
 
         // Skip if it's a comment
         if (c == "/".code && pos < length - 1) {
-            final next = input.uCharCodeAt(pos + 1);
+            final next = codeAt(pos + 1);
             if (next == "/".code || next == "*".code) return null;
         }
 
@@ -2679,11 +2731,11 @@ class Token {
             var hasSameLineContent = false;
             var eolPos = scanEndPos;
             while (eolPos < length) {
-                final sc = input.uCharCodeAt(eolPos);
+                final sc = codeAt(eolPos);
                 if (sc == ' '.code || sc == '\t'.code) { eolPos++; continue; }
                 if (sc == '\n'.code || sc == '\r'.code) break;
                 if (sc == '/'.code && eolPos + 1 < length &&
-                    (input.uCharCodeAt(eolPos+1) == '/'.code || input.uCharCodeAt(eolPos+1) == '*'.code)) break;
+                    (codeAt(eolPos+1) == '/'.code || codeAt(eolPos+1) == '*'.code)) break;
                 if (sc == ']'.code || sc == '}'.code || sc == ')'.code || sc == ','.code) break;
                 if (sc == '#'.code) break;
                 hasSameLineContent = true;
@@ -2693,21 +2745,21 @@ class Token {
                 // Check if next line continues at same column with narrative text (not a statement)
                 final nextLinePos = skipWhitespaceAndComments(eolPos, true);
                 if (nextLinePos <= eolPos || nextLinePos >= length) return null;
-                final nextChar = input.uCharCodeAt(nextLinePos);
+                final nextChar = codeAt(nextLinePos);
                 // Blank line, comment, or another quoted string → not a continuation
                 if (nextChar == '\n'.code || nextChar == '\r'.code || nextChar == '"'.code ||
                     (nextChar == '/'.code && nextLinePos + 1 < length &&
-                        (input.uCharCodeAt(nextLinePos + 1) == '/'.code || input.uCharCodeAt(nextLinePos + 1) == '*'.code))) return null;
+                        (codeAt(nextLinePos + 1) == '/'.code || codeAt(nextLinePos + 1) == '*'.code))) return null;
                 // Check indent matches current column
                 var nextIndent = 0;
                 var tmpPos = nextLinePos;
-                while (tmpPos > 0 && (input.uCharCodeAt(tmpPos - 1) == ' '.code || input.uCharCodeAt(tmpPos - 1) == '\t'.code)) {
+                while (tmpPos > 0 && (codeAt(tmpPos - 1) == ' '.code || codeAt(tmpPos - 1) == '\t'.code)) {
                     nextIndent++; tmpPos--;
                 }
                 final expectedIndent = multilineIndent != -1 ? multilineIndent : column - 1;
                 if (nextIndent != expectedIndent) return null;
                 // -> transition or + choice insertion
-                if (nextChar == '-'.code && nextLinePos + 1 < length && input.uCharCodeAt(nextLinePos + 1) == '>'.code) return null;
+                if (nextChar == '-'.code && nextLinePos + 1 < length && codeAt(nextLinePos + 1) == '>'.code) return null;
                 if (nextChar == '+'.code) return null;
                 // Reuse existing statement-detection helpers (all take pos:Int, don't modify this.pos)
                 if (isAssignStart(nextLinePos, false)) return null;
@@ -2718,7 +2770,7 @@ class Token {
                 // Check for keywords (beat, state, character, choice, function, etc.)
                 if (isIdentifierStart(nextChar)) {
                     var wordEnd = nextLinePos;
-                    while (wordEnd < length && isIdentifierPart(input.uCharCodeAt(wordEnd))) wordEnd++;
+                    while (wordEnd < length && isIdentifierPart(codeAt(wordEnd))) wordEnd++;
                     final kw = input.uSubstr(nextLinePos, wordEnd - nextLinePos);
                     if (kw != 'null' && kw != 'true' && kw != 'false' && KEYWORDS.exists(kw)) return null;
                 }
@@ -2747,7 +2799,7 @@ class Token {
         var hasContent = false;
 
         while (pos < length) {
-            final c = input.uCharCodeAt(pos);
+            final c = codeAt(pos);
             final isSpace = isWhitespace(c);
 
             if (!hasContent) {
@@ -2778,13 +2830,13 @@ class Token {
             // Check for line breaks, which end the string only if not followed by more
             // string content on the next non-empty line
             // Also check trailing comments //
-            else if (tagStart == -1 && (c == "\n".code || c == "\r".code || (c == "/".code && pos < length - 1 && input.uCharCodeAt(pos+1) == "/".code))) {
+            else if (tagStart == -1 && (c == "\n".code || c == "\r".code || (c == "/".code && pos < length - 1 && codeAt(pos+1) == "/".code))) {
                 if (multilineIndent != -1) {
                     if (isContinuingMultilineText(pos, multilineIndent)) {
                         buf.addChar(c);
                         advance();
                         // CRLF
-                        if (c == "\r".code && input.uCharCodeAt(pos) == "\n".code) {
+                        if (c == "\r".code && codeAt(pos) == "\n".code) {
                             buf.addChar("\n".code);
                             advance();
                         }
@@ -2799,7 +2851,7 @@ class Token {
                     break;
                 }
             }
-            else if (tagStart == -1 && (c == "/".code && pos < length - 1 && input.uCharCodeAt(pos+1) == "*".code)) {
+            else if (tagStart == -1 && (c == "/".code && pos < length - 1 && codeAt(pos+1) == "*".code)) {
                 // Skip multiline comment in unquoted string
                 buf.addChar("/".code);
                 buf.addChar("*".code);
@@ -2808,14 +2860,14 @@ class Token {
                 // Read until comment end
                 var commentClosed = false;
                 while (pos < length) {
-                    if (input.uCharCodeAt(pos) == "*".code && pos + 1 < length && input.uCharCodeAt(pos + 1) == "/".code) {
+                    if (codeAt(pos) == "*".code && pos + 1 < length && codeAt(pos + 1) == "/".code) {
                         buf.addChar("*".code);
                         buf.addChar("/".code);
                         advance(2); // Process */
                         commentClosed = true;
                         break;
                     }
-                    buf.addChar(input.uCharCodeAt(pos));
+                    buf.addChar(codeAt(pos));
                     advance();
                 }
 
@@ -2831,7 +2883,7 @@ class Token {
                 break;
             }
             // Check for arrow start
-            else if (tagStart == -1 && c == "-".code && pos < length - 1 && input.uCharCodeAt(pos+1) == ">".code && isTransitionStart(pos)) {
+            else if (tagStart == -1 && c == "-".code && pos < length - 1 && codeAt(pos+1) == ">".code && isTransitionStart(pos)) {
                 break;
             }
             else if (tagStart == -1 && isValue && (c == ",".code || c == "]".code || c == "}".code)) {
@@ -2841,11 +2893,11 @@ class Token {
                 if (tagStart != -1) {
                     error("Unexpected < inside tag", true);
                 }
-                final nextChar = pos + 1 < length ? input.uCharCodeAt(pos + 1) : 0;
+                final nextChar = pos + 1 < length ? codeAt(pos + 1) : 0;
                 tagIsClosing = nextChar == "/".code;
                 final checkPos = pos + (tagIsClosing ? 2 : 1);
                 if (checkPos < length) {
-                    final nameStart = input.uCharCodeAt(checkPos);
+                    final nameStart = codeAt(checkPos);
                     if (isIdentifierStart(nameStart) || nameStart == "_".code || nameStart == "$".code || (tagIsClosing && nameStart == ">".code)) {
                         tagStart = buf.length;
                     }
@@ -2865,7 +2917,7 @@ class Token {
             }
             else if (tagStart == -1 && c == "#".code && !escaped) {
                 // # in unquoted string: handle ## escape or break for hash comment
-                final nextChar = pos + 1 < length ? input.uCharCodeAt(pos + 1) : 0;
+                final nextChar = pos + 1 < length ? codeAt(pos + 1) : 0;
                 if (nextChar == "#".code) {
                     // ## escape: keep both in buffer, interpreter converts ## → #
                     buf.addChar("#".code);
@@ -2894,7 +2946,7 @@ class Token {
                     advance();
                     currentColumn++;
 
-                    if (input.uCharCodeAt(pos) == "{".code) {
+                    if (codeAt(pos) == "{".code) {
                         advance();
                         currentColumn++;
 
@@ -2905,7 +2957,7 @@ class Token {
 
                         buf.add(input.uSubstr(tokenStartPos, interpLength));
                     }
-                    else if (isIdentifierStart(input.uCharCodeAt(pos))) {
+                    else if (isIdentifierStart(codeAt(pos))) {
                         final interpPos = new Position(interpLine, interpColumn + 1, pos);
                         final tokens = readFieldAccessInterpolation(interpPos);
                         final interpLength = pos - tokenStartPos;
@@ -2913,7 +2965,7 @@ class Token {
 
                         buf.add(input.uSubstr(tokenStartPos, interpLength));
                     }
-                    else if (input.uCharCodeAt(pos) == "$".code) {
+                    else if (codeAt(pos) == "$".code) {
                         buf.addChar("$".code);
                         buf.addChar("$".code);
                         advance();
@@ -2992,7 +3044,7 @@ class Token {
                             }
                             rtrimmedOffset = 0;
                             var n = pos - 1;
-                            while (n >= 0 && (input.uCharCodeAt(n) == " ".code || input.uCharCodeAt(n) == "\t".code)) {
+                            while (n >= 0 && (codeAt(n) == " ".code || codeAt(n) == "\t".code)) {
                                 rtrimmedOffset++;
                                 n--;
                             }
@@ -3052,7 +3104,7 @@ class Token {
         var allowTags = (parentBlockType() == KwBeat);
 
         while (pos < length) {
-            final c = input.uCharCodeAt(pos);
+            final c = codeAt(pos);
 
             if (escaped) {
                 buf.addChar("\\".code);
@@ -3078,11 +3130,11 @@ class Token {
                 if (tagStart != -1) {
                     error("Unexpected < inside tag", true);
                 }
-                final nextChar = pos + 1 < length ? input.uCharCodeAt(pos + 1) : 0;
+                final nextChar = pos + 1 < length ? codeAt(pos + 1) : 0;
                 tagIsClosing = nextChar == "/".code;
                 final checkPos = pos + (tagIsClosing ? 2 : 1);
                 if (checkPos < length) {
-                    final nameStart = input.uCharCodeAt(checkPos);
+                    final nameStart = codeAt(checkPos);
                     if (isIdentifierStart(nameStart) || nameStart == "_".code || nameStart == "$".code || (tagIsClosing && nameStart == ">".code)) {
                         tagStart = buf.length;
                     }
@@ -3110,7 +3162,7 @@ class Token {
                     advance();
                     currentColumn++;
 
-                    if (input.uCharCodeAt(pos) == "{".code) {
+                    if (codeAt(pos) == "{".code) {
                         advance();
                         currentColumn++;
 
@@ -3121,7 +3173,7 @@ class Token {
 
                         buf.add(input.uSubstr(tokenStartPos, interpLength));
                     }
-                    else if (isIdentifierStart(input.uCharCodeAt(pos))) {
+                    else if (isIdentifierStart(codeAt(pos))) {
                         final interpPos = new Position(interpLine, interpColumn + 1, pos);
                         final tokens = readFieldAccessInterpolation(interpPos);
                         final interpLength = pos - tokenStartPos;
@@ -3129,7 +3181,7 @@ class Token {
 
                         buf.add(input.uSubstr(tokenStartPos, interpLength));
                     }
-                    else if (input.uCharCodeAt(pos) == "$".code) {
+                    else if (codeAt(pos) == "$".code) {
                         buf.addChar("$".code);
                         buf.addChar("$".code);
                         advance();
@@ -3200,7 +3252,7 @@ class Token {
 
         while (pos < length && braceLevel > 0) {
 
-            if (input.uCharCodeAt(pos) == '"'.code) {
+            if (codeAt(pos) == '"'.code) {
                 final stringPos = new Position(currentLine, currentColumn, pos);
                 tokens.push(readString(stringPos));
                 currentColumn += (pos - stringPos.offset);
@@ -3285,14 +3337,14 @@ class Token {
         final tokens = new Tokens();
 
         // Read initial identifier
-        if (!isIdentifierStart(input.uCharCodeAt(pos))) {
+        if (!isIdentifierStart(codeAt(pos))) {
             error("Expected identifier in field access", true);
         }
 
         // Read identifier token
         final idStartPos = pos;
         while (pos < length) {
-            final c = input.uCharCodeAt(pos);
+            final c = codeAt(pos);
             if (!isIdentifierPart(c)) break;
             advance();
         }
@@ -3302,7 +3354,7 @@ class Token {
 
         // Keep reading field access, array access, function calls, and their combinations
         while (pos < length) {
-            switch (input.uCharCodeAt(pos)) {
+            switch (codeAt(pos)) {
                 case "[".code:
                     // Push the [ token
                     tokens.push(new Token(LBracket, new Position(line, column, pos, 1)));
@@ -3315,7 +3367,7 @@ class Token {
                     // Read tokens until closing bracket
                     var bracketLevel = 1;
                     while (pos < length && bracketLevel > 0) {
-                        if (input.uCharCodeAt(pos) == "]".code) {
+                        if (codeAt(pos) == "]".code) {
                             bracketLevel--;
                             if (bracketLevel == 0) {
                                 tokens.push(new Token(RBracket, new Position(line, column, pos, 1)));
@@ -3325,7 +3377,7 @@ class Token {
                                 break;
                             }
                         }
-                        else if (input.uCharCodeAt(pos) == "[".code) {
+                        else if (codeAt(pos) == "[".code) {
                             bracketLevel++;
                         }
 
@@ -3349,7 +3401,7 @@ class Token {
                     // Read tokens until closing parenthesis
                     var parenLevel = 1;
                     while (pos < length && parenLevel > 0) {
-                        if (input.uCharCodeAt(pos) == ")".code) {
+                        if (codeAt(pos) == ")".code) {
                             parenLevel--;
                             if (parenLevel == 0) {
                                 tokens.push(new Token(RParen, new Position(line, column, pos, 1)));
@@ -3359,11 +3411,11 @@ class Token {
                                 break;
                             }
                         }
-                        else if (input.uCharCodeAt(pos) == "(".code) {
+                        else if (codeAt(pos) == "(".code) {
                             parenLevel++;
                         }
 
-                        if (input.uCharCodeAt(pos) == ",".code) {
+                        if (codeAt(pos) == ",".code) {
                             tokens.push(new Token(Comma, new Position(line, column, pos, 1)));
                             advance();
                         }
@@ -3377,14 +3429,14 @@ class Token {
                         error("Unterminated function call in interpolation", true);
                     }
 
-                case ".".code if (pos + 1 < length && isIdentifierStart(input.uCharCodeAt(pos + 1))):
+                case ".".code if (pos + 1 < length && isIdentifierStart(codeAt(pos + 1))):
                     tokens.push(new Token(Dot, new Position(line, column, pos, 1)));
                     advance();
 
                     // Read the identifier after the dot
                     final idStartPos = pos;
                     while (pos < length) {
-                        final c = input.uCharCodeAt(pos);
+                        final c = codeAt(pos);
                         if (!isIdentifierPart(c)) break;
                         advance();
                     }
@@ -3411,7 +3463,7 @@ class Token {
         final startOffset = pos;
 
         while (pos < length) {
-            final c = input.uCharCodeAt(pos);
+            final c = codeAt(pos);
             if (!isIdentifierPart(c)) break;
             advance();
         }
@@ -3435,7 +3487,7 @@ class Token {
         var i = stringStart.offset;
 
         while (i < pos) {
-            if (input.uCharCodeAt(i) == "\n".code) {
+            if (codeAt(i) == "\n".code) {
                 line++;
                 column = 1;
             }
@@ -3458,7 +3510,7 @@ class Token {
         final contentStart = pos;
 
         while (pos < length) {
-            final c = input.uCharCodeAt(pos);
+            final c = codeAt(pos);
             if (c == "\n".code || c == "\r".code) break;
             advance();
         }
@@ -3478,7 +3530,7 @@ class Token {
         var nestLevel = 1;
 
         while (pos < length && nestLevel > 0) {
-            if (input.uCharCodeAt(pos) == "*".code && peek() == "/".code) {
+            if (codeAt(pos) == "*".code && peek() == "/".code) {
                 nestLevel--;
                 if (nestLevel == 0) {
                     final content = input.uSubstr(contentStart, pos - contentStart);
@@ -3487,7 +3539,7 @@ class Token {
                 }
                 advance(2);
             }
-            else if (input.uCharCodeAt(pos) == "/".code && peek() == "*".code) {
+            else if (codeAt(pos) == "/".code && peek() == "*".code) {
                 nestLevel++;
                 advance(2);
             }
@@ -3512,7 +3564,7 @@ class Token {
 
         // Only allow tag-syntax chars: identifier chars and dashes
         while (pos < length) {
-            final c = input.uCharCodeAt(pos);
+            final c = codeAt(pos);
             if (isIdentifierPart(c) || c == "-".code) {
                 advance();
             }
@@ -3530,13 +3582,13 @@ class Token {
         final start = makePosition();
         final startPos = pos;
 
-        while (pos < length && isDigit(input.uCharCodeAt(pos))) {
+        while (pos < length && isDigit(codeAt(pos))) {
             advance();
         }
 
-        if (pos < length && input.uCharCodeAt(pos) == ".".code && pos + 1 < length && isDigit(input.uCharCodeAt(pos + 1))) {
+        if (pos < length && codeAt(pos) == ".".code && pos + 1 < length && isDigit(codeAt(pos + 1))) {
             advance();
-            while (pos < length && isDigit(input.uCharCodeAt(pos))) advance();
+            while (pos < length && isDigit(codeAt(pos))) advance();
         }
 
         final token = makeToken(LNumber(Std.parseFloat(input.uSubstr(startPos, pos - startPos))), start);
@@ -3552,7 +3604,7 @@ class Token {
         final startPos = pos;
 
         while (pos < length) {
-            final c = input.uCharCodeAt(pos);
+            final c = codeAt(pos);
             if (!isIdentifierPart(c)) break;
             advance();
         }
@@ -3589,9 +3641,9 @@ class Token {
 
         // Read function name if present
         var name:Null<String> = null;
-        if (isIdentifierStart(input.uCharCodeAt(pos))) {
+        if (isIdentifierStart(codeAt(pos))) {
             final nameStart = pos;
-            while (pos < length && isIdentifierPart(input.uCharCodeAt(pos))) {
+            while (pos < length && isIdentifierPart(codeAt(pos))) {
                 advance();
             }
             name = input.uSubstr(nameStart, pos - nameStart);
@@ -3600,7 +3652,7 @@ class Token {
         skipWhitespaceAndComments();
 
         // Read parameters
-        if (pos >= length || input.uCharCodeAt(pos) != "(".code) {
+        if (pos >= length || codeAt(pos) != "(".code) {
             error('Expected opening parenthesis after function name', true);
         }
 
@@ -3614,7 +3666,7 @@ class Token {
 
         var currentArg = new Utf8Buf();
         while (pos < length && parenLevel > 0) {
-            final c = input.uCharCodeAt(pos);
+            final c = codeAt(pos);
 
             // Handle nested parentheses
             if (c == "/".code) {
@@ -3671,7 +3723,7 @@ class Token {
         skipWhitespaceAndComments();
 
         // Check if using braces or indentation
-        final usesBraces = pos < length && input.uCharCodeAt(pos) == "{".code;
+        final usesBraces = pos < length && codeAt(pos) == "{".code;
 
         var lastLineBreakPos = pos;
         var lastLineBreakLine = line;
@@ -3683,7 +3735,7 @@ class Token {
             var braceLevel = 1;
 
             while (pos < length && braceLevel > 0) {
-                final c = input.uCharCodeAt(pos);
+                final c = codeAt(pos);
 
                 // Handle string literals
                 if (c == "\"".code) {
@@ -3712,7 +3764,7 @@ class Token {
 
             // Skip to next line to start indent-based parsing
             while (pos < length) {
-                final c = input.uCharCodeAt(pos);
+                final c = codeAt(pos);
                 if (c == "\n".code || c == "\r".code) {
                     lastLineBreakPos = pos;
                     lastLineBreakLine = line;
@@ -3732,7 +3784,7 @@ class Token {
                     final indentStart = pos;
 
                     while (pos < length) {
-                        final c = input.uCharCodeAt(pos);
+                        final c = codeAt(pos);
                         if (c == " ".code) indent++;
                         else if (c == "\t".code) indent++;
                         else break;
@@ -3740,7 +3792,7 @@ class Token {
                     }
 
                     // If this is the first line, record the indent level
-                    if (functionIndentLevel == -1 && pos < length && input.uCharCodeAt(pos) != "\n".code && input.uCharCodeAt(pos) != "\r".code) {
+                    if (functionIndentLevel == -1 && pos < length && codeAt(pos) != "\n".code && codeAt(pos) != "\r".code) {
                         functionIndentLevel = indent;
 
                         // Check this is indented enough
@@ -3751,7 +3803,7 @@ class Token {
                     }
                     // Check if we are done (dedent or empty line at lower indentation)
                     else if (functionIndentLevel != -1 && indent < functionIndentLevel &&
-                            (pos >= length || (input.uCharCodeAt(pos) != "\n".code && input.uCharCodeAt(pos) != "\r".code))) {
+                            (pos >= length || (codeAt(pos) != "\n".code && codeAt(pos) != "\r".code))) {
                         // Rewind position to the start of this line
                         pos = indentStart;
                         break;
@@ -3760,7 +3812,7 @@ class Token {
                     currentLine = false;
                 }
 
-                final c = input.uCharCodeAt(pos);
+                final c = codeAt(pos);
 
                 // Handle string literals
                 if (c == "\"".code) {
@@ -3806,7 +3858,7 @@ class Token {
         advance(); // Skip opening quote
 
         while (pos < length) {
-            final c = input.uCharCodeAt(pos);
+            final c = codeAt(pos);
 
             if (escaped) {
                 // Handle escape sequence
@@ -3827,7 +3879,7 @@ class Token {
                 // Handle string interpolation
                 advance(); // Skip $
 
-                if (pos < length && input.uCharCodeAt(pos) == "{".code) {
+                if (pos < length && codeAt(pos) == "{".code) {
                     // Complex interpolation ${...}
                     advance(); // Skip {
 
@@ -3835,7 +3887,7 @@ class Token {
                     var interpBraceLevel = 1;
 
                     while (pos < length && interpBraceLevel > 0) {
-                        final ic = input.uCharCodeAt(pos);
+                        final ic = codeAt(pos);
 
                         if (ic == "\"".code) {
                             // Handle nested strings within interpolation
@@ -3857,9 +3909,9 @@ class Token {
                         }
                     }
                 }
-                else if (isIdentifierStart(input.uCharCodeAt(pos))) {
+                else if (isIdentifierStart(codeAt(pos))) {
                     // Simple identifier interpolation $identifier
-                    while (pos < length && isIdentifierPart(input.uCharCodeAt(pos))) {
+                    while (pos < length && isIdentifierPart(codeAt(pos))) {
                         advance();
                     }
                 }
@@ -3899,7 +3951,7 @@ class Token {
     inline function advance(count:Int = 1) {
         for (_ in 0...count) {
             if (pos >= length) break;
-            if (input.uCharCodeAt(pos) == "\n".code) {
+            if (codeAt(pos) == "\n".code) {
                 line++;
                 column = 1;
             }
@@ -3916,7 +3968,7 @@ class Token {
      * @return Character code at the offset position, or 0 if beyond input length
      */
     inline function peek(offset:Int = 1):Int {
-        return pos + offset < length ? input.uCharCodeAt(pos + offset) : 0;
+        return pos + offset < length ? codeAt(pos + offset) : 0;
     }
 
     /**
@@ -3950,7 +4002,7 @@ class Token {
      */
     function skipWhitespace() {
         while (pos < length) {
-            switch (input.uCharCodeAt(pos)) {
+            switch (codeAt(pos)) {
                 case " ".code | "\t".code:
                     advance();
                 case _:
@@ -8,6 +8,7 @@ import loreline.Lens;
 import loreline.Lexer;
 import loreline.Node.NStringLiteral;
 import loreline.Parser;
+import loreline.Simulator;
 
 using loreline.Utf8;
 
@@ -61,15 +62,30 @@ class Loreline {
      *                 When a callback is supplied, parse errors are reported by invoking it with `null` and the error becomes
      *                 readable via `Loreline.lastError()` — `parse()` itself never throws in that mode. Without a callback,
      *                 the call throws on error as usual.
+     * @param cache (optional) A parse cache shared across calls. Files (root and imports) found in the cache with the same
+     *              content are not lexed again. Requires `filePath` to be used for the root script.
      * @return The parsed script as an AST `Script` instance (if loaded synchronously)
      * @throws loreline.Error If the script contains syntax errors or other parsing issues (sync mode only)
      */
-    public static function parse(input:String, ?filePath:String, ?handleFile:ImportsFileHandler, ?callback:(script:Script)->Void):Null<Script> {
+    public static function parse(input:String, ?filePath:String, ?handleFile:ImportsFileHandler, ?callback:(script:Script)->Void, ?cache:ParseCache):Null<Script> {
 
         _lastError = null;
 
-        final lexer = new Lexer(input);
-        final tokens = lexer.tokenize();
+        final tokens:Tokens;
+        final lexerErrors:Array<LexerError>;
+        final indentSize:Int;
+        if (cache != null && filePath != null) {
+            final entry = cache.tokenize(Path.normalize(filePath), input);
+            tokens = entry.tokens;
+            lexerErrors = entry.errors;
+            indentSize = entry.indentSize;
+        }
+        else {
+            final lexer = new Lexer(input);
+            tokens = lexer.tokenize();
+            lexerErrors = lexer.getErrors();
+            indentSize = lexer.detectedIndentSize;
+        }
 
         #if loreline_debug_tokens
         for (tok in tokens) {
@@ -77,7 +93,6 @@ class Loreline {
         }
         #end
 
-        final lexerErrors = lexer.getErrors();
         if (lexerErrors != null && lexerErrors.length > 0) {
             return _reportParseError(lexerErrors[0], callback);
         }
@@ -89,6 +104,7 @@ class Loreline {
             // imports, either synchronous or asynchronous
 
             final imports = new Imports();
+            imports.cache = cache;
             imports.resolve(filePath, tokens, handleFile, (error) -> {
                 _reportParseError(error, callback);
             },
@@ -106,7 +122,7 @@ class Loreline {
                 });
 
                 result = parser.parse();
-                result.indentSize = lexer.detectedIndentSize;
+                result.indentSize = indentSize;
                 final parseErrors = parser.getErrors();
 
                 if (parseErrors != null && parseErrors.length > 0) {
@@ -127,7 +143,7 @@ class Loreline {
         final parser = new Parser(tokens);
 
         result = parser.parse();
-        result.indentSize = lexer.detectedIndentSize;
+        result.indentSize = indentSize;
         final parseErrors = parser.getErrors();
 
         if (parseErrors != null && parseErrors.length > 0) {
@@ -162,7 +178,9 @@ class Loreline {
      * For each file involved in the script (root + transitively imported), the
      * corresponding translation file is looked up by inserting `.<locale>` before
      * the extension (e.g. `characters.lor` → `characters.fr.lor`). Missing translation
-     * files are silently skipped.
+     * files are silently skipped. Every translation file is requested up front,
+     * so an asynchronous `handleFile` can load them concurrently: each one is parsed
+     * and merged into the result as soon as its content arrives.
      *
      * Each translation key is stored under both:
      *   - a global key `<id>` (first occurrence wins, root file priority)
@@ -256,7 +274,7 @@ class Loreline {
 
         // Imported files
         if (sourceRootPath != null) {
-            final lens = new Lens(script);
+            final lens = script.prepared != null ? script.prepared.lens : new Lens(script);
             final sourceRootDir = Path.directory(sourceRootPath);
             final importedAbsPaths = lens.getImportedPaths(sourceRootPath);
             for (importAbsPath in importedAbsPaths) {
@@ -305,15 +323,13 @@ class Loreline {
                         // of `parse()` so any errors throw synchronously here.
                         final transScript = parse(content, transPath, noopHandle);
                         if (transScript != null) {
-                            final translations = AstUtils.extractTranslations(transScript);
-                            for (id => str in translations) {
-                                // Scoped per file. The interpreter walks the
-                                // import ancestor chain at lookup time, so a
-                                // translation in an ancestor's file naturally
-                                // applies to descendants that don't have their
-                                // own translation for the same key.
-                                result.set(relPath + '#' + id, str);
-                            }
+                            // Scoped per file. The interpreter walks the
+                            // import ancestor chain at lookup time, so a
+                            // translation in an ancestor's file naturally
+                            // applies to descendants that don't have their
+                            // own translation for the same key. Entries go
+                            // straight to the merged map as each file arrives.
+                            AstUtils.extractTranslations(transScript, result, relPath + '#');
                         }
                     } catch (e:Error) {
                         // Translation file parse error: remember the first one
@@ -363,6 +379,21 @@ class Loreline {
         return result.join('/');
     }
 
+    /**
+     * Prepares a script so that every interpreter created from it shares the same
+     * analysis data (node lookups, parent links, parsed function code...) instead
+     * of rebuilding it. Useful when a lot of interpreters run the same script.
+     *
+     * The script must not be modified after being prepared. Calling this more
+     * than once on the same script is a no-op.
+     *
+     * @param script The parsed script (result from `parse()`)
+     * @return The prepared script data
+     */
+    public static function prepare(script:Script):PreparedScript {
+        return PreparedScript.prepare(script);
+    }
+
     /**
      * Starts playing a Loreline script from the beginning or a specific beat.
      *
@@ -445,6 +476,32 @@ class Loreline {
         return interpreter;
     }
 
+    /**
+     * Plays a script many times without any host involved, picking choices with a
+     * built-in policy, and returns aggregated beat visits, choices taken and the way
+     * each playthrough ended. Useful to find dead ends, unreachable beats and errors.
+     *
+     * @param script The parsed script (result from `parse()`)
+     * @param policy How choices are picked: `random`, `weighted` (favours the least taken options) or `exhaustive` (depth first)
+     * @param runs Number of playthroughs (maximum number for an exhaustive simulation)
+     * @param seed Seed of choices and built-in random functions, for reproducible results
+     * @param threads Number of threads to split random and weighted playthroughs across (threaded targets only)
+     * @param maxSteps Maximum number of dialogues and choices of a playthrough
+     * @param beatName Optional name of a specific beat to start from
+     * @return The aggregated results
+     */
+    public static function simulate(
+        script:Script,
+        policy:SimulationPolicy,
+        runs:Int,
+        seed:Int,
+        threads:Int = 1,
+        maxSteps:Int = 10000,
+        ?beatName:String
+    ):SimulationStats {
+        return Simulator.simulate(script, policy, runs, seed, threads, maxSteps, beatName);
+    }
+
     /**
      * Extracts translations from a parsed translation script.
      *
@@ -902,6 +902,30 @@ enum abstract ConditionStyle(Int) {
 
 }
 
+/**
+ * How an identifier access is resolved at runtime, computed by `PreparedScript`.
+ */
+enum abstract AccessBinding(Int) {
+
+    /**
+     * Not bound ahead of time: look in every scope of the stack, then in top level declarations.
+     */
+    var Unbound = 0;
+
+    /**
+     * No state of any scope can declare this name: look directly in top level declarations.
+     */
+    var TopLevel = 1;
+
+    public function toString() {
+        return switch abstract {
+            case Unbound: "Unbound";
+            case TopLevel: "TopLevel";
+        }
+    }
+
+}
+
 /**
  * Represents the mode of an alternative block.
  */
@@ -1975,6 +1999,12 @@ class NAccess extends NExpr {
      */
     public var name:String;
 
+    /**
+     * How this access is resolved at runtime (only relevant without target).
+     * Bound by `PreparedScript`, not part of the AST data.
+     */
+    @:noCompletion public var binding:AccessBinding = Unbound;
+
     /**
      * Creates a new field access node.
      * @param pos Position in source where this access appears
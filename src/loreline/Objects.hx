@@ -8,7 +8,10 @@ class Objects {
 
     public static function isFields(value:Any):Bool {
 
-        if (value is Fields) {
+        if (value is ShapedFields) {
+            return true;
+        }
+        else if (value is Fields) {
             return true;
         }
         else if (value is StringMap) {
@@ -42,7 +45,10 @@ class Objects {
 
     public static function getField(interpreter:Interpreter, fields:Any, name:String):Any {
 
-        return if (fields is Fields) {
+        return if (fields is ShapedFields) {
+            (cast fields:ShapedFields).get(name);
+        }
+        else if (fields is Fields) {
             (cast fields:Fields).lorelineGet(interpreter, name);
         }
         else if (fields is StringMap) {
@@ -74,7 +80,10 @@ class Objects {
 
     public static function getFields(interpreter:Interpreter, fields:Any):Array<String> {
 
-        return if (fields is Fields) {
+        return if (fields is ShapedFields) {
+            (cast fields:ShapedFields).keys();
+        }
+        else if (fields is Fields) {
             (cast fields:Fields).lorelineFields(interpreter);
         }
         else if (fields is StringMap) {
@@ -100,7 +109,10 @@ class Objects {
 
     public static function setField(interpreter:Interpreter, fields:Any, name:String, value:Any):Void {
 
-        if (fields is Fields) {
+        if (fields is ShapedFields) {
+            (cast fields:ShapedFields).set(name, value);
+        }
+        else if (fields is Fields) {
             (cast fields:Fields).lorelineSet(interpreter, name, value);
         }
         else if (fields is StringMap) {
@@ -126,7 +138,10 @@ class Objects {
 
     public static function removeField(interpreter:Interpreter, fields:Any, name:String):Bool {
 
-        if (fields is Fields) {
+        if (fields is ShapedFields) {
+            return (cast fields:ShapedFields).remove(name);
+        }
+        else if (fields is Fields) {
             return (cast fields:Fields).lorelineRemove(interpreter, name);
         }
         else if (fields is StringMap) {
@@ -152,7 +167,10 @@ class Objects {
 
     public static function fieldExists(interpreter:Interpreter, fields:Any, name:String):Bool {
 
-        return if (fields is Fields) {
+        return if (fields is ShapedFields) {
+            (cast fields:ShapedFields).exists(name);
+        }
+        else if (fields is Fields) {
             (cast fields:Fields).lorelineExists(interpreter, name);
         }
         else if (fields is StringMap) {
@@ -202,6 +220,16 @@ class Objects {
             }
         }
 
+        // States and characters created from a declaration share its field shape
+        #if !(loreline_use_jvm_types || loreline_use_cs_types)
+        if (type == null && interpreter != null && node != null) {
+            final shape = interpreter.fieldShape(node);
+            if (shape != null) {
+                return new ShapedFields(shape);
+            }
+        }
+        #end
+
         if (type != null) {
             final instance:Any = Type.createEmptyInstance(Type.resolveClass(type));
             if (instance is Fields) {
@@ -0,0 +1,182 @@
+package loreline;
+
+import loreline.Lexer;
+
+/**
+ * A lexed file kept by a `ParseCache`.
+ */
+@:structInit
+class ParseCacheEntry {
+
+    /**
+     * Hash of the content the tokens were produced from.
+     */
+    public var hash:Int;
+
+    /**
+     * The content the tokens were produced from.
+     */
+    public var content:String;
+
+    /**
+     * The resulting tokens. Never modified after lexing.
+     */
+    public var tokens:Tokens;
+
+    /**
+     * The lexer errors, if any.
+     */
+    public var errors:Array<LexerError>;
+
+    /**
+     * The indentation size detected by the lexer.
+     */
+    public var indentSize:Int;
+
+}
+
+/**
+ * An opt-in cache of lexed `.lor` files, shared across `Loreline.parse()` calls.
+ *
+ * Entries are keyed by resolved file path and content: when a file is read again
+ * with the same content (typically a shared module imported by many root scripts,
+ * or an unchanged file during a hot reload), its token stream is reused instead of
+ * being lexed again. Files whose content changed are lexed again and replace the
+ * previous entry.
+ *
+ * Parsed nodes are not cached: node ids depend on the position of each file in the
+ * import tree of the script being parsed, so imported files are still parsed for
+ * every script, from their cached tokens.
+ */
+class ParseCache {
+
+    final entries:Map<String,ParseCacheEntry> = new Map();
+
+    /**
+     * Number of lookups that reused a cached token stream.
+     */
+    public var hits(default, null):Int = 0;
+
+    /**
+     * Number of lookups that had to lex the content.
+     */
+    public var misses(default, null):Int = 0;
+
+    public function new() {}
+
+    /**
+     * Lexes the given content. Does not depend on any cache state,
+     * so it can run on any thread. Fatal lexer errors are not thrown
+     * but returned with the other errors, along with an empty token stream.
+     *
+     * @param content The file content
+     * @return A new entry for this content
+     */
+    public static function lex(content:String):ParseCacheEntry {
+
+        final lexer = new Lexer(content);
+        var tokens:Tokens;
+        try {
+            tokens = lexer.tokenize();
+        }
+        catch (e:LexerError) {
+            tokens = [];
+        }
+
+        return {
+            hash: hashContent(content),
+            content: content,
+            tokens: tokens,
+            errors: lexer.getErrors(),
+            indentSize: lexer.detectedIndentSize
+        };
+
+    }
+
+    /**
+     * Returns the lexed file for the given path and content, lexing it
+     * only if it is not cached yet or if its content changed.
+     *
+     * @param path The resolved file path
+     * @param content The file content
+     * @return The cache entry for this content
+     */
+    public function tokenize(path:String, content:String):ParseCacheEntry {
+
+        return get(path, content) ?? store(path, lex(content));
+
+    }
+
+    /**
+     * Returns the cached entry of the given path, if it was lexed from the same content.
+     *
+     * @param path The resolved file path
+     * @param content The file content
+     * @return The cache entry, or null if there is none for this content
+     */
+    public function get(path:String, content:String):Null<ParseCacheEntry> {
+
+        final existing = entries.get(path);
+
+        if (existing != null && existing.hash == hashContent(content) && existing.content == content) {
+            hits++;
+            return existing;
+        }
+
+        return null;
+
+    }
+
+    /**
+     * Stores a lexed file, replacing any previous entry of the same path.
+     *
+     * @param path The resolved file path
+     * @param entry The entry to store (from `ParseCache.lex()`)
+     * @return The stored entry
+     */
+    public function store(path:String, entry:ParseCacheEntry):ParseCacheEntry {
+
+        misses++;
+        entries.set(path, entry);
+
+        return entry;
+
+    }
+
+    /**
+     * Removes the cached entry of the given path, if any.
+     * @param path The resolved file path
+     */
+    public function remove(path:String):Void {
+
+        entries.remove(path);
+
+    }
+
+    /**
+     * Removes all cached entries.
+     */
+    public function clear():Void {
+
+        entries.clear();
+        hits = 0;
+        misses = 0;
+
+    }
+
+    /**
+     * FNV-1a hash of the content code units.
+     */
+    static function hashContent(content:String):Int {
+
+        var hash = 0x811c9dc5;
+
+        for (i in 0...content.length) {
+            hash = ((hash ^ StringTools.fastCodeAt(content, i)) * 0x01000193) | 0;
+        }
+
+        return hash;
+
+    }
+
+}
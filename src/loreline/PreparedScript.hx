@@ -0,0 +1,487 @@
+package loreline;
+
+import loreline.Node;
+import loreline.ShapedFields;
+
+using StringTools;
+using loreline.Utf8;
+
+/**
+ * Immutable data derived from a script that can be shared by every interpreter
+ * created from that script: the lens (node maps, parent links, file paths...)
+ * and the pre-parsed lorscript code of each top level function.
+ *
+ * A prepared script is built once with `PreparedScript.prepare()` and attached
+ * to its script. Interpreters created afterwards reuse it instead of walking the
+ * whole AST and parsing function code again. The script must not be modified
+ * once it has been prepared.
+ *
+ * Scripts loaded from a compiled image already have the parsed code of their
+ * functions: it is only decoded and compiled when a function is first needed.
+ */
+class PreparedScript {
+
+    /**
+     * The script this data has been prepared from.
+     */
+    public final script:Script;
+
+    /**
+     * The lens of the script, shared by every interpreter.
+     */
+    public final lens:Lens;
+
+    /**
+     * Parsed lorscript expressions of top level functions, keyed by function node id.
+     */
+    final functionExprs:NodeIdMap<loreline.lorscript.Expr> = new NodeIdMap();
+
+    /**
+     * Compiled top level functions, keyed by function node id.
+     * Functions that can't be compiled are missing and run through `Interp`.
+     */
+    final compiledFunctions:NodeIdMap<loreline.lorscript.Compiler.CompiledFunction> = new NodeIdMap();
+
+    /**
+     * Decoders of the functions whose parsed code comes from a compiled image and
+     * hasn't been used yet, keyed by function node id. Only access it with
+     * `functionsMutex` held.
+     */
+    final pendingFunctions:NodeIdMap<()->loreline.lorscript.Expr>;
+
+    /**
+     * Field shape of the top level state, made of every top level state declaration.
+     */
+    final topLevelShape:FieldShape;
+
+    /**
+     * Field shapes of character and state declarations, keyed by declaration node id.
+     */
+    final fieldShapes:NodeIdMap<FieldShape> = new NodeIdMap();
+
+    /**
+     * Maximum number of translation indexes kept by a prepared script. Using more
+     * translations maps than this (e.g. switching locales repeatedly) rebuilds
+     * the least recently used index instead of keeping every map alive.
+     */
+    static inline final MAX_TRANSLATION_INDEXES:Int = 4;
+
+    /**
+     * Translation indexes built for this script, one per translations map, most
+     * recently used first. Interpreters of the same script may run on different
+     * threads: only access it with `translationIndexesMutex` held.
+     */
+    final translationIndexes:Array<{translations:Map<String, NStringLiteral>, index:NodeIdMap<NStringLiteral>}> = [];
+
+    #if target.threaded
+    final translationIndexesMutex:sys.thread.Mutex = new sys.thread.Mutex();
+
+    final functionsMutex:sys.thread.Mutex = new sys.thread.Mutex();
+
+    /**
+     * Serializes `prepare()`: preparing binds the accesses of the script nodes,
+     * which must not happen twice, or while another thread prepares the same script.
+     */
+    static final prepareMutex:sys.thread.Mutex = new sys.thread.Mutex();
+    #end
+
+    /**
+     * Returns the prepared data of the given script, building it if needed.
+     *
+     * @param script The script to prepare
+     * @param accessesBound Whether identifier access bindings are already resolved
+     *                      (scripts loaded from a compiled image store them)
+     * @param functions Decoders of the parsed function code stored in a compiled image,
+     *                  by function node id. These functions are not parsed again.
+     * @return The prepared script, attached to `script.prepared`
+     */
+    public static function prepare(script:Script, accessesBound:Bool = false, ?functions:NodeIdMap<()->loreline.lorscript.Expr>):PreparedScript {
+
+        #if target.threaded
+        prepareMutex.acquire();
+        try {
+            if (script.prepared == null) {
+                script.prepared = new PreparedScript(script, accessesBound, functions);
+            }
+        }
+        catch (e:Any) {
+            prepareMutex.release();
+            throw e;
+        }
+        prepareMutex.release();
+        #else
+        if (script.prepared == null) {
+            script.prepared = new PreparedScript(script, accessesBound, functions);
+        }
+        #end
+
+        return script.prepared;
+
+    }
+
+    function new(script:Script, accessesBound:Bool, functions:Null<NodeIdMap<()->loreline.lorscript.Expr>>) {
+
+        this.script = script;
+        this.lens = new Lens(script);
+        this.pendingFunctions = functions ?? new NodeIdMap();
+
+        if (!accessesBound) {
+            bindAccesses();
+        }
+
+        topLevelShape = FieldShape.ofNode(script);
+        script.each((node, parent) -> {
+            if (node is NCharacterDecl || node is NStateDecl) {
+                fieldShapes.set(node.id, FieldShape.ofNode(node));
+            }
+        });
+
+        for (decl in script) {
+            if (decl is NFunctionDecl) {
+                final func:NFunctionDecl = cast decl;
+                if (func.name != null && !pendingFunctions.exists(func.id)) {
+                    try {
+                        final expr = parseFunction(func);
+                        functionExprs.set(func.id, expr);
+                        final compiled = loreline.lorscript.Compiler.compileFunction(expr);
+                        if (compiled != null) {
+                            compiledFunctions.set(func.id, compiled);
+                        }
+                    }
+                    catch (e:Any) {
+                        // Errors are reported by the interpreter when it
+                        // initializes the function
+                    }
+                }
+            }
+        }
+
+    }
+
+    /**
+     * Binds identifier accesses that can only resolve to top level declarations,
+     * so that the interpreter does not need to look for them in every scope.
+     *
+     * Scopes are dynamic (a beat called from another one sees the states of its
+     * caller), so a name is only bound if no state other than the top level ones
+     * declares it, anywhere in the script or its imports. Other accesses stay
+     * unbound and are resolved by walking the scope stack.
+     */
+    function bindAccesses():Void {
+
+        final topLevelStates = new NodeIdMap<Bool>();
+        for (decl in script) {
+            if (decl is NStateDecl) {
+                topLevelStates.set(decl.id, true);
+            }
+        }
+
+        final scopedNames = new Map<String, Bool>();
+        final accesses:Array<NAccess> = [];
+
+        script.each((node, parent) -> {
+            if (node is NStateDecl) {
+                if (!topLevelStates.exists(node.id)) {
+                    final stateDecl:NStateDecl = cast node;
+                    for (field in stateDecl.fields) {
+                        scopedNames.set(field.name, true);
+                    }
+                }
+            }
+            else if (node is NAccess) {
+                final access:NAccess = cast node;
+                if (access.target == null && access.name != null) {
+                    accesses.push(access);
+                }
+            }
+        });
+
+        for (access in accesses) {
+            // Underscore names may match internal node state fields (_visitCount...)
+            if (!scopedNames.exists(access.name) && !access.name.startsWith("_")) {
+                access.binding = AccessBinding.TopLevel;
+            }
+        }
+
+    }
+
+    /**
+     * Returns the parsed lorscript expression of the given function.
+     *
+     * @param func The function declaration
+     * @return The lorscript expression to execute
+     */
+    public function functionExpr(func:NFunctionDecl):loreline.lorscript.Expr {
+
+        materializeFunction(func);
+
+        var expr = functionExprs.get(func.id);
+
+        if (expr == null) {
+            expr = parseFunction(func);
+            functionExprs.set(func.id, expr);
+        }
+
+        return expr;
+
+    }
+
+    /**
+     * Returns the compiled code of the given function, if it could be compiled.
+     *
+     * @param func The function declaration
+     * @return The compiled function, or null if it must run through `Interp`
+     */
+    public function compiledFunction(func:NFunctionDecl):Null<loreline.lorscript.Compiler.CompiledFunction> {
+
+        materializeFunction(func);
+
+        return compiledFunctions.get(func.id);
+
+    }
+
+    /**
+     * Tells whether the code of the given function is stored in a compiled image
+     * and has not been decoded yet. Interpreters defer binding such functions
+     * until they are called.
+     *
+     * @param func The function declaration
+     * @return `true` if the function has not been decoded yet
+     */
+    public function isFunctionPending(func:NFunctionDecl):Bool {
+
+        lockFunctions();
+        final pending = pendingFunctions.exists(func.id);
+        unlockFunctions();
+
+        return pending;
+
+    }
+
+    /**
+     * Decodes and compiles the given function if its code comes from a compiled
+     * image and hasn't been used yet. Does nothing otherwise.
+     */
+    function materializeFunction(func:NFunctionDecl):Void {
+
+        lockFunctions();
+        try {
+            final decode = pendingFunctions.get(func.id);
+            if (decode != null) {
+                pendingFunctions.remove(func.id);
+                final expr = decode();
+                functionExprs.set(func.id, expr);
+                final compiled = loreline.lorscript.Compiler.compileFunction(expr);
+                if (compiled != null) {
+                    compiledFunctions.set(func.id, compiled);
+                }
+            }
+        }
+        catch (e:Any) {
+            unlockFunctions();
+            throw e;
+        }
+        unlockFunctions();
+
+    }
+
+    inline function lockFunctions():Void {
+
+        #if target.threaded
+        functionsMutex.acquire();
+        #end
+
+    }
+
+    inline function unlockFunctions():Void {
+
+        #if target.threaded
+        functionsMutex.release();
+        #end
+
+    }
+
+    /**
+     * Returns the field shape of the states created from the given node.
+     *
+     * @param node The script (for the top level state), or a character or state declaration
+     * @return The field shape, or null if the node doesn't declare fields
+     */
+    public function fieldShape(node:Node):Null<FieldShape> {
+
+        if (node == script) return topLevelShape;
+        return fieldShapes.get(node.id);
+
+    }
+
+    /**
+     * Returns the translated string literals of this script by node id,
+     * resolving every translatable node of the script the first time
+     * a given translations map is used.
+     *
+     * @param translations The translations map (localization key → translated string literal)
+     * @return The translated literals by node id, only containing nodes that have a translation
+     */
+    public function translationIndex(translations:Map<String, NStringLiteral>):NodeIdMap<NStringLiteral> {
+
+        lockTranslationIndexes();
+        var index = findTranslationIndex(translations);
+        unlockTranslationIndexes();
+        if (index != null) return index;
+
+        // Built without holding the lock: it only reads the script and the translations
+        final built = buildTranslationIndex(translations);
+
+        lockTranslationIndexes();
+        index = findTranslationIndex(translations);
+        if (index == null) {
+            index = built;
+            translationIndexes.unshift({
+                translations: translations,
+                index: index
+            });
+            if (translationIndexes.length > MAX_TRANSLATION_INDEXES) {
+                translationIndexes.pop();
+            }
+        }
+        unlockTranslationIndexes();
+
+        return index;
+
+    }
+
+    /**
+     * Returns the index built for the given translations map, if any, moving
+     * it first. Must be called with the lock held.
+     */
+    function findTranslationIndex(translations:Map<String, NStringLiteral>):Null<NodeIdMap<NStringLiteral>> {
+
+        for (i in 0...translationIndexes.length) {
+            final entry = translationIndexes[i];
+            if (entry.translations == translations) {
+                if (i > 0) {
+                    translationIndexes.splice(i, 1);
+                    translationIndexes.unshift(entry);
+                }
+                return entry.index;
+            }
+        }
+
+        return null;
+
+    }
+
+    /**
+     * Resolves the translation of every translatable node of the script.
+     */
+    function buildTranslationIndex(translations:Map<String, NStringLiteral>):NodeIdMap<NStringLiteral> {
+
+        final index = new NodeIdMap<NStringLiteral>();
+
+        script.each((node, parent) -> {
+            final str:NStringLiteral = if (node is NTextStatement) {
+                (cast node:NTextStatement).content;
+            }
+            else if (node is NDialogueStatement) {
+                (cast node:NDialogueStatement).content;
+            }
+            else if (node is NChoiceOption) {
+                (cast node:NChoiceOption).text;
+            }
+            else {
+                null;
+            }
+
+            if (str != null) {
+                final translated = resolveTranslation(script, lens, translations, cast node, str);
+                if (translated != null) {
+                    index.set(node.id, translated);
+                }
+            }
+        });
+
+        return index;
+
+    }
+
+    inline function lockTranslationIndexes():Void {
+
+        #if target.threaded
+        translationIndexesMutex.acquire();
+        #end
+
+    }
+
+    inline function unlockTranslationIndexes():Void {
+
+        #if target.threaded
+        translationIndexesMutex.release();
+        #end
+
+    }
+
+    /**
+     * Looks for the translation of a string literal, from the hash comment of its node.
+     *
+     * Walks the import ancestor chain from the node's own file up to root,
+     * trying each scoped key in turn. A translation defined in an ancestor's
+     * `.<lang>.lor` file applies to descendants that don't translate the same
+     * key themselves. Siblings (non-ancestor files) never share translations.
+     *
+     * @param script The root script
+     * @param lens The lens of the root script
+     * @param translations The translations map
+     * @param node The node holding the string literal
+     * @param str The string literal
+     * @return The translated string literal, or null if there is none
+     */
+    public static function resolveTranslation(script:Script, lens:Lens, translations:Map<String, NStringLiteral>, node:AstNode, str:NStringLiteral):Null<NStringLiteral> {
+
+        final id = AstUtils.findHashComment(node, str);
+        if (id != null && script.filePath != null) {
+            for (relPath in lens.getNodeAncestorFilePaths(node)) {
+                final scoped = translations.get(relPath + '#' + id);
+                if (scoped != null) {
+                    return scoped;
+                }
+            }
+        }
+
+        return null;
+
+    }
+
+    /**
+     * Converts the code of a function to lorscript and parses it.
+     * Throws if the code is invalid.
+     *
+     * @param func The function declaration
+     * @return The lorscript expression to execute
+     */
+    public static function parseFunction(func:NFunctionDecl):loreline.lorscript.Expr {
+
+        final codeToLorscript = new CodeToLorscript();
+        final expr = codeToLorscript.process(func.code + (func.external ? " {}" : ""));
+        #if loreline_debug_functions
+        final offsets = @:privateAccess codeToLorscript.posOffsets;
+        trace('\n'+func.code);
+        trace('\n'+expr);
+        trace(offsets.length + ' / ' + expr.uLength());
+        trace(offsets.join(" "));
+        var chars = [];
+        var origChars = [];
+        for (i in 0...expr.uLength()) {
+            chars.push(expr.uCharAt(i).replace("\n", " "));
+            origChars.push(func.code.uCharAt(i - offsets[i]).replace("\n", " "));
+        }
+        trace(origChars.join(" "));
+        trace(chars.join(" "));
+        #end
+        final parser = new loreline.lorscript.Parser();
+        parser.allowJSON = true;
+        parser.allowTypes = true;
+        return parser.parseString(expr);
+
+    }
+
+}
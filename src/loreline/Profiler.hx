@@ -0,0 +1,315 @@
+package loreline;
+
+import loreline.Node;
+
+/**
+ * Call count and accumulated time of a profiled section.
+ */
+@:structInit
+class ProfilerEntry {
+
+    /**
+     * Name of the section (node type, beat or function name).
+     */
+    public var name:String;
+
+    /**
+     * Number of times the section has been entered.
+     */
+    public var calls:Int = 0;
+
+    /**
+     * Time spent in the section, in seconds, excluding the time spent
+     * in the other profiled sections it entered.
+     */
+    public var time:Float = 0;
+
+}
+
+/**
+ * Opt-in profiler of an `Interpreter`, accumulating call counts and wall time
+ * per statement type, expression type, beat, function and host handler.
+ *
+ * Evaluation is written in continuation passing style: a statement can run the
+ * rest of the script from its own callback. Times are then only meaningful as
+ * self times: each section only accounts for the time elapsed while it was the
+ * innermost profiled section. Beats account for the self time of every statement
+ * and expression evaluated in them, host handlers (dialogue, choice and finish)
+ * are accounted separately and are not part of any beat.
+ *
+ * Profiling is disabled by default and costs a null check per evaluation when
+ * disabled. Once `Profiler.enabled` is set, each interpreter created afterwards
+ * gets its own profiler, available as `interpreter.profiler`.
+ */
+class Profiler {
+
+    /**
+     * Whether interpreters created from now on are profiled.
+     */
+    public static var enabled:Bool = false;
+
+    /**
+     * Statements, by node type.
+     */
+    public final nodes:Map<String,ProfilerEntry> = new Map();
+
+    /**
+     * Expressions (including strings), by node type.
+     */
+    public final expressions:Map<String,ProfilerEntry> = new Map();
+
+    /**
+     * Beats, by beat name. Calls are the number of times a beat has been run or inserted.
+     */
+    public final beats:Map<String,ProfilerEntry> = new Map();
+
+    /**
+     * Function calls, by function name. Method calls are prefixed with a dot.
+     */
+    public final functions:Map<String,ProfilerEntry> = new Map();
+
+    /**
+     * Host handlers: `dialogue`, `choice` and `finish`.
+     */
+    public final handlers:Map<String,ProfilerEntry> = new Map();
+
+    /**
+     * Sections currently entered, innermost last.
+     */
+    final stack:Array<ProfilerEntry> = [];
+
+    /**
+     * Beat of each section currently entered, if any.
+     */
+    final stackBeats:Array<ProfilerEntry> = [];
+
+    /**
+     * Time of the latest enter or exit.
+     */
+    var last:Float = 0;
+
+    public function new() {}
+
+    /**
+     * Returns the entry of a statement.
+     */
+    public function node(node:Node):ProfilerEntry {
+
+        return entry(nodes, nodeType(node));
+
+    }
+
+    /**
+     * Returns the entry of an expression.
+     */
+    public function expression(expr:Node):ProfilerEntry {
+
+        return entry(expressions, nodeType(expr));
+
+    }
+
+    /**
+     * Returns the entry of a beat.
+     */
+    public function beat(beat:NBeatDecl):ProfilerEntry {
+
+        return entry(beats, beat.name);
+
+    }
+
+    /**
+     * Returns the entry of a function.
+     */
+    public function func(name:String):ProfilerEntry {
+
+        return entry(functions, name);
+
+    }
+
+    /**
+     * Returns the entry of a host handler.
+     */
+    public function handler(name:String):ProfilerEntry {
+
+        return entry(handlers, name);
+
+    }
+
+    /**
+     * Enters a section, pausing the current one.
+     *
+     * @param entry The entry of the section
+     * @param beat The entry of the beat the section belongs to, if any
+     * @return The depth to give to `exit()` when leaving the section
+     */
+    public function enter(entry:ProfilerEntry, beat:Null<ProfilerEntry>):Int {
+
+        final now = haxe.Timer.stamp();
+        final depth = stack.length;
+
+        if (depth > 0) {
+            account(depth - 1, now);
+        }
+
+        entry.calls++;
+        stack.push(entry);
+        stackBeats.push(beat);
+        last = now;
+
+        return depth;
+
+    }
+
+    /**
+     * Leaves a section, resuming the one that entered it. Sections still
+     * entered above it (left by an exception) are left as well.
+     *
+     * @param depth The depth returned by `enter()`
+     */
+    public function exit(depth:Int):Void {
+
+        final now = haxe.Timer.stamp();
+
+        if (stack.length > depth) {
+            account(stack.length - 1, now);
+            stack.resize(depth);
+            stackBeats.resize(depth);
+        }
+
+        last = now;
+
+    }
+
+    /**
+     * Clears every recorded entry.
+     */
+    public function reset():Void {
+
+        nodes.clear();
+        expressions.clear();
+        beats.clear();
+        functions.clear();
+        handlers.clear();
+        stack.resize(0);
+        stackBeats.resize(0);
+
+    }
+
+    /**
+     * Returns the recorded entries, as JSON. Each category is an array of
+     * `{name, calls, time}` objects (time in milliseconds), by decreasing time.
+     *
+     * @param pretty Whether to indent the output
+     * @return The JSON snapshot
+     */
+    public function snapshot(pretty:Bool = false):String {
+
+        return haxe.Json.stringify({
+            nodes: sorted(nodes).map(entryJson),
+            expressions: sorted(expressions).map(entryJson),
+            beats: sorted(beats).map(entryJson),
+            functions: sorted(functions).map(entryJson),
+            handlers: sorted(handlers).map(entryJson)
+        }, null, pretty ? '  ' : null);
+
+    }
+
+    /**
+     * Returns the recorded entries as a human readable table.
+     *
+     * @param limit Maximum number of entries printed per category
+     * @return The report
+     */
+    public function report(limit:Int = 15):String {
+
+        final buf = new StringBuf();
+
+        inline function category(title:String, entries:Map<String,ProfilerEntry>) {
+            final list = sorted(entries);
+            if (list.length > 0) {
+                buf.add(title);
+                buf.add('\n');
+                for (i in 0...Std.int(Math.min(limit, list.length))) {
+                    final e = list[i];
+                    buf.add('  ');
+                    buf.add(StringTools.rpad(e.name, ' ', 28));
+                    buf.add(StringTools.lpad(Std.string(e.calls), ' ', 10));
+                    buf.add(StringTools.lpad(formatMs(e.time), ' ', 12));
+                    buf.add(' ms\n');
+                }
+            }
+        }
+
+        category('Beats', beats);
+        category('Statements', nodes);
+        category('Expressions', expressions);
+        category('Functions', functions);
+        category('Handlers', handlers);
+
+        return buf.toString();
+
+    }
+
+    /**
+     * Adds the time elapsed since the latest enter or exit to the section at the given depth.
+     */
+    function account(index:Int, now:Float):Void {
+
+        final elapsed = now - last;
+        stack[index].time += elapsed;
+
+        final beat = stackBeats[index];
+        if (beat != null) {
+            beat.time += elapsed;
+        }
+
+    }
+
+    static function entry(entries:Map<String,ProfilerEntry>, name:String):ProfilerEntry {
+
+        var result = entries.get(name);
+
+        if (result == null) {
+            result = { name: name };
+            entries.set(name, result);
+        }
+
+        return result;
+
+    }
+
+    static function nodeType(node:Node):String {
+
+        final name = Type.getClassName(Type.getClass(node));
+        final dot = name.lastIndexOf('.');
+
+        return dot != -1 ? name.substr(dot + 1) : name;
+
+    }
+
+    static function sorted(entries:Map<String,ProfilerEntry>):Array<ProfilerEntry> {
+
+        final list = [for (e in entries) e];
+        list.sort((a, b) -> a.time < b.time ? 1 : a.time > b.time ? -1 : 0);
+
+        return list;
+
+    }
+
+    static function entryJson(e:ProfilerEntry):Dynamic {
+
+        return {
+            name: e.name,
+            calls: e.calls,
+            time: Math.round(e.time * 1000000) / 1000
+        };
+
+    }
+
+    static function formatMs(time:Float):String {
+
+        return Std.string(Math.round(time * 1000000) / 1000);
+
+    }
+
+}
@@ -0,0 +1,1317 @@
+package loreline;
+
+import haxe.io.Bytes;
+import haxe.io.BytesBuffer;
+import haxe.io.Encoding;
+import loreline.Interpreter;
+import loreline.Node;
+import loreline.SaveData;
+
+/**
+ * Compact binary encoding of save data, an alternative to JSON.
+ *
+ * Layout: the `LRLB` magic, the binary format version, then the save data
+ * itself. Integers are LEB128 varints (zigzag for signed values), node ids are
+ * written as their four varint components, strings are interned (each distinct
+ * string is written once, then referenced by index) and values are typed.
+ *
+ * `save()` and `restore()` write and read an interpreter directly, without
+ * going through `SaveData`, while `encode()` and `decode()` convert save data.
+ */
+class SaveBinary {
+
+    /**
+     * Version of the binary layout (independent from `SaveData.version`).
+     */
+    public static inline final FORMAT_VERSION:Int = 1;
+
+    /**
+     * Tells whether the given bytes start like binary save data.
+     *
+     * @param bytes The bytes to check
+     * @return `true` if the bytes have the binary save data header
+     */
+    public static function isBinary(bytes:Bytes):Bool {
+
+        return bytes != null && bytes.length >= 5 &&
+            bytes.get(0) == Flags.MAGIC_0 && bytes.get(1) == Flags.MAGIC_1 &&
+            bytes.get(2) == Flags.MAGIC_2 && bytes.get(3) == Flags.MAGIC_3;
+
+    }
+
+    /**
+     * Encodes save data to bytes.
+     *
+     * @param saveData The save data (typically from `interpreter.save()`)
+     * @return The encoded bytes
+     */
+    public static function encode(saveData:SaveData):Bytes {
+
+        final writer = new SaveBinaryWriter();
+        writer.writeSaveData(saveData);
+        return writer.getBytes();
+
+    }
+
+    /**
+     * Decodes save data from bytes produced by `encode()`.
+     *
+     * @param bytes The encoded bytes
+     * @return The decoded save data
+     * @throws Error If the bytes are not valid binary save data
+     */
+    public static function decode(bytes:Bytes):SaveData {
+
+        if (!isBinary(bytes)) {
+            throw new Error("Invalid binary save data");
+        }
+
+        final reader = new SaveBinaryReader(bytes);
+        return reader.readSaveData();
+
+    }
+
+    /**
+     * Saves the state of an interpreter to bytes, written directly from its
+     * runtime state. Contains the same data as `encode(interpreter.save())` and
+     * creates a save checkpoint the same way, but only serializes the states
+     * that changed since the last checkpoint, and builds no save data tree.
+     *
+     * @param interpreter The interpreter to save
+     * @return The encoded save data
+     */
+    public static function save(interpreter:Interpreter):Bytes {
+
+        final writer = new SaveBinaryWriter();
+        writer.writeInterpreter(interpreter);
+        return writer.getBytes();
+
+    }
+
+    /**
+     * Restores the state of an interpreter from bytes produced by `save()` or `encode()`,
+     * read directly into its runtime state. Same result as `interpreter.restore(decode(bytes))`.
+     * The bytes are read entirely before the interpreter is modified: if they are
+     * invalid, the interpreter is left untouched.
+     *
+     * @param interpreter The interpreter to restore
+     * @param bytes The encoded save data
+     * @throws Error If the bytes are not valid binary save data
+     */
+    public static function restore(interpreter:Interpreter, bytes:Bytes):Void {
+
+        if (!isBinary(bytes)) {
+            throw new Error("Invalid binary save data");
+        }
+
+        final reader = new SaveBinaryReader(bytes);
+        reader.restoreInterpreter(interpreter);
+
+    }
+
+}
+
+private enum abstract ValueKind(Int) from Int to Int {
+
+    var NULL = 0;
+
+    var FALSE = 1;
+
+    var TRUE = 2;
+
+    var INT = 3;
+
+    var FLOAT = 4;
+
+    var STRING = 5;
+
+    var ARRAY = 6;
+
+    var FIELDS = 7;
+
+}
+
+private class Flags {
+
+    public static inline final MAGIC_0:Int = 0x4C; // L
+    public static inline final MAGIC_1:Int = 0x52; // R
+    public static inline final MAGIC_2:Int = 0x4C; // L
+    public static inline final MAGIC_3:Int = 0x42; // B
+
+    public static inline final SAVE_INSERTIONS:Int = 1;
+    public static inline final SAVE_PENDING_OPTIONS:Int = 2;
+    public static inline final SAVE_CHOICE_CONTEXT:Int = 4;
+    public static inline final SAVE_TOKEN:Int = 8;
+
+    public static inline final SCOPE_BEAT:Int = 1;
+    public static inline final SCOPE_NODE:Int = 2;
+    public static inline final SCOPE_STATE:Int = 4;
+    public static inline final SCOPE_BEATS:Int = 8;
+    public static inline final SCOPE_HEAD:Int = 16;
+    public static inline final SCOPE_INSERTION:Int = 32;
+
+    public static inline final INSERTION_ORIGIN:Int = 1;
+    public static inline final INSERTION_OPTIONS:Int = 2;
+    public static inline final INSERTION_STACK:Int = 4;
+    public static inline final INSERTION_PARTIAL:Int = 8;
+    public static inline final INSERTION_NEXT_INDEX:Int = 16;
+
+    public static inline final OPTION_DISABLED:Int = 1;
+    public static inline final OPTION_TAGS:Int = 2;
+    public static inline final OPTION_NODE:Int = 4;
+    public static inline final OPTION_INSERTION:Int = 8;
+
+}
+
+@:allow(loreline.SaveBinary)
+@:access(loreline.Interpreter)
+@:access(loreline.Interpreter.ChoiceOption)
+private class SaveBinaryWriter {
+
+    final buffer:BytesBuffer = new BytesBuffer();
+
+    final strings:Map<String, Int> = new Map();
+
+    var numStrings:Int = 0;
+
+    function new() {}
+
+    function getBytes():Bytes {
+        return buffer.getBytes();
+    }
+
+    function writeHeader():Void {
+
+        buffer.addByte(Flags.MAGIC_0);
+        buffer.addByte(Flags.MAGIC_1);
+        buffer.addByte(Flags.MAGIC_2);
+        buffer.addByte(Flags.MAGIC_3);
+        buffer.addByte(SaveBinary.FORMAT_VERSION);
+
+    }
+
+    function writeSaveData(saveData:SaveData):Void {
+
+        writeHeader();
+
+        writeVarInt(saveData.version);
+
+        var flags = 0;
+        if (saveData.insertions != null) flags |= Flags.SAVE_INSERTIONS;
+        if (saveData.pendingChoiceOptions != null) flags |= Flags.SAVE_PENDING_OPTIONS;
+        if (saveData.choiceEvalContext != null) flags |= Flags.SAVE_CHOICE_CONTEXT;
+        if (saveData.token != null) flags |= Flags.SAVE_TOKEN;
+        writeVarInt(flags);
+
+        writeScopes(saveData.stack);
+        writeFields(saveData.state);
+
+        final characterNames = Reflect.fields(saveData.characters);
+        writeVarInt(characterNames.length);
+        for (name in characterNames) {
+            writeString(name);
+            writeFields(Reflect.field(saveData.characters, name));
+        }
+
+        final nodeIds = Reflect.fields(saveData.nodeStates);
+        writeVarInt(nodeIds.length);
+        for (id in nodeIds) {
+            writeNodeId(NodeId.fromString(id));
+            writeFields(Reflect.field(saveData.nodeStates, id));
+        }
+
+        if (saveData.insertions != null) {
+            final keys = Reflect.fields(saveData.insertions);
+            writeVarInt(keys.length);
+            for (key in keys) {
+                writeVarInt(Std.parseInt(key));
+                writeInsertion(Reflect.field(saveData.insertions, key));
+            }
+        }
+
+        if (saveData.pendingChoiceOptions != null) {
+            writeChoiceOptions(saveData.pendingChoiceOptions);
+        }
+
+        if (saveData.choiceEvalContext != null) {
+            writeChoiceOptions(saveData.choiceEvalContext);
+        }
+
+        if (saveData.token != null) {
+            writeVarInt(saveData.token);
+        }
+
+    }
+
+    /**
+     * Writes the same data as `writeSaveData(interpreter.save())`, straight from
+     * the interpreter. States that didn't change since the last checkpoint are
+     * written from the fields serialized at that checkpoint.
+     */
+    function writeInterpreter(interpreter:Interpreter):Void {
+
+        // Insertions are written after everything they are referenced from,
+        // but the header tells whether there are any
+        final insertions = collectInsertions(interpreter);
+
+        writeHeader();
+
+        writeVarInt(1);
+
+        var flags = 0;
+        if (insertions.length > 0) flags |= Flags.SAVE_INSERTIONS;
+        if (interpreter.pendingChoiceOptions != null) flags |= Flags.SAVE_PENDING_OPTIONS;
+        if (interpreter._choiceEvalTexts.length > 0) flags |= Flags.SAVE_CHOICE_CONTEXT;
+        if (interpreter.checkpointing) flags |= Flags.SAVE_TOKEN;
+        writeVarInt(flags);
+
+        final stack = interpreter.stack;
+        writeVarInt(stack.length);
+        for (scope in stack) {
+            writeRuntimeScope(interpreter, scope);
+        }
+
+        writeFields(checkpointFields(interpreter, interpreter.topLevelState));
+
+        // Characters and node states without any saved field are left out
+        final characterNames:Array<String> = [];
+        final characterFields:Array<SaveDataFields> = [];
+        for (name => character in interpreter.topLevelCharacters) {
+            final fields = checkpointFields(interpreter, character);
+            if (Reflect.fields(fields.fields).length > 0) {
+                characterNames.push(name);
+                characterFields.push(fields);
+            }
+        }
+        writeVarInt(characterNames.length);
+        for (i in 0...characterNames.length) {
+            writeString(characterNames[i]);
+            writeFields(characterFields[i]);
+        }
+
+        final nodeIds:Array<NodeId> = [];
+        final nodeFields:Array<SaveDataFields> = [];
+        for (id => state in interpreter.nodeStates) {
+            final fields = checkpointFields(interpreter, state);
+            if (Reflect.fields(fields.fields).length > 0) {
+                nodeIds.push(id);
+                nodeFields.push(fields);
+            }
+        }
+        writeVarInt(nodeIds.length);
+        for (i in 0...nodeIds.length) {
+            writeNodeId(nodeIds[i]);
+            writeFields(nodeFields[i]);
+        }
+
+        if (insertions.length > 0) {
+            writeVarInt(insertions.length);
+            for (insertion in insertions) {
+                writeVarInt(insertion.id);
+                writeRuntimeInsertion(interpreter, insertion);
+            }
+        }
+
+        if (interpreter.pendingChoiceOptions != null) {
+            writeRuntimeChoiceOptions(interpreter.pendingChoiceOptions);
+        }
+
+        final choiceEvalTexts = interpreter._choiceEvalTexts;
+        if (choiceEvalTexts.length > 0) {
+            writeVarInt(choiceEvalTexts.length);
+            for (i in 0...choiceEvalTexts.length) {
+                writeVarInt(interpreter._choiceEvalEnabled[i] ? 0 : Flags.OPTION_DISABLED);
+                writeString(choiceEvalTexts[i]);
+            }
+        }
+
+        if (interpreter.checkpointing) {
+            writeVarInt(++interpreter.saveToken);
+        }
+
+    }
+
+    /**
+     * Returns the serialized fields of a state and makes them its new checkpoint.
+     * A state that didn't change since the last checkpoint isn't serialized again.
+     */
+    function checkpointFields(interpreter:Interpreter, state:RuntimeState):SaveDataFields {
+
+        if (!state.dirty && state.savedFields != null) {
+            final result:SaveDataFields = {
+                fields: state.savedFields
+            };
+            final type = interpreter.serializedFieldsType(state.fields);
+            if (type != null) {
+                result.type = type;
+            }
+            return result;
+        }
+
+        return interpreter.checkpointState(state, interpreter.serializeState(state));
+
+    }
+
+    /**
+     * Lists the insertions referenced by the stack and the pending choice options
+     * of the interpreter, directly or through other insertions.
+     */
+    function collectInsertions(interpreter:Interpreter):Array<RuntimeInsertion> {
+
+        final result:Array<RuntimeInsertion> = [];
+        final seen = new Map<Int, Bool>();
+
+        for (scope in interpreter.stack) {
+            collectInsertion(scope.insertion, result, seen);
+        }
+
+        if (interpreter.pendingChoiceOptions != null) {
+            for (option in interpreter.pendingChoiceOptions) {
+                collectInsertion(option.insertion, result, seen);
+            }
+        }
+
+        return result;
+
+    }
+
+    function collectInsertion(insertion:RuntimeInsertion, result:Array<RuntimeInsertion>, seen:Map<Int, Bool>):Void {
+
+        if (insertion == null || seen.exists(insertion.id)) return;
+        seen.set(insertion.id, true);
+        result.push(insertion);
+
+        if (insertion.options != null) {
+            for (option in insertion.options) {
+                collectInsertion(option.insertion, result, seen);
+            }
+        }
+
+        if (insertion.stack != null) {
+            for (scope in insertion.stack) {
+                collectInsertion(scope.insertion, result, seen);
+            }
+        }
+
+        if (insertion.parentPartialOptions != null) {
+            for (option in insertion.parentPartialOptions) {
+                collectInsertion(option.insertion, result, seen);
+            }
+        }
+
+    }
+
+    function writeRuntimeScope(interpreter:Interpreter, scope:RuntimeScope):Void {
+
+        var flags = 0;
+        if (scope.beat != null) flags |= Flags.SCOPE_BEAT;
+        if (scope.node != null) flags |= Flags.SCOPE_NODE;
+        if (scope.state != null) flags |= Flags.SCOPE_STATE;
+        if (scope.beats != null) flags |= Flags.SCOPE_BEATS;
+        if (scope.head != null) flags |= Flags.SCOPE_HEAD;
+        if (scope.insertion != null) flags |= Flags.SCOPE_INSERTION;
+
+        writeVarInt(scope.id);
+        writeVarInt(flags);
+
+        if (scope.beat != null) writeBeatReference(interpreter, scope.beat);
+        if (scope.node != null) writeNodeReference(scope.node);
+        if (scope.state != null) writeFields(interpreter.serializeState(scope.state));
+        if (scope.beats != null) {
+            writeVarInt(scope.beats.length);
+            for (beat in scope.beats) {
+                writeBeatReference(interpreter, beat);
+            }
+        }
+        if (scope.head != null) writeNodeReference(scope.head);
+        if (scope.insertion != null) writeVarInt(scope.insertion.id);
+
+    }
+
+    function writeRuntimeInsertion(interpreter:Interpreter, insertion:RuntimeInsertion):Void {
+
+        var flags = 0;
+        if (insertion.origin != null) flags |= Flags.INSERTION_ORIGIN;
+        if (insertion.options != null) flags |= Flags.INSERTION_OPTIONS;
+        if (insertion.stack != null) flags |= Flags.INSERTION_STACK;
+        if (insertion.parentPartialOptions != null) flags |= Flags.INSERTION_PARTIAL | Flags.INSERTION_NEXT_INDEX;
+        writeVarInt(flags);
+
+        if (insertion.origin != null) writeNodeReference(insertion.origin);
+        if (insertion.options != null) writeRuntimeChoiceOptions(insertion.options);
+        if (insertion.stack != null) {
+            writeVarInt(insertion.stack.length);
+            for (scope in insertion.stack) {
+                writeRuntimeScope(interpreter, scope);
+            }
+        }
+        if (insertion.parentPartialOptions != null) {
+            writeRuntimeChoiceOptions(insertion.parentPartialOptions);
+            writeVarInt(insertion.parentNextOptionIndex);
+        }
+
+    }
+
+    function writeRuntimeChoiceOptions(options:Array<ChoiceOption>):Void {
+
+        writeVarInt(options.length);
+        for (option in options) {
+            var flags = 0;
+            if (!option.enabled) flags |= Flags.OPTION_DISABLED;
+            if (option.tags != null) flags |= Flags.OPTION_TAGS;
+            if (option.node != null) flags |= Flags.OPTION_NODE;
+            if (option.insertion != null) flags |= Flags.OPTION_INSERTION;
+            writeVarInt(flags);
+
+            writeString(option.text);
+
+            if (option.tags != null) {
+                writeVarInt(option.tags.length);
+                for (tag in option.tags) {
+                    writeString(tag.value);
+                    writeVarInt(tag.offset);
+                    buffer.addByte(tag.closing ? 1 : 0);
+                }
+            }
+            if (option.node != null) writeNodeReference(option.node);
+            if (option.insertion != null) writeVarInt(option.insertion.id);
+        }
+
+    }
+
+    function writeBeatReference(interpreter:Interpreter, beat:NBeatDecl):Void {
+
+        writeNodeId(beat.id);
+        writeString(interpreter.beatPath(beat));
+
+    }
+
+    function writeNodeReference(node:AstNode):Void {
+
+        writeNodeId(node.id);
+        writeString(node.type());
+
+    }
+
+    function writeScopes(scopes:Array<SaveDataScope>):Void {
+
+        writeVarInt(scopes.length);
+        for (scope in scopes) {
+            writeScope(scope);
+        }
+
+    }
+
+    function writeScope(scope:SaveDataScope):Void {
+
+        var flags = 0;
+        if (scope.beat != null) flags |= Flags.SCOPE_BEAT;
+        if (scope.node != null) flags |= Flags.SCOPE_NODE;
+        if (scope.state != null) flags |= Flags.SCOPE_STATE;
+        if (scope.beats != null) flags |= Flags.SCOPE_BEATS;
+        if (scope.head != null) flags |= Flags.SCOPE_HEAD;
+        if (scope.insertion != null) flags |= Flags.SCOPE_INSERTION;
+
+        writeVarInt(scope.id);
+        writeVarInt(flags);
+
+        if (scope.beat != null) writeBeat(scope.beat);
+        if (scope.node != null) writeNode(scope.node);
+        if (scope.state != null) writeFields(scope.state);
+        if (scope.beats != null) {
+            writeVarInt(scope.beats.length);
+            for (beat in scope.beats) {
+                writeBeat(beat);
+            }
+        }
+        if (scope.head != null) writeNode(scope.head);
+        if (scope.insertion != null) writeVarInt(scope.insertion);
+
+    }
+
+    function writeInsertion(insertion:SaveDataInsertion):Void {
+
+        var flags = 0;
+        if (insertion.origin != null) flags |= Flags.INSERTION_ORIGIN;
+        if (insertion.options != null) flags |= Flags.INSERTION_OPTIONS;
+        if (insertion.stack != null) flags |= Flags.INSERTION_STACK;
+        if (insertion.parentPartialOptions != null) flags |= Flags.INSERTION_PARTIAL;
+        if (insertion.parentNextOptionIndex != null) flags |= Flags.INSERTION_NEXT_INDEX;
+        writeVarInt(flags);
+
+        if (insertion.origin != null) writeNode(insertion.origin);
+        if (insertion.options != null) writeChoiceOptions(insertion.options);
+        if (insertion.stack != null) writeScopes(insertion.stack);
+        if (insertion.parentPartialOptions != null) writeChoiceOptions(insertion.parentPartialOptions);
+        if (insertion.parentNextOptionIndex != null) writeVarInt(insertion.parentNextOptionIndex);
+
+    }
+
+    function writeChoiceOptions(options:Array<SaveDataChoiceOption>):Void {
+
+        writeVarInt(options.length);
+        for (option in options) {
+            writeChoiceOption(option);
+        }
+
+    }
+
+    function writeChoiceOption(option:SaveDataChoiceOption):Void {
+
+        var flags = 0;
+        if (option.disabled == true) flags |= Flags.OPTION_DISABLED;
+        if (option.tags != null) flags |= Flags.OPTION_TAGS;
+        if (option.node != null) flags |= Flags.OPTION_NODE;
+        if (option.insertion != null) flags |= Flags.OPTION_INSERTION;
+        writeVarInt(flags);
+
+        writeString(option.text);
+
+        if (option.tags != null) {
+            writeVarInt(option.tags.length);
+            for (tag in option.tags) {
+                writeString(tag.value);
+                writeVarInt(tag.offset);
+                buffer.addByte(tag.closing == true ? 1 : 0);
+            }
+        }
+        if (option.node != null) writeNode(option.node);
+        if (option.insertion != null) writeVarInt(option.insertion);
+
+    }
+
+    function writeBeat(beat:SaveDataBeat):Void {
+
+        writeNodeId(NodeId.fromString(beat.id));
+        writeString(beat.path);
+
+    }
+
+    function writeNode(node:SaveDataNode):Void {
+
+        writeNodeId(NodeId.fromString(node.id));
+        writeString(node.type);
+
+    }
+
+    function writeNodeId(id:NodeId):Void {
+
+        writeVarInt(id.section);
+        writeVarInt(id.branch);
+        writeVarInt(id.block);
+        writeVarInt(id.node);
+
+    }
+
+    function writeFields(fields:SaveDataFields):Void {
+
+        writeString(fields.type);
+
+        final data:Dynamic = fields.fields;
+        final keys = data != null ? Reflect.fields(data) : [];
+        writeVarInt(keys.length);
+        for (key in keys) {
+            writeString(key);
+            writeValue(Reflect.field(data, key));
+        }
+
+    }
+
+    function writeValue(value:Any):Void {
+
+        if (value == null) {
+            buffer.addByte(ValueKind.NULL);
+        }
+        else if (Std.isOfType(value, Bool)) {
+            buffer.addByte((value:Bool) ? ValueKind.TRUE : ValueKind.FALSE);
+        }
+        else if (Std.isOfType(value, String)) {
+            buffer.addByte(ValueKind.STRING);
+            writeString(value);
+        }
+        else if (Std.isOfType(value, Int)) {
+            buffer.addByte(ValueKind.INT);
+            writeZigZag(value);
+        }
+        else if (Std.isOfType(value, Float)) {
+            buffer.addByte(ValueKind.FLOAT);
+            buffer.addDouble(value);
+        }
+        else if (value is Array) {
+            final array:Array<Any> = value;
+            buffer.addByte(ValueKind.ARRAY);
+            writeVarInt(array.length);
+            for (item in array) {
+                writeValue(item);
+            }
+        }
+        else {
+            buffer.addByte(ValueKind.FIELDS);
+            writeFields(value);
+        }
+
+    }
+
+    /**
+     * Writes an interned (and nullable) string: 0 for null,
+     * 1 followed by the string the first time it is seen,
+     * then 2 + index of the string for subsequent occurrences.
+     */
+    function writeString(str:String):Void {
+
+        if (str == null) {
+            writeVarInt(0);
+            return;
+        }
+
+        final index = strings.get(str);
+        if (index != null) {
+            writeVarInt(index + 2);
+            return;
+        }
+
+        strings.set(str, numStrings++);
+        final bytes = Bytes.ofString(str, Encoding.UTF8);
+        writeVarInt(1);
+        writeVarInt(bytes.length);
+        buffer.add(bytes);
+
+    }
+
+    function writeZigZag(value:Int):Void {
+
+        writeVarInt((value << 1) ^ (value >> 31));
+
+    }
+
+    function writeVarInt(value:Int):Void {
+
+        // Treated as unsigned 32-bit
+        while ((value & ~0x7F) != 0) {
+            buffer.addByte((value & 0x7F) | 0x80);
+            value = value >>> 7;
+        }
+        buffer.addByte(value);
+
+    }
+
+}
+
+@:allow(loreline.SaveBinary)
+@:access(loreline.Interpreter)
+@:access(loreline.Interpreter.ChoiceOption)
+private class SaveBinaryReader {
+
+    final bytes:Bytes;
+
+    var pos:Int = 0;
+
+    final strings:Array<String> = [];
+
+    /**
+     * The interpreter being restored by `restoreInterpreter()`.
+     */
+    var interpreter:Interpreter = null;
+
+    /**
+     * Insertions read by `restoreInterpreter()`, created on their first reference.
+     */
+    var insertions:Map<Int, RuntimeInsertion> = null;
+
+    /**
+     * Beat of the last scope read by `readRuntimeScope()`, null if not found.
+     */
+    var lastScopeBeat:NBeatDecl = null;
+
+    function new(bytes:Bytes) {
+        this.bytes = bytes;
+    }
+
+    function readHeader():Void {
+
+        pos = 4;
+        final formatVersion = readByte();
+        if (formatVersion != SaveBinary.FORMAT_VERSION) {
+            throw new Error("Unsupported binary save format: " + formatVersion);
+        }
+
+    }
+
+    function readSaveData():SaveData {
+
+        readHeader();
+
+        final version = readVarInt();
+        final flags = readVarInt();
+
+        final stack = readScopes();
+        final state = readFields();
+
+        final characters:Dynamic<SaveDataFields> = {};
+        for (_ in 0...readVarInt()) {
+            final name = readString();
+            Reflect.setField(characters, name, readFields());
+        }
+
+        final nodeStates:Dynamic<SaveDataFields> = {};
+        for (_ in 0...readVarInt()) {
+            final id = readNodeId();
+            Reflect.setField(nodeStates, id.toString(), readFields());
+        }
+
+        final result:SaveData = {
+            version: version,
+            stack: stack,
+            state: state,
+            characters: characters,
+            nodeStates: nodeStates
+        };
+
+        if (flags & Flags.SAVE_INSERTIONS != 0) {
+            final insertions:Dynamic<SaveDataInsertion> = {};
+            for (_ in 0...readVarInt()) {
+                final key = readVarInt();
+                Reflect.setField(insertions, Std.string(key), readInsertion());
+            }
+            result.insertions = insertions;
+        }
+
+        if (flags & Flags.SAVE_PENDING_OPTIONS != 0) {
+            result.pendingChoiceOptions = readChoiceOptions();
+        }
+
+        if (flags & Flags.SAVE_CHOICE_CONTEXT != 0) {
+            result.choiceEvalContext = readChoiceOptions();
+        }
+
+        if (flags & Flags.SAVE_TOKEN != 0) {
+            result.token = readVarInt();
+        }
+
+        return result;
+
+    }
+
+    /**
+     * Restores the interpreter with the same result as `interpreter.restore(readSaveData())`.
+     * Everything is read into new runtime objects first, then applied to the interpreter.
+     */
+    function restoreInterpreter(interpreter:Interpreter):Void {
+
+        this.interpreter = interpreter;
+        this.insertions = new Map();
+
+        readHeader();
+
+        final version = readVarInt();
+        if (version != 1) {
+            throw new RuntimeError("Unsupported save version: " + version, interpreter.script.pos);
+        }
+
+        final flags = readVarInt();
+
+        // Scope stack: if any scope can't be resolved in the current script,
+        // execution resumes from the top level beat of the first one instead
+        final scopes:Array<RuntimeScope> = [];
+        var stackRestored = true;
+        var firstBeat:NBeatDecl = null;
+        for (i in 0...readVarInt()) {
+            final scope = readRuntimeScope();
+            if (i == 0) firstBeat = lastScopeBeat;
+            if (scope != null) {
+                scopes.push(scope);
+            }
+            else {
+                stackRestored = false;
+            }
+        }
+
+        final state = readFields();
+
+        final characterNames:Array<String> = [];
+        final characterFields:Array<SaveDataFields> = [];
+        for (_ in 0...readVarInt()) {
+            characterNames.push(readString());
+            characterFields.push(readFields());
+        }
+
+        final nodeIds:Array<NodeId> = [];
+        final nodeFields:Array<SaveDataFields> = [];
+        for (_ in 0...readVarInt()) {
+            nodeIds.push(readNodeId());
+            nodeFields.push(readFields());
+        }
+
+        final defined = new Map<Int, Bool>();
+        if (flags & Flags.SAVE_INSERTIONS != 0) {
+            for (_ in 0...readVarInt()) {
+                final id = readVarInt();
+                readRuntimeInsertion(insertionById(id));
+                defined.set(id, true);
+            }
+        }
+        for (id in insertions.keys()) {
+            if (!defined.exists(id)) {
+                throw new Error("Invalid insertion reference in binary save data");
+            }
+        }
+
+        final pendingChoiceOptions = flags & Flags.SAVE_PENDING_OPTIONS != 0 ? readRuntimeChoiceOptions() : null;
+        final choiceEvalContext = flags & Flags.SAVE_CHOICE_CONTEXT != 0 ? readRuntimeChoiceOptions() : null;
+        final token = flags & Flags.SAVE_TOKEN != 0 ? readVarInt() : 0;
+
+        // Everything is read, apply it the same way as `restore()` does
+
+        // Restored save data becomes the latest checkpoint
+        interpreter.saveToken = token;
+        interpreter.resetCheckpoint(interpreter.topLevelState);
+        for (character in interpreter.topLevelCharacters) {
+            interpreter.resetCheckpoint(character);
+        }
+
+        // Clear current state
+        interpreter.stack.resize(0);
+        interpreter.nodeStates.clear();
+        interpreter.nextScopeId = 1;
+        interpreter.nextInsertionId = 1;
+        interpreter.pendingChoiceOptions = null;
+        interpreter._choiceEvalTexts.resize(0);
+        interpreter._choiceEvalEnabled.resize(0);
+
+        interpreter.restoreState(interpreter.topLevelState, state);
+        interpreter.topLevelState.savedFields = state.fields;
+
+        for (i in 0...characterNames.length) {
+            final name = characterNames[i];
+            final fields = characterFields[i];
+            if (interpreter.topLevelCharacters.exists(name)) {
+                interpreter.restoreCharacter(interpreter.topLevelCharacters.get(name), fields).savedFields = fields.fields;
+            }
+            else {
+                final newCharacter = interpreter.restoreCharacter(null, fields);
+                newCharacter.savedFields = fields.fields;
+                interpreter.addTopLevelCharacter(name, newCharacter);
+            }
+        }
+
+        for (i in 0...nodeIds.length) {
+            final nodeState = interpreter.restoreState(null, nodeFields[i]);
+            nodeState.savedFields = nodeFields[i].fields;
+            interpreter.nodeStates.set(nodeIds[i], nodeState);
+        }
+
+        for (id in insertions.keys()) {
+            if (id >= interpreter.nextInsertionId) {
+                interpreter.nextInsertionId = id + 1;
+            }
+        }
+
+        if (stackRestored) {
+            for (scope in scopes) {
+                interpreter.push(scope);
+            }
+        }
+        else {
+            interpreter.beatToResume = interpreter.topLevelBeatOf(firstBeat);
+        }
+
+        interpreter.pendingChoiceOptions = pendingChoiceOptions;
+
+        if (choiceEvalContext != null) {
+            for (option in choiceEvalContext) {
+                interpreter._choiceEvalTexts.push(option.text);
+                interpreter._choiceEvalEnabled.push(option.enabled);
+            }
+        }
+
+    }
+
+    function insertionById(id:Int):RuntimeInsertion {
+
+        var insertion = insertions.get(id);
+        if (insertion == null) {
+            insertion = new RuntimeInsertion(id, null);
+            insertions.set(id, insertion);
+        }
+        return insertion;
+
+    }
+
+    /**
+     * Reads a scope into a new runtime scope, or returns null if its beat or nodes
+     * can't be resolved in the current script. The scope is read entirely either way.
+     */
+    function readRuntimeScope():RuntimeScope {
+
+        readVarInt(); // The scope id, given again by push()
+        final flags = readVarInt();
+
+        var resolved = true;
+
+        var beat:NBeatDecl = null;
+        var savedBeatId:NodeId = NodeId.UNDEFINED;
+        if (flags & Flags.SCOPE_BEAT != 0) {
+            savedBeatId = readNodeId();
+            beat = findBeat(readString());
+        }
+        lastScopeBeat = beat;
+        if (beat == null) resolved = false;
+
+        var node:AstNode = null;
+        if (flags & Flags.SCOPE_NODE != 0) {
+            final nodeId = readNodeId();
+            final type = readString();
+            if (resolved) {
+                node = interpreter.restoreNodeById(nodeId, type, savedBeatId, beat);
+                if (node == null) resolved = false;
+            }
+        }
+
+        var state:RuntimeState = null;
+        if (flags & Flags.SCOPE_STATE != 0) {
+            final fields = readFields();
+            state = interpreter.restoreState(null, fields);
+        }
+
+        final beats:Array<NBeatDecl> = [];
+        if (flags & Flags.SCOPE_BEATS != 0) {
+            for (_ in 0...readVarInt()) {
+                readNodeId();
+                final beatInScope = findBeat(readString());
+                if (beatInScope != null) {
+                    beats.push(beatInScope);
+                }
+                else {
+                    resolved = false;
+                }
+            }
+        }
+
+        var head:AstNode = null;
+        if (flags & Flags.SCOPE_HEAD != 0) {
+            final nodeId = readNodeId();
+            final type = readString();
+            if (resolved) {
+                head = interpreter.restoreNodeById(nodeId, type, savedBeatId, beat);
+                if (head == null) resolved = false;
+            }
+        }
+
+        var insertion:RuntimeInsertion = null;
+        if (flags & Flags.SCOPE_INSERTION != 0) {
+            insertion = insertionById(readVarInt());
+        }
+
+        if (!resolved) return null;
+
+        return ({
+            beat: beat,
+            node: node,
+            state: state,
+            beats: beats,
+            head: head,
+            insertion: insertion
+        } : RuntimeScope);
+
+    }
+
+    function readRuntimeInsertion(insertion:RuntimeInsertion):Void {
+
+        final flags = readVarInt();
+
+        if (flags & Flags.INSERTION_ORIGIN != 0) {
+            final nodeId = readNodeId();
+            final type = readString();
+            final node = interpreter.lens.getNodeById(nodeId);
+            if (node != null && node.type() == type) {
+                insertion.origin = cast node;
+            }
+        }
+        if (flags & Flags.INSERTION_OPTIONS != 0) {
+            insertion.options = readRuntimeChoiceOptions();
+        }
+        if (flags & Flags.INSERTION_STACK != 0) {
+            // Scopes of an insertion are not pushed, and the ones that can't be resolved are skipped
+            insertion.stack = [];
+            for (_ in 0...readVarInt()) {
+                final scope = readRuntimeScope();
+                if (scope != null) insertion.stack.push(scope);
+            }
+        }
+        if (flags & Flags.INSERTION_PARTIAL != 0) {
+            insertion.parentPartialOptions = readRuntimeChoiceOptions();
+        }
+        if (flags & Flags.INSERTION_NEXT_INDEX != 0) {
+            insertion.parentNextOptionIndex = readVarInt();
+        }
+
+    }
+
+    function readRuntimeChoiceOptions():Array<ChoiceOption> {
+
+        final result:Array<ChoiceOption> = [];
+
+        for (_ in 0...readVarInt()) {
+            final flags = readVarInt();
+            final text = readString();
+
+            var tags:Array<TextTag> = null;
+            if (flags & Flags.OPTION_TAGS != 0) {
+                tags = [];
+                for (_ in 0...readVarInt()) {
+                    final value = readString();
+                    final offset = readVarInt();
+                    final closing = readByte() != 0;
+                    tags.push(({
+                        closing: closing,
+                        value: value,
+                        offset: offset
+                    } : TextTag));
+                }
+            }
+
+            var node:NChoiceOption = null;
+            if (flags & Flags.OPTION_NODE != 0) {
+                final nodeId = readNodeId();
+                final type = readString();
+                final astNode = interpreter.lens.getNodeById(nodeId);
+                if (astNode != null && astNode.type() == type) {
+                    node = cast astNode;
+                }
+            }
+
+            var insertion:RuntimeInsertion = null;
+            if (flags & Flags.OPTION_INSERTION != 0) {
+                insertion = insertionById(readVarInt());
+            }
+
+            result.push(({
+                text: text,
+                tags: tags,
+                enabled: flags & Flags.OPTION_DISABLED == 0,
+                node: node,
+                insertion: insertion
+            } : ChoiceOption));
+        }
+
+        return result;
+
+    }
+
+    function findBeat(path:String):NBeatDecl {
+
+        return path != null ? interpreter.lens.findBeatByPathFromNode(path, interpreter.script) : null;
+
+    }
+
+    function readScopes():Array<SaveDataScope> {
+
+        return [for (_ in 0...readVarInt()) readScope()];
+
+    }
+
+    function readScope():SaveDataScope {
+
+        final id = readVarInt();
+        final flags = readVarInt();
+
+        final scope:SaveDataScope = {
+            id: id
+        };
+
+        if (flags & Flags.SCOPE_BEAT != 0) scope.beat = readBeat();
+        if (flags & Flags.SCOPE_NODE != 0) scope.node = readNode();
+        if (flags & Flags.SCOPE_STATE != 0) scope.state = readFields();
+        if (flags & Flags.SCOPE_BEATS != 0) {
+            scope.beats = [for (_ in 0...readVarInt()) readBeat()];
+        }
+        if (flags & Flags.SCOPE_HEAD != 0) scope.head = readNode();
+        if (flags & Flags.SCOPE_INSERTION != 0) scope.insertion = readVarInt();
+
+        return scope;
+
+    }
+
+    function readInsertion():SaveDataInsertion {
+
+        final flags = readVarInt();
+        final insertion:SaveDataInsertion = {};
+
+        if (flags & Flags.INSERTION_ORIGIN != 0) insertion.origin = readNode();
+        if (flags & Flags.INSERTION_OPTIONS != 0) insertion.options = readChoiceOptions();
+        if (flags & Flags.INSERTION_STACK != 0) insertion.stack = readScopes();
+        if (flags & Flags.INSERTION_PARTIAL != 0) insertion.parentPartialOptions = readChoiceOptions();
+        if (flags & Flags.INSERTION_NEXT_INDEX != 0) insertion.parentNextOptionIndex = readVarInt();
+
+        return insertion;
+
+    }
+
+    function readChoiceOptions():Array<SaveDataChoiceOption> {
+
+        return [for (_ in 0...readVarInt()) readChoiceOption()];
+
+    }
+
+    function readChoiceOption():SaveDataChoiceOption {
+
+        final flags = readVarInt();
+
+        final option:SaveDataChoiceOption = {
+            text: readString()
+        };
+
+        if (flags & Flags.OPTION_DISABLED != 0) option.disabled = true;
+        if (flags & Flags.OPTION_TAGS != 0) {
+            option.tags = [for (_ in 0...readVarInt()) {
+                final value = readString();
+                final offset = readVarInt();
+                final tag:SaveDataTextTag = {
+                    value: value,
+                    offset: offset
+                };
+                if (readByte() != 0) tag.closing = true;
+                tag;
+            }];
+        }
+        if (flags & Flags.OPTION_NODE != 0) option.node = readNode();
+        if (flags & Flags.OPTION_INSERTION != 0) option.insertion = readVarInt();
+
+        return option;
+
+    }
+
+    function readBeat():SaveDataBeat {
+
+        final id = readNodeId();
+        return {
+            id: id.toString(),
+            path: readString()
+        };
+
+    }
+
+    function readNode():SaveDataNode {
+
+        final id = readNodeId();
+        return {
+            id: id.toString(),
+            type: readString()
+        };
+
+    }
+
+    function readNodeId():NodeId {
+
+        final section = readVarInt();
+        final branch = readVarInt();
+        final block = readVarInt();
+        final node = readVarInt();
+        return new NodeId(section, branch, block, node);
+
+    }
+
+    function readFields():SaveDataFields {
+
+        final type = readString();
+        final fields:Dynamic = {};
+        for (_ in 0...readVarInt()) {
+            final key = readString();
+            Reflect.setField(fields, key, readValue());
+        }
+
+        return type != null ? {
+            type: type,
+            fields: fields
+        } : {
+            fields: fields
+        };
+
+    }
+
+    function readValue():Any {
+
+        final kind:ValueKind = readByte();
+        return switch kind {
+            case NULL: null;
+            case FALSE: false;
+            case TRUE: true;
+            case INT: readZigZag();
+            case FLOAT:
+                if (pos + 8 > bytes.length) {
+                    throw new Error("Truncated binary save data");
+                }
+                final value = bytes.getDouble(pos);
+                pos += 8;
+                value;
+            case STRING: readString();
+            case ARRAY:
+                final array:Array<Any> = [];
+                for (_ in 0...readVarInt()) {
+                    array.push(readValue());
+                }
+                array;
+            case FIELDS: readFields();
+            case _:
+                throw new Error("Invalid value kind in binary save data: " + (kind:Int));
+        }
+
+    }
+
+    function readString():String {
+
+        final ref = readVarInt();
+        if (ref == 0) return null;
+        if (ref >= 2) {
+            final index = ref - 2;
+            if (index >= strings.length) {
+                throw new Error("Invalid string reference in binary save data");
+            }
+            return strings[index];
+        }
+
+        final length = readVarInt();
+        if (pos + length > bytes.length) {
+            throw new Error("Truncated binary save data");
+        }
+        final str = bytes.getString(pos, length, Encoding.UTF8);
+        pos += length;
+        strings.push(str);
+        return str;
+
+    }
+
+    function readZigZag():Int {
+
+        final value = readVarInt();
+        return (value >>> 1) ^ -(value & 1);
+
+    }
+
+    function readVarInt():Int {
+
+        var result = 0;
+        var shift = 0;
+        while (true) {
+            final byte = readByte();
+            result |= (byte & 0x7F) << shift;
+            if (byte & 0x80 == 0) break;
+            shift += 7;
+            if (shift > 28) {
+                throw new Error("Invalid varint in binary save data");
+            }
+        }
+        return result;
+
+    }
+
+    inline function readByte():Int {
+
+        if (pos >= bytes.length) {
+            throw new Error("Truncated binary save data");
+        }
+        return bytes.get(pos++);
+
+    }
+
+}
@@ -124,4 +124,44 @@ typedef SaveData = {
     var ?pendingChoiceOptions:Array<SaveDataChoiceOption>;
     /** Choice evaluation context when save happened inside a choice option body */
     var ?choiceEvalContext:Array<SaveDataChoiceOption>;
+    /** Token of the save checkpoint, used as base for `saveDelta()` */
+    var ?token:Int;
+}
+
+/**
+ * Changes of a fields object since the previous save checkpoint
+ */
+typedef SaveDataFieldsDelta = {
+    /** Optional type information for special cases */
+    var ?type:String;
+    /** Field values that changed or were added */
+    var fields:Any;
+    /** Names of fields that are no longer saved (back to their original value) */
+    var ?removed:Array<String>;
+}
+
+/**
+ * Incremental save data: what changed since a previous save checkpoint
+ */
+typedef SaveDataDelta = {
+    /** Save data format version */
+    var version:Int;
+    /** Token of the checkpoint this delta applies onto */
+    var since:Int;
+    /** Token of the checkpoint created by this delta */
+    var token:Int;
+    /** Current execution stack (always complete) */
+    var stack:Array<SaveDataScope>;
+    /** Changes of the top level state, if any */
+    var ?state:SaveDataFieldsDelta;
+    /** Changes of character states keyed by name */
+    var characters:Dynamic<SaveDataFieldsDelta>;
+    /** Changes of node states keyed by ID */
+    var nodeStates:Dynamic<SaveDataFieldsDelta>;
+    /** Insertions keyed by ID */
+    var ?insertions:Dynamic<SaveDataInsertion>;
+    /** Pending choice options when save happened at a choice with insertions */
+    var ?pendingChoiceOptions:Array<SaveDataChoiceOption>;
+    /** Choice evaluation context when save happened inside a choice option body */
+    var ?choiceEvalContext:Array<SaveDataChoiceOption>;
 }
@@ -0,0 +1,214 @@
+package loreline;
+
+import loreline.SaveData;
+
+/**
+ * Helpers to compute and apply incremental save data (`SaveDataDelta`).
+ *
+ * A delta only contains the state, character and node state fields that changed
+ * since a previous save checkpoint, plus the complete execution stack. A chain of
+ * deltas, each one created since the previous, can be applied onto the full save
+ * data it started from to obtain an up to date full save data.
+ */
+class SaveDelta {
+
+    /**
+     * Applies a chain of deltas onto a full save data.
+     * The given save data and deltas are not modified.
+     *
+     * @param base The full save data the chain starts from (from `interpreter.save()`)
+     * @param deltas The deltas to apply, in order (from `interpreter.saveDelta()`)
+     * @return The resulting full save data
+     * @throws Error If a delta does not follow the previous checkpoint of the chain
+     */
+    public static function apply(base:SaveData, deltas:Array<SaveDataDelta>):SaveData {
+
+        final characters:Dynamic<SaveDataFields> = copyEntries(base.characters);
+        final nodeStates:Dynamic<SaveDataFields> = copyEntries(base.nodeStates);
+
+        final result:SaveData = {
+            version: base.version,
+            stack: base.stack,
+            state: base.state,
+            characters: characters,
+            nodeStates: nodeStates
+        };
+
+        if (base.insertions != null) result.insertions = base.insertions;
+        if (base.pendingChoiceOptions != null) result.pendingChoiceOptions = base.pendingChoiceOptions;
+        if (base.choiceEvalContext != null) result.choiceEvalContext = base.choiceEvalContext;
+
+        var token:Null<Int> = base.token;
+
+        for (delta in deltas) {
+            if (token == null || delta.since != token) {
+                throw new Error('Save delta does not follow the previous checkpoint (expected since $token, got ${delta.since})');
+            }
+
+            // Execution position is always complete in a delta
+            result.version = delta.version;
+            result.stack = delta.stack;
+            result.insertions = delta.insertions;
+            result.pendingChoiceOptions = delta.pendingChoiceOptions;
+            result.choiceEvalContext = delta.choiceEvalContext;
+
+            if (delta.state != null) {
+                result.state = applyFields(result.state, delta.state);
+            }
+
+            applyEntries(characters, delta.characters);
+            applyEntries(nodeStates, delta.nodeStates);
+
+            token = delta.token;
+        }
+
+        result.token = token;
+
+        return result;
+
+    }
+
+    /**
+     * Computes the changes between two serialized fields objects.
+     *
+     * @param previous The fields at the previous checkpoint, or null if there were none
+     * @param current The current serialized fields
+     * @return The changes, or null if nothing changed
+     */
+    public static function diffFields(previous:Dynamic, current:Dynamic):SaveDataFieldsDelta {
+
+        final changed:Dynamic = {};
+        var hasChanges = false;
+        var removed:Array<String> = null;
+
+        for (key in Reflect.fields(current)) {
+            final value:Any = Reflect.field(current, key);
+            if (previous == null || !Reflect.hasField(previous, key) || !sameValue(Reflect.field(previous, key), value)) {
+                Reflect.setField(changed, key, value);
+                hasChanges = true;
+            }
+        }
+
+        if (previous != null) {
+            for (key in Reflect.fields(previous)) {
+                if (!Reflect.hasField(current, key)) {
+                    if (removed == null) removed = [];
+                    removed.push(key);
+                }
+            }
+        }
+
+        if (!hasChanges && removed == null) {
+            return null;
+        }
+
+        final result:SaveDataFieldsDelta = {
+            fields: changed
+        };
+
+        if (removed != null) {
+            result.removed = removed;
+        }
+
+        return result;
+
+    }
+
+    static function applyFields(base:SaveDataFields, delta:SaveDataFieldsDelta):SaveDataFields {
+
+        final fields:Dynamic = {};
+
+        if (base != null && base.fields != null) {
+            for (key in Reflect.fields(base.fields)) {
+                Reflect.setField(fields, key, Reflect.field(base.fields, key));
+            }
+        }
+
+        if (delta.removed != null) {
+            for (key in delta.removed) {
+                Reflect.deleteField(fields, key);
+            }
+        }
+
+        for (key in Reflect.fields(delta.fields)) {
+            Reflect.setField(fields, key, Reflect.field(delta.fields, key));
+        }
+
+        final type = delta.type ?? base?.type;
+
+        return type != null ? {
+            type: type,
+            fields: fields
+        } : {
+            fields: fields
+        };
+
+    }
+
+    static function applyEntries(entries:Dynamic<SaveDataFields>, deltas:Dynamic<SaveDataFieldsDelta>):Void {
+
+        if (deltas == null) return;
+
+        for (key in Reflect.fields(deltas)) {
+            final applied = applyFields(Reflect.field(entries, key), Reflect.field(deltas, key));
+
+            // Entries without saved fields are omitted, as in full save data
+            if (Reflect.fields(applied.fields).length > 0) {
+                Reflect.setField(entries, key, applied);
+            }
+            else {
+                Reflect.deleteField(entries, key);
+            }
+        }
+
+    }
+
+    static function copyEntries(entries:Dynamic<SaveDataFields>):Dynamic<SaveDataFields> {
+
+        final result:Dynamic<SaveDataFields> = {};
+
+        if (entries != null) {
+            for (key in Reflect.fields(entries)) {
+                Reflect.setField(result, key, Reflect.field(entries, key));
+            }
+        }
+
+        return result;
+
+    }
+
+    /**
+     * Deep equality of serialized values (primitives, arrays and fields objects).
+     */
+    static function sameValue(a:Any, b:Any):Bool {
+
+        if (a == b) return true;
+        if (a == null || b == null) return false;
+
+        if (a is Array) {
+            if (!(b is Array)) return false;
+            final arrA:Array<Any> = a;
+            final arrB:Array<Any> = b;
+            if (arrA.length != arrB.length) return false;
+            for (i in 0...arrA.length) {
+                if (!sameValue(arrA[i], arrB[i])) return false;
+            }
+            return true;
+        }
+
+        if (Reflect.isObject(a) && Reflect.isObject(b) && !(a is String) && !(b is String)) {
+            final keysA = Reflect.fields(a);
+            if (keysA.length != Reflect.fields(b).length) return false;
+            for (key in keysA) {
+                if (!Reflect.hasField(b, key) || !sameValue(Reflect.field(a, key), Reflect.field(b, key))) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        return false;
+
+    }
+
+}
@@ -25,6 +25,12 @@ class Script extends AstNode {
      */
     public var body:Array<AstNode>;
 
+    /**
+     * Data shared by every interpreter running this script, if the script
+     * has been prepared with `PreparedScript.prepare()`.
+     */
+    @:noCompletion public var prepared:PreparedScript = null;
+
     /**
      * Creates a new script root node.
      * @param id The node id of this script
@@ -57,6 +63,24 @@ class Script extends AstNode {
         return JsonToAst.scriptFromJson(json);
     }
 
+    /**
+     * Compiles the script to its compact binary representation.
+     * @return The encoded bytes (see `ScriptBinary`)
+     */
+    public function toBinary():haxe.io.Bytes {
+        return ScriptBinary.encode(this);
+    }
+
+    /**
+     * Loads a Script from its compact binary representation.
+     * The returned script is already prepared for interpreters.
+     * @param bytes The encoded bytes (as returned by script.toBinary())
+     * @return The reconstructed Script
+     */
+    @:keep public static function fromBinary(bytes:haxe.io.Bytes):Script {
+        return ScriptBinary.decode(bytes);
+    }
+
     public override function type():String {
         return "Script";
     }
@@ -0,0 +1,1705 @@
+package loreline;
+
+import haxe.io.Bytes;
+import haxe.io.BytesBuffer;
+import haxe.io.Encoding;
+import loreline.Node;
+import loreline.lorscript.Expr.Argument;
+import loreline.lorscript.Expr.CType;
+import loreline.lorscript.Expr.Const;
+import loreline.lorscript.Expr.ExprDef;
+
+/**
+ * Compact binary encoding of a parsed script, an alternative to the JSON AST.
+ *
+ * Layout: the `LRLS` magic, the binary format version, then a table of node
+ * records ended by an `END` marker and the index of the root script. Records
+ * are written children first, so every node reference (a varint index into the
+ * table, 0 for null) points to a node that has already been read: loading
+ * builds each node directly from its record, in a single pass, without any
+ * intermediate tree. Integers are LEB128 varints (zigzag for signed values),
+ * node ids and source positions are written as their varint components and
+ * strings are interned. Identifier access bindings are stored resolved, so
+ * they are not computed again when the loaded script is prepared.
+ *
+ * The table is followed by the parsed lorscript code of every top level function,
+ * one section per function. Sections are skipped on load and only decoded, then
+ * compiled, when their function is first called: loading doesn't convert or
+ * parse function code. Functions with invalid code have no section and report
+ * their error when an interpreter initializes them, as with parsed scripts.
+ *
+ * Loading a compiled script skips lexing, parsing and JSON decoding, which
+ * makes it the fastest way to ship a story that doesn't change at runtime.
+ */
+class ScriptBinary {
+
+    /**
+     * Version of the binary layout.
+     */
+    public static inline final FORMAT_VERSION:Int = 3;
+
+    /**
+     * Tells whether the given bytes start like a compiled script.
+     *
+     * @param bytes The bytes to check
+     * @return `true` if the bytes have the compiled script header
+     */
+    public static function isBinary(bytes:Bytes):Bool {
+
+        return bytes != null && bytes.length >= 5 &&
+            bytes.get(0) == Flags.MAGIC_0 && bytes.get(1) == Flags.MAGIC_1 &&
+            bytes.get(2) == Flags.MAGIC_2 && bytes.get(3) == Flags.MAGIC_3;
+
+    }
+
+    /**
+     * Encodes a script (and the scripts it imports) to bytes.
+     *
+     * @param script The script to encode
+     * @return The encoded bytes
+     */
+    public static function encode(script:Script):Bytes {
+
+        // Resolves identifier access bindings, stored with their nodes
+        PreparedScript.prepare(script);
+
+        final writer = new ScriptBinaryWriter();
+        writer.writeScript(script);
+        return writer.getBytes();
+
+    }
+
+    /**
+     * Decodes a script from bytes produced by `encode()`.
+     *
+     * @param bytes The encoded bytes
+     * @return The decoded script
+     * @throws Error If the bytes are not a valid compiled script
+     */
+    public static function decode(bytes:Bytes):Script {
+
+        if (!isBinary(bytes)) {
+            throw new Error("Invalid compiled script");
+        }
+
+        final reader = new ScriptBinaryReader(bytes);
+        return reader.readScript();
+
+    }
+
+}
+
+private enum abstract ValueKind(Int) from Int to Int {
+
+    var NULL = 0;
+
+    var FALSE = 1;
+
+    var TRUE = 2;
+
+    var INT = 3;
+
+    var FLOAT = 4;
+
+    var STRING = 5;
+
+    var ARRAY = 6;
+
+    var OBJECT = 7;
+
+}
+
+private enum abstract NodeKind(Int) from Int to Int {
+
+    var END = 0;
+
+    var SCRIPT = 1;
+
+    var COMMENT = 2;
+
+    var STATE = 3;
+
+    var FIELD = 4;
+
+    var CHARACTER = 5;
+
+    var BEAT = 6;
+
+    var PART = 7;
+
+    var STRING = 8;
+
+    var TEXT = 9;
+
+    var DIALOGUE = 10;
+
+    var CHOICE = 11;
+
+    var OPTION = 12;
+
+    var BLOCK = 13;
+
+    var IF = 14;
+
+    var ALTERNATIVE = 15;
+
+    var CALL = 16;
+
+    var TRANSITION = 17;
+
+    var INSERTION = 18;
+
+    var FUNCTION = 19;
+
+    var LITERAL = 20;
+
+    var ACCESS = 21;
+
+    var ASSIGN = 22;
+
+    var ARRAY_ACCESS = 23;
+
+    var BINARY = 24;
+
+    var UNARY = 25;
+
+    var TERNARY = 26;
+
+    var IMPORT = 27;
+
+}
+
+private enum abstract ExprKind(Int) from Int to Int {
+
+    var NULL = 0;
+
+    var CONST = 1;
+
+    var IDENT = 2;
+
+    var VAR = 3;
+
+    var PARENT = 4;
+
+    var BLOCK = 5;
+
+    var FIELD = 6;
+
+    var BINOP = 7;
+
+    var UNOP = 8;
+
+    var CALL = 9;
+
+    var IF = 10;
+
+    var WHILE = 11;
+
+    var FOR = 12;
+
+    var BREAK = 13;
+
+    var CONTINUE = 14;
+
+    var FUNCTION = 15;
+
+    var RETURN = 16;
+
+    var ARRAY = 17;
+
+    var ARRAY_DECL = 18;
+
+    var NEW = 19;
+
+    var THROW = 20;
+
+    var TRY = 21;
+
+    var OBJECT = 22;
+
+    var TERNARY = 23;
+
+    var SWITCH = 24;
+
+    var DO_WHILE = 25;
+
+    var META = 26;
+
+    var CHECK_TYPE = 27;
+
+}
+
+private enum abstract TypeKind(Int) from Int to Int {
+
+    var NULL = 0;
+
+    var PATH = 1;
+
+    var FUN = 2;
+
+    var ANON = 3;
+
+    var PARENT = 4;
+
+    var OPT = 5;
+
+    var NAMED = 6;
+
+}
+
+private enum abstract PartKind(Int) from Int to Int {
+
+    var RAW = 0;
+
+    var EXPR = 1;
+
+    var TAG = 2;
+
+}
+
+private enum abstract LiteralKind(Int) from Int to Int {
+
+    var NUMBER = 0;
+
+    var BOOLEAN = 1;
+
+    var NULL = 2;
+
+    var ARRAY = 3;
+
+    var OBJECT = 4;
+
+}
+
+private class Flags {
+
+    public static inline final MAGIC_0:Int = 0x4C; // L
+    public static inline final MAGIC_1:Int = 0x52; // R
+    public static inline final MAGIC_2:Int = 0x4C; // L
+    public static inline final MAGIC_3:Int = 0x53; // S
+
+}
+
+@:allow(loreline.ScriptBinary)
+private class ScriptBinaryWriter {
+
+    final buffer:BytesBuffer = new BytesBuffer();
+
+    final strings:Map<String, Int> = new Map();
+
+    var numStrings:Int = 0;
+
+    /**
+     * Number of node records written so far, which is also
+     * the reference of the latest one.
+     */
+    var numNodes:Int = 0;
+
+    function new() {}
+
+    function getBytes():Bytes {
+        return buffer.getBytes();
+    }
+
+    function writeScript(script:Script):Void {
+
+        buffer.addByte(Flags.MAGIC_0);
+        buffer.addByte(Flags.MAGIC_1);
+        buffer.addByte(Flags.MAGIC_2);
+        buffer.addByte(Flags.MAGIC_3);
+        buffer.addByte(ScriptBinary.FORMAT_VERSION);
+
+        final root = writeNode(script);
+        buffer.addByte(NodeKind.END);
+        writeVarInt(root);
+
+        writeFunctionSections(script);
+
+    }
+
+    /**
+     * Writes the parsed code of every top level function, each in its own
+     * section (with its own strings) so that it can be decoded on its own.
+     * Functions with invalid code are left out: their error is reported when
+     * an interpreter initializes them.
+     */
+    function writeFunctionSections(script:Script):Void {
+
+        final prepared = PreparedScript.prepare(script);
+
+        final ids:Array<NodeId> = [];
+        final sections:Array<Bytes> = [];
+        for (decl in script) {
+            if (decl is NFunctionDecl) {
+                final func:NFunctionDecl = cast decl;
+                if (func.name == null) continue;
+                final expr = try prepared.functionExpr(func) catch (e:Any) null;
+                if (expr == null) continue;
+                final section = new ScriptBinaryWriter();
+                section.writeExpr(expr);
+                ids.push(func.id);
+                sections.push(section.getBytes());
+            }
+        }
+
+        writeVarInt(sections.length);
+        for (i in 0...sections.length) {
+            writeNodeId(ids[i]);
+            writeVarInt(sections[i].length);
+            buffer.add(sections[i]);
+        }
+
+    }
+
+    /**
+     * Writes a lorscript expression (may be null) and everything it contains.
+     */
+    function writeExpr(expr:loreline.lorscript.Expr):Void {
+
+        if (expr == null) {
+            writeVarInt(ExprKind.NULL);
+            return;
+        }
+
+        switch expr.e {
+            case EConst(c):
+                writeExprHeader(ExprKind.CONST, expr);
+                switch c {
+                    case CInt(v):
+                        writeVarInt(0);
+                        writeZigZag(v);
+                    case CFloat(f):
+                        writeVarInt(1);
+                        buffer.addDouble(f);
+                    case CString(str):
+                        writeVarInt(2);
+                        writeString(str);
+                }
+            case EIdent(v):
+                writeExprHeader(ExprKind.IDENT, expr);
+                writeString(v);
+            case EVar(n, t, e):
+                writeExprHeader(ExprKind.VAR, expr);
+                writeString(n);
+                writeType(t);
+                writeExpr(e);
+            case EParent(e):
+                writeExprHeader(ExprKind.PARENT, expr);
+                writeExpr(e);
+            case EBlock(exprs):
+                writeExprHeader(ExprKind.BLOCK, expr);
+                writeExprs(exprs);
+            case EField(e, f):
+                writeExprHeader(ExprKind.FIELD, expr);
+                writeExpr(e);
+                writeString(f);
+            case EBinop(op, e1, e2):
+                writeExprHeader(ExprKind.BINOP, expr);
+                writeString(op);
+                writeExpr(e1);
+                writeExpr(e2);
+            case EUnop(op, prefix, e):
+                writeExprHeader(ExprKind.UNOP, expr);
+                writeString(op);
+                writeBool(prefix);
+                writeExpr(e);
+            case ECall(e, params):
+                writeExprHeader(ExprKind.CALL, expr);
+                writeExpr(e);
+                writeExprs(params);
+            case EIf(cond, e1, e2):
+                writeExprHeader(ExprKind.IF, expr);
+                writeExpr(cond);
+                writeExpr(e1);
+                writeExpr(e2);
+            case EWhile(cond, e):
+                writeExprHeader(ExprKind.WHILE, expr);
+                writeExpr(cond);
+                writeExpr(e);
+            case EFor(v, it, e):
+                writeExprHeader(ExprKind.FOR, expr);
+                writeString(v);
+                writeExpr(it);
+                writeExpr(e);
+            case EBreak:
+                writeExprHeader(ExprKind.BREAK, expr);
+            case EContinue:
+                writeExprHeader(ExprKind.CONTINUE, expr);
+            case EFunction(args, e, name, ret):
+                writeExprHeader(ExprKind.FUNCTION, expr);
+                writeVarInt(args.length);
+                for (arg in args) {
+                    writeString(arg.name);
+                    writeType(arg.t);
+                    writeVarInt(arg.opt == null ? 0 : arg.opt ? 2 : 1);
+                    writeExpr(arg.value);
+                }
+                writeExpr(e);
+                writeString(name);
+                writeType(ret);
+            case EReturn(e):
+                writeExprHeader(ExprKind.RETURN, expr);
+                writeExpr(e);
+            case EArray(e, index):
+                writeExprHeader(ExprKind.ARRAY, expr);
+                writeExpr(e);
+                writeExpr(index);
+            case EArrayDecl(exprs):
+                writeExprHeader(ExprKind.ARRAY_DECL, expr);
+                writeExprs(exprs);
+            case ENew(cl, params):
+                writeExprHeader(ExprKind.NEW, expr);
+                writeString(cl);
+                writeExprs(params);
+            case EThrow(e):
+                writeExprHeader(ExprKind.THROW, expr);
+                writeExpr(e);
+            case ETry(e, v, t, ecatch):
+                writeExprHeader(ExprKind.TRY, expr);
+                writeExpr(e);
+                writeString(v);
+                writeType(t);
+                writeExpr(ecatch);
+            case EObject(fl):
+                writeExprHeader(ExprKind.OBJECT, expr);
+                writeVarInt(fl.length);
+                for (field in fl) {
+                    writeString(field.name);
+                    writeExpr(field.e);
+                }
+            case ETernary(cond, e1, e2):
+                writeExprHeader(ExprKind.TERNARY, expr);
+                writeExpr(cond);
+                writeExpr(e1);
+                writeExpr(e2);
+            case ESwitch(e, cases, defaultExpr):
+                writeExprHeader(ExprKind.SWITCH, expr);
+                writeExpr(e);
+                writeVarInt(cases.length);
+                for (c in cases) {
+                    writeExprs(c.values);
+                    writeExpr(c.expr);
+                }
+                writeExpr(defaultExpr);
+            case EDoWhile(cond, e):
+                writeExprHeader(ExprKind.DO_WHILE, expr);
+                writeExpr(cond);
+                writeExpr(e);
+            case EMeta(name, args, e):
+                writeExprHeader(ExprKind.META, expr);
+                writeString(name);
+                writeExprs(args);
+                writeExpr(e);
+            case ECheckType(e, t):
+                writeExprHeader(ExprKind.CHECK_TYPE, expr);
+                writeExpr(e);
+                writeType(t);
+        }
+
+    }
+
+    function writeExprHeader(kind:ExprKind, expr:loreline.lorscript.Expr):Void {
+
+        writeVarInt(kind);
+        writeZigZag(expr.pmin);
+        writeZigZag(expr.pmax);
+        writeString(expr.origin);
+        writeZigZag(expr.line);
+
+    }
+
+    /**
+     * Writes a nullable array of lorscript expressions: 0 for null,
+     * otherwise the length + 1 followed by each expression.
+     */
+    function writeExprs(exprs:Null<Array<loreline.lorscript.Expr>>):Void {
+
+        if (exprs == null) {
+            writeVarInt(0);
+            return;
+        }
+
+        writeVarInt(exprs.length + 1);
+        for (expr in exprs) {
+            writeExpr(expr);
+        }
+
+    }
+
+    function writeType(t:Null<CType>):Void {
+
+        if (t == null) {
+            writeVarInt(TypeKind.NULL);
+            return;
+        }
+
+        switch t {
+            case CTPath(path, params):
+                writeVarInt(TypeKind.PATH);
+                writeVarInt(path.length);
+                for (part in path) {
+                    writeString(part);
+                }
+                writeTypes(params);
+            case CTFun(args, ret):
+                writeVarInt(TypeKind.FUN);
+                writeTypes(args);
+                writeType(ret);
+            case CTAnon(fields):
+                writeVarInt(TypeKind.ANON);
+                writeVarInt(fields.length);
+                for (field in fields) {
+                    writeString(field.name);
+                    writeType(field.t);
+                    if (field.meta == null) {
+                        writeVarInt(0);
+                    }
+                    else {
+                        writeVarInt(field.meta.length + 1);
+                        for (meta in field.meta) {
+                            writeString(meta.name);
+                            writeExprs(meta.params);
+                        }
+                    }
+                }
+            case CTParent(t):
+                writeVarInt(TypeKind.PARENT);
+                writeType(t);
+            case CTOpt(t):
+                writeVarInt(TypeKind.OPT);
+                writeType(t);
+            case CTNamed(n, t):
+                writeVarInt(TypeKind.NAMED);
+                writeString(n);
+                writeType(t);
+        }
+
+    }
+
+    function writeTypes(types:Null<Array<CType>>):Void {
+
+        if (types == null) {
+            writeVarInt(0);
+            return;
+        }
+
+        writeVarInt(types.length + 1);
+        for (t in types) {
+            writeType(t);
+        }
+
+    }
+
+    /**
+     * Writes the records of a node and of everything it contains,
+     * children first.
+     *
+     * @param node The node to write (may be null)
+     * @return The reference of the node, 0 for null
+     */
+    function writeNode(node:Node):Int {
+
+        if (node == null) return 0;
+
+        if (node is Comment) {
+            final comment:Comment = cast node;
+            beginRecord(NodeKind.COMMENT, node);
+            writeString(comment.content);
+            writeBool(comment.multiline);
+            writeBool(comment.isHash);
+            return ++numNodes;
+        }
+
+        final astNode:AstNode = cast node;
+        final leading = writeNodes(astNode.leadingComments);
+        final trailing = writeNodes(astNode.trailingComments);
+
+        if (node is Script) {
+            final script:Script = cast node;
+            final body = writeNodes(script.body);
+            beginAstRecord(NodeKind.SCRIPT, astNode, leading, trailing);
+            writeRefs(body);
+            writeVarInt(script.indentSize);
+            writeString(script.filePath);
+        }
+        else if (node is NStateDecl) {
+            final state:NStateDecl = cast node;
+            final fields = writeNodes(state.fields);
+            beginAstRecord(NodeKind.STATE, astNode, leading, trailing);
+            writeBool(state.temporary);
+            writeRefs(fields);
+            writeVarInt(cast state.style);
+        }
+        else if (node is NObjectField) {
+            final field:NObjectField = cast node;
+            final value = writeNode(field.value);
+            beginAstRecord(NodeKind.FIELD, astNode, leading, trailing);
+            writeString(field.name);
+            writeVarInt(value);
+        }
+        else if (node is NCharacterDecl) {
+            final character:NCharacterDecl = cast node;
+            final fields = writeNodes(character.fields);
+            beginAstRecord(NodeKind.CHARACTER, astNode, leading, trailing);
+            writeString(character.name);
+            writePosition(character.namePos);
+            writeRefs(fields);
+            writeVarInt(cast character.style);
+        }
+        else if (node is NBeatDecl) {
+            final beat:NBeatDecl = cast node;
+            final body = writeNodes(beat.body);
+            beginAstRecord(NodeKind.BEAT, astNode, leading, trailing);
+            writeString(beat.name);
+            writeRefs(body);
+            writeVarInt(cast beat.style);
+        }
+        else if (node is NStringPart) {
+            final part:NStringPart = cast node;
+            switch part.partType {
+                case Raw(text):
+                    beginAstRecord(NodeKind.PART, astNode, leading, trailing);
+                    writeVarInt(PartKind.RAW);
+                    writeString(text);
+                case Expr(expr):
+                    final ref = writeNode(expr);
+                    beginAstRecord(NodeKind.PART, astNode, leading, trailing);
+                    writeVarInt(PartKind.EXPR);
+                    writeVarInt(ref);
+                case Tag(closing, expr):
+                    final ref = writeNode(expr);
+                    beginAstRecord(NodeKind.PART, astNode, leading, trailing);
+                    writeVarInt(PartKind.TAG);
+                    writeBool(closing);
+                    writeVarInt(ref);
+            }
+        }
+        else if (node is NStringLiteral) {
+            final str:NStringLiteral = cast node;
+            final parts = writeNodes(str.parts);
+            beginAstRecord(NodeKind.STRING, astNode, leading, trailing);
+            writeVarInt(cast str.quotes);
+            writeRefs(parts);
+        }
+        else if (node is NTextStatement) {
+            final text:NTextStatement = cast node;
+            final content = writeNode(text.content);
+            final condition = writeNode(text.condition);
+            beginAstRecord(NodeKind.TEXT, astNode, leading, trailing);
+            writeVarInt(content);
+            writeCondition(condition, text.conditionStyle, text.conditionPos);
+        }
+        else if (node is NDialogueStatement) {
+            final dialogue:NDialogueStatement = cast node;
+            final content = writeNode(dialogue.content);
+            final condition = writeNode(dialogue.condition);
+            beginAstRecord(NodeKind.DIALOGUE, astNode, leading, trailing);
+            writeString(dialogue.character);
+            writePosition(dialogue.characterPos);
+            writeVarInt(content);
+            writeCondition(condition, dialogue.conditionStyle, dialogue.conditionPos);
+        }
+        else if (node is NChoiceStatement) {
+            final choice:NChoiceStatement = cast node;
+            final options = writeNodes(choice.options);
+            beginAstRecord(NodeKind.CHOICE, astNode, leading, trailing);
+            writeRefs(options);
+            writeVarInt(cast choice.style);
+        }
+        else if (node is NChoiceOption) {
+            final option:NChoiceOption = cast node;
+            final text = writeNode(option.text);
+            final insertion = writeNode(option.insertion);
+            final condition = writeNode(option.condition);
+            final body = writeNodes(option.body);
+            beginAstRecord(NodeKind.OPTION, astNode, leading, trailing);
+            writeVarInt(text);
+            writeVarInt(insertion);
+            writeCondition(condition, option.conditionStyle, option.conditionPos);
+            writeRefs(body);
+            writeVarInt(cast option.style);
+            writeBool(option.once);
+        }
+        else if (node is NBlock) {
+            final block:NBlock = cast node;
+            final body = writeNodes(block.body);
+            beginAstRecord(NodeKind.BLOCK, astNode, leading, trailing);
+            writeRefs(body);
+            writeVarInt(cast block.style);
+        }
+        else if (node is NIfStatement) {
+            final ifStatement:NIfStatement = cast node;
+            final condition = writeNode(ifStatement.condition);
+            final thenBranch = writeNode(ifStatement.thenBranch);
+            final elseBranch = writeNode(ifStatement.elseBranch);
+            final elseLeading = writeNodes(ifStatement.elseLeadingComments);
+            final elseTrailing = writeNodes(ifStatement.elseTrailingComments);
+            beginAstRecord(NodeKind.IF, astNode, leading, trailing);
+            writeVarInt(condition);
+            writeVarInt(cast ifStatement.conditionStyle);
+            writeVarInt(thenBranch);
+            writeVarInt(elseBranch);
+            writeRefs(elseLeading);
+            writeRefs(elseTrailing);
+        }
+        else if (node is NAlternative) {
+            final alternative:NAlternative = cast node;
+            final items = writeNodes(alternative.items);
+            final separatorComments = alternative.separatorComments != null ? [for (group in alternative.separatorComments) writeNodes(group)] : null;
+            beginAstRecord(NodeKind.ALTERNATIVE, astNode, leading, trailing);
+            writeVarInt(cast alternative.mode);
+            writeRefs(items);
+            writeVarInt(cast alternative.style);
+            if (separatorComments == null) {
+                writeVarInt(0);
+            }
+            else {
+                writeVarInt(separatorComments.length + 1);
+                for (group in separatorComments) {
+                    writeRefs(group);
+                }
+            }
+        }
+        else if (node is NCall) {
+            final call:NCall = cast node;
+            final target = writeNode(call.target);
+            final args = writeNodes(call.args);
+            beginAstRecord(NodeKind.CALL, astNode, leading, trailing);
+            writeVarInt(target);
+            writeRefs(args);
+        }
+        else if (node is NTransition) {
+            final transition:NTransition = cast node;
+            beginAstRecord(NodeKind.TRANSITION, astNode, leading, trailing);
+            writeString(transition.target);
+            writePosition(transition.targetPos);
+        }
+        else if (node is NInsertion) {
+            final insertion:NInsertion = cast node;
+            beginAstRecord(NodeKind.INSERTION, astNode, leading, trailing);
+            writeString(insertion.target);
+            writePosition(insertion.targetPos);
+        }
+        else if (node is NFunctionDecl) {
+            final func:NFunctionDecl = cast node;
+            beginAstRecord(NodeKind.FUNCTION, astNode, leading, trailing);
+            writeString(func.name);
+            writeVarInt(func.args.length);
+            for (arg in func.args) {
+                writeString(arg);
+            }
+            writeString(func.code);
+            writeBool(func.external);
+        }
+        else if (node is NLiteral) {
+            writeLiteral(cast node, leading, trailing);
+        }
+        else if (node is NAccess) {
+            final access:NAccess = cast node;
+            final target = writeNode(access.target);
+            beginAstRecord(NodeKind.ACCESS, astNode, leading, trailing);
+            writeVarInt(target);
+            writeString(access.name);
+            writeVarInt(cast access.binding);
+        }
+        else if (node is NAssign) {
+            final assign:NAssign = cast node;
+            final target = writeNode(assign.target);
+            final value = writeNode(assign.value);
+            beginAstRecord(NodeKind.ASSIGN, astNode, leading, trailing);
+            writeVarInt(target);
+            writeString(Std.string(assign.op));
+            writeVarInt(value);
+        }
+        else if (node is NArrayAccess) {
+            final arrayAccess:NArrayAccess = cast node;
+            final target = writeNode(arrayAccess.target);
+            final index = writeNode(arrayAccess.index);
+            beginAstRecord(NodeKind.ARRAY_ACCESS, astNode, leading, trailing);
+            writeVarInt(target);
+            writeVarInt(index);
+        }
+        else if (node is NBinary) {
+            final binary:NBinary = cast node;
+            final left = writeNode(binary.left);
+            final right = writeNode(binary.right);
+            beginAstRecord(NodeKind.BINARY, astNode, leading, trailing);
+            writeVarInt(left);
+            writeString(Std.string(binary.op));
+            writeVarInt(right);
+        }
+        else if (node is NUnary) {
+            final unary:NUnary = cast node;
+            final operand = writeNode(unary.operand);
+            beginAstRecord(NodeKind.UNARY, astNode, leading, trailing);
+            writeString(Std.string(unary.op));
+            writeVarInt(operand);
+        }
+        else if (node is NTernary) {
+            final ternary:NTernary = cast node;
+            final condition = writeNode(ternary.condition);
+            final trueExpr = writeNode(ternary.trueExpr);
+            final falseExpr = writeNode(ternary.falseExpr);
+            beginAstRecord(NodeKind.TERNARY, astNode, leading, trailing);
+            writeVarInt(condition);
+            writeVarInt(trueExpr);
+            writeVarInt(falseExpr);
+        }
+        else if (node is NImportStatement) {
+            final importStatement:NImportStatement = cast node;
+            final path = writeNode(importStatement.path);
+            final script = writeNode(importStatement.script);
+            beginAstRecord(NodeKind.IMPORT, astNode, leading, trailing);
+            writeVarInt(path);
+            writeVarInt(script);
+        }
+        else {
+            throw new Error("Cannot compile node of type: " + node.type(), node.pos);
+        }
+
+        return ++numNodes;
+
+    }
+
+    function writeLiteral(literal:NLiteral, leading:Array<Int>, trailing:Array<Int>):Void {
+
+        switch literal.literalType {
+            case Number | Boolean | Null:
+                beginAstRecord(NodeKind.LITERAL, literal, leading, trailing);
+                writeVarInt(switch literal.literalType {
+                    case Number: LiteralKind.NUMBER;
+                    case Boolean: LiteralKind.BOOLEAN;
+                    case _: LiteralKind.NULL;
+                });
+                writeValue(literal.value);
+            case Array:
+                final elems:Array<Dynamic> = literal.value;
+                // Elements are nodes (written as references) or plain values
+                final refs = elems != null ? [for (elem in elems) Std.isOfType(elem, Node) ? writeNode(elem) : 0] : null;
+                beginAstRecord(NodeKind.LITERAL, literal, leading, trailing);
+                writeVarInt(LiteralKind.ARRAY);
+                if (elems == null) {
+                    writeVarInt(0);
+                }
+                else {
+                    writeVarInt(elems.length + 1);
+                    for (i in 0...elems.length) {
+                        writeVarInt(refs[i]);
+                        if (refs[i] == 0) {
+                            writeValue(elems[i]);
+                        }
+                    }
+                }
+            case Object(style):
+                final fields = writeNodes(literal.value);
+                beginAstRecord(NodeKind.LITERAL, literal, leading, trailing);
+                writeVarInt(LiteralKind.OBJECT);
+                writeVarInt(cast style);
+                writeRefs(fields);
+        }
+
+    }
+
+    /**
+     * Writes the records of every node of an array.
+     *
+     * @return The references of the nodes, or null for a null array
+     */
+    function writeNodes(nodes:Array<Dynamic>):Null<Array<Int>> {
+
+        if (nodes == null) return null;
+        return [for (node in nodes) writeNode(node)];
+
+    }
+
+    function beginRecord(kind:NodeKind, node:Node):Void {
+
+        buffer.addByte(kind);
+        writeNodeId(node.id);
+        writePosition(node.pos);
+
+    }
+
+    function beginAstRecord(kind:NodeKind, node:AstNode, leading:Array<Int>, trailing:Array<Int>):Void {
+
+        beginRecord(kind, node);
+        writeRefs(leading);
+        writeRefs(trailing);
+
+    }
+
+    /**
+     * Writes a nullable array of node references: 0 for null,
+     * otherwise the length + 1 followed by each reference.
+     */
+    function writeRefs(refs:Null<Array<Int>>):Void {
+
+        if (refs == null) {
+            writeVarInt(0);
+            return;
+        }
+
+        writeVarInt(refs.length + 1);
+        for (ref in refs) {
+            writeVarInt(ref);
+        }
+
+    }
+
+    function writeCondition(condition:Int, style:ConditionStyle, pos:Null<Position>):Void {
+
+        writeVarInt(condition);
+        writeVarInt(cast style);
+        if (pos != null) {
+            writeBool(true);
+            writePosition(pos);
+        }
+        else {
+            writeBool(false);
+        }
+
+    }
+
+    function writeValue(value:Any):Void {
+
+        if (value == null) {
+            buffer.addByte(ValueKind.NULL);
+        }
+        else if (Std.isOfType(value, Bool)) {
+            buffer.addByte((value:Bool) ? ValueKind.TRUE : ValueKind.FALSE);
+        }
+        else if (Std.isOfType(value, String)) {
+            buffer.addByte(ValueKind.STRING);
+            writeString(value);
+        }
+        else if (Std.isOfType(value, Int)) {
+            buffer.addByte(ValueKind.INT);
+            writeZigZag(value);
+        }
+        else if (Std.isOfType(value, Float)) {
+            buffer.addByte(ValueKind.FLOAT);
+            buffer.addDouble(value);
+        }
+        else if (value is Array) {
+            final array:Array<Any> = value;
+            buffer.addByte(ValueKind.ARRAY);
+            writeVarInt(array.length);
+            for (item in array) {
+                writeValue(item);
+            }
+        }
+        else {
+            buffer.addByte(ValueKind.OBJECT);
+            final keys = Reflect.fields(value);
+            writeVarInt(keys.length);
+            for (key in keys) {
+                writeString(key);
+                writeValue(Reflect.field(value, key));
+            }
+        }
+
+    }
+
+    inline function writeBool(value:Bool):Void {
+
+        buffer.addByte(value ? 1 : 0);
+
+    }
+
+    function writePosition(pos:Position):Void {
+
+        if (pos == null) pos = new Position(0, 0, 0, 0);
+        writeVarInt(pos.line);
+        writeVarInt(pos.column);
+        writeVarInt(pos.offset);
+        writeVarInt(pos.length);
+
+    }
+
+    function writeNodeId(id:NodeId):Void {
+
+        writeVarInt(id.section);
+        writeVarInt(id.branch);
+        writeVarInt(id.block);
+        writeVarInt(id.node);
+
+    }
+
+    /**
+     * Writes an interned (and nullable) string: 0 for null,
+     * 1 followed by the string the first time it is seen,
+     * then 2 + index of the string for subsequent occurrences.
+     */
+    function writeString(str:String):Void {
+
+        if (str == null) {
+            writeVarInt(0);
+            return;
+        }
+
+        final index = strings.get(str);
+        if (index != null) {
+            writeVarInt(index + 2);
+            return;
+        }
+
+        strings.set(str, numStrings++);
+        final bytes = Bytes.ofString(str, Encoding.UTF8);
+        writeVarInt(1);
+        writeVarInt(bytes.length);
+        buffer.add(bytes);
+
+    }
+
+    function writeZigZag(value:Int):Void {
+
+        writeVarInt((value << 1) ^ (value >> 31));
+
+    }
+
+    function writeVarInt(value:Int):Void {
+
+        // Treated as unsigned 32-bit
+        while ((value & ~0x7F) != 0) {
+            buffer.addByte((value & 0x7F) | 0x80);
+            value = value >>> 7;
+        }
+        buffer.addByte(value);
+
+    }
+
+}
+
+@:allow(loreline.ScriptBinary)
+private class ScriptBinaryReader {
+
+    final bytes:Bytes;
+
+    var pos:Int = 0;
+
+    final strings:Array<String> = [];
+
+    /**
+     * Nodes read so far, by reference - 1.
+     */
+    final nodes:Array<Node> = [];
+
+    function new(bytes:Bytes, start:Int = 0) {
+        this.bytes = bytes;
+        this.pos = start;
+    }
+
+    function readScript():Script {
+
+        pos = 4;
+        final formatVersion = readByte();
+        if (formatVersion != ScriptBinary.FORMAT_VERSION) {
+            throw new Error("Unsupported compiled script format: " + formatVersion);
+        }
+
+        while (true) {
+            final kind:NodeKind = readByte();
+            if (kind == NodeKind.END) break;
+            nodes.push(readNode(kind));
+        }
+
+        final root = readNodeRef();
+        if (!(root is Script)) {
+            throw new Error("Invalid compiled script root");
+        }
+
+        final script:Script = cast root;
+        PreparedScript.prepare(script, true, readFunctionSections());
+        return script;
+
+    }
+
+    /**
+     * Skips the function code sections, returning how to decode each of them later.
+     *
+     * @return A function returning the parsed code of each function, by function node id
+     */
+    function readFunctionSections():NodeIdMap<()->loreline.lorscript.Expr> {
+
+        final result = new NodeIdMap<()->loreline.lorscript.Expr>();
+        final image = bytes;
+
+        for (_ in 0...readVarInt()) {
+            final id = readNodeId();
+            final length = readVarInt();
+            final start = pos;
+            if (start + length > image.length) {
+                throw new Error("Truncated compiled script");
+            }
+            pos += length;
+            result.set(id, () -> new ScriptBinaryReader(image, start).readExpr());
+        }
+
+        return result;
+
+    }
+
+    /**
+     * Reads a lorscript expression written by `writeExpr()`.
+     */
+    function readExpr():loreline.lorscript.Expr {
+
+        final kind:ExprKind = readVarInt();
+        if (kind == ExprKind.NULL) return null;
+
+        final pmin = readZigZag();
+        final pmax = readZigZag();
+        final origin = readString();
+        final line = readZigZag();
+
+        final e:ExprDef = switch kind {
+            case CONST:
+                final constKind = readVarInt();
+                switch constKind {
+                    case 0: EConst(CInt(readZigZag()));
+                    case 1: EConst(CFloat(readDouble()));
+                    case 2: EConst(CString(readString()));
+                    case _: throw new Error("Invalid constant in compiled script");
+                }
+            case IDENT:
+                EIdent(readString());
+            case VAR:
+                final n = readString();
+                final t = readType();
+                EVar(n, t, readExpr());
+            case PARENT:
+                EParent(readExpr());
+            case BLOCK:
+                EBlock(readExprs());
+            case FIELD:
+                final target = readExpr();
+                EField(target, readString());
+            case BINOP:
+                final op = readString();
+                final e1 = readExpr();
+                EBinop(op, e1, readExpr());
+            case UNOP:
+                final op = readString();
+                final prefix = readBool();
+                EUnop(op, prefix, readExpr());
+            case CALL:
+                final target = readExpr();
+                ECall(target, readExprs());
+            case IF:
+                final cond = readExpr();
+                final e1 = readExpr();
+                EIf(cond, e1, readExpr());
+            case WHILE:
+                final cond = readExpr();
+                EWhile(cond, readExpr());
+            case FOR:
+                final v = readString();
+                final it = readExpr();
+                EFor(v, it, readExpr());
+            case BREAK:
+                EBreak;
+            case CONTINUE:
+                EContinue;
+            case FUNCTION:
+                final args:Array<Argument> = [];
+                for (_ in 0...readVarInt()) {
+                    final name = readString();
+                    final t = readType();
+                    final opt = readVarInt();
+                    final value = readExpr();
+                    final arg:Argument = { name: name };
+                    if (t != null) arg.t = t;
+                    if (opt != 0) arg.opt = opt == 2;
+                    if (value != null) arg.value = value;
+                    args.push(arg);
+                }
+                final body = readExpr();
+                final name = readString();
+                EFunction(args, body, name, readType());
+            case RETURN:
+                EReturn(readExpr());
+            case ARRAY:
+                final target = readExpr();
+                EArray(target, readExpr());
+            case ARRAY_DECL:
+                EArrayDecl(readExprs());
+            case NEW:
+                final cl = readString();
+                ENew(cl, readExprs());
+            case THROW:
+                EThrow(readExpr());
+            case TRY:
+                final body = readExpr();
+                final v = readString();
+                final t = readType();
+                ETry(body, v, t, readExpr());
+            case OBJECT:
+                final fields:Array<{ name : String, e : loreline.lorscript.Expr }> = [];
+                for (_ in 0...readVarInt()) {
+                    final name = readString();
+                    fields.push({ name: name, e: readExpr() });
+                }
+                EObject(fields);
+            case TERNARY:
+                final cond = readExpr();
+                final e1 = readExpr();
+                ETernary(cond, e1, readExpr());
+            case SWITCH:
+                final target = readExpr();
+                final cases:Array<{ values : Array<loreline.lorscript.Expr>, expr : loreline.lorscript.Expr }> = [];
+                for (_ in 0...readVarInt()) {
+                    final values = readExprs();
+                    cases.push({ values: values, expr: readExpr() });
+                }
+                ESwitch(target, cases, readExpr());
+            case DO_WHILE:
+                final cond = readExpr();
+                EDoWhile(cond, readExpr());
+            case META:
+                final name = readString();
+                final args = readExprs();
+                EMeta(name, args, readExpr());
+            case CHECK_TYPE:
+                final target = readExpr();
+                ECheckType(target, readType());
+            case _:
+                throw new Error("Invalid expression kind in compiled script: " + (kind:Int));
+        }
+
+        return {
+            e: e,
+            pmin: pmin,
+            pmax: pmax,
+            origin: origin,
+            line: line
+        };
+
+    }
+
+    function readExprs():Null<Array<loreline.lorscript.Expr>> {
+
+        final count = readVarInt();
+        if (count == 0) return null;
+
+        final result:Array<loreline.lorscript.Expr> = [];
+        for (_ in 0...count - 1) {
+            result.push(readExpr());
+        }
+        return result;
+
+    }
+
+    function readType():Null<CType> {
+
+        final kind:TypeKind = readVarInt();
+        return switch kind {
+            case NULL:
+                null;
+            case PATH:
+                final path:Array<String> = [for (_ in 0...readVarInt()) readString()];
+                CTPath(path, readTypes());
+            case FUN:
+                final args = readTypes();
+                CTFun(args, readType());
+            case ANON:
+                final fields:Array<{ name : String, t : CType, ?meta : loreline.lorscript.Expr.Metadata }> = [];
+                for (_ in 0...readVarInt()) {
+                    final name = readString();
+                    final t = readType();
+                    final metaCount = readVarInt();
+                    if (metaCount == 0) {
+                        fields.push({ name: name, t: t });
+                    }
+                    else {
+                        final meta:loreline.lorscript.Expr.Metadata = [];
+                        for (_ in 0...metaCount - 1) {
+                            final metaName = readString();
+                            meta.push({ name: metaName, params: readExprs() });
+                        }
+                        fields.push({ name: name, t: t, meta: meta });
+                    }
+                }
+                CTAnon(fields);
+            case PARENT:
+                CTParent(readType());
+            case OPT:
+                CTOpt(readType());
+            case NAMED:
+                final n = readString();
+                CTNamed(n, readType());
+            case _:
+                throw new Error("Invalid type kind in compiled script: " + (kind:Int));
+        }
+
+    }
+
+    function readTypes():Null<Array<CType>> {
+
+        final count = readVarInt();
+        if (count == 0) return null;
+
+        final result:Array<CType> = [];
+        for (_ in 0...count - 1) {
+            result.push(readType());
+        }
+        return result;
+
+    }
+
+    function readDouble():Float {
+
+        if (pos + 8 > bytes.length) {
+            throw new Error("Truncated compiled script");
+        }
+        final value = bytes.getDouble(pos);
+        pos += 8;
+        return value;
+
+    }
+
+    function readNode(kind:NodeKind):Node {
+
+        final id = readNodeId();
+        final pos = readPosition();
+
+        if (kind == NodeKind.COMMENT) {
+            final content = readString();
+            final multiline = readBool();
+            final isHash = readBool();
+            return new Comment(id, pos, content, multiline, isHash);
+        }
+
+        final leading:Array<Comment> = readNodeRefs();
+        final trailing:Array<Comment> = readNodeRefs();
+
+        return switch kind {
+            case SCRIPT:
+                final body:Array<AstNode> = readNodeRefs();
+                final script = new Script(id, pos, body);
+                script.indentSize = readVarInt();
+                script.filePath = readString();
+                script.leadingComments = leading;
+                script.trailingComments = trailing;
+                script;
+            case STATE:
+                final temporary = readBool();
+                final fields:Array<NObjectField> = readNodeRefs();
+                final state = new NStateDecl(id, pos, temporary, fields, leading, trailing);
+                state.style = cast readVarInt();
+                state;
+            case FIELD:
+                final name = readString();
+                new NObjectField(id, pos, name, cast readNodeRef(), leading, trailing);
+            case CHARACTER:
+                final name = readString();
+                final namePos = readPosition();
+                final fields:Array<NObjectField> = readNodeRefs();
+                final character = new NCharacterDecl(id, pos, name, namePos, fields, leading, trailing);
+                character.style = cast readVarInt();
+                character;
+            case BEAT:
+                final name = readString();
+                final body:Array<AstNode> = readNodeRefs();
+                final beat = new NBeatDecl(id, pos, name, body, leading, trailing);
+                beat.style = cast readVarInt();
+                beat;
+            case PART:
+                final partKind:PartKind = readVarInt();
+                final partType = switch partKind {
+                    case RAW: Raw(readString());
+                    case EXPR: Expr(cast readNodeRef());
+                    case TAG:
+                        final closing = readBool();
+                        Tag(closing, cast readNodeRef());
+                    case _: throw new Error("Invalid string part in compiled script");
+                }
+                new NStringPart(id, pos, partType, leading, trailing);
+            case STRING:
+                final quotes:Quotes = cast readVarInt();
+                final parts:Array<NStringPart> = readNodeRefs();
+                new NStringLiteral(id, pos, quotes, parts, leading, trailing);
+            case TEXT:
+                final content:NStringLiteral = cast readNodeRef();
+                final text = new NTextStatement(id, pos, content, leading, trailing);
+                text.condition = cast readNodeRef();
+                text.conditionStyle = cast readVarInt();
+                text.conditionPos = readBool() ? readPosition() : null;
+                text;
+            case DIALOGUE:
+                final character = readString();
+                final characterPos = readPosition();
+                final content:NStringLiteral = cast readNodeRef();
+                final dialogue = new NDialogueStatement(id, pos, character, characterPos, content, leading, trailing);
+                dialogue.condition = cast readNodeRef();
+                dialogue.conditionStyle = cast readVarInt();
+                dialogue.conditionPos = readBool() ? readPosition() : null;
+                dialogue;
+            case CHOICE:
+                final options:Array<NChoiceOption> = readNodeRefs();
+                final choice = new NChoiceStatement(id, pos, options, leading, trailing);
+                choice.style = cast readVarInt();
+                choice;
+            case OPTION:
+                final text:NStringLiteral = cast readNodeRef();
+                final insertion:NInsertion = cast readNodeRef();
+                final condition:NExpr = cast readNodeRef();
+                final conditionStyle:ConditionStyle = cast readVarInt();
+                final conditionPos = readBool() ? readPosition() : null;
+                final body:Array<AstNode> = readNodeRefs();
+                final option = new NChoiceOption(id, pos, text, insertion, condition, conditionStyle, body, leading, trailing);
+                option.conditionPos = conditionPos;
+                option.style = cast readVarInt();
+                option.once = readBool();
+                option;
+            case BLOCK:
+                final body:Array<AstNode> = readNodeRefs();
+                final block = new NBlock(id, pos, body, leading, trailing);
+                block.style = cast readVarInt();
+                block;
+            case IF:
+                final condition:NExpr = cast readNodeRef();
+                final conditionStyle:ConditionStyle = cast readVarInt();
+                final thenBranch:NBlock = cast readNodeRef();
+                final elseBranch:NBlock = cast readNodeRef();
+                final elseLeading:Array<Comment> = readNodeRefs();
+                final elseTrailing:Array<Comment> = readNodeRefs();
+                new NIfStatement(id, pos, condition, conditionStyle, thenBranch, elseBranch, leading, trailing, elseLeading, elseTrailing);
+            case ALTERNATIVE:
+                final mode:AlternativeMode = cast readVarInt();
+                final items:Array<NBlock> = readNodeRefs();
+                final alternative = new NAlternative(id, pos, mode, items, leading, trailing);
+                alternative.style = cast readVarInt();
+                final groups = readVarInt();
+                if (groups > 0) {
+                    alternative.separatorComments = [for (_ in 0...groups - 1) (readNodeRefs():Array<Comment>)];
+                }
+                alternative;
+            case CALL:
+                final target:NExpr = cast readNodeRef();
+                final args:Array<NExpr> = readNodeRefs();
+                new NCall(id, pos, target, args, leading, trailing);
+            case TRANSITION:
+                final target = readString();
+                new NTransition(id, pos, target, readPosition(), leading, trailing);
+            case INSERTION:
+                final target = readString();
+                new NInsertion(id, pos, target, readPosition(), leading, trailing);
+            case FUNCTION:
+                final name = readString();
+                final args = [for (_ in 0...readVarInt()) readString()];
+                final code = readString();
+                new NFunctionDecl(id, pos, name, args, code, readBool(), leading, trailing);
+            case LITERAL:
+                readLiteral(id, pos, leading, trailing);
+            case ACCESS:
+                final target:NExpr = cast readNodeRef();
+                final access = new NAccess(id, pos, target, readString(), leading, trailing);
+                access.binding = cast readVarInt();
+                access;
+            case ASSIGN:
+                final target:NExpr = cast readNodeRef();
+                final op = JsonToAst.tokenTypeFromString(readString());
+                new NAssign(id, pos, target, op, cast readNodeRef(), leading, trailing);
+            case ARRAY_ACCESS:
+                final target:NExpr = cast readNodeRef();
+                new NArrayAccess(id, pos, target, cast readNodeRef(), leading, trailing);
+            case BINARY:
+                final left:NExpr = cast readNodeRef();
+                final op = JsonToAst.tokenTypeFromString(readString());
+                new NBinary(id, pos, left, op, cast readNodeRef(), leading, trailing);
+            case UNARY:
+                final op = JsonToAst.tokenTypeFromString(readString());
+                new NUnary(id, pos, op, cast readNodeRef(), leading, trailing);
+            case TERNARY:
+                final condition:NExpr = cast readNodeRef();
+                final trueExpr:NExpr = cast readNodeRef();
+                new NTernary(id, pos, condition, trueExpr, cast readNodeRef(), leading, trailing);
+            case IMPORT:
+                final path:NStringLiteral = cast readNodeRef();
+                new NImportStatement(id, pos, path, cast readNodeRef(), leading, trailing);
+            case _:
+                throw new Error("Invalid node kind in compiled script: " + (kind:Int));
+        }
+
+    }
+
+    function readLiteral(id:NodeId, pos:Position, leading:Array<Comment>, trailing:Array<Comment>):NLiteral {
+
+        final literalKind:LiteralKind = readVarInt();
+        return switch literalKind {
+            case NUMBER:
+                new NLiteral(id, pos, readValue(), Number, leading, trailing);
+            case BOOLEAN:
+                new NLiteral(id, pos, readValue(), Boolean, leading, trailing);
+            case NULL:
+                readValue();
+                new NLiteral(id, pos, null, Null, leading, trailing);
+            case ARRAY:
+                final count = readVarInt();
+                var elems:Array<Any> = null;
+                if (count > 0) {
+                    elems = [];
+                    for (_ in 0...count - 1) {
+                        final ref = readVarInt();
+                        elems.push(ref > 0 ? nodeAt(ref) : readValue());
+                    }
+                }
+                new NLiteral(id, pos, elems, LiteralType.Array, leading, trailing);
+            case OBJECT:
+                final style:BlockStyle = cast readVarInt();
+                var fields:Array<NObjectField> = readNodeRefs();
+                if (fields == null) fields = [];
+                new NLiteral(id, pos, fields, Object(style), leading, trailing);
+            case _:
+                throw new Error("Invalid literal in compiled script");
+        }
+
+    }
+
+    /**
+     * Reads a node reference and returns the node it points to (null for 0).
+     */
+    function readNodeRef():Dynamic {
+
+        final ref = readVarInt();
+        return ref == 0 ? null : nodeAt(ref);
+
+    }
+
+    /**
+     * Reads a nullable array of node references, as written by `writeRefs()`.
+     */
+    function readNodeRefs():Dynamic {
+
+        final count = readVarInt();
+        if (count == 0) return null;
+
+        final result:Array<Node> = [];
+        for (_ in 0...count - 1) {
+            result.push(readNodeRef());
+        }
+        return result;
+
+    }
+
+    inline function nodeAt(ref:Int):Node {
+
+        if (ref < 1 || ref > nodes.length) {
+            throw new Error("Invalid node reference in compiled script");
+        }
+        return nodes[ref - 1];
+
+    }
+
+    function readValue():Any {
+
+        final kind:ValueKind = readByte();
+        return switch kind {
+            case NULL: null;
+            case FALSE: false;
+            case TRUE: true;
+            case INT: readZigZag();
+            case FLOAT: readDouble();
+            case STRING: readString();
+            case ARRAY:
+                final array:Array<Any> = [];
+                for (_ in 0...readVarInt()) {
+                    array.push(readValue());
+                }
+                array;
+            case OBJECT:
+                final object:Dynamic = {};
+                for (_ in 0...readVarInt()) {
+                    final key = readString();
+                    Reflect.setField(object, key, readValue());
+                }
+                object;
+            case _:
+                throw new Error("Invalid value kind in compiled script: " + (kind:Int));
+        }
+
+    }
+
+    inline function readBool():Bool {
+
+        return readByte() != 0;
+
+    }
+
+    function readPosition():Position {
+
+        final line = readVarInt();
+        final column = readVarInt();
+        final offset = readVarInt();
+        final length = readVarInt();
+        return new Position(line, column, offset, length);
+
+    }
+
+    function readNodeId():NodeId {
+
+        final section = readVarInt();
+        final branch = readVarInt();
+        final block = readVarInt();
+        final node = readVarInt();
+        return new NodeId(section, branch, block, node);
+
+    }
+
+    function readString():String {
+
+        final ref = readVarInt();
+        if (ref == 0) return null;
+        if (ref >= 2) {
+            final index = ref - 2;
+            if (index >= strings.length) {
+                throw new Error("Invalid string reference in compiled script");
+            }
+            return strings[index];
+        }
+
+        final length = readVarInt();
+        if (pos + length > bytes.length) {
+            throw new Error("Truncated compiled script");
+        }
+        final str = bytes.getString(pos, length, Encoding.UTF8);
+        pos += length;
+        strings.push(str);
+        return str;
+
+    }
+
+    function readZigZag():Int {
+
+        final value = readVarInt();
+        return (value >>> 1) ^ -(value & 1);
+
+    }
+
+    function readVarInt():Int {
+
+        var result = 0;
+        var shift = 0;
+        while (true) {
+            final byte = readByte();
+            result |= (byte & 0x7F) << shift;
+            if (byte & 0x80 == 0) break;
+            shift += 7;
+            if (shift > 28) {
+                throw new Error("Invalid varint in compiled script");
+            }
+        }
+        return result;
+
+    }
+
+    inline function readByte():Int {
+
+        if (pos >= bytes.length) {
+            throw new Error("Truncated compiled script");
+        }
+        return bytes.get(pos++);
+
+    }
+
+}
@@ -0,0 +1,203 @@
+package loreline;
+
+import loreline.Node;
+
+/**
+ * Field layout shared by every object created from the same declaration:
+ * the declared field names, in order, and the slot each of them is stored at.
+ */
+class FieldShape {
+
+    /**
+     * Field names, by slot.
+     */
+    public final names:Array<String> = [];
+
+    final slots:Map<String, Int> = new Map();
+
+    public function new(names:Array<String>) {
+
+        for (name in names) {
+            if (!slots.exists(name)) {
+                slots.set(name, this.names.length);
+                this.names.push(name);
+            }
+        }
+
+    }
+
+    /**
+     * Returns the slot of the given field, or -1 if it is not part of the shape.
+     */
+    public inline function slot(name:String):Int {
+
+        final index = slots.get(name);
+        return index != null ? index : -1;
+
+    }
+
+    /**
+     * Builds the shape of the objects created from the given node: the fields of
+     * a character declaration, of a state declaration, or of every top level state
+     * declaration of a script. Returns null for other nodes.
+     *
+     * @param node The declaration node
+     * @return The shape, or null if the node doesn't declare fields
+     */
+    public static function ofNode(node:Node):Null<FieldShape> {
+
+        if (node is NCharacterDecl) {
+            return new FieldShape([for (field in (cast node:NCharacterDecl).fields) field.name]);
+        }
+        else if (node is NStateDecl) {
+            return new FieldShape([for (field in (cast node:NStateDecl).fields) field.name]);
+        }
+        else if (node is Script) {
+            final names:Array<String> = [];
+            for (decl in (cast node:Script)) {
+                if (decl is NStateDecl) {
+                    for (field in (cast decl:NStateDecl).fields) {
+                        names.push(field.name);
+                    }
+                }
+            }
+            return new FieldShape(names);
+        }
+
+        return null;
+
+    }
+
+}
+
+/**
+ * Field storage of states and characters, laid out by a `FieldShape`.
+ *
+ * Declared fields are stored in an array indexed by their slot in the shape,
+ * which is shared with every other state created from the same declaration.
+ * Fields added at runtime that are not part of the shape go to a map, only
+ * created when needed. The API mirrors `StringMap` so that hosts reading
+ * fields returned by `Interpreter.getCharacter()` don't see a difference.
+ */
+class ShapedFields {
+
+    static final ABSENT:Any = new ShapedFieldsAbsent();
+
+    /**
+     * The shape of these fields.
+     */
+    public final shape:FieldShape;
+
+    final values:Array<Any>;
+
+    var extra:Map<String, Any> = null;
+
+    public function new(shape:FieldShape) {
+
+        this.shape = shape;
+        this.values = [for (_ in 0...shape.names.length) ABSENT];
+
+    }
+
+    public function get(name:String):Any {
+
+        final slot = shape.slot(name);
+        if (slot != -1) {
+            final value = values[slot];
+            return value != ABSENT ? value : null;
+        }
+        return extra?.get(name);
+
+    }
+
+    public function set(name:String, value:Any):Void {
+
+        final slot = shape.slot(name);
+        if (slot != -1) {
+            values[slot] = value;
+        }
+        else {
+            if (extra == null) extra = new Map();
+            extra.set(name, value);
+        }
+
+    }
+
+    public function exists(name:String):Bool {
+
+        final slot = shape.slot(name);
+        if (slot != -1) {
+            return values[slot] != ABSENT;
+        }
+        return extra != null && extra.exists(name);
+
+    }
+
+    public function remove(name:String):Bool {
+
+        final slot = shape.slot(name);
+        if (slot != -1) {
+            final existed = values[slot] != ABSENT;
+            values[slot] = ABSENT;
+            return existed;
+        }
+        return extra != null && extra.remove(name);
+
+    }
+
+    /**
+     * Returns the names of the fields that are set: declared fields first,
+     * in declaration order, then fields added at runtime.
+     */
+    public function keys():Array<String> {
+
+        final result:Array<String> = [];
+        for (i in 0...values.length) {
+            if (values[i] != ABSENT) {
+                result.push(shape.names[i]);
+            }
+        }
+        if (extra != null) {
+            for (key in extra.keys()) {
+                result.push(key);
+            }
+        }
+        return result;
+
+    }
+
+    /**
+     * Tells whether a value is set at the given slot of the shape.
+     */
+    public inline function existsAt(slot:Int):Bool {
+
+        return values[slot] != ABSENT;
+
+    }
+
+    /**
+     * Returns the value at the given slot of the shape, or null if it is not set.
+     */
+    public inline function getAt(slot:Int):Any {
+
+        final value = values[slot];
+        return value != ABSENT ? value : null;
+
+    }
+
+    /**
+     * Sets the value at the given slot of the shape.
+     */
+    public inline function setAt(slot:Int, value:Any):Void {
+
+        values[slot] = value;
+
+    }
+
+}
+
+private class ShapedFieldsAbsent {
+
+    public function new() {}
+
+}
@@ -0,0 +1,610 @@
+package loreline;
+
+import loreline.Interpreter;
+import loreline.Node;
+
+/**
+ * How choices are picked during a simulation.
+ */
+enum abstract SimulationPolicy(String) from String to String {
+
+    /**
+     * Picks one of the enabled options at random.
+     */
+    var Random = "random";
+
+    /**
+     * Picks one of the enabled options at random, favouring the ones taken
+     * the least so far, so that rare branches get explored sooner.
+     */
+    var Weighted = "weighted";
+
+    /**
+     * Explores every combination of choices depth first, one path per run,
+     * until every path has been played or the number of runs is reached.
+     */
+    var Exhaustive = "exhaustive";
+
+}
+
+/**
+ * How a simulated playthrough ended.
+ */
+enum abstract SimulationEnd(String) to String {
+
+    /**
+     * The script reached its end.
+     */
+    var Finished = "finished";
+
+    /**
+     * A choice was presented without any enabled option.
+     */
+    var DeadEnd = "deadEnd";
+
+    /**
+     * The playthrough reached the maximum number of steps, likely stuck in a loop.
+     */
+    var StepLimit = "stepLimit";
+
+    /**
+     * The script is waiting for an asynchronous function that never completed.
+     */
+    var Suspended = "suspended";
+
+    /**
+     * The script threw an error.
+     */
+    var Failed = "error";
+
+}
+
+/**
+ * Aggregated counts of a choice option over a simulation.
+ */
+@:structInit
+class SimulationChoice {
+
+    /**
+     * The choice option node.
+     */
+    public var node:NChoiceOption;
+
+    /**
+     * Text of the option, as it was displayed the first time.
+     */
+    public var text:String;
+
+    /**
+     * Number of times the option was presented while enabled.
+     */
+    public var offered:Int = 0;
+
+    /**
+     * Number of times the option was taken.
+     */
+    public var taken:Int = 0;
+
+}
+
+/**
+ * Aggregated results of a simulation.
+ */
+class SimulationStats {
+
+    /**
+     * The policy used to pick choices.
+     */
+    public final policy:SimulationPolicy;
+
+    /**
+     * The seed of the simulation.
+     */
+    public final seed:Int;
+
+    /**
+     * Every beat of the script (including imported ones), in script order.
+     */
+    public final beats:Array<NBeatDecl>;
+
+    /**
+     * Number of playthroughs run.
+     */
+    public var runs:Int = 0;
+
+    /**
+     * Number of playthroughs by way they ended.
+     */
+    public final endings:Map<String,Int> = new Map();
+
+    /**
+     * Dead ends, by line of the choice with no enabled option.
+     */
+    public final deadEnds:Map<Int,Int> = new Map();
+
+    /**
+     * Errors, by message.
+     */
+    public final errors:Map<String,Int> = new Map();
+
+    /**
+     * Whether an exhaustive simulation has explored every path.
+     */
+    public var exhausted:Bool = false;
+
+    /**
+     * Total number of dialogues and choices, over every playthrough.
+     */
+    public var steps:Int = 0;
+
+    /**
+     * Number of steps of the shortest playthrough.
+     */
+    public var minSteps:Int = -1;
+
+    /**
+     * Number of steps of the longest playthrough.
+     */
+    public var maxSteps:Int = 0;
+
+    /**
+     * Total visits of each beat, in the order of `beats`.
+     */
+    public final beatVisits:Array<Int>;
+
+    /**
+     * Number of playthroughs that visited each beat, in the order of `beats`.
+     */
+    public final beatRuns:Array<Int>;
+
+    /**
+     * Choice options, in the order they were first presented.
+     */
+    public final choices:Array<SimulationChoice> = [];
+
+    final choiceIndexes:NodeIdMap<Int> = new NodeIdMap();
+
+    public function new(policy:SimulationPolicy, seed:Int, beats:Array<NBeatDecl>) {
+
+        this.policy = policy;
+        this.seed = seed;
+        this.beats = beats;
+        this.beatVisits = [for (_ in beats) 0];
+        this.beatRuns = [for (_ in beats) 0];
+
+    }
+
+    /**
+     * Returns the counts of a choice option, creating them if needed.
+     */
+    public function choice(option:ChoiceOption):SimulationChoice {
+
+        final node = @:privateAccess option.node;
+        final index = choiceIndexes.get(node.id);
+        if (index != null) return choices[index];
+
+        final result:SimulationChoice = { node: node, text: option.text };
+        choiceIndexes.set(node.id, choices.length);
+        choices.push(result);
+        return result;
+
+    }
+
+    /**
+     * Adds the results of another simulation of the same script.
+     */
+    public function merge(other:SimulationStats):Void {
+
+        runs += other.runs;
+        steps += other.steps;
+        if (other.minSteps != -1 && (minSteps == -1 || other.minSteps < minSteps)) minSteps = other.minSteps;
+        if (other.maxSteps > maxSteps) maxSteps = other.maxSteps;
+        exhausted = exhausted || other.exhausted;
+
+        for (key => count in other.endings) endings.set(key, (endings.get(key) ?? 0) + count);
+        for (key => count in other.deadEnds) deadEnds.set(key, (deadEnds.get(key) ?? 0) + count);
+        for (key => count in other.errors) errors.set(key, (errors.get(key) ?? 0) + count);
+
+        for (i in 0...beats.length) {
+            beatVisits[i] += other.beatVisits[i];
+            beatRuns[i] += other.beatRuns[i];
+        }
+
+        for (otherChoice in other.choices) {
+            final index = choiceIndexes.get(otherChoice.node.id);
+            if (index != null) {
+                choices[index].offered += otherChoice.offered;
+                choices[index].taken += otherChoice.taken;
+            }
+            else {
+                choiceIndexes.set(otherChoice.node.id, choices.length);
+                choices.push({
+                    node: otherChoice.node,
+                    text: otherChoice.text,
+                    offered: otherChoice.offered,
+                    taken: otherChoice.taken
+                });
+            }
+        }
+
+    }
+
+    /**
+     * Returns the results as a JSON-compatible object.
+     */
+    public function toJson():Dynamic {
+
+        final endingsJson:Dynamic = {};
+        for (end in [SimulationEnd.Finished, SimulationEnd.DeadEnd, SimulationEnd.StepLimit, SimulationEnd.Suspended, SimulationEnd.Failed]) {
+            Reflect.setField(endingsJson, end, endings.get(end) ?? 0);
+        }
+
+        final deadEndLines = [for (line in deadEnds.keys()) line];
+        deadEndLines.sort((a, b) -> a - b);
+
+        final errorsJson:Dynamic = {};
+        for (message => count in errors) {
+            Reflect.setField(errorsJson, message, count);
+        }
+
+        final beatsJson:Array<Dynamic> = [];
+        final unvisitedBeats:Array<String> = [];
+        for (i in 0...beats.length) {
+            beatsJson.push({
+                name: beats[i].name,
+                line: beats[i].pos.line,
+                visits: beatVisits[i],
+                runs: beatRuns[i]
+            });
+            if (beatVisits[i] == 0) {
+                unvisitedBeats.push(beats[i].name);
+            }
+        }
+
+        final sortedChoices = choices.copy();
+        sortedChoices.sort((a, b) -> a.node.pos.offset - b.node.pos.offset);
+
+        return {
+            policy: (policy:String),
+            seed: seed,
+            runs: runs,
+            exhausted: exhausted,
+            endings: endingsJson,
+            deadEnds: [for (line in deadEndLines) { line: line, count: deadEnds.get(line) }],
+            errors: errorsJson,
+            steps: {
+                total: steps,
+                min: minSteps == -1 ? 0 : minSteps,
+                max: maxSteps,
+                average: runs > 0 ? Math.round(steps * 100 / runs) / 100 : 0
+            },
+            beats: beatsJson,
+            unvisitedBeats: unvisitedBeats,
+            choices: [for (c in sortedChoices) {
+                line: c.node.pos.line,
+                text: c.text,
+                offered: c.offered,
+                taken: c.taken
+            }],
+            untakenChoices: [for (c in sortedChoices) if (c.taken == 0) c.text]
+        };
+
+    }
+
+}
+
+/**
+ * Plays a script many times without a host, picking choices with a built-in
+ * policy, to find dead ends, unreachable beats and errors.
+ *
+ * Dialogues are skipped as soon as they are delivered and `wait()` returns
+ * immediately. Text is still evaluated, as interpolated expressions can have
+ * side effects. Built-in random functions are seeded per playthrough, so a
+ * simulation with the same seed, policy and threads always gives the same results.
+ *
+ * Random and weighted simulations can split their playthroughs across threads
+ * on threaded targets. Each thread keeps its own counts, which are merged at the
+ * end: weighted choices only see the counts of their thread, so their results
+ * depend on the number of threads as well. Exhaustive simulations follow one path
+ * after the other and always run on a single thread.
+ */
+@:access(loreline.Interpreter)
+class Simulator {
+
+    /**
+     * Simulates playthroughs of a script.
+     *
+     * @param script The parsed script to simulate
+     * @param policy How choices are picked
+     * @param runs Number of playthroughs (maximum number for an exhaustive simulation)
+     * @param seed Seed of choices and built-in random functions
+     * @param threads Number of threads to split playthroughs across
+     * @param maxSteps Maximum number of dialogues and choices of a playthrough
+     * @param beatName Optional name of the beat to start from
+     * @return The aggregated results
+     */
+    public static function simulate(script:Script, policy:SimulationPolicy, runs:Int, seed:Int, threads:Int = 1, maxSteps:Int = 10000, ?beatName:String):SimulationStats {
+
+        if (policy != SimulationPolicy.Random && policy != SimulationPolicy.Weighted && policy != SimulationPolicy.Exhaustive) {
+            throw new Error('Invalid simulation policy: $policy', script.pos);
+        }
+
+        // Interpreters of every thread share the same prepared data
+        final prepared = PreparedScript.prepare(script);
+        final beats = prepared.lens.getNodesOfType(NBeatDecl, true);
+
+        if (policy == SimulationPolicy.Exhaustive || threads <= 1 || runs <= 1) {
+            final simulator = new Simulator(script, policy, seed, beats, maxSteps, beatName);
+            simulator.simulateRuns(0, runs, 1);
+            return simulator.stats;
+        }
+
+        #if target.threaded
+        if (threads > runs) threads = runs;
+
+        final results = new sys.thread.Deque<Any>();
+        for (t in 0...threads) {
+            sys.thread.Thread.create(() -> {
+                try {
+                    final simulator = new Simulator(script, policy, seed, beats, maxSteps, beatName);
+                    simulator.simulateRuns(t, runs, threads);
+                    results.add(simulator.stats);
+                }
+                catch (e:Any) {
+                    results.add(new Error('Simulation thread failed: $e', script.pos));
+                }
+            });
+        }
+
+        final stats = new SimulationStats(policy, seed, beats);
+        var error:Error = null;
+        for (_ in 0...threads) {
+            final result:Any = results.pop(true);
+            if (result is Error) {
+                error = result;
+            }
+            else {
+                stats.merge(result);
+            }
+        }
+        if (error != null) throw error;
+
+        return stats;
+        #else
+        final simulator = new Simulator(script, policy, seed, beats, maxSteps, beatName);
+        simulator.simulateRuns(0, runs, 1);
+        return simulator.stats;
+        #end
+
+    }
+
+    final script:Script;
+
+    final policy:SimulationPolicy;
+
+    final seed:Int;
+
+    final beats:Array<NBeatDecl>;
+
+    final maxSteps:Int;
+
+    final beatName:Null<String>;
+
+    final stats:SimulationStats;
+
+    final instantWait:Any;
+
+    /**
+     * Random numbers of the current playthrough.
+     */
+    var random:loreline.Random = null;
+
+    /**
+     * How the current playthrough ended, if it did.
+     */
+    var end:Null<SimulationEnd> = null;
+
+    /**
+     * Number of dialogues and choices of the current playthrough.
+     */
+    var runSteps:Int = 0;
+
+    /**
+     * Exhaustive simulation: option taken at each choice of the current path,
+     * as an index among the enabled options.
+     */
+    final path:Array<Int> = [];
+
+    /**
+     * Exhaustive simulation: number of enabled options at each choice of the current path.
+     */
+    final pathOptions:Array<Int> = [];
+
+    /**
+     * Exhaustive simulation: number of choices made in the current playthrough.
+     */
+    var depth:Int = 0;
+
+    function new(script:Script, policy:SimulationPolicy, seed:Int, beats:Array<NBeatDecl>, maxSteps:Int, beatName:Null<String>) {
+
+        this.script = script;
+        this.policy = policy;
+        this.seed = seed;
+        this.beats = beats;
+        this.maxSteps = maxSteps;
+        this.beatName = beatName;
+        this.stats = new SimulationStats(policy, seed, beats);
+        this.instantWait = (seconds:Float) -> new Async(done -> done());
+
+    }
+
+    /**
+     * Runs the playthroughs `first`, `first + step`, `first + 2 * step`... below `runs`.
+     */
+    function simulateRuns(first:Int, runs:Int, step:Int):Void {
+
+        var run = first;
+        while (run < runs) {
+            playthrough(run);
+            if (policy == SimulationPolicy.Exhaustive && !nextPath()) {
+                stats.exhausted = true;
+                break;
+            }
+            run += step;
+        }
+
+    }
+
+    function playthrough(run:Int):Void {
+
+        final runSeed = 1 + Math.abs((seed * 1000003.0 + run) % 2147483646.0);
+        random = new loreline.Random(runSeed);
+        end = null;
+        runSteps = 0;
+        depth = 0;
+
+        var finished = false;
+        final interpreter = new Interpreter(script, handleDialogue, handleChoice, _ -> finished = true);
+        interpreter.topLevelFunctions.set("wait", instantWait);
+        interpreter.builtins.seed_random(runSeed);
+
+        try {
+            interpreter.start(beatName);
+            if (end == null) {
+                end = finished ? SimulationEnd.Finished : SimulationEnd.Suspended;
+            }
+        }
+        catch (e:Any) {
+            end = SimulationEnd.Failed;
+            final message = if (e is Error) {
+                final error:Error = e;
+                error.pos != null ? '${error.message} (line ${error.pos.line})' : error.message;
+            }
+            else {
+                Std.string(e);
+            }
+            stats.errors.set(message, (stats.errors.get(message) ?? 0) + 1);
+        }
+
+        stats.runs++;
+        stats.endings.set(end, (stats.endings.get(end) ?? 0) + 1);
+        stats.steps += runSteps;
+        if (stats.minSteps == -1 || runSteps < stats.minSteps) stats.minSteps = runSteps;
+        if (runSteps > stats.maxSteps) stats.maxSteps = runSteps;
+
+        for (i in 0...beats.length) {
+            final visits = interpreter.getBeatVisitCount(beats[i]);
+            if (visits > 0) {
+                stats.beatVisits[i] += visits;
+                stats.beatRuns[i]++;
+            }
+        }
+
+    }
+
+    function handleDialogue(interpreter:Interpreter, character:String, text:String, tags:Array<TextTag>, callback:()->Void):Void {
+
+        if (++runSteps > maxSteps) {
+            runSteps--;
+            end = SimulationEnd.StepLimit;
+            return;
+        }
+
+        callback();
+
+    }
+
+    function handleChoice(interpreter:Interpreter, options:Array<ChoiceOption>, callback:(index:Int)->Void):Void {
+
+        if (++runSteps > maxSteps) {
+            runSteps--;
+            end = SimulationEnd.StepLimit;
+            return;
+        }
+
+        final enabled:Array<Int> = [];
+        for (i in 0...options.length) {
+            if (options[i].enabled) {
+                enabled.push(i);
+                stats.choice(options[i]).offered++;
+            }
+        }
+
+        if (enabled.length == 0) {
+            end = SimulationEnd.DeadEnd;
+            final node = interpreter.currentNode();
+            final line = node != null ? node.pos.line : 0;
+            stats.deadEnds.set(line, (stats.deadEnds.get(line) ?? 0) + 1);
+            return;
+        }
+
+        final index = enabled[pick(options, enabled)];
+        stats.choice(options[index]).taken++;
+
+        callback(index);
+
+    }
+
+    /**
+     * Returns the position, in `enabled`, of the option to take.
+     */
+    function pick(options:Array<ChoiceOption>, enabled:Array<Int>):Int {
+
+        switch policy {
+
+            case Weighted:
+                var total = 0.0;
+                final weights = [for (i in enabled) {
+                    final weight = 1.0 / (1 + stats.choice(options[i]).taken);
+                    total += weight;
+                    weight;
+                }];
+                var target = random.next() * total;
+                for (i in 0...weights.length) {
+                    target -= weights[i];
+                    if (target < 0) return i;
+                }
+                return weights.length - 1;
+
+            case Exhaustive:
+                if (depth < path.length) {
+                    // Random functions of the script can change the options: stay in range
+                    final index = path[depth] < enabled.length ? path[depth] : enabled.length - 1;
+                    pathOptions[depth] = enabled.length;
+                    depth++;
+                    return index;
+                }
+                path.push(0);
+                pathOptions.push(enabled.length);
+                depth++;
+                return 0;
+
+            case _:
+                return random.between(0, enabled.length);
+        }
+
+    }
+
+    /**
+     * Moves to the next path of an exhaustive simulation.
+     * @return `false` if every path has been explored
+     */
+    function nextPath():Bool {
+
+        // Choices of the previous path that were not reached anymore are dropped
+        path.resize(depth);
+        pathOptions.resize(depth);
+
+        while (path.length > 0 && path[path.length - 1] + 1 >= pathOptions[pathOptions.length - 1]) {
+            path.pop();
+            pathOptions.pop();
+        }
+
+        if (path.length == 0) return false;
+
+        path[path.length - 1]++;
+        return true;
+
+    }
+
+}
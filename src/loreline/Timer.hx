@@ -18,7 +18,27 @@ private class PendingTimer {
  */
 class Timer {
 
+    #if (cpp && loreline_cpp_lib)
+    /**
+     * Pending timers of the current thread. The native library can run
+     * interpreters on several worker threads: each worker ticks its own
+     * timers so that a wait() always resumes on the thread that started it.
+     */
+    static final threadTimers:sys.thread.Tls<Array<PendingTimer>> = new sys.thread.Tls();
+
+    static var timers(get, never):Array<PendingTimer>;
+
+    static function get_timers():Array<PendingTimer> {
+        var result = threadTimers.value;
+        if (result == null) {
+            result = [];
+            threadTimers.value = result;
+        }
+        return result;
+    }
+    #else
     static var timers:Array<PendingTimer> = [];
+    #end
 
     #if sys
     /**
@@ -56,6 +76,7 @@ class Timer {
         #if sys
         deferredMode = true;
         #end
+        final timers = Timer.timers;
         if (timers.length == 0) return;
         var i = timers.length;
         while (--i >= 0) {
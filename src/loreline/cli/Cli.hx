@@ -8,6 +8,8 @@ import loreline.AstUtils;
 import loreline.Error;
 import loreline.Interpreter;
 import loreline.Lens;
+import loreline.Lexer;
+import loreline.Simulator;
 import loreline.test.TestCase;
 import loreline.test.TestRunner;
 import sys.FileSystem;
@@ -100,7 +102,7 @@ class Cli {
 
                 case 'play':
                     if (args.length >= 2)
-                        play(args[1]);
+                        play(args[1], argFlag(args, 'profile'));
                     else
                         fail('Missing file argument');
 
@@ -140,6 +142,21 @@ class Cli {
                     else
                         fail('Missing file argument');
 
+                case 'simulate':
+                    if (args.length >= 2)
+                        simulate(args[1], args);
+                    else
+                        fail('Missing file argument');
+
+                case 'compile':
+                    if (args.length >= 2)
+                        compile(args[1], args);
+                    else
+                        fail('Missing file argument');
+
+                case 'bench-lexer':
+                    benchLexer(args.length >= 2 && !args[1].startsWith('--') ? args[1] : 'test', args);
+
                 case _:
                     help();
             }
@@ -159,7 +176,7 @@ class Cli {
         print(" |_|\\___/|_|  \\___|_|_|_| |_|\\___|".green());
         print("");
         print(" " + "USAGE".bold());
-        print(" loreline " + "[".gray() + "play" + "|".gray() + "json" + "|".gray() + "ast" + "|".gray() + "format" + "|".gray() + "translate" + "]".gray() + " " + "story.lor".underline());
+        print(" loreline " + "[".gray() + "play" + "|".gray() + "json" + "|".gray() + "ast" + "|".gray() + "format" + "|".gray() + "translate" + "|".gray() + "simulate" + "|".gray() + "compile" + "]".gray() + " " + "story.lor".underline());
         print("");
 
     }
@@ -202,6 +219,35 @@ class Cli {
 
     }
 
+    function compile(file:String, args:Array<String>) {
+
+        if (!FileSystem.exists(file) || FileSystem.isDirectory(file)) {
+            fail('Invalid file: $file');
+        }
+
+        final output = argValue(args, 'output') ?? Path.withExtension(file, 'lorc');
+
+        try {
+            final content = File.getContent(file);
+            final script = Loreline.parse(content, file, handleFile);
+            File.saveBytes(output, script.toBinary());
+            print('Compiled script created: ' + output);
+        }
+        catch (e:Any) {
+            #if debug
+            if (e is Error) {
+                printStackTrace(false, (e:Error).stack);
+                error((e:Error).toString());
+            }
+            else {
+                printStackTrace(false, CallStack.exceptionStack());
+            }
+            #end
+            fail(e, file);
+        }
+
+    }
+
     function ast(file:String) {
 
         if (!FileSystem.exists(file) || FileSystem.isDirectory(file)) {
@@ -293,6 +339,8 @@ class Cli {
      *      - every file under `<test>/expected/` exists in the workspace and
      *        matches byte-for-byte
      *      - every path in `spec.expectMissing` does NOT exist in the workspace
+     *      - every path in `spec.expectExists` exists in the workspace (for
+     *        outputs that can't be compared byte-for-byte, like binary files)
      *   5. On pass, deletes the workspace. On failure, keeps it so the
      *      developer can inspect the actual outputs.
      */
@@ -400,6 +448,10 @@ class Cli {
             ? cast spec.expectMissing
             : [];
         final expectMissing = [for (p in expectMissingRaw) Std.string(p)];
+        final expectExistsRaw:Array<Dynamic> = (spec.expectExists != null && (spec.expectExists is Array))
+            ? cast spec.expectExists
+            : [];
+        final expectExists = [for (p in expectExistsRaw) Std.string(p)];
 
         // Spawn the CLI: `neko <abs-run.n> <spec.args...> <workspace>`.
         // Trailing workspace is the cwd-switch convention used by Cli.main.
@@ -455,6 +507,14 @@ class Cli {
             }
         }
 
+        // Verify expectExists.
+        for (rel in expectExists) {
+            final p = Path.join([workspace, rel]);
+            if (!FileSystem.exists(p)) {
+                failures.push('file expected to exist but is missing: $rel');
+            }
+        }
+
         // Verify expectMissing.
         for (rel in expectMissing) {
             final p = Path.join([workspace, rel]);
@@ -718,6 +778,9 @@ class Cli {
             // JSON round-trip test: toJson → fromJson → toJson must be stable
             testJsonRoundTrip(script, file, crlf);
 
+            // Compiled round-trip test: toBinary → fromBinary must give the same AST
+            testBinaryRoundTrip(script, file, crlf);
+
             // AST printer smoke test: print must not throw
             testAstPrint(script, file, crlf);
         }
@@ -870,6 +933,35 @@ class Cli {
         }
     }
 
+    function testBinaryRoundTrip(script:Script, file:String, crlf:Bool) {
+        final modeLabel = crlf ? 'CRLF' : 'LF';
+        try {
+            // toJson of the parsed script and of the script loaded back from its compiled image
+            final json1 = Json.stringify(script.toJson());
+            final bytes1 = script.toBinary();
+            final script2 = Script.fromBinary(bytes1);
+            final json2 = Json.stringify(script2.toJson());
+
+            // Encoding the loaded script again also writes back the function code it decoded
+            final bytes2 = script2.toBinary();
+
+            if (json1 == json2 && bytes1.compare(bytes2) == 0) {
+                passCount++;
+                print('PASS'.green().bold() + ' - ' + file.gray() + ' ~ '.gray() + modeLabel.gray() + ' ~ '.gray() + 'binary-roundtrip'.gray());
+            } else {
+                failCount++;
+                hasFailedTest = true;
+                print('FAIL'.red().bold() + ' - ' + file.gray() + ' ~ '.gray() + modeLabel.gray() + ' ~ '.gray() + 'binary-roundtrip'.gray());
+                print(json1 != json2 ? '> AST differs after loading the compiled script' : '> Function code differs after loading the compiled script');
+                print('');
+            }
+        } catch (e:Any) {
+            failCount++;
+            hasFailedTest = true;
+            print('FAIL'.red().bold() + ' - binary-roundtrip error: $e - ' + file.gray() + ' ~ '.gray() + modeLabel.gray() + ' ~ '.gray() + 'binary-roundtrip'.gray());
+        }
+    }
+
     /**
      * Smoke-test that AstPrinter handles every node type encountered in real
      * `.lor` scripts (the default switch case throws on an unhandled type).
@@ -1024,7 +1116,63 @@ class Cli {
         }
     }
 
-    function play(file:String) {
+    /**
+     * Measures lexer throughput (in MB/s) over a .lor file or every .lor file of a directory.
+     * Files are read once up front so that only tokenization is timed.
+     */
+    function benchLexer(path:String, args:Array<String>) {
+
+        final iterations = Std.parseInt(argValue(args, 'iterations') ?? '20') ?? 20;
+
+        final files:Array<String> = [];
+        if (FileSystem.exists(path) && FileSystem.isDirectory(path)) {
+            for (file in FileSystem.readDirectory(path)) {
+                if (file.endsWith('.lor')) {
+                    files.push(Path.join([path, file]));
+                }
+            }
+        }
+        else if (FileSystem.exists(path)) {
+            files.push(path);
+        }
+        else {
+            fail('Invalid path: $path');
+        }
+
+        // Warm up, and leave out files the lexer rejects
+        final contents:Array<String> = [];
+        var bytes = 0;
+        for (file in files) {
+            final content = File.getContent(file);
+            try {
+                new Lexer(content).tokenize();
+                contents.push(content);
+                bytes += haxe.io.Bytes.ofString(content).length;
+            }
+            catch (e:Any) {
+                error(e, file);
+            }
+        }
+
+        if (bytes == 0) {
+            fail('No input to lex in: $path');
+        }
+
+        final start = haxe.Timer.stamp();
+        for (_ in 0...iterations) {
+            for (content in contents) {
+                new Lexer(content).tokenize();
+            }
+        }
+        final elapsed = haxe.Timer.stamp() - start;
+
+        final megabytes = (bytes * iterations) / (1024 * 1024);
+        print('${contents.length} files, ${bytes} bytes, $iterations iterations');
+        print('${Math.round(elapsed * 1000)}ms, ' + (Math.round(megabytes / elapsed * 100) / 100) + ' MB/s');
+
+    }
+
+    function play(file:String, profile:Bool = false) {
 
         print("");
 
@@ -1039,12 +1187,18 @@ class Cli {
 
             errorInStdOut = true;
 
+            // Each interpreter created from now on gets its own profiler
+            Profiler.enabled = profile;
+
             Loreline.play(
                 script,
                 handleDialogue,
                 handleChoice,
-                _ -> {
+                interpreter -> {
                     // Finished script execution
+                    if (interpreter.profiler != null) {
+                        print(interpreter.profiler.report().gray());
+                    }
                 }
             );
         }
@@ -1063,6 +1217,74 @@ class Cli {
 
     }
 
+    function simulate(file:String, args:Array<String>) {
+
+        if (!FileSystem.exists(file) || FileSystem.isDirectory(file)) {
+            fail('Invalid file: $file');
+        }
+
+        final policy:SimulationPolicy = argValue(args, 'policy') ?? SimulationPolicy.Random;
+        final runs = Std.parseInt(argValue(args, 'runs') ?? '1000') ?? 1000;
+        final seed = Std.parseInt(argValue(args, 'seed') ?? '1') ?? 1;
+        final threads = Std.parseInt(argValue(args, 'threads') ?? '1') ?? 1;
+        final maxSteps = Std.parseInt(argValue(args, 'max-steps') ?? '10000') ?? 10000;
+        final beatName = argValue(args, 'beat');
+
+        try {
+            final content = File.getContent(file);
+            final script = Loreline.parse(content, file, handleFile);
+
+            final stats = Loreline.simulate(script, policy, runs, seed, threads, maxSteps, beatName);
+            final result:Dynamic = stats.toJson();
+
+            if (argFlag(args, 'json')) {
+                print(Json.stringify(result, null, '  '));
+                return;
+            }
+
+            print('');
+            print(' ' + 'Runs'.bold() + ' ' + result.runs + (stats.exhausted ? ' (every path explored)'.gray() : ''));
+            print(' ' + 'Endings'.bold());
+            for (end in Reflect.fields(result.endings)) {
+                final count:Int = Reflect.field(result.endings, end);
+                if (count > 0) print('   ' + end + ': ' + count);
+            }
+            for (deadEnd in (result.deadEnds:Array<Dynamic>)) {
+                print(('   dead end at line ' + deadEnd.line + ': ' + deadEnd.count).yellow());
+            }
+            for (message in Reflect.fields(result.errors)) {
+                print(('   ' + message + ': ' + Reflect.field(result.errors, message)).red());
+            }
+            print(' ' + 'Steps'.bold() + ' min ' + result.steps.min + ', max ' + result.steps.max + ', average ' + result.steps.average);
+
+            final unvisited:Array<String> = result.unvisitedBeats;
+            print(' ' + 'Beats'.bold() + ' ' + (stats.beats.length - unvisited.length) + '/' + stats.beats.length + ' visited');
+            for (name in unvisited) {
+                print(('   never visited: ' + name).yellow());
+            }
+
+            final untaken:Array<String> = result.untakenChoices;
+            print(' ' + 'Choices'.bold() + ' ' + (stats.choices.length - untaken.length) + '/' + stats.choices.length + ' offered options taken');
+            for (text in untaken) {
+                print(('   never taken: ' + text).yellow());
+            }
+            print('');
+        }
+        catch (e:Any) {
+            #if debug
+            if (e is Error) {
+                printStackTrace(false, (e:Error).stack);
+                error((e:Error).toString());
+            }
+            else {
+                printStackTrace(false, CallStack.exceptionStack());
+            }
+            #end
+            fail(e, file);
+        }
+
+    }
+
     function handleDialogue(interpreter:Interpreter, character:String, text:String, tags:Array<TextTag>, callback:()->Void):Void {
 
         final multiline = text.contains("\n");
@@ -11,25 +11,43 @@
 
 #include <hxcpp.h>
 #include <loreline/Script.h>
+#include <loreline/PreparedScript.h>
+#include <loreline/ParseCache.h>
+#include <loreline/ParseCacheEntry.h>
+#include <loreline/Imports.h>
 #include <loreline/Interpreter.h>
 #include <loreline/Loreline.h>
+#include <loreline/Objects.h>
 #include <loreline/Error.h>
 #include <loreline/Json.h>
+#include <loreline/SaveBinary.h>
+#include <loreline/ScriptBinary.h>
+#include <loreline/SaveDelta.h>
 #include <loreline/InterpreterOptions.h>
+#include <loreline/Profiler.h>
+#include <loreline/Simulator.h>
+#include <loreline/SimulationStats.h>
 #include <loreline/Timer.h>
 #include <loreline/Async.h>
 #include <haxe/ds/StringMap.h>
+#include <haxe/io/Bytes.h>
 #include <Reflect.h>
 #include "Loreline.h"
 
 #include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <functional>
 #include <mutex>
+#include <new>
 #include <condition_variable>
 #include <queue>
 #include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 /* ── hxcpp runtime entry points ─────────────────────────────────────────── */
@@ -42,30 +60,63 @@ extern "C" const char* hxRunLibrary();
 struct Loreline_StringData {
     std::atomic<int> refCount;
     size_t len;
+    size_t capacity;   /* bytes available in data, excluding the NUL */
+    const char* chars; /* data, or a borrowed hxcpp string buffer */
+    hx::Object* root;  /* GC root keeping a borrowed buffer alive, NULL if owned */
     char data[1]; /* flexible array member */
 };
 
-static Loreline_StringData* linc_createStringData(const char* s, size_t len) {
+static Loreline_StringData* linc_createStringData(const char* s, size_t len, size_t capacity = 0) {
     if (!s) return nullptr;
+    if (capacity < len) capacity = len;
     Loreline_StringData* d = (Loreline_StringData*)malloc(
-        sizeof(Loreline_StringData) + len);
+        sizeof(Loreline_StringData) + capacity);
     d->refCount.store(1, std::memory_order_relaxed);
     d->len = len;
+    d->capacity = capacity;
+    d->chars = d->data;
+    d->root = nullptr;
     memcpy(d->data, s, len);
     d->data[len] = '\0';
     return d;
 }
 
+/* Wrap the NUL-terminated buffer of an hxcpp string without copying it.
+ * The string object is registered as a GC root until the data is released.
+ * Must be called on a Haxe thread. */
+static Loreline_StringData* linc_borrowStringData(::String s) {
+    Loreline_StringData* d = (Loreline_StringData*)malloc(sizeof(Loreline_StringData));
+    d->refCount.store(1, std::memory_order_relaxed);
+    d->len = (size_t)s.length;
+    d->capacity = 0;
+    d->chars = s.raw_ptr();
+    d->root = ::Dynamic(s).mPtr;
+    hx::GCAddRoot(&d->root);
+    return d;
+}
+
 static void linc_retainStringData(Loreline_StringData* d) {
     if (d) d->refCount.fetch_add(1, std::memory_order_relaxed);
 }
 
 static void linc_releaseStringData(Loreline_StringData* d) {
     if (d && d->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        if (d->root) hx::GCRemoveRoot(&d->root);
         free(d);
     }
 }
 
+struct Loreline_StringAccess {
+    static Loreline_String adopt(Loreline_StringData* d) {
+        Loreline_String s;
+        s.ptr = d;
+        return s;
+    }
+    static Loreline_StringData* data(const Loreline_String& s) {
+        return s.ptr;
+    }
+};
+
 /* ── Loreline_String implementation ─────────────────────────────────────── */
 
 LORELINE_PUBLIC Loreline_String::Loreline_String() : ptr(nullptr) {}
@@ -107,7 +158,7 @@ LORELINE_PUBLIC Loreline_String& Loreline_String::operator=(Loreline_String&& o)
 }
 
 LORELINE_PUBLIC const char* Loreline_String::c_str() const {
-    return ptr ? ptr->data : nullptr;
+    return ptr ? ptr->chars : nullptr;
 }
 
 LORELINE_PUBLIC size_t Loreline_String::length() const {
@@ -162,10 +213,21 @@ LORELINE_PUBLIC Loreline_Value Loreline_Value::from_string(Loreline_String s) {
 
 /* ── Opaque handles ─────────────────────────────────────────────────────── */
 
+class Loreline_Thread;
+struct Loreline_CallbackArena;
+
+static void linc_deleteArenas(Loreline_CallbackArena* arenas);
+
+/* Live handle counts, reported by Loreline_memoryStats */
+static std::atomic<int> linc_Loreline_liveScripts(0);
+static std::atomic<int> linc_Loreline_liveInterpreters(0);
+
 struct Loreline_Script {
     hx::Object* obj;
 
-    Loreline_Script() : obj(nullptr) {}
+    Loreline_Script() : obj(nullptr) {
+        linc_Loreline_liveScripts.fetch_add(1, std::memory_order_relaxed);
+    }
 
     void set(hx::Object* o) {
         obj = o;
@@ -173,6 +235,7 @@ struct Loreline_Script {
     }
 
     ~Loreline_Script() {
+        linc_Loreline_liveScripts.fetch_sub(1, std::memory_order_relaxed);
         if (obj) {
             hx::GCRemoveRoot(&obj);
             obj = nullptr;
@@ -184,34 +247,61 @@ private:
     Loreline_Script& operator=(const Loreline_Script&);
 };
 
+/* What the pending callback of an interpreter continues */
+enum Loreline_PendingKind {
+    Loreline_PendingNone = 0,
+    Loreline_PendingDialogue, /* resumed by advance */
+    Loreline_PendingChoice    /* resumed by select */
+};
+
 struct Loreline_Interpreter {
     hx::Object* obj;
     hx::Object* pendingCb; /* GC-rooted pending callback (advance/select) */
+    Loreline_PendingKind pendingKind;
     Loreline_DialogueHandler dialogueHandler;
     Loreline_ChoiceHandler choiceHandler;
     Loreline_FinishHandler finishHandler;
     void* userData;
     Loreline_UserDataRetain retain;   /* may be NULL */
     Loreline_UserDataRelease release; /* may be NULL */
-
-    Loreline_Interpreter() : obj(nullptr), pendingCb(nullptr), dialogueHandler(nullptr),
+    Loreline_Thread* worker;          /* pool worker running this interpreter, or NULL */
+    std::mutex arenaMutex;
+    Loreline_CallbackArena* freeArenas; /* arenas ready for the next callback payload */
+    Loreline_StateChangedHandler stateChangedHandler; /* may be NULL */
+    std::vector<std::string> stateFilters;            /* empty: every path */
+    std::mutex stateMutex;
+    std::vector<std::pair<std::string, Loreline_Value>> pendingStateChanges; /* latest value by path */
+    bool stateFlushScheduled;
+    Loreline_CallbackArena* upcoming; /* tags of the last Loreline_peekUpcoming, or NULL */
+    int stepBudget;                   /* execution budget, see Loreline_optionsSetStepBudget */
+    double timeBudget;
+
+    Loreline_Interpreter() : obj(nullptr), pendingCb(nullptr), pendingKind(Loreline_PendingNone), dialogueHandler(nullptr),
         choiceHandler(nullptr), finishHandler(nullptr), userData(nullptr),
-        retain(nullptr), release(nullptr) {}
+        retain(nullptr), release(nullptr), worker(nullptr), freeArenas(nullptr),
+        stateChangedHandler(nullptr), stateFlushScheduled(false), upcoming(nullptr),
+        stepBudget(0), timeBudget(0.0) {
+        linc_Loreline_liveInterpreters.fetch_add(1, std::memory_order_relaxed);
+    }
 
     void set(hx::Object* o) {
         obj = o;
         if (obj) hx::GCAddRoot(&obj);
     }
 
-    void setPendingCallback(hx::Object* cb) {
+    void setPendingCallback(hx::Object* cb, Loreline_PendingKind kind) {
         if (pendingCb) { hx::GCRemoveRoot(&pendingCb); pendingCb = nullptr; }
         pendingCb = cb;
+        pendingKind = cb ? kind : Loreline_PendingNone;
         if (pendingCb) hx::GCAddRoot(&pendingCb);
     }
 
     ~Loreline_Interpreter() {
+        linc_Loreline_liveInterpreters.fetch_sub(1, std::memory_order_relaxed);
         if (pendingCb) { hx::GCRemoveRoot(&pendingCb); pendingCb = nullptr; }
         if (obj) { hx::GCRemoveRoot(&obj); obj = nullptr; }
+        linc_deleteArenas(freeArenas);
+        linc_deleteArenas(upcoming);
     }
 
 private:
@@ -241,10 +331,33 @@ private:
     Loreline_Translations& operator=(const Loreline_Translations&);
 };
 
+struct Loreline_ParseCache {
+    hx::Object* obj;
+
+    Loreline_ParseCache() : obj(nullptr) {}
+
+    void set(hx::Object* o) {
+        obj = o;
+        if (obj) hx::GCAddRoot(&obj);
+    }
+
+    ~Loreline_ParseCache() {
+        if (obj) {
+            hx::GCRemoveRoot(&obj);
+            obj = nullptr;
+        }
+    }
+
+private:
+    Loreline_ParseCache(const Loreline_ParseCache&);
+    Loreline_ParseCache& operator=(const Loreline_ParseCache&);
+};
+
 struct Loreline_AsyncResolve {
     hx::Object* doneObj;
+    Loreline_Thread* worker; /* worker of the interpreter awaiting the result */
 
-    Loreline_AsyncResolve() : doneObj(nullptr) {}
+    Loreline_AsyncResolve() : doneObj(nullptr), worker(nullptr) {}
 
     void setDone(hx::Object* d) {
         doneObj = d;
@@ -275,8 +388,15 @@ struct Loreline_InterpreterOptions {
     };
     std::vector<FunctionEntry> functions;
 
+    Loreline_StateChangedHandler stateChangedHandler;
+    std::vector<std::string> stateFilters;
+
+    int stepBudget;    /* 0: no limit */
+    double timeBudget; /* in seconds, 0: no limit */
+
     Loreline_InterpreterOptions()
-        : strictAccess(false), translationsObj(nullptr) {}
+        : strictAccess(false), translationsObj(nullptr), stateChangedHandler(nullptr),
+          stepBudget(0), timeBudget(0.0) {}
 
     void setTranslations(hx::Object* t) {
         if (translationsObj) hx::GCRemoveRoot(&translationsObj);
@@ -298,10 +418,76 @@ private:
 
 /* ── Conversion helpers ─────────────────────────────────────────────────── */
 
+/* Strings at least this long are borrowed from hxcpp instead of copied
+ * (registering a GC root costs more than copying a short string). */
+#ifndef LORELINE_STRING_BORROW_MIN
+#define LORELINE_STRING_BORROW_MIN 256
+#endif
+
+/* Strings up to this long can be interned (see linc_hxToInternedString). */
+#define LORELINE_STRING_INTERN_MAX 48
+#define LORELINE_STRING_INTERN_SLOTS 256
+
 static Loreline_String linc_hxToString(::String s) {
     if (s == null()) return Loreline_String();
-    const char* cstr = s.c_str();
-    return Loreline_String(cstr, strlen(cstr));
+#ifdef HX_SMART_STRINGS
+    if (s.isUTF16Encoded()) {
+        const char* utf8 = s.utf8_str();
+        return Loreline_String(utf8, strlen(utf8));
+    }
+#endif
+#ifndef HXCPP_GC_MOVING
+    if (s.length >= LORELINE_STRING_BORROW_MIN) {
+        return Loreline_StringAccess::adopt(linc_borrowStringData(s));
+    }
+#endif
+    return Loreline_String(s.raw_ptr(), (size_t)s.length);
+}
+
+/* Per-thread cache of recurring short strings (character names, field
+ * names, tag values, node types), so they are not allocated again for
+ * every callback. Direct-mapped by content hash; a collision replaces
+ * the previous entry. */
+struct Loreline_StringInternTable {
+    Loreline_StringData* slots[LORELINE_STRING_INTERN_SLOTS];
+
+    Loreline_StringInternTable() {
+        memset(slots, 0, sizeof(slots));
+    }
+
+    ~Loreline_StringInternTable() {
+        for (int i = 0; i < LORELINE_STRING_INTERN_SLOTS; i++) {
+            linc_releaseStringData(slots[i]);
+        }
+    }
+};
+
+static thread_local Loreline_StringInternTable linc_Loreline_internTable;
+
+static Loreline_String linc_hxToInternedString(::String s) {
+    if (s == null()) return Loreline_String();
+#ifdef HX_SMART_STRINGS
+    if (s.isUTF16Encoded()) return linc_hxToString(s);
+#endif
+    size_t len = (size_t)s.length;
+    if (len > LORELINE_STRING_INTERN_MAX) return linc_hxToString(s);
+
+    const char* chars = s.raw_ptr();
+
+    /* FNV-1a */
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ (unsigned char)chars[i]) * 16777619u;
+    }
+
+    Loreline_StringData*& slot = linc_Loreline_internTable.slots[hash % LORELINE_STRING_INTERN_SLOTS];
+    if (!slot || slot->len != len || memcmp(slot->chars, chars, len) != 0) {
+        linc_releaseStringData(slot);
+        slot = linc_createStringData(chars, len);
+    }
+
+    linc_retainStringData(slot);
+    return Loreline_StringAccess::adopt(slot);
 }
 
 static ::String linc_toHxString(const char* s) {
@@ -311,7 +497,31 @@ static ::String linc_toHxString(const char* s) {
 
 static ::String linc_toHxString(const Loreline_String& s) {
     if (s.isNull()) return null();
-    return ::String(s.c_str());
+    return ::String::create(s.c_str(), (int)s.length());
+}
+
+static Loreline_String linc_hxBytesToString(::haxe::io::Bytes bytes) {
+    if (hx::IsNull(bytes)) return Loreline_String();
+    return Loreline_String((const char*)bytes->b->getBase(), (size_t)bytes->length);
+}
+
+static ::haxe::io::Bytes linc_toHxBytes(const Loreline_String& s) {
+    if (s.isNull()) return null();
+    ::haxe::io::Bytes bytes = ::haxe::io::Bytes_obj::alloc((int)s.length());
+    if (s.length() > 0) memcpy(bytes->b->getBase(), s.c_str(), s.length());
+    return bytes;
+}
+
+/* Binary saves start with the "LRLB" magic; JSON saves start with '{'. */
+static bool linc_isBinarySave(const Loreline_String& s) {
+    return !s.isNull() && s.length() >= 4 && memcmp(s.c_str(), "LRLB", 4) == 0;
+}
+
+static ::Dynamic linc_toHxSaveData(const Loreline_String& s) {
+    if (linc_isBinarySave(s)) {
+        return ::loreline::SaveBinary_obj::decode(linc_toHxBytes(s));
+    }
+    return ::loreline::Json_obj::parse(linc_toHxString(s));
 }
 
 static Loreline_Value linc_hxToValue(::Dynamic val) {
@@ -325,7 +535,7 @@ static Loreline_Value linc_hxToValue(::Dynamic val) {
         case vtFloat:
             return Loreline_Value::from_float((double)(Float)val);
         case vtString:
-            return Loreline_Value::from_string(((::String)val).c_str());
+            return Loreline_Value::from_string(linc_hxToInternedString((::String)val));
         default:
             return Loreline_Value::null_val();
     }
@@ -337,14 +547,65 @@ static ::Dynamic linc_valueToHx(Loreline_Value v) {
         case Loreline_Float:  return (Float)v.floatValue;
         case Loreline_Bool:   return (bool)v.boolValue;
         case Loreline_StringValue:
-            return v.stringValue.isNull() ? (::Dynamic)null() : (::Dynamic)::String(v.stringValue.c_str());
+            return v.stringValue.isNull() ? (::Dynamic)null() : (::Dynamic)linc_toHxString(v.stringValue);
         default:
             return null();
     }
 }
 
+/* ── Sync slots ─────────────────────────────────────────────────────────── */
+
+/* Reusable per-thread completion slot for blocking round trips. A thread only
+ * ever waits on one sync call at a time, so its slot is reset and reused by
+ * every call instead of allocating a mutex/condvar pair each time. */
+struct Loreline_SyncSlot {
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool done = false;
+
+    void reset() {
+        std::lock_guard<std::mutex> lock(mtx);
+        done = false;
+    }
+
+    /* Notifies while holding the lock: once the waiter returns, the slot is
+     * not touched anymore (it may be destroyed along with a finishing thread) */
+    void signal() {
+        std::lock_guard<std::mutex> lock(mtx);
+        done = true;
+        cv.notify_one();
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [this]() { return done; });
+    }
+};
+
+static thread_local Loreline_SyncSlot linc_Loreline_syncSlot;
+
+/* Runs a task given by reference, then signals the slot of the waiting thread
+ * (even if the task throws, so the waiter never hangs). Small and trivially
+ * copyable: fits in any task record without allocating. */
+template <typename F>
+struct Loreline_SyncTask {
+    F* task;
+    Loreline_SyncSlot* slot;
+
+    void operator()() const {
+        struct Signal {
+            Loreline_SyncSlot* slot;
+            ~Signal() { slot->signal(); }
+        } signal = { slot };
+        (*task)();
+    }
+};
+
 /* ── Thread worker ──────────────────────────────────────────────────────── */
 
+/* True on threads owned by Loreline (internal thread or pool workers). */
+static thread_local bool linc_Loreline_isWorkerThread = false;
+
 class Loreline_Thread {
 public:
     Loreline_Thread() : stopFlag(false) {
@@ -368,32 +629,18 @@ public:
         cv.notify_one();
     }
 
-    void scheduleSync(std::function<void()> task) {
-        auto syncMutex = std::make_shared<std::mutex>();
-        auto syncCv = std::make_shared<std::condition_variable>();
-        auto completed = std::make_shared<bool>(false);
-
-        auto wrappedTask = [task, syncMutex, syncCv, completed]() {
-            task();
-            {
-                std::lock_guard<std::mutex> lock(*syncMutex);
-                *completed = true;
-            }
-            syncCv->notify_one();
-        };
-
-        {
-            std::lock_guard<std::mutex> lock(mtx);
-            taskQueue.push(std::move(wrappedTask));
-        }
-        cv.notify_one();
-
-        std::unique_lock<std::mutex> lockSync(*syncMutex);
-        syncCv->wait(lockSync, [completed]() { return *completed; });
+    template <typename F>
+    void scheduleSync(F&& task) {
+        typedef typename std::remove_reference<F>::type Fn;
+        Loreline_SyncSlot* slot = &linc_Loreline_syncSlot;
+        slot->reset();
+        schedule(Loreline_SyncTask<Fn>{ &task, slot });
+        slot->wait();
     }
 
 private:
     void threadLoop() {
+        linc_Loreline_isWorkerThread = true;
         while (true) {
             std::function<void()> task;
             {
@@ -418,28 +665,179 @@ private:
 
 /* ── Dispatch-out queue ─────────────────────────────────────────────────── */
 
+/* Inline storage of a task record. Every dispatch-out lambda of this file
+ * fits; bigger callables still work but are boxed on the heap. */
+#define LORELINE_TASK_INLINE_SIZE 128
+
+/* Capacity of the dispatch-out ring (power of 2). When it is full, tasks
+ * spill into a mutex-guarded overflow list until the next flush. */
+#define LORELINE_DISPATCH_RING_SIZE 1024
+
+/* Fixed-size, type-erased task record: a callable constructed in place in
+ * inline storage, so queueing a task does not allocate. */
+class Loreline_Task {
+public:
+    Loreline_Task() : invokeFn(nullptr), destroyFn(nullptr) {}
+
+    ~Loreline_Task() {
+        reset();
+    }
+
+    template <typename F>
+    void set(F&& func) {
+        typedef typename std::decay<F>::type Fn;
+        reset();
+        construct<Fn>(std::forward<F>(func), std::integral_constant<bool,
+            sizeof(Fn) <= LORELINE_TASK_INLINE_SIZE && alignof(Fn) <= alignof(std::max_align_t)>());
+    }
+
+    void run() {
+        invokeFn(storage);
+    }
+
+    void reset() {
+        if (destroyFn) destroyFn(storage);
+        invokeFn = nullptr;
+        destroyFn = nullptr;
+    }
+
+private:
+    template <typename Fn, typename F>
+    void construct(F&& func, std::true_type /* inline */) {
+        new (storage) Fn(std::forward<F>(func));
+        invokeFn = [](void* p) { (*static_cast<Fn*>(p))(); };
+        destroyFn = [](void* p) { static_cast<Fn*>(p)->~Fn(); };
+    }
+
+    template <typename Fn, typename F>
+    void construct(F&& func, std::false_type /* boxed */) {
+        *reinterpret_cast<Fn**>(storage) = new Fn(std::forward<F>(func));
+        invokeFn = [](void* p) { (**static_cast<Fn**>(p))(); };
+        destroyFn = [](void* p) { delete *static_cast<Fn**>(p); };
+    }
+
+    alignas(std::max_align_t) unsigned char storage[LORELINE_TASK_INLINE_SIZE];
+    void (*invokeFn)(void*);
+    void (*destroyFn)(void*);
+
+    Loreline_Task(const Loreline_Task&);
+    Loreline_Task& operator=(const Loreline_Task&);
+};
+
+/* Per-thread overflow marker: set to (overflow epoch + 1) when this thread
+ * spills a task, so that its next tasks keep going to the overflow list
+ * (preserving their order) until the consumer has taken it. */
+static thread_local size_t linc_Loreline_overflowMark = 0;
+
+/* Multi-producer, single-consumer queue of tasks to run on the host thread.
+ * Producers (any thread) claim a ring cell with a CAS and construct the task
+ * in place; the consumer (Loreline_update) runs cells in order, without locks.
+ * Each cell carries a sequence number telling whether it is free (== pos),
+ * ready (== pos + 1) or not yet reused for this lap. */
 class Loreline_FunctionQueue {
 public:
-    void add(std::function<void()> func) {
-        std::lock_guard<std::mutex> lock(queueMutex);
-        functionQueue.push_back(std::move(func));
+    Loreline_FunctionQueue() : enqueuePos(0), dequeuePos(0), overflowCount(0), overflowEpoch(0) {
+        for (size_t i = 0; i < LORELINE_DISPATCH_RING_SIZE; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    template <typename F>
+    void add(F&& func) {
+        if (linc_Loreline_overflowMark == overflowEpoch.load(std::memory_order_acquire) + 1) {
+            addOverflow(std::forward<F>(func));
+            return;
+        }
+
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        Cell* cell = nullptr;
+        while (true) {
+            cell = &cells[pos & (LORELINE_DISPATCH_RING_SIZE - 1)];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                /* Ring is full */
+                addOverflow(std::forward<F>(func));
+                return;
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->task.set(std::forward<F>(func));
+        cell->sequence.store(pos + 1, std::memory_order_release);
     }
 
+    /* Runs every task queued before the call. Tasks queued while flushing
+     * (e.g. by the callbacks themselves) run on the next flush.
+     * Must always be called from the same (host) thread. */
     void flush() {
-        if (functionQueue.empty()) return;
-        std::vector<std::function<void()>> tempQueue;
+        size_t end = enqueuePos.load(std::memory_order_acquire);
+        runUntil(end);
+
+        if (overflowCount.load(std::memory_order_acquire) == 0) return;
+
+        std::vector<std::function<void()>> pending;
         {
-            std::lock_guard<std::mutex> lock(queueMutex);
-            tempQueue.swap(functionQueue);
+            std::lock_guard<std::mutex> lock(overflowMutex);
+            pending.swap(overflow);
+            overflowCount.store(0, std::memory_order_relaxed);
+            /* Ring tasks claimed before the overflow ones of a same thread
+             * are all below this position: run them first */
+            end = enqueuePos.load(std::memory_order_acquire);
+            overflowEpoch.fetch_add(1, std::memory_order_release);
         }
-        for (auto& func : tempQueue) {
+        runUntil(end);
+        for (auto& func : pending) {
             func();
         }
     }
 
 private:
-    std::mutex queueMutex;
-    std::vector<std::function<void()>> functionQueue;
+    struct Cell {
+        std::atomic<size_t> sequence;
+        Loreline_Task task;
+    };
+
+    template <typename F>
+    void addOverflow(F&& func) {
+        std::lock_guard<std::mutex> lock(overflowMutex);
+        overflow.push_back(std::function<void()>(std::forward<F>(func)));
+        overflowCount.fetch_add(1, std::memory_order_release);
+        linc_Loreline_overflowMark = overflowEpoch.load(std::memory_order_relaxed) + 1;
+    }
+
+    void runUntil(size_t end) {
+        while (dequeuePos != end) {
+            size_t pos = dequeuePos;
+            Cell& cell = cells[pos & (LORELINE_DISPATCH_RING_SIZE - 1)];
+            /* The cell is claimed: its producer is only constructing the task */
+            while (cell.sequence.load(std::memory_order_acquire) != pos + 1) {
+                std::this_thread::yield();
+            }
+            dequeuePos = pos + 1;
+            try {
+                cell.task.run();
+            } catch (...) {
+                cell.task.reset();
+                cell.sequence.store(pos + LORELINE_DISPATCH_RING_SIZE, std::memory_order_release);
+                throw;
+            }
+            cell.task.reset();
+            cell.sequence.store(pos + LORELINE_DISPATCH_RING_SIZE, std::memory_order_release);
+        }
+    }
+
+    Cell cells[LORELINE_DISPATCH_RING_SIZE];
+    std::atomic<size_t> enqueuePos;
+    size_t dequeuePos;
+
+    std::mutex overflowMutex;
+    std::vector<std::function<void()>> overflow;
+    std::atomic<size_t> overflowCount;
+    std::atomic<size_t> overflowEpoch;
 };
 
 /* ── Static state ───────────────────────────────────────────────────────── */
@@ -449,8 +847,19 @@ static bool linc_Loreline_useInternalThread = false;
 static bool linc_Loreline_deferCallbacks = false;
 static std::thread::id linc_Loreline_haxeThreadId;
 static Loreline_Thread* linc_Loreline_thread = nullptr;
+static std::vector<Loreline_Thread*> linc_Loreline_workers;
+static std::atomic<unsigned int> linc_Loreline_nextWorker(0);
 static Loreline_FunctionQueue linc_Loreline_dispatchOutFunctions;
 static double linc_Loreline_gcAccum = 0.0;
+static Loreline_GcMode linc_Loreline_gcMode = Loreline_GcInterval;
+static double linc_Loreline_gcValue = 15.0;
+static int linc_Loreline_gcCollections = 0;
+static double linc_Loreline_gcLastDuration = 0.0;
+static double linc_Loreline_gcLiveBytes = 0.0;
+static double linc_Loreline_gcStepRatio = 0.5;
+/* Seconds per byte in use of the last collection, used to estimate the next
+ * one. Starts at about 1 ms per MB, until a collection has been timed. */
+static double linc_Loreline_gcSecondsPerByte = 1e-9;
 
 /* ── ensureHaxeThread ───────────────────────────────────────────────────── */
 
@@ -464,7 +873,10 @@ static void linc_Loreline_ensureHaxeThread() {
         hxRunLibrary();
     }
 
-    if (linc_Loreline_haxeThreadId != currentThreadId) {
+    /* Pool workers all run Haxe code: each one attaches to the GC on every
+     * call (LORELINE_HX_BEGIN) and detaches when done (LORELINE_HX_END). */
+    if (linc_Loreline_haxeThreadId != currentThreadId &&
+        !(linc_Loreline_isWorkerThread && linc_Loreline_workers.size() > 1)) {
         throw std::runtime_error("Calling Loreline from the wrong thread!");
     }
 }
@@ -479,17 +891,55 @@ static void linc_Loreline_schedule(std::function<void()> task) {
     }
 }
 
-static void linc_Loreline_scheduleSync(std::function<void()> task) {
+template <typename F>
+static void linc_Loreline_scheduleSync(F&& task) {
     if (linc_Loreline_useInternalThread && linc_Loreline_thread) {
-        linc_Loreline_thread->scheduleSync(std::move(task));
+        linc_Loreline_thread->scheduleSync(task);
     } else {
         task();
     }
 }
 
-static void linc_Loreline_dispatchOut(std::function<void()> task) {
+/* Pick the worker lexing an imported file (round-robin over every worker but
+ * the first one, which runs the parse). Only used when a thread pool runs. */
+static std::atomic<unsigned int> linc_Loreline_nextLexWorker(0);
+
+static Loreline_Thread* linc_Loreline_pickLexWorker() {
+    unsigned int index = linc_Loreline_nextLexWorker.fetch_add(1);
+    return linc_Loreline_workers[1 + index % (linc_Loreline_workers.size() - 1)];
+}
+
+/* Pick the worker a new interpreter is pinned to (round-robin).
+ * Returns NULL when no thread pool is running. */
+static Loreline_Thread* linc_Loreline_pickWorker() {
+    if (linc_Loreline_workers.size() <= 1) return nullptr;
+    unsigned int index = linc_Loreline_nextWorker.fetch_add(1);
+    return linc_Loreline_workers[index % linc_Loreline_workers.size()];
+}
+
+/* Same as schedule / scheduleSync, but on the worker an interpreter is pinned
+ * to, so that a given interpreter always runs on the same thread. */
+static void linc_Loreline_scheduleOn(Loreline_Thread* worker, std::function<void()> task) {
+    if (linc_Loreline_useInternalThread && worker) {
+        worker->schedule(std::move(task));
+    } else {
+        linc_Loreline_schedule(std::move(task));
+    }
+}
+
+template <typename F>
+static void linc_Loreline_scheduleSyncOn(Loreline_Thread* worker, F&& task) {
+    if (linc_Loreline_useInternalThread && worker) {
+        worker->scheduleSync(task);
+    } else {
+        linc_Loreline_scheduleSync(task);
+    }
+}
+
+template <typename F>
+static void linc_Loreline_dispatchOut(F&& task) {
     if (linc_Loreline_useInternalThread || linc_Loreline_deferCallbacks) {
-        linc_Loreline_dispatchOutFunctions.add(std::move(task));
+        linc_Loreline_dispatchOutFunctions.add(std::forward<F>(task));
     } else {
         task();
     }
@@ -497,26 +947,22 @@ static void linc_Loreline_dispatchOut(std::function<void()> task) {
 
 /* Reverse sync dispatch: hxcpp thread → main thread, blocking.
  * Used by sync custom functions in threaded mode (Android). */
-static void linc_Loreline_dispatchOutSync(std::function<void()> task) {
+template <typename F>
+static void linc_Loreline_dispatchOutSync(F&& task) {
     if (!linc_Loreline_useInternalThread) {
         task();
         return;
     }
-    auto syncMutex = std::make_shared<std::mutex>();
-    auto syncCv = std::make_shared<std::condition_variable>();
-    auto completed = std::make_shared<bool>(false);
-
-    linc_Loreline_dispatchOutFunctions.add([task, syncMutex, syncCv, completed]() {
-        task();
-        {
-            std::lock_guard<std::mutex> lock(*syncMutex);
-            *completed = true;
-        }
-        syncCv->notify_one();
-    });
+    typedef typename std::remove_reference<F>::type Fn;
+    Loreline_SyncSlot* slot = &linc_Loreline_syncSlot;
+    slot->reset();
+    linc_Loreline_dispatchOutFunctions.add(Loreline_SyncTask<Fn>{ &task, slot });
 
-    std::unique_lock<std::mutex> lock(*syncMutex);
-    syncCv->wait(lock, [completed]() { return *completed; });
+    /* Don't hold up collections triggered by other workers while waiting */
+    bool gcFree = linc_Loreline_workers.size() > 1;
+    if (gcFree) hx::EnterGCFreeZone();
+    slot->wait();
+    if (gcFree) hx::ExitGCFreeZone();
 }
 
 /* ── Call macros ─────────────────────────────────────────────────────────── */
@@ -541,6 +987,13 @@ static void linc_Loreline_dispatchOutSync(std::function<void()> task) {
 #define LORELINE_BEGIN_CALL_SYNC \
     linc_Loreline_scheduleSync([&]() {
 
+/* Calls bound to an interpreter run on the worker it is pinned to */
+#define LORELINE_BEGIN_INTERP_CALL(interp) \
+    linc_Loreline_scheduleOn((interp)->worker, [=]() mutable {
+
+#define LORELINE_BEGIN_INTERP_CALL_SYNC(interp) \
+    linc_Loreline_scheduleSyncOn((interp)->worker, [&]() {
+
 #define LORELINE_END_CALL \
     });
 
@@ -578,9 +1031,28 @@ LORELINE_PUBLIC void Loreline_dispose(void) {
     // The thread sleeps on cv.wait() when idle, consuming no CPU.
 }
 
+/* ── Garbage collection ─────────────────────────────────────────────────── */
+
+/* Bytes allocated since the last collection */
+static double linc_Loreline_gcGrowth() {
+    return __hxcpp_gc_mem_info(2) - linc_Loreline_gcLiveBytes;
+}
+
+/* Runs a collection and records its cost. Must run inside LORELINE_HX_BEGIN/END. */
+static void linc_Loreline_collect() {
+    double bytesBefore = __hxcpp_gc_mem_info(2);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    hx::InternalCollect(false, false);
+    linc_Loreline_gcLastDuration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (bytesBefore > 0) linc_Loreline_gcSecondsPerByte = linc_Loreline_gcLastDuration / bytesBefore;
+    linc_Loreline_gcCollections++;
+    linc_Loreline_gcAccum = 0.0;
+    linc_Loreline_gcLiveBytes = __hxcpp_gc_mem_info(0);
+}
+
 static LORELINE_NOINLINE void Loreline_gc_hx() {
     LORELINE_HX_BEGIN
-    hx::InternalCollect(false, false);
+    linc_Loreline_collect();
     LORELINE_HX_END
 }
 
@@ -590,13 +1062,91 @@ LORELINE_PUBLIC void Loreline_gc(void) {
     LORELINE_END_CALL
 }
 
+LORELINE_PUBLIC void Loreline_setGcPolicy(Loreline_GcMode mode, double value) {
+    LORELINE_BEGIN_CALL
+    linc_Loreline_gcMode = mode;
+    linc_Loreline_gcValue = value;
+    linc_Loreline_gcAccum = 0.0;
+    LORELINE_END_CALL
+}
+
+LORELINE_PUBLIC void Loreline_setGcStepThreshold(double growthRatio) {
+    LORELINE_BEGIN_CALL
+    linc_Loreline_gcStepRatio = growthRatio > 0 ? growthRatio : 0.0;
+    LORELINE_END_CALL
+}
+
+static LORELINE_NOINLINE void Loreline_gcStep_hx(double budget, bool* outCollected) {
+    LORELINE_HX_BEGIN
+    /* Not worth it until the heap grew by the threshold ratio since the last
+     * collection (with a 1 MB floor, for small or never collected heaps) */
+    double threshold = linc_Loreline_gcLiveBytes * linc_Loreline_gcStepRatio;
+    if (threshold < 1048576.0) threshold = 1048576.0;
+    if (linc_Loreline_gcGrowth() >= threshold) {
+        /* A collection can't be split: only run one if it should fit in the
+         * budget, estimated from the cost of the last one per byte in use */
+        double estimate = __hxcpp_gc_mem_info(2) * linc_Loreline_gcSecondsPerByte;
+        if (estimate <= budget) {
+            linc_Loreline_collect();
+            *outCollected = true;
+        }
+    }
+    LORELINE_HX_END
+}
+
+LORELINE_PUBLIC bool Loreline_gcStep(double budget) {
+    bool collected = false;
+
+    LORELINE_BEGIN_CALL_SYNC
+    Loreline_gcStep_hx(budget, &collected);
+    LORELINE_END_CALL
+
+    return collected;
+}
+
+static LORELINE_NOINLINE void Loreline_memoryStats_hx(Loreline_MemoryStats* outStats) {
+    LORELINE_HX_BEGIN
+    outStats->heapSize = __hxcpp_gc_mem_info(1);
+    outStats->liveBytes = __hxcpp_gc_mem_info(0);
+    outStats->currentBytes = __hxcpp_gc_mem_info(2);
+    outStats->largeBytes = __hxcpp_gc_mem_info(3);
+    outStats->collections = linc_Loreline_gcCollections;
+    outStats->lastCollectionTime = linc_Loreline_gcLastDuration;
+    LORELINE_HX_END
+}
+
+LORELINE_PUBLIC Loreline_MemoryStats Loreline_memoryStats(void) {
+    Loreline_MemoryStats stats;
+    memset(&stats, 0, sizeof(stats));
+
+    LORELINE_BEGIN_CALL_SYNC
+    Loreline_memoryStats_hx(&stats);
+    LORELINE_END_CALL
+
+    stats.scripts = linc_Loreline_liveScripts.load(std::memory_order_relaxed);
+    stats.interpreters = linc_Loreline_liveInterpreters.load(std::memory_order_relaxed);
+    return stats;
+}
+
+static LORELINE_NOINLINE void Loreline_updateTimers_hx(double delta) {
+    LORELINE_HX_BEGIN
+    ::loreline::Timer_obj::update(delta);
+    LORELINE_HX_END
+}
+
 static LORELINE_NOINLINE void Loreline_update_hx(double delta) {
     LORELINE_HX_BEGIN
     ::loreline::Timer_obj::update(delta);
     linc_Loreline_gcAccum += delta;
-    if (linc_Loreline_gcAccum >= 15.0) {
-        linc_Loreline_gcAccum = 0.0;
-        hx::InternalCollect(false, false);
+    switch (linc_Loreline_gcMode) {
+        case Loreline_GcInterval:
+            if (linc_Loreline_gcAccum >= linc_Loreline_gcValue) linc_Loreline_collect();
+            break;
+        case Loreline_GcGrowth:
+            if (linc_Loreline_gcGrowth() >= linc_Loreline_gcValue) linc_Loreline_collect();
+            break;
+        case Loreline_GcManual:
+            break;
     }
     LORELINE_HX_END
 }
@@ -614,6 +1164,13 @@ LORELINE_PUBLIC void Loreline_update(double delta) {
     LORELINE_BEGIN_CALL
     Loreline_update_hx(delta);
     LORELINE_END_CALL
+
+    /* Timers are per thread: other pool workers tick their own */
+    for (size_t i = 1; i < linc_Loreline_workers.size(); i++) {
+        linc_Loreline_workers[i]->schedule([=]() {
+            Loreline_updateTimers_hx(delta);
+        });
+    }
 }
 
 static LORELINE_NOINLINE void Loreline_createThread_hx() {
@@ -622,134 +1179,246 @@ static LORELINE_NOINLINE void Loreline_createThread_hx() {
     LORELINE_HX_END
 }
 
+static void Loreline_createThreadPool_hx();
+
 LORELINE_PUBLIC void Loreline_createThread(void) {
+    Loreline_createThreadPool(1);
+}
+
+LORELINE_PUBLIC void Loreline_createThreadPool(int workers) {
     if (linc_Loreline_useInternalThread) return;
+    if (workers < 1) workers = 1;
     linc_Loreline_useInternalThread = true;
     linc_Loreline_thread = new Loreline_Thread();
-    /* Enable deferred timer mode before any interpreter work starts */
+    /* Enable deferred timer mode before any interpreter work starts.
+     * This also initializes the Haxe runtime on the first worker, before
+     * the other workers exist. */
     LORELINE_BEGIN_CALL_SYNC
     Loreline_createThread_hx();
     LORELINE_END_CALL
+    if (workers > 1) {
+        /* Workers are only added once the pool is complete, so that
+         * interpreters are never pinned to a partially built pool */
+        std::vector<Loreline_Thread*> pool;
+        pool.push_back(linc_Loreline_thread);
+        for (int i = 1; i < workers; i++) {
+            pool.push_back(new Loreline_Thread());
+        }
+        linc_Loreline_workers.swap(pool);
+        /* Imported files can now be lexed on the other workers */
+        LORELINE_BEGIN_CALL_SYNC
+        Loreline_createThreadPool_hx();
+        LORELINE_END_CALL
+    }
 }
 
 /* ── Callback wrapper helpers ───────────────────────────────────────────── */
 
-/* Build a Loreline_TextTag array from Haxe Array<TextTag>.
- * Caller must delete[] the returned array. */
-static void linc_buildTextTags(::Dynamic hxTags, Loreline_TextTag** outTags, int* outCount) {
-    if (hx::IsNull(hxTags)) {
-        *outTags = nullptr;
-        *outCount = 0;
-        return;
+/* Reusable storage for the payload of a dialogue or choice callback: texts,
+ * tag and option arrays. An arena is taken from its interpreter when a callback
+ * is built and given back, emptied, once the host handler returns, so steady-state
+ * delivery reuses the same memory instead of allocating it for every callback.
+ * With deferred callbacks the next payload can be built before the previous
+ * handler returns, which then simply takes another arena from the interpreter.
+ * Text data still referenced by the host when its arena is reused is left to
+ * the host and replaced with a new buffer. */
+struct Loreline_CallbackArena {
+    Loreline_String character;
+    Loreline_String text;
+    std::vector<Loreline_TextTag> tags;
+    std::vector<Loreline_ChoiceOption> options;
+    std::vector<size_t> tagStarts;
+    std::vector<Loreline_StringData*> strings; /* reusable text buffers */
+    size_t stringCount;                        /* buffers used by the current payload */
+    Loreline_CallbackArena* next;              /* next free arena of the interpreter */
+
+    Loreline_CallbackArena() : stringCount(0), next(nullptr) {}
+
+    ~Loreline_CallbackArena() {
+        reset();
+        for (size_t i = 0; i < strings.size(); i++) {
+            linc_releaseStringData(strings[i]);
+        }
     }
 
-    ::cpp::VirtualArray arr = (::cpp::VirtualArray)hxTags;
-    int count = arr->get_length();
-    if (count == 0) {
-        *outTags = nullptr;
-        *outCount = 0;
-        return;
+    /* Copy a Haxe string into the next text buffer of the arena */
+    Loreline_String string(::String s) {
+        if (s == null()) return Loreline_String();
+
+        const char* chars = s.raw_ptr();
+        size_t len = (size_t)s.length;
+#ifdef HX_SMART_STRINGS
+        if (s.isUTF16Encoded()) {
+            chars = s.utf8_str();
+            len = strlen(chars);
+        }
+#endif
+
+        if (stringCount == strings.size()) strings.push_back(nullptr);
+        Loreline_StringData*& d = strings[stringCount++];
+
+        /* Only the arena references the buffer once its count is back to 1 */
+        if (d && (d->capacity < len || d->refCount.load(std::memory_order_acquire) != 1)) {
+            linc_releaseStringData(d);
+            d = nullptr;
+        }
+
+        if (!d) {
+            d = linc_createStringData(chars, len, len < 64 ? 64 : len);
+        } else {
+            d->len = len;
+            memcpy(d->data, chars, len);
+            d->data[len] = '\0';
+        }
+
+        linc_retainStringData(d);
+        return Loreline_StringAccess::adopt(d);
     }
 
-    Loreline_TextTag* tags = new Loreline_TextTag[count];
-    for (int i = 0; i < count; i++) {
-        ::Dynamic tag = arr->__get(i);
-        tags[i].value = linc_hxToString(tag->__Field(HX_CSTRING("value"), hx::paccDynamic));
-        tags[i].offset = (int)tag->__Field(HX_CSTRING("offset"), hx::paccDynamic);
-        tags[i].closing = (bool)tag->__Field(HX_CSTRING("closing"), hx::paccDynamic);
+    /* Drop the payload, keeping the memory for the next one */
+    void reset() {
+        character = Loreline_String();
+        text = Loreline_String();
+        tags.clear();
+        options.clear();
+        tagStarts.clear();
+        stringCount = 0;
+    }
+};
+
+static void linc_deleteArenas(Loreline_CallbackArena* arenas) {
+    while (arenas) {
+        Loreline_CallbackArena* next = arenas->next;
+        delete arenas;
+        arenas = next;
     }
-    *outTags = tags;
-    *outCount = count;
 }
 
-/* Build a Loreline_ChoiceOption array from Haxe Array<ChoiceOption>.
- * Caller must delete[] each option's tags array and the options array itself. */
-static void linc_buildChoiceOptions(::Dynamic hxOptions, Loreline_ChoiceOption** outOptions, int* outCount) {
-    if (hx::IsNull(hxOptions)) {
-        *outOptions = nullptr;
-        *outCount = 0;
-        return;
+static Loreline_CallbackArena* linc_acquireArena(Loreline_Interpreter* h) {
+    {
+        std::lock_guard<std::mutex> lock(h->arenaMutex);
+        Loreline_CallbackArena* arena = h->freeArenas;
+        if (arena) {
+            h->freeArenas = arena->next;
+            arena->next = nullptr;
+            return arena;
+        }
     }
+    return new Loreline_CallbackArena();
+}
 
-    ::cpp::VirtualArray arr = (::cpp::VirtualArray)hxOptions;
+/* Can be called from any thread (deferred callbacks run on the host thread) */
+static void linc_releaseArena(Loreline_Interpreter* h, Loreline_CallbackArena* arena) {
+    arena->reset();
+    std::lock_guard<std::mutex> lock(h->arenaMutex);
+    arena->next = h->freeArenas;
+    h->freeArenas = arena;
+}
+
+/* Append the tags of a Haxe Array<TextTag> to the arena.
+ * Returns the number of tags added. */
+static int linc_buildTextTags(Loreline_CallbackArena* arena, ::Dynamic hxTags) {
+    if (hx::IsNull(hxTags)) return 0;
+
+    ::cpp::VirtualArray arr = (::cpp::VirtualArray)hxTags;
     int count = arr->get_length();
-    if (count == 0) {
-        *outOptions = nullptr;
-        *outCount = 0;
-        return;
+    for (int i = 0; i < count; i++) {
+        ::Dynamic hxTag = arr->__get(i);
+        arena->tags.emplace_back();
+        Loreline_TextTag& tag = arena->tags.back();
+        tag.value = linc_hxToInternedString(hxTag->__Field(HX_CSTRING("value"), hx::paccDynamic));
+        tag.offset = (int)hxTag->__Field(HX_CSTRING("offset"), hx::paccDynamic);
+        tag.closing = (bool)hxTag->__Field(HX_CSTRING("closing"), hx::paccDynamic);
     }
+    return count;
+}
 
-    Loreline_ChoiceOption* options = new Loreline_ChoiceOption[count];
-    for (int i = 0; i < count; i++) {
-        ::Dynamic opt = arr->__get(i);
-        options[i].text = linc_hxToString(opt->__Field(HX_CSTRING("text"), hx::paccDynamic));
-        options[i].enabled = (bool)opt->__Field(HX_CSTRING("enabled"), hx::paccDynamic);
+/* Fill the options of the arena from a Haxe Array<ChoiceOption>.
+ * Returns the number of options. */
+static int linc_buildChoiceOptions(Loreline_CallbackArena* arena, ::Dynamic hxOptions) {
+    if (hx::IsNull(hxOptions)) return 0;
 
-        ::Dynamic optTags = opt->__Field(HX_CSTRING("tags"), hx::paccDynamic);
-        Loreline_TextTag* tags = nullptr;
-        int tagCount = 0;
-        linc_buildTextTags(optTags, &tags, &tagCount);
-        options[i].tags = tags;
-        options[i].tagCount = tagCount;
+    ::cpp::VirtualArray arr = (::cpp::VirtualArray)hxOptions;
+    int count = arr->get_length();
+    for (int i = 0; i < count; i++) {
+        ::Dynamic hxOpt = arr->__get(i);
+        arena->options.emplace_back();
+        Loreline_ChoiceOption& opt = arena->options.back();
+        opt.text = arena->string(hxOpt->__Field(HX_CSTRING("text"), hx::paccDynamic));
+        opt.enabled = (bool)hxOpt->__Field(HX_CSTRING("enabled"), hx::paccDynamic);
+        arena->tagStarts.push_back(arena->tags.size());
+        opt.tagCount = linc_buildTextTags(arena, hxOpt->__Field(HX_CSTRING("tags"), hx::paccDynamic));
     }
-    *outOptions = options;
-    *outCount = count;
-}
 
-static void linc_freeChoiceOptions(Loreline_ChoiceOption* options, int count) {
-    if (!options) return;
+    /* Tags are only pointed to once they are all added, as adding may move them */
     for (int i = 0; i < count; i++) {
-        delete[] options[i].tags;
+        Loreline_ChoiceOption& opt = arena->options[i];
+        opt.tags = opt.tagCount > 0 ? arena->tags.data() + arena->tagStarts[i] : nullptr;
     }
-    delete[] options;
+    return count;
 }
 
 /* ── Callback dispatch helpers ─────────────────────────────────────────── */
 
+/* Interpreter whose handler is currently being dispatched. Only used by the
+ * context-free advance()/select() pointers handed to the handlers; hosts
+ * driving several suspended interpreters use Loreline_advance/Loreline_select. */
 static Loreline_Interpreter* s_dispatchInterp = nullptr;
 
-static LORELINE_NOINLINE void linc_advance_hx(::Dynamic cb) {
+static LORELINE_NOINLINE void linc_advance_hx(Loreline_Interpreter* h) {
     LORELINE_HX_BEGIN
-    try {
-        cb->__run();
-    } catch (::Dynamic e) {
-        ::String msg = (::String)e;
-        fprintf(stderr, "Loreline advance error: %s\n", msg.c_str());
+    /* A pending choice is left as is: it can only be resumed by select */
+    if (h->pendingCb && h->pendingKind == Loreline_PendingDialogue) {
+        ::Dynamic cb = ::Dynamic(h->pendingCb);
+        h->setPendingCallback(nullptr, Loreline_PendingNone);
+        try {
+            cb->__run();
+        } catch (::Dynamic e) {
+            ::String msg = (::String)e;
+            fprintf(stderr, "Loreline advance error: %s\n", msg.c_str());
+        }
     }
     LORELINE_HX_END
 }
 
-static void linc_advance() {
-    Loreline_Interpreter* h = s_dispatchInterp;
-    if (!h || !h->pendingCb) return;
-    ::Dynamic cb = ::Dynamic(h->pendingCb);
-    h->setPendingCallback(nullptr);
-    LORELINE_BEGIN_CALL
-    linc_advance_hx(cb);
-    LORELINE_END_CALL
+static LORELINE_NOINLINE void linc_select_hx(Loreline_Interpreter* h, int index) {
+    LORELINE_HX_BEGIN
+    /* A pending dialogue is left as is: it can only be resumed by advance */
+    if (h->pendingCb && h->pendingKind == Loreline_PendingChoice) {
+        ::Dynamic cb = ::Dynamic(h->pendingCb);
+        h->setPendingCallback(nullptr, Loreline_PendingNone);
+        try {
+            cb->__run(index);
+        } catch (::Dynamic e) {
+            ::String msg = (::String)e;
+            fprintf(stderr, "Loreline select error: %s\n", msg.c_str());
+        }
+    }
+    LORELINE_HX_END
 }
 
-static LORELINE_NOINLINE void linc_select_hx(::Dynamic cb, int index) {
-    LORELINE_HX_BEGIN
-    try {
-        cb->__run(index);
-    } catch (::Dynamic e) {
-        ::String msg = (::String)e;
-        fprintf(stderr, "Loreline select error: %s\n", msg.c_str());
-    }
-    LORELINE_HX_END
+LORELINE_PUBLIC void Loreline_advance(Loreline_Interpreter* interp) {
+    if (!interp) return;
+    LORELINE_BEGIN_INTERP_CALL(interp)
+    linc_advance_hx(interp);
+    LORELINE_END_CALL
 }
 
-static void linc_select(int index) {
-    Loreline_Interpreter* h = s_dispatchInterp;
-    if (!h || !h->pendingCb) return;
-    ::Dynamic cb = ::Dynamic(h->pendingCb);
-    h->setPendingCallback(nullptr);
-    LORELINE_BEGIN_CALL
-    linc_select_hx(cb, index);
+LORELINE_PUBLIC void Loreline_select(Loreline_Interpreter* interp, int index) {
+    if (!interp) return;
+    LORELINE_BEGIN_INTERP_CALL(interp)
+    linc_select_hx(interp, index);
     LORELINE_END_CALL
 }
 
+static void linc_advance() {
+    Loreline_advance(s_dispatchInterp);
+}
+
+static void linc_select(int index) {
+    Loreline_select(s_dispatchInterp, index);
+}
+
 /* ── File request token ────────────────────────────────────────────────── */
 
 /* Per-call retainer for an in-flight file load. Holds a GC root on the Haxe
@@ -799,6 +1468,90 @@ LORELINE_PUBLIC void Loreline_provideFile(Loreline_FileRequest* request, Lorelin
     LORELINE_END_CALL
 }
 
+/* ── Parallel lexing ────────────────────────────────────────────────────── */
+
+/* An imported file being lexed on another pool worker. Holds GC roots on the
+ * Haxe callback (called back on the first worker, which runs the parse) and,
+ * once lexed, on the resulting ParseCacheEntry while it travels back. */
+struct Loreline_LexRequest {
+    hx::Object* cb;
+    hx::Object* result;
+    Loreline_String content;
+
+    Loreline_LexRequest() : cb(nullptr), result(nullptr) {}
+
+    void setCallback(hx::Object* c) {
+        cb = c;
+        if (cb) hx::GCAddRoot(&cb);
+    }
+
+    void setResult(hx::Object* r) {
+        result = r;
+        if (result) hx::GCAddRoot(&result);
+    }
+
+    ~Loreline_LexRequest() {
+        if (cb) { hx::GCRemoveRoot(&cb); cb = nullptr; }
+        if (result) { hx::GCRemoveRoot(&result); result = nullptr; }
+    }
+
+private:
+    Loreline_LexRequest(const Loreline_LexRequest&);
+    Loreline_LexRequest& operator=(const Loreline_LexRequest&);
+};
+
+static LORELINE_NOINLINE void Loreline_lexFileDone_hx(Loreline_LexRequest* req) {
+    LORELINE_HX_BEGIN
+    ::Dynamic cb(req->cb);
+    try {
+        ::Dynamic lexed(req->result);
+        if (hx::IsNull(lexed)) {
+            /* Lexing failed on the worker: lex here, reporting the same way as inline lexing */
+            lexed = ::loreline::ParseCache_obj::lex(linc_toHxString(req->content));
+        }
+        cb->__run(lexed);
+    } catch (::Dynamic e) {
+        fprintf(stderr, "Loreline lex error: %s\n", ((::String)e).c_str());
+    }
+    delete req;
+    LORELINE_HX_END
+}
+
+static LORELINE_NOINLINE void Loreline_lexFile_hx(Loreline_LexRequest* req) {
+    LORELINE_HX_BEGIN
+    try {
+        ::loreline::ParseCacheEntry lexed =
+            ::loreline::ParseCache_obj::lex(linc_toHxString(req->content));
+        req->setResult(lexed.GetPtr());
+    } catch (::Dynamic e) {
+        /* Left to Loreline_lexFileDone_hx */
+    }
+    LORELINE_HX_END
+}
+
+/* Lex handler (Imports.lexHandler): 3 Haxe args. Called on the first worker
+ * when an imported file is delivered: lexes it on another worker, then calls
+ * back on the first worker, which keeps receiving the other files meanwhile. */
+HX_BEGIN_LOCAL_FUNC_S0(::hx::LocalFunc, _hx_Closure_lexFile) HXARGC(3)
+void _hx_run(::Dynamic hxPath, ::Dynamic hxData, ::Dynamic hxCallback) {
+    Loreline_LexRequest* req = new Loreline_LexRequest();
+    req->setCallback(hxCallback.GetPtr());
+    req->content = linc_hxToString((::String)hxData);
+    linc_Loreline_pickLexWorker()->schedule([req]() {
+        Loreline_lexFile_hx(req);
+        linc_Loreline_thread->schedule([req]() {
+            Loreline_lexFileDone_hx(req);
+        });
+    });
+}
+HX_END_LOCAL_FUNC3((void))
+
+static LORELINE_NOINLINE void Loreline_createThreadPool_hx() {
+    LORELINE_HX_BEGIN
+    ::loreline::Imports_obj::lexHandler = ::Dynamic(new _hx_Closure_lexFile());
+    LORELINE_HX_END
+}
+
 /* ── Haxe callback closures (using hxcpp local func macros) ────────────── */
 
 /* Helper: lazily set the interpreter handle from the Haxe callback.
@@ -816,12 +1569,11 @@ HX_BEGIN_LOCAL_FUNC_S1(::hx::LocalFunc, _hx_Closure_dialogue,
 void _hx_run(::Dynamic hxInterp, ::Dynamic hxChar, ::Dynamic hxText,
              ::Dynamic hxTags, ::Dynamic hxCallback) {
     linc_ensureInterpHandle(h, hxInterp);
-    Loreline_String character = linc_hxToString((::String)hxChar);
-    Loreline_String text = linc_hxToString((::String)hxText);
-    Loreline_TextTag* tags = nullptr;
-    int tagCount = 0;
-    linc_buildTextTags(hxTags, &tags, &tagCount);
-    h->setPendingCallback(hxCallback.GetPtr());
+    Loreline_CallbackArena* arena = linc_acquireArena(h);
+    arena->character = linc_hxToInternedString((::String)hxChar);
+    arena->text = arena->string((::String)hxText);
+    int tagCount = linc_buildTextTags(arena, hxTags);
+    h->setPendingCallback(hxCallback.GetPtr(), Loreline_PendingDialogue);
 
     // Retain the host's userData before queueing so the queued lambda can't
     // fire into a freed interpreter.
@@ -831,14 +1583,15 @@ void _hx_run(::Dynamic hxInterp, ::Dynamic hxChar, ::Dynamic hxText,
     s_dispatchInterp = h;
     try {
         if (h->dialogueHandler) {
-            h->dialogueHandler(h, character, text, tags, tagCount, linc_advance, h->userData);
+            const Loreline_TextTag* tags = tagCount > 0 ? arena->tags.data() : nullptr;
+            h->dialogueHandler(h, arena->character, arena->text, tags, tagCount, linc_advance, h->userData);
         }
     } catch (...) {
-        delete[] tags;
+        linc_releaseArena(h, arena);
         if (h->release) h->release(r);
         throw;
     }
-    delete[] tags;
+    linc_releaseArena(h, arena);
     if (h->release) h->release(r);
     LORELINE_END_DISPATCH_OUT
 }
@@ -849,10 +1602,9 @@ HX_BEGIN_LOCAL_FUNC_S1(::hx::LocalFunc, _hx_Closure_choice,
     Loreline_Interpreter*, h) HXARGC(3)
 void _hx_run(::Dynamic hxInterp, ::Dynamic hxOptions, ::Dynamic hxCallback) {
     linc_ensureInterpHandle(h, hxInterp);
-    Loreline_ChoiceOption* options = nullptr;
-    int optionCount = 0;
-    linc_buildChoiceOptions(hxOptions, &options, &optionCount);
-    h->setPendingCallback(hxCallback.GetPtr());
+    Loreline_CallbackArena* arena = linc_acquireArena(h);
+    int optionCount = linc_buildChoiceOptions(arena, hxOptions);
+    h->setPendingCallback(hxCallback.GetPtr(), Loreline_PendingChoice);
 
     Loreline_Retainer *r = h->retain ? h->retain(h->userData) : nullptr;
 
@@ -860,14 +1612,15 @@ void _hx_run(::Dynamic hxInterp, ::Dynamic hxOptions, ::Dynamic hxCallback) {
     s_dispatchInterp = h;
     try {
         if (h->choiceHandler) {
+            const Loreline_ChoiceOption* options = optionCount > 0 ? arena->options.data() : nullptr;
             h->choiceHandler(h, options, optionCount, linc_select, h->userData);
         }
     } catch (...) {
-        linc_freeChoiceOptions(options, optionCount);
+        linc_releaseArena(h, arena);
         if (h->release) h->release(r);
         throw;
     }
-    linc_freeChoiceOptions(options, optionCount);
+    linc_releaseArena(h, arena);
     if (h->release) h->release(r);
     LORELINE_END_DISPATCH_OUT
 }
@@ -895,6 +1648,77 @@ void _hx_run(::Dynamic hxInterp) {
 }
 HX_END_LOCAL_FUNC1((void))
 
+/* Tells whether a changed field path is one the host subscribed to */
+static bool linc_matchesStateFilters(Loreline_Interpreter* h, const std::string& path) {
+    if (h->stateFilters.empty()) return true;
+    for (size_t i = 0; i < h->stateFilters.size(); i++) {
+        const std::string& filter = h->stateFilters[i];
+        if (path.compare(0, filter.size(), filter) == 0 &&
+            (path.size() == filter.size() || path[filter.size()] == '.')) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Reports the changes queued since the last flush, on the host thread */
+static void linc_flushStateChanges(Loreline_Interpreter* h) {
+    std::vector<std::pair<std::string, Loreline_Value>> changes;
+    {
+        std::lock_guard<std::mutex> lock(h->stateMutex);
+        changes.swap(h->pendingStateChanges);
+        h->stateFlushScheduled = false;
+    }
+    for (size_t i = 0; i < changes.size(); i++) {
+        const std::string& path = changes[i].first;
+        h->stateChangedHandler(h, Loreline_String(path.c_str(), path.size()), changes[i].second, h->userData);
+    }
+}
+
+/* State change handler: 1 capture (Loreline_Interpreter*), 3 Haxe args.
+ * Changes are coalesced by path: a single flush is queued until it runs,
+ * reporting the latest value of every path changed in the meantime. */
+HX_BEGIN_LOCAL_FUNC_S1(::hx::LocalFunc, _hx_Closure_stateChanged,
+    Loreline_Interpreter*, h) HXARGC(3)
+void _hx_run(::Dynamic hxInterp, ::Dynamic hxPath, ::Dynamic hxValue) {
+    ::String hxPathStr = (::String)hxPath;
+    std::string path(hxPathStr.utf8_str());
+    if (!linc_matchesStateFilters(h, path)) return;
+
+    Loreline_Value value = linc_hxToValue(hxValue);
+    bool scheduleFlush = false;
+    {
+        std::lock_guard<std::mutex> lock(h->stateMutex);
+        bool found = false;
+        for (size_t i = 0; i < h->pendingStateChanges.size(); i++) {
+            if (h->pendingStateChanges[i].first == path) {
+                h->pendingStateChanges[i].second = value;
+                found = true;
+                break;
+            }
+        }
+        if (!found) h->pendingStateChanges.push_back(std::make_pair(path, value));
+        if (!h->stateFlushScheduled) {
+            h->stateFlushScheduled = true;
+            scheduleFlush = true;
+        }
+    }
+    if (!scheduleFlush) return;
+
+    Loreline_Retainer *r = h->retain ? h->retain(h->userData) : nullptr;
+
+    LORELINE_BEGIN_DISPATCH_OUT
+    try {
+        linc_flushStateChanges(h);
+    } catch (...) {
+        if (h->release) h->release(r);
+        throw;
+    }
+    if (h->release) h->release(r);
+    LORELINE_END_DISPATCH_OUT
+}
+HX_END_LOCAL_FUNC3((void))
+
 /* File handler: 2 captures (Loreline_FileHandler, void*), 2 Haxe args.
  * Allocates a per-call Loreline_FileRequest that GC-roots the Haxe callback,
  * hands the token to the host. Host MUST eventually call Loreline_provideFile
@@ -944,6 +1768,7 @@ HX_BEGIN_LOCAL_FUNC_S4(::hx::LocalFunc, _hx_Closure_asyncFuncBody,
 void _hx_run(::Dynamic hxDone) {
     auto resolve = new Loreline_AsyncResolve();
     resolve->setDone(hxDone.GetPtr());
+    resolve->worker = h->worker;
 
     auto args = capturedArgs;
     auto cFn = fn;
@@ -989,6 +1814,17 @@ HX_END_LOCAL_FUNC1(return)
 
 /* ── Parse ──────────────────────────────────────────────────────────────── */
 
+/* Wraps a script into a handle, prepared right away: interpreters of the same
+ * script may run on different workers, and preparing binds the accesses of the
+ * shared nodes, so it has to happen before the handle is shared with any of them
+ * (play, resume, fork). Must be called on a Haxe thread. */
+static Loreline_Script* linc_newScript(::Dynamic hxScript) {
+    ::loreline::PreparedScript_obj::prepare((::loreline::Script)hxScript, false);
+    Loreline_Script* script = new Loreline_Script();
+    script->set(hxScript.GetPtr());
+    return script;
+}
+
 /* Parse completion closure: 2 captures (C completion fn, userData), 1 Haxe arg
  * (the resulting Script, may be null on parse failure). Wraps into Loreline_Script*
  * and dispatches the C completion via DISPATCH_OUT (host's update tick). */
@@ -997,8 +1833,7 @@ HX_BEGIN_LOCAL_FUNC_S2(::hx::LocalFunc, _hx_Closure_parseCompletion,
 void _hx_run(::Dynamic hxScript) {
     Loreline_Script* script = nullptr;
     if (!hx::IsNull(hxScript)) {
-        script = new Loreline_Script();
-        script->set(hxScript.GetPtr());
+        script = linc_newScript(hxScript);
     }
     LORELINE_BEGIN_DISPATCH_OUT
     if (completion) {
@@ -1014,6 +1849,7 @@ HX_END_LOCAL_FUNC1((void))
 static LORELINE_NOINLINE void Loreline_parseAsync_hx(
     Loreline_String input, Loreline_String filePath,
     Loreline_FileHandler fileHandler, void* fileHandlerData,
+    Loreline_ParseCache* cache,
     Loreline_ParseCompletionCallback completionHandler, void* completionHandlerData
 ) {
     LORELINE_HX_BEGIN
@@ -1029,8 +1865,13 @@ static LORELINE_NOINLINE void Loreline_parseAsync_hx(
     ::Dynamic hxCompletion = ::Dynamic(new _hx_Closure_parseCompletion(
         completionHandler, completionHandlerData));
 
+    ::loreline::ParseCache hxCache = null();
+    if (cache) {
+        hxCache = (::loreline::ParseCache)::Dynamic(cache->obj);
+    }
+
     try {
-        ::loreline::Loreline_obj::parse(hxInput, hxFilePath, hxFileHandler, hxCompletion);
+        ::loreline::Loreline_obj::parse(hxInput, hxFilePath, hxFileHandler, hxCompletion, hxCache);
         /* Result delivered via hxCompletion — sync (fires inline) or async (fires later) */
     } catch (::Dynamic e) {
         fprintf(stderr, "Loreline_parseAsync error: %s\n", ((::String)e).c_str());
@@ -1045,20 +1886,33 @@ static LORELINE_NOINLINE void Loreline_parseAsync_hx(
     LORELINE_HX_END
 }
 
-LORELINE_PUBLIC void Loreline_parseAsync(
+LORELINE_PUBLIC void Loreline_parseAsyncWithCache(
     Loreline_String input,
     Loreline_String filePath,
     Loreline_FileHandler fileHandler,
     void* fileHandlerData,
+    Loreline_ParseCache* cache,
     Loreline_ParseCompletionCallback completionHandler,
     void* completionHandlerData
 ) {
     LORELINE_BEGIN_CALL
-    Loreline_parseAsync_hx(input, filePath, fileHandler, fileHandlerData,
+    Loreline_parseAsync_hx(input, filePath, fileHandler, fileHandlerData, cache,
                            completionHandler, completionHandlerData);
     LORELINE_END_CALL
 }
 
+LORELINE_PUBLIC void Loreline_parseAsync(
+    Loreline_String input,
+    Loreline_String filePath,
+    Loreline_FileHandler fileHandler,
+    void* fileHandlerData,
+    Loreline_ParseCompletionCallback completionHandler,
+    void* completionHandlerData
+) {
+    Loreline_parseAsyncWithCache(input, filePath, fileHandler, fileHandlerData, nullptr,
+                                 completionHandler, completionHandlerData);
+}
+
 /* Sync wrapper: condvar-backed wait around Loreline_parseAsync. */
 struct Loreline_ParseSyncSlot {
     std::mutex mtx;
@@ -1075,20 +1929,91 @@ static void Loreline_parseSync_completion(Loreline_Script* script, void* userDat
     slot->cv.notify_one();
 }
 
-LORELINE_PUBLIC Loreline_Script* Loreline_parse(
+LORELINE_PUBLIC Loreline_Script* Loreline_parseWithCache(
     Loreline_String input,
     Loreline_String filePath,
     Loreline_FileHandler fileHandler,
-    void* fileHandlerData
+    void* fileHandlerData,
+    Loreline_ParseCache* cache
 ) {
     Loreline_ParseSyncSlot slot;
-    Loreline_parseAsync(input, filePath, fileHandler, fileHandlerData,
-                        Loreline_parseSync_completion, &slot);
+    Loreline_parseAsyncWithCache(input, filePath, fileHandler, fileHandlerData, cache,
+                                 Loreline_parseSync_completion, &slot);
     std::unique_lock<std::mutex> lock(slot.mtx);
     slot.cv.wait(lock, [&]() { return slot.done; });
     return slot.result;
 }
 
+LORELINE_PUBLIC Loreline_Script* Loreline_parse(
+    Loreline_String input,
+    Loreline_String filePath,
+    Loreline_FileHandler fileHandler,
+    void* fileHandlerData
+) {
+    return Loreline_parseWithCache(input, filePath, fileHandler, fileHandlerData, nullptr);
+}
+
+/* ── Parse cache ────────────────────────────────────────────────────────── */
+
+static LORELINE_NOINLINE void Loreline_createParseCache_hx(Loreline_ParseCache** outHandle) {
+    LORELINE_HX_BEGIN
+    *outHandle = new Loreline_ParseCache();
+    (*outHandle)->set(::loreline::ParseCache_obj::__new().GetPtr());
+    LORELINE_HX_END
+}
+
+LORELINE_PUBLIC Loreline_ParseCache* Loreline_createParseCache(void) {
+    Loreline_ParseCache* handle = nullptr;
+
+    LORELINE_BEGIN_CALL_SYNC
+    Loreline_createParseCache_hx(&handle);
+    LORELINE_END_CALL
+
+    return handle;
+}
+
+static LORELINE_NOINLINE void Loreline_clearParseCache_hx(Loreline_ParseCache* cache) {
+    LORELINE_HX_BEGIN
+    ((::loreline::ParseCache)::Dynamic(cache->obj))->clear();
+    LORELINE_HX_END
+}
+
+LORELINE_PUBLIC void Loreline_clearParseCache(Loreline_ParseCache* cache) {
+    if (!cache) return;
+    LORELINE_BEGIN_CALL
+    Loreline_clearParseCache_hx(cache);
+    LORELINE_END_CALL
+}
+
+static LORELINE_NOINLINE void Loreline_releaseParseCache_hx(Loreline_ParseCache* cache) {
+    LORELINE_HX_BEGIN
+    delete cache;
+    LORELINE_HX_END
+}
+
+LORELINE_PUBLIC void Loreline_releaseParseCache(Loreline_ParseCache* cache) {
+    if (!cache) return;
+    LORELINE_BEGIN_CALL
+    Loreline_releaseParseCache_hx(cache);
+    LORELINE_END_CALL
+}
+
+/* ── Preparation ────────────────────────────────────────────────────────── */
+
+static LORELINE_NOINLINE void Loreline_prepareScript_hx(Loreline_Script* script) {
+    LORELINE_HX_BEGIN
+    ::loreline::Script hxScript = (::loreline::Script)::Dynamic(script->obj);
+    ::loreline::PreparedScript_obj::prepare(hxScript);
+    LORELINE_HX_END
+}
+
+LORELINE_PUBLIC void Loreline_prepareScript(Loreline_Script* script) {
+    if (!script) return;
+    LORELINE_BEGIN_CALL_SYNC
+    Loreline_prepareScript_hx(script);
+    LORELINE_END_CALL
+}
+
 /* ── Translations ───────────────────────────────────────────────────────── */
 
 static LORELINE_NOINLINE void Loreline_extractTranslations_hx(
@@ -1242,6 +2167,28 @@ LORELINE_PUBLIC Loreline_Translations* Loreline_loadLocale(
     return slot.result;
 }
 
+static LORELINE_NOINLINE void Loreline_setInterpreterTranslations_hx(
+    Loreline_Interpreter* interp, hx::Object* translationsObj
+) {
+    LORELINE_HX_BEGIN
+    ::loreline::Interpreter hxInterp = (::loreline::Interpreter)::Dynamic(interp->obj);
+    /* The interpreter resolves translations again whenever the map changes */
+    hxInterp->translations = translationsObj
+        ? (::haxe::ds::StringMap)::Dynamic(translationsObj) : null();
+    LORELINE_HX_END
+}
+
+LORELINE_PUBLIC void Loreline_setInterpreterTranslations(
+    Loreline_Interpreter* interp, Loreline_Translations* translations
+) {
+    if (!interp) return;
+    hx::Object* translationsObj = translations ? translations->obj : nullptr;
+
+    LORELINE_BEGIN_INTERP_CALL_SYNC(interp)
+    Loreline_setInterpreterTranslations_hx(interp, translationsObj);
+    LORELINE_END_CALL
+}
+
 /* ── Translation formats ────────────────────────────────────────────────── */
 
 static LORELINE_NOINLINE void Loreline_translationFormat_hx(
@@ -1282,6 +2229,72 @@ LORELINE_PUBLIC Loreline_String Loreline_lastError(void) {
     return out;
 }
 
+/* Build the Haxe InterpreterOptions of an interpreter handle from C options.
+ * Custom functions are bound to `h`. Returns null if `opts` is NULL. */
+static ::Dynamic linc_buildHxOptions(Loreline_InterpreterOptions* opts, Loreline_Interpreter* h) {
+    if (!opts) return null();
+
+    /* Build Haxe functions StringMap from C entries */
+    ::Dynamic hxFunctions = null();
+    if (!opts->functions.empty()) {
+        ::haxe::ds::StringMap map = ::haxe::ds::StringMap_obj::__new();
+        for (size_t i = 0; i < opts->functions.size(); i++) {
+            const auto& entry = opts->functions[i];
+            ::Dynamic hxFunc;
+            if (entry.syncFn) {
+                hxFunc = ::Dynamic(
+                    new _hx_Closure_customFunction(
+                        entry.syncFn, entry.userData, h));
+            } else {
+                hxFunc = ::Dynamic(
+                    new _hx_Closure_asyncCustomFunction(
+                        entry.asyncFn, entry.userData, h));
+            }
+            // Wrap with Reflect.makeVarArgs so the Interpreter can invoke
+            // via positional Reflect.callMethod; our closures expect a single
+            // Array<Any> argument containing all script-level positional args.
+            hxFunc = ::Reflect_obj::makeVarArgs(hxFunc);
+            map->set(::String::create(entry.name.c_str(), (int)entry.name.size()), hxFunc);
+        }
+        hxFunctions = map;
+    }
+
+    ::Dynamic hxTranslations = opts->translationsObj
+        ? ::Dynamic(opts->translationsObj) : null();
+
+    /* customCreateFields is not meaningfully bridgeable through the C API
+     * since it returns Haxe-internal field objects. Passing null causes
+     * the interpreter to use its default field creation, which is correct. */
+
+    return ::loreline::InterpreterOptions_obj::__new(
+        hxFunctions,
+        opts->strictAccess,
+        null(), /* customCreateFields — not exposed through C API */
+        hxTranslations,
+        null()  /* stringLiteralProcessors — not exposed */
+    );
+}
+
+/* Copies the options that are not part of the Haxe options (state change
+ * subscription, execution budget) to the handle */
+static void linc_applyHandleOptions(Loreline_Interpreter* h, Loreline_InterpreterOptions* opts) {
+    if (!opts) return;
+    h->stepBudget = opts->stepBudget;
+    h->timeBudget = opts->timeBudget;
+    if (!opts->stateChangedHandler) return;
+    h->stateChangedHandler = opts->stateChangedHandler;
+    h->stateFilters = opts->stateFilters;
+}
+
+/* Applies the handle options to the interpreter, before it runs anything */
+static void linc_hookInterpreter(Loreline_Interpreter* h, ::loreline::Interpreter hxInterp) {
+    hxInterp->stepBudget = h->stepBudget;
+    hxInterp->timeBudget = h->timeBudget;
+    if (h->stateChangedHandler) {
+        hxInterp->onStateChange = ::Dynamic(new _hx_Closure_stateChanged(h));
+    }
+}
+
 /* ── Play ───────────────────────────────────────────────────────────────── */
 
 static LORELINE_NOINLINE void Loreline_play_hx(
@@ -1295,54 +2308,15 @@ static LORELINE_NOINLINE void Loreline_play_hx(
     ::Dynamic hxChoiceHandler = ::Dynamic(new _hx_Closure_choice(h));
     ::Dynamic hxFinishHandler = ::Dynamic(new _hx_Closure_finish(h));
 
-    ::Dynamic hxOptions = null();
-    if (opts) {
-        /* Build Haxe functions StringMap from C entries */
-        ::Dynamic hxFunctions = null();
-        if (!opts->functions.empty()) {
-            ::haxe::ds::StringMap map = ::haxe::ds::StringMap_obj::__new();
-            for (size_t i = 0; i < opts->functions.size(); i++) {
-                const auto& entry = opts->functions[i];
-                ::Dynamic hxFunc;
-                if (entry.syncFn) {
-                    hxFunc = ::Dynamic(
-                        new _hx_Closure_customFunction(
-                            entry.syncFn, entry.userData, h));
-                } else {
-                    hxFunc = ::Dynamic(
-                        new _hx_Closure_asyncCustomFunction(
-                            entry.asyncFn, entry.userData, h));
-                }
-                // Wrap with Reflect.makeVarArgs so the Interpreter can invoke
-                // via positional Reflect.callMethod; our closures expect a single
-                // Array<Any> argument containing all script-level positional args.
-                hxFunc = ::Reflect_obj::makeVarArgs(hxFunc);
-                map->set(::String(entry.name.c_str()), hxFunc);
-            }
-            hxFunctions = map;
-        }
-
-        ::Dynamic hxTranslations = opts->translationsObj
-            ? ::Dynamic(opts->translationsObj) : null();
-
-        /* customCreateFields is not meaningfully bridgeable through the C API
-         * since it returns Haxe-internal field objects. Passing null causes
-         * the interpreter to use its default field creation, which is correct. */
-
-        hxOptions = ::loreline::InterpreterOptions_obj::__new(
-            hxFunctions,
-            opts->strictAccess,
-            null(), /* customCreateFields — not exposed through C API */
-            hxTranslations,
-            null()  /* stringLiteralProcessors — not exposed */
-        );
-    }
+    ::Dynamic hxOptions = linc_buildHxOptions(opts, h);
 
     try {
-        ::Dynamic hxInterp = ::loreline::Loreline_obj::play(
-            hxScript, hxDialogueHandler, hxChoiceHandler, hxFinishHandler, hxBeatName, hxOptions
+        ::loreline::Interpreter hxInterp = ::loreline::Interpreter_obj::__new(
+            hxScript, hxDialogueHandler, hxChoiceHandler, hxFinishHandler, hxOptions
         );
+        linc_hookInterpreter(h, hxInterp);
         h->set(hxInterp.GetPtr());
+        hxInterp->start(hxBeatName);
     } catch (::Dynamic e) {
         fprintf(stderr, "Loreline_play error: %s\n", ((::String)e).c_str());
     }
@@ -1370,11 +2344,13 @@ LORELINE_PUBLIC Loreline_Interpreter* Loreline_play(
     handle->userData = userData;
     handle->retain = retain;
     handle->release = release;
+    handle->worker = linc_Loreline_pickWorker();
+    linc_applyHandleOptions(handle, options);
 
     Loreline_Interpreter* h = handle;
     ::Dynamic hxScript = ::Dynamic(script->obj);
 
-    LORELINE_BEGIN_CALL
+    LORELINE_BEGIN_INTERP_CALL(h)
     Loreline_play_hx(h, hxScript, beatName, options);
     LORELINE_END_CALL
 
@@ -1391,57 +2367,32 @@ static LORELINE_NOINLINE void Loreline_resume_hx(
     LORELINE_HX_BEGIN
 
     ::String hxBeatName = linc_toHxString(beatName);
-    ::String hxSaveStr = linc_toHxString(saveData);
-    ::Dynamic hxSaveData = ::loreline::Json_obj::parse(hxSaveStr);
+    /* Binary saves are restored straight from their bytes */
+    bool binarySave = linc_isBinarySave(saveData);
+    ::Dynamic hxSaveData = binarySave ? ::Dynamic(null()) : linc_toHxSaveData(saveData);
 
     ::Dynamic hxDialogueHandler = ::Dynamic(new _hx_Closure_dialogue(h));
     ::Dynamic hxChoiceHandler = ::Dynamic(new _hx_Closure_choice(h));
     ::Dynamic hxFinishHandler = ::Dynamic(new _hx_Closure_finish(h));
 
-    ::Dynamic hxOptions = null();
-    if (opts) {
-        ::Dynamic hxFunctions = null();
-        if (!opts->functions.empty()) {
-            ::haxe::ds::StringMap map = ::haxe::ds::StringMap_obj::__new();
-            for (size_t i = 0; i < opts->functions.size(); i++) {
-                const auto& entry = opts->functions[i];
-                ::Dynamic hxFunc;
-                if (entry.syncFn) {
-                    hxFunc = ::Dynamic(
-                        new _hx_Closure_customFunction(
-                            entry.syncFn, entry.userData, h));
-                } else {
-                    hxFunc = ::Dynamic(
-                        new _hx_Closure_asyncCustomFunction(
-                            entry.asyncFn, entry.userData, h));
-                }
-                // Wrap with Reflect.makeVarArgs so the Interpreter can invoke
-                // via positional Reflect.callMethod; our closures expect a single
-                // Array<Any> argument containing all script-level positional args.
-                hxFunc = ::Reflect_obj::makeVarArgs(hxFunc);
-                map->set(::String(entry.name.c_str()), hxFunc);
-            }
-            hxFunctions = map;
-        }
-
-        ::Dynamic hxTranslations = opts->translationsObj
-            ? ::Dynamic(opts->translationsObj) : null();
-
-        hxOptions = ::loreline::InterpreterOptions_obj::__new(
-            hxFunctions,
-            opts->strictAccess,
-            null(),
-            hxTranslations,
-            null()
-        );
-    }
+    ::Dynamic hxOptions = linc_buildHxOptions(opts, h);
 
     try {
-        ::Dynamic hxInterp = ::loreline::Loreline_obj::resume(
-            hxScript, hxDialogueHandler, hxChoiceHandler, hxFinishHandler,
-            hxSaveData, hxBeatName, hxOptions
+        ::loreline::Interpreter hxInterp = ::loreline::Interpreter_obj::__new(
+            hxScript, hxDialogueHandler, hxChoiceHandler, hxFinishHandler, hxOptions
         );
+        linc_hookInterpreter(h, hxInterp);
         h->set(hxInterp.GetPtr());
+        if (binarySave) {
+            hxInterp->restoreBinary(linc_toHxBytes(saveData));
+        } else {
+            hxInterp->restore(hxSaveData);
+        }
+        if (hxBeatName != null()) {
+            hxInterp->start(hxBeatName);
+        } else {
+            hxInterp->resume();
+        }
     } catch (::Dynamic e) {
         fprintf(stderr, "Loreline_resume error: %s\n", ((::String)e).c_str());
     }
@@ -1470,17 +2421,140 @@ LORELINE_PUBLIC Loreline_Interpreter* Loreline_resume(
     handle->userData = userData;
     handle->retain = retain;
     handle->release = release;
+    handle->worker = linc_Loreline_pickWorker();
+    linc_applyHandleOptions(handle, options);
 
     Loreline_Interpreter* h = handle;
     ::Dynamic hxScript = ::Dynamic(script->obj);
 
-    LORELINE_BEGIN_CALL
+    LORELINE_BEGIN_INTERP_CALL(h)
     Loreline_resume_hx(h, hxScript, saveData, beatName, options);
     LORELINE_END_CALL
 
     return handle;
 }
 
+/* ── Fork ───────────────────────────────────────────────────────────────── */
+
+static LORELINE_NOINLINE void Loreline_forkInterpreter_hx(
+    Loreline_Interpreter* h, Loreline_Interpreter* source,
+    Loreline_InterpreterOptions* opts
+) {
+    LORELINE_HX_BEGIN
+
+    if (source->obj) {
+        ::Dynamic hxDialogueHandler = ::Dynamic(new _hx_Closure_dialogue(h));
+        ::Dynamic hxChoiceHandler = ::Dynamic(new _hx_Closure_choice(h));
+        ::Dynamic hxFinishHandler = ::Dynamic(new _hx_Closure_finish(h));
+
+        ::Dynamic hxOptions = linc_buildHxOptions(opts, h);
+
+        try {
+            ::loreline::Interpreter hxSource = (::loreline::Interpreter)::Dynamic(source->obj);
+            ::loreline::Interpreter hxInterp = hxSource->fork(
+                hxDialogueHandler, hxChoiceHandler, hxFinishHandler, hxOptions
+            );
+            linc_hookInterpreter(h, hxInterp);
+            h->set(hxInterp.GetPtr());
+            hxInterp->resume();
+        } catch (::Dynamic e) {
+            fprintf(stderr, "Loreline_forkInterpreter error: %s\n", ((::String)e).c_str());
+        }
+    }
+
+    LORELINE_HX_END
+}
+
+LORELINE_PUBLIC Loreline_Interpreter* Loreline_forkInterpreter(
+    Loreline_Interpreter* interp,
+    Loreline_DialogueHandler onDialogue,
+    Loreline_ChoiceHandler onChoice,
+    Loreline_FinishHandler onFinish,
+    Loreline_InterpreterOptions* options,
+    void* userData,
+    Loreline_UserDataRetain retain,
+    Loreline_UserDataRelease release
+) {
+    if (!interp) return nullptr;
+
+    Loreline_Interpreter* handle = new Loreline_Interpreter();
+    handle->dialogueHandler = onDialogue;
+    handle->choiceHandler = onChoice;
+    handle->finishHandler = onFinish;
+    handle->userData = userData;
+    handle->retain = retain;
+    handle->release = release;
+    /* Same worker as the source: its state is read in order with its other calls */
+    handle->worker = interp->worker;
+    linc_applyHandleOptions(handle, options);
+
+    Loreline_Interpreter* h = handle;
+    Loreline_Interpreter* source = interp;
+
+    LORELINE_BEGIN_INTERP_CALL(h)
+    Loreline_forkInterpreter_hx(h, source, options);
+    LORELINE_END_CALL
+
+    return handle;
+}
+
+/* ── Look-ahead ─────────────────────────────────────────────────────────── */
+
+static LORELINE_NOINLINE void Loreline_peekUpcoming_hx(
+    Loreline_Interpreter* interp, Loreline_UpcomingLine* outLines, int max, int* outCount
+) {
+    LORELINE_HX_BEGIN
+    ::loreline::Interpreter hxInterp = (::loreline::Interpreter)::Dynamic(interp->obj);
+
+    try {
+        ::Dynamic hxLines = hxInterp->peekUpcoming(max);
+        ::cpp::VirtualArray arr = (::cpp::VirtualArray)hxLines;
+        int count = arr->get_length();
+        if (count > max) count = max;
+
+        if (!interp->upcoming) interp->upcoming = new Loreline_CallbackArena();
+        Loreline_CallbackArena* arena = interp->upcoming;
+        arena->reset();
+
+        for (int i = 0; i < count; i++) {
+            ::Dynamic hxLine = arr->__get(i);
+            ::Dynamic hxNode = hxLine->__Field(HX_CSTRING("node"), hx::paccDynamic);
+            Loreline_UpcomingLine& line = outLines[i];
+            line.nodeId = hx::IsNull(hxNode) ? Loreline_String()
+                : linc_hxToString(hxNode->__Field(HX_CSTRING("id"), hx::paccDynamic)->toString());
+            line.character = linc_hxToInternedString((::String)hxLine->__Field(HX_CSTRING("character"), hx::paccDynamic));
+            line.text = linc_hxToString((::String)hxLine->__Field(HX_CSTRING("text"), hx::paccDynamic));
+            arena->tagStarts.push_back(arena->tags.size());
+            line.tagCount = linc_buildTextTags(arena, hxLine->__Field(HX_CSTRING("tags"), hx::paccDynamic));
+        }
+
+        /* Tags are only pointed to once they are all added, as adding may move them */
+        for (int i = 0; i < count; i++) {
+            Loreline_UpcomingLine& line = outLines[i];
+            line.tags = line.tagCount > 0 ? arena->tags.data() + arena->tagStarts[i] : nullptr;
+        }
+
+        *outCount = count;
+    } catch (::Dynamic e) {
+        fprintf(stderr, "Loreline_peekUpcoming error: %s\n", ((::String)e).c_str());
+    }
+
+    LORELINE_HX_END
+}
+
+LORELINE_PUBLIC int Loreline_peekUpcoming(
+    Loreline_Interpreter* interp, Loreline_UpcomingLine* outLines, int max
+) {
+    if (!interp || !outLines || max <= 0) return 0;
+    int count = 0;
+
+    LORELINE_BEGIN_INTERP_CALL_SYNC(interp)
+    Loreline_peekUpcoming_hx(interp, outLines, max, &count);
+    LORELINE_END_CALL
+
+    return count;
+}
+
 /* ── Interpreter methods ────────────────────────────────────────────────── */
 
 static LORELINE_NOINLINE void Loreline_start_hx(Loreline_Interpreter* interp, Loreline_String beatName) {
@@ -1494,7 +2568,7 @@ static LORELINE_NOINLINE void Loreline_start_hx(Loreline_Interpreter* interp, Lo
 LORELINE_PUBLIC void Loreline_start(Loreline_Interpreter* interp, Loreline_String beatName) {
     if (!interp) return;
 
-    LORELINE_BEGIN_CALL
+    LORELINE_BEGIN_INTERP_CALL(interp)
     Loreline_start_hx(interp, beatName);
     LORELINE_END_CALL
 }
@@ -1512,7 +2586,7 @@ LORELINE_PUBLIC Loreline_String Loreline_save(Loreline_Interpreter* interp) {
     if (!interp) return Loreline_String();
     Loreline_String result;
 
-    LORELINE_BEGIN_CALL_SYNC
+    LORELINE_BEGIN_INTERP_CALL_SYNC(interp)
     Loreline_save_hx(interp, &result);
     LORELINE_END_CALL
 
@@ -1521,10 +2595,12 @@ LORELINE_PUBLIC Loreline_String Loreline_save(Loreline_Interpreter* interp) {
 
 static LORELINE_NOINLINE void Loreline_restore_hx(Loreline_Interpreter* interp, Loreline_String saveData) {
     LORELINE_HX_BEGIN
-    ::String hxSaveStr = linc_toHxString(saveData);
     ::loreline::Interpreter hxInterp = (::loreline::Interpreter)::Dynamic(interp->obj);
-    ::Dynamic hxSaveData = ::loreline::Json_obj::parse(hxSaveStr);
-    hxInterp->restore(hxSaveData);
+    if (linc_isBinarySave(saveData)) {
+        hxInterp->restoreBinary(linc_toHxBytes(saveData));
+    } else {
+        hxInterp->restore(linc_toHxSaveData(saveData));
+    }
     hxInterp->resume();
     LORELINE_HX_END
 }
@@ -1532,11 +2608,121 @@ static LORELINE_NOINLINE void Loreline_restore_hx(Loreline_Interpreter* interp,
 LORELINE_PUBLIC void Loreline_restore(Loreline_Interpreter* interp, Loreline_String saveData) {
     if (!interp || saveData.isNull()) return;
 
-    LORELINE_BEGIN_CALL
+    LORELINE_BEGIN_INTERP_CALL(interp)
     Loreline_restore_hx(interp, saveData);
     LORELINE_END_CALL
 }
 
+static LORELINE_NOINLINE void Loreline_saveBinary_hx(Loreline_Interpreter* interp, Loreline_String* outResult) {
+    LORELINE_HX_BEGIN
+    ::loreline::Interpreter hxInterp = (::loreline::Interpreter)::Dynamic(interp->obj);
+    ::haxe::io::Bytes bytes = hxInterp->saveBinary();
+    *outResult = linc_hxBytesToString(bytes);
+    LORELINE_HX_END
+}
+
+LORELINE_PUBLIC Loreline_String Loreline_saveBinary(Loreline_Interpreter* interp) {
+    if (!interp) return Loreline_String();
+    Loreline_String result;
+
+    LORELINE_BEGIN_INTERP_CALL_SYNC(interp)
+    Loreline_saveBinary_hx(interp, &result);
+    LORELINE_END_CALL
+
+    return result;
+}
+
+static LORELINE_NOINLINE void Loreline_restoreBinary_hx(Loreline_Interpreter* interp, Loreline_String saveData) {
+    LORELINE_HX_BEGIN
+    ::loreline::Interpreter hxInterp = (::loreline::Interpreter)::Dynamic(interp->obj);
+    hxInterp->restoreBinary(linc_toHxBytes(saveData));
+    hxInterp->resume();
+    LORELINE_HX_END
+}
+
+LORELINE_PUBLIC void Loreline_restoreBinary(Loreline_Interpreter* interp, Loreline_String saveData) {
+    if (!interp || saveData.isNull()) return;
+
+    LORELINE_BEGIN_INTERP_CALL(interp)
+    Loreline_restoreBinary_hx(interp, saveData);
+    LORELINE_END_CALL
+}
+
+static LORELINE_NOINLINE void Loreline_saveDelta_hx(
+    Loreline_Interpreter* interp, int sinceToken, Loreline_String* outResult
+) {
+    LORELINE_HX_BEGIN
+    ::loreline::Interpreter hxInterp = (::loreline::Interpreter)::Dynamic(interp->obj);
+    try {
+        ::Dynamic delta = hxInterp->saveDelta(sinceToken);
+        *outResult = linc_hxToString(::loreline::Json_obj::stringify(delta, false));
+    } catch (::Dynamic e) {
+        fprintf(stderr, "Loreline_saveDelta error: %s\n", ((::String)e).c_str());
+    }
+    LORELINE_HX_END
+}
+
+LORELINE_PUBLIC Loreline_String Loreline_saveDelta(Loreline_Interpreter* interp, int sinceToken) {
+    if (!interp) return Loreline_String();
+    Loreline_String result;
+
+    LORELINE_BEGIN_INTERP_CALL_SYNC(interp)
+    Loreline_saveDelta_hx(interp, sinceToken, &result);
+    LORELINE_END_CALL
+
+    return result;
+}
+
+static LORELINE_NOINLINE void Loreline_saveToken_hx(Loreline_Interpreter* interp, int* outResult) {
+    LORELINE_HX_BEGIN
+    ::loreline::Interpreter hxInterp = (::loreline::Interpreter)::Dynamic(interp->obj);
+    *outResult = hxInterp->saveToken;
+    LORELINE_HX_END
+}
+
+LORELINE_PUBLIC int Loreline_saveToken(Loreline_Interpreter* interp) {
+    if (!interp) return 0;
+    int result = 0;
+
+    LORELINE_BEGIN_INTERP_CALL_SYNC(interp)
+    Loreline_saveToken_hx(interp, &result);
+    LORELINE_END_CALL
+
+    return result;
+}
+
+static LORELINE_NOINLINE void Loreline_applySaveDeltas_hx(
+    Loreline_String saveData, const Loreline_String* deltas, int deltaCount,
+    Loreline_String* outResult
+) {
+    LORELINE_HX_BEGIN
+    try {
+        ::Dynamic hxSaveData = linc_toHxSaveData(saveData);
+        ::Array< ::Dynamic> hxDeltas = ::Array_obj< ::Dynamic>::__new(0, deltaCount);
+        for (int i = 0; i < deltaCount; i++) {
+            hxDeltas->push(::loreline::Json_obj::parse(linc_toHxString(deltas[i])));
+        }
+        ::Dynamic merged = ::loreline::SaveDelta_obj::apply(hxSaveData, hxDeltas);
+        *outResult = linc_hxToString(::loreline::Json_obj::stringify(merged, false));
+    } catch (::Dynamic e) {
+        fprintf(stderr, "Loreline_applySaveDeltas error: %s\n", ((::String)e).c_str());
+    }
+    LORELINE_HX_END
+}
+
+LORELINE_PUBLIC Loreline_String Loreline_applySaveDeltas(
+    Loreline_String saveData, const Loreline_String* deltas, int deltaCount
+) {
+    if (saveData.isNull() || deltaCount < 0 || (deltaCount > 0 && !deltas)) return Loreline_String();
+    Loreline_String result;
+
+    LORELINE_BEGIN_CALL_SYNC
+    Loreline_applySaveDeltas_hx(saveData, deltas, deltaCount, &result);
+    LORELINE_END_CALL
+
+    return result;
+}
+
 /* ── Character access ───────────────────────────────────────────────────── */
 
 static LORELINE_NOINLINE void Loreline_getCharacterField_hx(
@@ -1556,7 +2742,7 @@ LORELINE_PUBLIC Loreline_Value Loreline_getCharacterField(
     if (!interp || character.isNull() || field.isNull()) return Loreline_Value::null_val();
     Loreline_Value result;
 
-    LORELINE_BEGIN_CALL_SYNC
+    LORELINE_BEGIN_INTERP_CALL_SYNC(interp)
     Loreline_getCharacterField_hx(interp, character, field, &result);
     LORELINE_END_CALL
 
@@ -1578,7 +2764,7 @@ LORELINE_PUBLIC void Loreline_setCharacterField(
 ) {
     if (!interp || character.isNull() || field.isNull()) return;
 
-    LORELINE_BEGIN_CALL
+    LORELINE_BEGIN_INTERP_CALL(interp)
     Loreline_setCharacterField_hx(interp, character, field, value);
     LORELINE_END_CALL
 }
@@ -1601,7 +2787,7 @@ LORELINE_PUBLIC Loreline_Value Loreline_getStateField(
     if (!interp || field.isNull()) return Loreline_Value::null_val();
     Loreline_Value result;
 
-    LORELINE_BEGIN_CALL_SYNC
+    LORELINE_BEGIN_INTERP_CALL_SYNC(interp)
     Loreline_getStateField_hx(interp, field, &result);
     LORELINE_END_CALL
 
@@ -1623,7 +2809,7 @@ LORELINE_PUBLIC void Loreline_setStateField(
 ) {
     if (!interp || field.isNull()) return;
 
-    LORELINE_BEGIN_CALL
+    LORELINE_BEGIN_INTERP_CALL(interp)
     Loreline_setStateField_hx(interp, field, value);
     LORELINE_END_CALL
 }
@@ -1646,7 +2832,7 @@ LORELINE_PUBLIC Loreline_Value Loreline_getTopLevelStateField(
     if (!interp || field.isNull()) return Loreline_Value::null_val();
     Loreline_Value result;
 
-    LORELINE_BEGIN_CALL_SYNC
+    LORELINE_BEGIN_INTERP_CALL_SYNC(interp)
     Loreline_getTopLevelStateField_hx(interp, field, &result);
     LORELINE_END_CALL
 
@@ -1668,11 +2854,151 @@ LORELINE_PUBLIC void Loreline_setTopLevelStateField(
 ) {
     if (!interp || field.isNull()) return;
 
-    LORELINE_BEGIN_CALL
+    LORELINE_BEGIN_INTERP_CALL(interp)
     Loreline_setTopLevelStateField_hx(interp, field, value);
     LORELINE_END_CALL
 }
 
+/* ── Batched field access ───────────────────────────────────────────────── */
+
+static LORELINE_NOINLINE void Loreline_getStateFields_hx(
+    Loreline_Interpreter* interp, const Loreline_String* fields, int count, Loreline_Value* outValues
+) {
+    LORELINE_HX_BEGIN
+    ::loreline::Interpreter hxInterp = (::loreline::Interpreter)::Dynamic(interp->obj);
+    for (int i = 0; i < count; i++) {
+        outValues[i] = fields[i].isNull()
+            ? Loreline_Value::null_val()
+            : linc_hxToValue(hxInterp->getStateField(linc_toHxString(fields[i])));
+    }
+    LORELINE_HX_END
+}
+
+LORELINE_PUBLIC void Loreline_getStateFields(
+    Loreline_Interpreter* interp, const Loreline_String* fields, int count, Loreline_Value* outValues
+) {
+    if (!interp || !fields || !outValues || count <= 0) return;
+
+    LORELINE_BEGIN_INTERP_CALL_SYNC(interp)
+    Loreline_getStateFields_hx(interp, fields, count, outValues);
+    LORELINE_END_CALL
+}
+
+static LORELINE_NOINLINE void Loreline_setStateFields_hx(
+    Loreline_Interpreter* interp, const std::vector<Loreline_String>& fields, const std::vector<Loreline_Value>& values
+) {
+    LORELINE_HX_BEGIN
+    ::loreline::Interpreter hxInterp = (::loreline::Interpreter)::Dynamic(interp->obj);
+    for (size_t i = 0; i < fields.size(); i++) {
+        if (fields[i].isNull()) continue;
+        hxInterp->setStateField(linc_toHxString(fields[i]), linc_valueToHx(values[i]));
+    }
+    LORELINE_HX_END
+}
+
+LORELINE_PUBLIC void Loreline_setStateFields(
+    Loreline_Interpreter* interp, const Loreline_String* fields, const Loreline_Value* values, int count
+) {
+    if (!interp || !fields || !values || count <= 0) return;
+
+    /* The call may run later on the interpreter's worker: copy the batch */
+    std::vector<Loreline_String> fieldsCopy(fields, fields + count);
+    std::vector<Loreline_Value> valuesCopy(values, values + count);
+
+    LORELINE_BEGIN_INTERP_CALL(interp)
+    Loreline_setStateFields_hx(interp, fieldsCopy, valuesCopy);
+    LORELINE_END_CALL
+}
+
+static LORELINE_NOINLINE void Loreline_getCharacterFields_hx(
+    Loreline_Interpreter* interp, Loreline_String character,
+    const Loreline_String* fields, int count, Loreline_Value* outValues
+) {
+    LORELINE_HX_BEGIN
+    ::loreline::Interpreter hxInterp = (::loreline::Interpreter)::Dynamic(interp->obj);
+    ::String hxCharacter = linc_toHxString(character);
+    for (int i = 0; i < count; i++) {
+        outValues[i] = fields[i].isNull()
+            ? Loreline_Value::null_val()
+            : linc_hxToValue(hxInterp->getCharacterField(hxCharacter, linc_toHxString(fields[i])));
+    }
+    LORELINE_HX_END
+}
+
+LORELINE_PUBLIC void Loreline_getCharacterFields(
+    Loreline_Interpreter* interp, Loreline_String character,
+    const Loreline_String* fields, int count, Loreline_Value* outValues
+) {
+    if (!interp || character.isNull() || !fields || !outValues || count <= 0) return;
+
+    LORELINE_BEGIN_INTERP_CALL_SYNC(interp)
+    Loreline_getCharacterFields_hx(interp, character, fields, count, outValues);
+    LORELINE_END_CALL
+}
+
+static LORELINE_NOINLINE void Loreline_setCharacterFields_hx(
+    Loreline_Interpreter* interp, Loreline_String character,
+    const std::vector<Loreline_String>& fields, const std::vector<Loreline_Value>& values
+) {
+    LORELINE_HX_BEGIN
+    ::loreline::Interpreter hxInterp = (::loreline::Interpreter)::Dynamic(interp->obj);
+    ::String hxCharacter = linc_toHxString(character);
+    for (size_t i = 0; i < fields.size(); i++) {
+        if (fields[i].isNull()) continue;
+        hxInterp->setCharacterField(hxCharacter, linc_toHxString(fields[i]), linc_valueToHx(values[i]));
+    }
+    LORELINE_HX_END
+}
+
+LORELINE_PUBLIC void Loreline_setCharacterFields(
+    Loreline_Interpreter* interp, Loreline_String character,
+    const Loreline_String* fields, const Loreline_Value* values, int count
+) {
+    if (!interp || character.isNull() || !fields || !values || count <= 0) return;
+
+    /* The call may run later on the interpreter's worker: copy the batch */
+    std::vector<Loreline_String> fieldsCopy(fields, fields + count);
+    std::vector<Loreline_Value> valuesCopy(values, values + count);
+
+    LORELINE_BEGIN_INTERP_CALL(interp)
+    Loreline_setCharacterFields_hx(interp, character, fieldsCopy, valuesCopy);
+    LORELINE_END_CALL
+}
+
+static LORELINE_NOINLINE void Loreline_getCharacterSnapshot_hx(
+    Loreline_Interpreter* interp, Loreline_String character,
+    Loreline_String* outFields, Loreline_Value* outValues, int capacity, int* outCount
+) {
+    LORELINE_HX_BEGIN
+    ::loreline::Interpreter hxInterp = (::loreline::Interpreter)::Dynamic(interp->obj);
+    ::Dynamic fields = hxInterp->getCharacter(linc_toHxString(character));
+    if (!hx::IsNull(fields)) {
+        ::Array< ::String > keys = ::loreline::Objects_obj::getFields(hxInterp, fields);
+        *outCount = keys->length;
+        for (int i = 0; i < keys->length && i < capacity; i++) {
+            ::String key = keys->__get(i);
+            if (outFields) outFields[i] = linc_hxToString(key);
+            if (outValues) outValues[i] = linc_hxToValue(::loreline::Objects_obj::getField(hxInterp, fields, key));
+        }
+    }
+    LORELINE_HX_END
+}
+
+LORELINE_PUBLIC int Loreline_getCharacterSnapshot(
+    Loreline_Interpreter* interp, Loreline_String character,
+    Loreline_String* outFields, Loreline_Value* outValues, int capacity
+) {
+    if (!interp || character.isNull()) return 0;
+    if (capacity < 0) capacity = 0;
+    int count = 0;
+
+    LORELINE_BEGIN_INTERP_CALL_SYNC(interp)
+    Loreline_getCharacterSnapshot_hx(interp, character, outFields, outValues, capacity, &count);
+    LORELINE_END_CALL
+
+    return count;
+}
+
 /* ── Current node ──────────────────────────────────────────────────────── */
 
 static LORELINE_NOINLINE void Loreline_currentNode_hx(
@@ -1684,7 +3010,7 @@ static LORELINE_NOINLINE void Loreline_currentNode_hx(
     if (!hx::IsNull(node)) {
         ::Dynamic hxType = node->__Field(HX_CSTRING("type"), hx::paccDynamic);
         if (!hx::IsNull(hxType)) {
-            outResult->type = linc_hxToString((::String)hxType->__run());
+            outResult->type = linc_hxToInternedString((::String)hxType->__run());
         }
         ::Dynamic pos = node->__Field(HX_CSTRING("pos"), hx::paccDynamic);
         if (!hx::IsNull(pos)) {
@@ -1707,13 +3033,107 @@ LORELINE_PUBLIC Loreline_Node Loreline_currentNode(Loreline_Interpreter* interp)
 
     if (!interp) return result;
 
-    LORELINE_BEGIN_CALL_SYNC
+    LORELINE_BEGIN_INTERP_CALL_SYNC(interp)
     Loreline_currentNode_hx(interp, &result);
     LORELINE_END_CALL
 
     return result;
 }
 
+/* ── Profiler ───────────────────────────────────────────────────────────── */
+
+static LORELINE_NOINLINE void Loreline_setProfilerEnabled_hx(bool enabled) {
+    LORELINE_HX_BEGIN
+    ::loreline::Profiler_obj::enabled = enabled;
+    LORELINE_HX_END
+}
+
+LORELINE_PUBLIC void Loreline_setProfilerEnabled(bool enabled) {
+    LORELINE_BEGIN_CALL_SYNC
+    Loreline_setProfilerEnabled_hx(enabled);
+    LORELINE_END_CALL
+}
+
+static LORELINE_NOINLINE void Loreline_profilerSnapshot_hx(
+    Loreline_Interpreter* interp, bool pretty, Loreline_String* outResult
+) {
+    LORELINE_HX_BEGIN
+    ::loreline::Interpreter hxInterp = (::loreline::Interpreter)::Dynamic(interp->obj);
+    ::loreline::Profiler profiler = hxInterp->profiler;
+    if (!hx::IsNull(profiler)) {
+        *outResult = linc_hxToString(profiler->snapshot(pretty));
+    }
+    LORELINE_HX_END
+}
+
+LORELINE_PUBLIC Loreline_String Loreline_profilerSnapshot(Loreline_Interpreter* interp, bool pretty) {
+    if (!interp) return Loreline_String();
+    Loreline_String result;
+
+    LORELINE_BEGIN_INTERP_CALL_SYNC(interp)
+    Loreline_profilerSnapshot_hx(interp, pretty, &result);
+    LORELINE_END_CALL
+
+    return result;
+}
+
+static LORELINE_NOINLINE void Loreline_resetProfiler_hx(Loreline_Interpreter* interp) {
+    LORELINE_HX_BEGIN
+    ::loreline::Interpreter hxInterp = (::loreline::Interpreter)::Dynamic(interp->obj);
+    ::loreline::Profiler profiler = hxInterp->profiler;
+    if (!hx::IsNull(profiler)) {
+        profiler->reset();
+    }
+    LORELINE_HX_END
+}
+
+LORELINE_PUBLIC void Loreline_resetProfiler(Loreline_Interpreter* interp) {
+    if (!interp) return;
+
+    LORELINE_BEGIN_INTERP_CALL_SYNC(interp)
+    Loreline_resetProfiler_hx(interp);
+    LORELINE_END_CALL
+}
+
+/* ── Simulation ─────────────────────────────────────────────────────────── */
+
+static LORELINE_NOINLINE void Loreline_simulate_hx(
+    Loreline_Script* script, const char* policy, int runs, int seed, int threads,
+    int maxSteps, bool pretty, Loreline_String* outResult
+) {
+    LORELINE_HX_BEGIN
+
+    try {
+        ::loreline::Script hxScript = (::loreline::Script)::Dynamic(script->obj);
+        ::loreline::SimulationStats stats = ::loreline::Simulator_obj::simulate(
+            hxScript, ::String(policy ? policy : "random"), runs, seed, threads, maxSteps, null()
+        );
+        *outResult = linc_hxToString(::loreline::Json_obj::stringify(stats->toJson(), pretty));
+    } catch (::Dynamic e) {
+        fprintf(stderr, "Loreline_simulate error: %s\n", ((::String)e).c_str());
+    }
+
+    LORELINE_HX_END
+}
+
+LORELINE_PUBLIC Loreline_String Loreline_simulate(
+    Loreline_Script* script, const char* policy, int runs, int seed,
+    int threads, int maxSteps, bool pretty
+) {
+    if (!script) return Loreline_String();
+    if (threads <= 0) {
+        threads = (int)std::thread::hardware_concurrency();
+        if (threads <= 0) threads = 1;
+    }
+    Loreline_String result;
+
+    LORELINE_BEGIN_CALL_SYNC
+    Loreline_simulate_hx(script, policy, runs, seed, threads, maxSteps, pretty, &result);
+    LORELINE_END_CALL
+
+    return result;
+}
+
 /* ── Utility ────────────────────────────────────────────────────────────── */
 
 static LORELINE_NOINLINE void Loreline_printScript_hx(
@@ -1770,8 +3190,7 @@ static LORELINE_NOINLINE void Loreline_scriptFromJson_hx(
         ::Dynamic hxScript = ::loreline::Script_obj::fromJson(jsonObj);
 
         if (!hx::IsNull(hxScript)) {
-            *outHandle = new Loreline_Script();
-            (*outHandle)->set(hxScript.GetPtr());
+            *outHandle = linc_newScript(hxScript);
         }
     } catch (::Dynamic e) {
         fprintf(stderr, "Loreline_scriptFromJson error: %s\n", ((::String)e).c_str());
@@ -1791,6 +3210,37 @@ LORELINE_PUBLIC Loreline_Script* Loreline_scriptFromJson(Loreline_String json) {
     return handle;
 }
 
+static LORELINE_NOINLINE void Loreline_loadCompiled_hx(
+    const void* data, size_t length, Loreline_Script** outHandle
+) {
+    LORELINE_HX_BEGIN
+
+    try {
+        ::haxe::io::Bytes bytes = ::haxe::io::Bytes_obj::alloc((int)length);
+        if (length > 0) memcpy(bytes->b->getBase(), data, length);
+        ::Dynamic hxScript = ::loreline::Script_obj::fromBinary(bytes);
+
+        if (!hx::IsNull(hxScript)) {
+            *outHandle = linc_newScript(hxScript);
+        }
+    } catch (::Dynamic e) {
+        fprintf(stderr, "Loreline_loadCompiled error: %s\n", ((::String)e).c_str());
+    }
+
+    LORELINE_HX_END
+}
+
+LORELINE_PUBLIC Loreline_Script* Loreline_loadCompiled(const void* data, size_t length) {
+    if (!data || length < 4 || memcmp(data, "LRLS", 4) != 0) return nullptr;
+    Loreline_Script* handle = nullptr;
+
+    LORELINE_BEGIN_CALL_SYNC
+    Loreline_loadCompiled_hx(data, length, &handle);
+    LORELINE_END_CALL
+
+    return handle;
+}
+
 /* ── Interpreter options ────────────────────────────────────────────────── */
 
 LORELINE_PUBLIC Loreline_InterpreterOptions* Loreline_createOptions(void) {
@@ -1822,6 +3272,28 @@ LORELINE_PUBLIC void Loreline_optionsSetTranslations(
     if (options) options->setTranslations(translations ? translations->obj : nullptr);
 }
 
+LORELINE_PUBLIC void Loreline_optionsOnStateChanged(
+    Loreline_InterpreterOptions* options, Loreline_StateChangedHandler handler,
+    const Loreline_String* filters, int filterCount
+) {
+    if (!options) return;
+    options->stateChangedHandler = handler;
+    options->stateFilters.clear();
+    for (int i = 0; filters && i < filterCount; i++) {
+        if (!filters[i].isNull()) {
+            options->stateFilters.push_back(std::string(filters[i].c_str(), filters[i].length()));
+        }
+    }
+}
+
+LORELINE_PUBLIC void Loreline_optionsSetStepBudget(
+    Loreline_InterpreterOptions* options, int maxSteps, double maxMicroseconds
+) {
+    if (!options) return;
+    options->stepBudget = maxSteps > 0 ? maxSteps : 0;
+    options->timeBudget = maxMicroseconds > 0.0 ? maxMicroseconds / 1000000.0 : 0.0;
+}
+
 LORELINE_PUBLIC void Loreline_optionsAddFunction(
     Loreline_InterpreterOptions* options, Loreline_String name,
     Loreline_CustomFunction fn, void* userData
@@ -1862,7 +3334,7 @@ LORELINE_PUBLIC void Loreline_resolveAsync(
     // GC then walks freed memory on the next collect.
     hx::Object* doneObj = resolve->doneObj;
 
-    LORELINE_BEGIN_CALL
+    LORELINE_BEGIN_INTERP_CALL(resolve)
     LORELINE_HX_BEGIN
     ::Dynamic(doneObj)->__run();
     LORELINE_HX_END
@@ -1906,13 +3378,16 @@ LORELINE_PUBLIC void Loreline_releaseScript(Loreline_Script* script) {
 
 static LORELINE_NOINLINE void Loreline_releaseInterpreter_hx(Loreline_Interpreter* interp) {
     LORELINE_HX_BEGIN
+    /* A flush that yielded on its budget is pending on a timer that outlives
+     * this handle: dispose the interpreter so that it never resumes */
+    if (interp->obj) ((::loreline::Interpreter)::Dynamic(interp->obj))->dispose();
     delete interp;
     LORELINE_HX_END
 }
 
 LORELINE_PUBLIC void Loreline_releaseInterpreter(Loreline_Interpreter* interp) {
     if (!interp) return;
-    LORELINE_BEGIN_CALL
+    LORELINE_BEGIN_INTERP_CALL(interp)
     Loreline_releaseInterpreter_hx(interp);
     LORELINE_END_CALL
 }
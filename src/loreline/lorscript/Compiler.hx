@@ -0,0 +1,965 @@
+package loreline.lorscript;
+
+import loreline.Arrays;
+import loreline.Interpreter;
+import loreline.Objects;
+import loreline.ShapedFields;
+import loreline.lorscript.Expr;
+
+/**
+ * A compiled lorscript expression, evaluated against a call frame.
+ */
+typedef Compiled = (frame:Frame)->Dynamic;
+
+/**
+ * State of one call of a compiled function.
+ */
+class Frame {
+
+    /**
+     * The interpreter the function is bound to, giving access to loreline state and helpers.
+     */
+    public final interp:Interp;
+
+    /**
+     * Cached bindings of the global identifiers of the function, shared by every call.
+     */
+    public final globals:Array<Dynamic>;
+
+    /**
+     * Values of the arguments and local variables, by slot.
+     */
+    public final slots:Array<Dynamic>;
+
+    /**
+     * The function itself, for recursive calls.
+     */
+    public final self:Dynamic;
+
+    /**
+     * Pending `break`, `continue` or `return`, if any.
+     */
+    public var control:Int = Compiler.NONE;
+
+    /**
+     * Value given to `return`.
+     */
+    public var returnValue:Dynamic = null;
+
+    public function new(interp:Interp, globals:Array<Dynamic>, slots:Array<Dynamic>, self:Dynamic) {
+        this.interp = interp;
+        this.globals = globals;
+        this.slots = slots;
+        this.self = self;
+    }
+
+}
+
+/**
+ * A top level lorscript function compiled into closures. Compiled once per script,
+ * then bound to each interpreter running it.
+ */
+class CompiledFunction {
+
+    final expr:Expr;
+
+    final name:Null<String>;
+
+    final params:Array<Argument>;
+
+    final minParams:Int;
+
+    /**
+     * Compiled default values of the optional parameters (null for the others).
+     */
+    final defaults:Array<Compiled>;
+
+    final body:Compiled;
+
+    final numSlots:Int;
+
+    final numGlobals:Int;
+
+    public function new(expr:Expr, name:Null<String>, params:Array<Argument>, defaults:Array<Compiled>, body:Compiled, numSlots:Int, numGlobals:Int) {
+        this.expr = expr;
+        this.name = name;
+        this.params = params;
+        this.defaults = defaults;
+        this.body = body;
+        this.numSlots = numSlots;
+        this.numGlobals = numGlobals;
+
+        var minParams = 0;
+        for (p in params) {
+            if (!p.opt && p.value == null) {
+                minParams++;
+            }
+        }
+        this.minParams = minParams;
+    }
+
+    /**
+     * Returns the function bound to the interpreter of the given lorscript `Interp`,
+     * callable with `Reflect.callMethod()` like the functions created by `Interp`.
+     */
+    public function bind(interp:Interp):Dynamic {
+
+        final globals:Array<Dynamic> = [for (_ in 0...numGlobals) null];
+        var self:Dynamic = null;
+
+        self = Reflect.makeVarArgs(function(args:Array<Dynamic>):Dynamic {
+            return call(interp, globals, self, args);
+        });
+
+        return self;
+
+    }
+
+    function call(interp:Interp, globals:Array<Dynamic>, self:Dynamic, args:Array<Dynamic>):Dynamic {
+
+        final slots:Array<Dynamic> = [];
+        slots.resize(numSlots);
+        final frame = new Frame(interp, globals, slots, self);
+
+        if (((args == null) ? 0 : args.length) != params.length) {
+            if (args.length < minParams) {
+                var str = "Invalid number of parameters. Got " + args.length + ", required " + minParams;
+                if (name != null) str += " for function '" + name + "'";
+                throw new Error(ECustom(str), expr.pmin, expr.pmax, expr.origin, expr.line);
+            }
+            // make sure mandatory args are forced
+            var extraParams = args.length - minParams;
+            var pos = 0;
+            for (i in 0...params.length) {
+                final p = params[i];
+                if (p.opt || p.value != null) {
+                    if (extraParams > 0) {
+                        slots[i] = args[pos++];
+                        extraParams--;
+                    }
+                    else {
+                        slots[i] = defaults[i] != null ? defaults[i](frame) : null;
+                    }
+                }
+                else {
+                    slots[i] = args[pos++];
+                }
+            }
+        }
+        else {
+            for (i in 0...params.length) {
+                slots[i] = args[i];
+            }
+        }
+
+        final result = body(frame);
+
+        return frame.control == Compiler.RETURN ? frame.returnValue : result;
+
+    }
+
+}
+
+/**
+ * Compiles top level lorscript functions into closures, as an alternative
+ * to walking their syntax tree with `Interp` at every call.
+ *
+ * Local variables and arguments are resolved to slots at compile time and
+ * character and function bindings are cached per identifier. State fields are
+ * still looked up at every access, as they can be added while the script runs
+ * and shadow characters and functions. `break`, `continue` and `return` are
+ * flags checked by blocks and loops instead of exceptions.
+ *
+ * Only functions whose behaviour is guaranteed to match `Interp` are compiled:
+ * functions using nested functions, `try`, `trace`, or control flow in the middle
+ * of an expression are not, and keep running through `Interp`.
+ */
+@:access(loreline.lorscript.Interp)
+@:access(loreline.Interpreter)
+class Compiler {
+
+    public static inline final NONE:Int = 0;
+
+    public static inline final BREAK:Int = 1;
+
+    public static inline final CONTINUE:Int = 2;
+
+    public static inline final RETURN:Int = 3;
+
+    /**
+     * Slot of each local variable visible at the current position.
+     */
+    final scope:Map<String,Int> = new Map();
+
+    /**
+     * Variables declared in the current blocks, with the slot they shadowed (-1 if none).
+     */
+    final declared:Array<{name:String, old:Int}> = [];
+
+    final selfName:Null<String>;
+
+    var numSlots:Int = 0;
+
+    var numGlobals:Int = 0;
+
+    var loopDepth:Int = 0;
+
+    var failed:Bool = false;
+
+    function new(selfName:Null<String>) {
+        this.selfName = selfName;
+    }
+
+    /**
+     * Compiles a top level function, as parsed from a `NFunctionDecl`.
+     *
+     * @param expr The function expression
+     * @return The compiled function, or null if it should run through `Interp`
+     */
+    public static function compileFunction(expr:Expr):Null<CompiledFunction> {
+
+        switch expr.e {
+            case EFunction(params, body, name, _):
+                final compiler = new Compiler(name);
+
+                // Arguments take the first slots. Default values are evaluated
+                // before arguments are assigned, so they don't see them
+                compiler.numSlots = params.length;
+                final defaults:Array<Compiled> = [
+                    for (p in params) p.value != null ? compiler.compile(p.value, false, false) : null
+                ];
+                for (i in 0...params.length) {
+                    compiler.scope.set(params[i].name, i);
+                }
+
+                final compiledBody = compiler.compile(body, true, true);
+
+                if (compiler.failed) return null;
+                return new CompiledFunction(expr, name, params, defaults, compiledBody, compiler.numSlots, compiler.numGlobals);
+
+            case _:
+                return null;
+        }
+
+    }
+
+    function fail():Compiled {
+
+        failed = true;
+        return null;
+
+    }
+
+    function declare(name:String):Int {
+
+        final slot = numSlots++;
+        declared.push({ name: name, old: scope.exists(name) ? scope.get(name) : -1 });
+        scope.set(name, slot);
+        return slot;
+
+    }
+
+    function restore(old:Int):Void {
+
+        while (declared.length > old) {
+            final d = declared.pop();
+            if (d.old == -1) {
+                scope.remove(d.name);
+            }
+            else {
+                scope.set(d.name, d.old);
+            }
+        }
+
+    }
+
+    /**
+     * Compiles an expression.
+     *
+     * @param e The expression
+     * @param statement Whether `break` and `continue` are allowed here
+     *                  (the enclosing blocks and loop check them right after)
+     * @param returnable Whether `return` is allowed here
+     */
+    function compile(e:Expr, statement:Bool, returnable:Bool):Compiled {
+
+        if (failed) return null;
+
+        switch e.e {
+
+            case EConst(c):
+                final value:Dynamic = switch c {
+                    case CInt(v): v;
+                    case CFloat(f): f;
+                    case CString(s): s;
+                }
+                return _ -> value;
+
+            case EIdent(id):
+                return compileIdent(e, id);
+
+            case EVar(_, _, _):
+                // Declarations are only compiled as statements of a block
+                return fail();
+
+            case EParent(e):
+                return compile(e, false, false);
+
+            case EBlock(exprs):
+                final old = declared.length;
+                final compiled:Array<Compiled> = [];
+                for (child in exprs) {
+                    switch child.e {
+                        case EVar(n, _, init):
+                            final value = init != null ? compile(init, false, false) : null;
+                            final slot = declare(n);
+                            compiled.push(value != null
+                                ? frame -> { frame.slots[slot] = value(frame); null; }
+                                : frame -> { frame.slots[slot] = null; null; }
+                            );
+                        case _:
+                            compiled.push(compile(child, statement, returnable));
+                    }
+                }
+                restore(old);
+                if (failed) return null;
+                final count = compiled.length;
+                return frame -> {
+                    var v:Dynamic = null;
+                    for (i in 0...count) {
+                        v = compiled[i](frame);
+                        if (frame.control != NONE) break;
+                    }
+                    v;
+                };
+
+            case EField(target, f):
+                final obj = compile(target, false, false);
+                return frame -> {
+                    final o = obj(frame);
+                    frame.interp.curExpr = e;
+                    frame.interp.get(o, f);
+                };
+
+            case EBinop(op, e1, e2):
+                return compileBinop(e, op, e1, e2);
+
+            case EUnop(op, prefix, target):
+                switch op {
+                    case "!":
+                        final value = compile(target, false, false);
+                        return frame -> value(frame) != true;
+                    case "-":
+                        final value = compile(target, false, false);
+                        return frame -> -value(frame);
+                    case "~":
+                        final value = compile(target, false, false);
+                        return frame -> ~value(frame);
+                    case "++":
+                        return compileIncrement(target, prefix, 1);
+                    case "--":
+                        return compileIncrement(target, prefix, -1);
+                    case _:
+                        return fail();
+                }
+
+            case ECall(target, params):
+                final args = [for (p in params) compile(p, false, false)];
+                final count = args.length;
+                switch target.e {
+                    case EField(objExpr, f):
+                        final obj = compile(objExpr, false, false);
+                        return frame -> {
+                            final values:Array<Dynamic> = [for (i in 0...count) args[i](frame)];
+                            final o = obj(frame);
+                            if (o == null) throw new Error(EInvalidAccess(f), objExpr.pmin, objExpr.pmax, objExpr.origin, objExpr.line);
+                            frame.interp.curExpr = e;
+                            frame.interp.fcall(o, f, values);
+                        };
+                    case _:
+                        final func = compile(target, false, false);
+                        return frame -> {
+                            final values:Array<Dynamic> = [for (i in 0...count) args[i](frame)];
+                            frame.interp.call(null, func(frame), values);
+                        };
+                }
+
+            case EIf(cond, e1, e2):
+                final c = compile(cond, false, false);
+                final a = compile(e1, statement, returnable);
+                if (e2 == null) {
+                    return frame -> c(frame) == true ? a(frame) : null;
+                }
+                final b = compile(e2, statement, returnable);
+                return frame -> c(frame) == true ? a(frame) : b(frame);
+
+            case ETernary(cond, e1, e2):
+                final c = compile(cond, false, false);
+                final a = compile(e1, false, false);
+                final b = compile(e2, false, false);
+                return frame -> c(frame) == true ? a(frame) : b(frame);
+
+            case EWhile(cond, body):
+                final c = compile(cond, false, false);
+                loopDepth++;
+                final b = compile(body, true, returnable);
+                loopDepth--;
+                return frame -> {
+                    while (c(frame) == true) {
+                        b(frame);
+                        if (frame.control != NONE && !continueLoop(frame)) break;
+                    }
+                    null;
+                };
+
+            case EDoWhile(cond, body):
+                final c = compile(cond, false, false);
+                loopDepth++;
+                final b = compile(body, true, returnable);
+                loopDepth--;
+                return frame -> {
+                    do {
+                        b(frame);
+                        if (frame.control != NONE && !continueLoop(frame)) break;
+                    }
+                    while (c(frame) == true);
+                    null;
+                };
+
+            case EFor(v, it, body):
+                final old = declared.length;
+                final iterable = compile(it, false, false);
+                final slot = declare(v);
+                loopDepth++;
+                final b = compile(body, true, returnable);
+                loopDepth--;
+                restore(old);
+                return frame -> {
+                    final value = iterable(frame);
+                    frame.interp.curExpr = it;
+                    final iterator = frame.interp.makeIterator(value);
+                    while (iterator.hasNext()) {
+                        frame.slots[slot] = iterator.next();
+                        b(frame);
+                        if (frame.control != NONE && !continueLoop(frame)) break;
+                    }
+                    null;
+                };
+
+            case EBreak:
+                if (!statement || loopDepth == 0) return fail();
+                return frame -> {
+                    frame.control = BREAK;
+                    null;
+                };
+
+            case EContinue:
+                if (!statement || loopDepth == 0) return fail();
+                return frame -> {
+                    frame.control = CONTINUE;
+                    null;
+                };
+
+            case EReturn(value):
+                if (!statement || !returnable) return fail();
+                final v = value != null ? compile(value, false, false) : null;
+                return frame -> {
+                    frame.returnValue = v != null ? v(frame) : null;
+                    frame.control = RETURN;
+                    null;
+                };
+
+            case EArray(target, index):
+                final arrExpr = compile(target, false, false);
+                final indexExpr = compile(index, false, false);
+                return frame -> {
+                    final arr:Dynamic = arrExpr(frame);
+                    final index:Dynamic = indexExpr(frame);
+                    if (Arrays.isArray(arr)) {
+                        Arrays.arrayGet(arr, index);
+                    }
+                    else if (Objects.isFields(arr)) {
+                        Objects.getField(frame.interp.interpreter, arr, index);
+                    }
+                    else if (frame.interp.isMap(arr)) {
+                        frame.interp.getMapValue(arr, index);
+                    }
+                    else {
+                        arr[index];
+                    }
+                };
+
+            case EArrayDecl(arr):
+                final isMap = arr.length > 0 && Tools.expr(arr[0]).match(EBinop("=>", _));
+                if (isMap) {
+                    final keys:Array<Compiled> = [];
+                    final values:Array<Compiled> = [];
+                    for (item in arr) {
+                        switch Tools.expr(item) {
+                            case EBinop("=>", eKey, eValue):
+                                keys.push(compile(eKey, false, false));
+                                values.push(compile(eValue, false, false));
+                            case _:
+                                return fail();
+                        }
+                    }
+                    final count = keys.length;
+                    return frame -> {
+                        final k:Array<Dynamic> = [];
+                        final v:Array<Dynamic> = [];
+                        for (i in 0...count) {
+                            k.push(keys[i](frame));
+                            v.push(values[i](frame));
+                        }
+                        frame.interp.curExpr = e;
+                        frame.interp.makeMap(k, v);
+                    };
+                }
+                final items = [for (item in arr) compile(item, false, false)];
+                final count = items.length;
+                return frame -> {
+                    final a:Array<Dynamic> = [];
+                    for (i in 0...count) {
+                        a.push(items[i](frame));
+                    }
+                    a;
+                };
+
+            case ENew(cl, params):
+                final args = [for (p in params) compile(p, false, false)];
+                final count = args.length;
+                return frame -> {
+                    final values:Array<Dynamic> = [for (i in 0...count) args[i](frame)];
+                    frame.interp.curExpr = e;
+                    frame.interp.cnew(cl, values);
+                };
+
+            case EThrow(value):
+                final v = compile(value, false, false);
+                return frame -> throw v(frame);
+
+            case EObject(fl):
+                final names = [for (f in fl) f.name];
+                final values = [for (f in fl) compile(f.e, false, false)];
+                final count = names.length;
+                return frame -> {
+                    final interpreter = frame.interp.interpreter;
+                    final o = Objects.createFields(interpreter);
+                    for (i in 0...count) {
+                        Objects.setField(interpreter, o, names[i], values[i](frame));
+                    }
+                    o;
+                };
+
+            case ESwitch(value, cases, def):
+                final v = compile(value, false, false);
+                final caseValues = [for (c in cases) [for (cv in c.values) compile(cv, false, false)]];
+                final caseExprs = [for (c in cases) compile(c.expr, statement, returnable)];
+                final d = def != null ? compile(def, statement, returnable) : null;
+                return frame -> {
+                    var val:Dynamic = v(frame);
+                    var match = false;
+                    for (i in 0...caseValues.length) {
+                        for (cv in caseValues[i]) {
+                            if (cv(frame) == val) {
+                                match = true;
+                                break;
+                            }
+                        }
+                        if (match) {
+                            val = caseExprs[i](frame);
+                            break;
+                        }
+                    }
+                    if (!match) {
+                        val = d == null ? null : d(frame);
+                    }
+                    val;
+                };
+
+            case EMeta(_, _, inner):
+                return compile(inner, statement, returnable);
+
+            case ECheckType(inner, _):
+                return compile(inner, false, false);
+
+            case EFunction(_, _, _, _) | ETry(_, _, _, _):
+                return fail();
+        }
+
+    }
+
+    /**
+     * Handles the `break` or `continue` pending at the end of a loop iteration.
+     * @return Whether the loop should go on
+     */
+    static function continueLoop(frame:Frame):Bool {
+
+        switch frame.control {
+            case CONTINUE:
+                frame.control = NONE;
+                return true;
+            case BREAK:
+                frame.control = NONE;
+                return false;
+            case _:
+                return false;
+        }
+
+    }
+
+    function compileIdent(e:Expr, id:String):Compiled {
+
+        if (scope.exists(id)) {
+            final slot = scope.get(id);
+            return frame -> frame.slots[slot];
+        }
+
+        switch id {
+            case "null":
+                return _ -> null;
+            case "true":
+                return _ -> true;
+            case "false":
+                return _ -> false;
+            case "trace":
+                return fail();
+            case _:
+        }
+
+        if (id == selfName) {
+            return frame -> frame.self;
+        }
+
+        final index = numGlobals++;
+
+        // Inline cache of the slot of the identifier in the top level state shape.
+        // Every interpreter running this code shares the same shape, so racing
+        // writes from several threads store the same values.
+        var cachedShape:FieldShape = null;
+        var cachedSlot = -1;
+
+        return frame -> {
+            final state = frame.interp.interpreter.topLevelState;
+            if (state.fields is ShapedFields) {
+                final fields:ShapedFields = cast state.fields;
+                if (fields.shape != cachedShape) {
+                    cachedSlot = fields.shape.slot(id);
+                    cachedShape = fields.shape;
+                }
+                if (cachedSlot != -1 && fields.existsAt(cachedSlot)) {
+                    state.dirty = true;
+                    return fields.getAt(cachedSlot);
+                }
+            }
+            return resolveGlobal(frame, index, id, e);
+        };
+
+    }
+
+    /**
+     * Resolves a global identifier like `Interp.resolve()` does.
+     */
+    static function resolveGlobal(frame:Frame, index:Int, id:String, e:Expr):Dynamic {
+
+        final interpreter = frame.interp.interpreter;
+
+        // State fields can be added at any time, they are always looked up first
+        final state = interpreter.topLevelState;
+        if (Objects.fieldExists(interpreter, state.fields, id)) {
+            state.dirty = true;
+            return Objects.getField(interpreter, state.fields, id);
+        }
+
+        // Characters and functions do not change once the interpreter is created
+        var binding:Dynamic = frame.globals[index];
+        if (binding == null) {
+            final character = interpreter.topLevelCharacters.get(id);
+            binding = character != null ? character : interpreter.topLevelFunctions.get(id);
+            frame.globals[index] = binding;
+        }
+
+        if (binding != null) {
+            if (binding is RuntimeCharacter) {
+                final character:RuntimeCharacter = binding;
+                character.dirty = true;
+                return character.fields;
+            }
+            return binding;
+        }
+
+        // Beat name fallback: depends on the current scope, never cached
+        final beat = interpreter.resolveBeatByName(id);
+        if (beat != null) return beat;
+
+        throw new Error(EUnknownVariable(id), e.pmin, e.pmax, e.origin, e.line);
+
+    }
+
+    /**
+     * Returns a closure writing a value to an identifier.
+     */
+    function compileWrite(id:String):(frame:Frame, value:Dynamic)->Void {
+
+        if (scope.exists(id)) {
+            final slot = scope.get(id);
+            return (frame, value) -> frame.slots[slot] = value;
+        }
+
+        if (id == "null" || id == "true" || id == "false" || id == "trace" || id == selfName) {
+            return (frame, value) -> throw "Invalid assign";
+        }
+
+        var cachedShape:FieldShape = null;
+        var cachedSlot = -1;
+
+        return (frame, value) -> {
+            final interpreter = frame.interp.interpreter;
+            final state = interpreter.topLevelState;
+            state.dirty = true;
+            if (state.fields is ShapedFields) {
+                final fields:ShapedFields = cast state.fields;
+                if (fields.shape != cachedShape) {
+                    cachedSlot = fields.shape.slot(id);
+                    cachedShape = fields.shape;
+                }
+                if (cachedSlot != -1) {
+                    fields.setAt(cachedSlot, value);
+                    if (interpreter.onStateChange != null) {
+                        interpreter.onStateChange(interpreter, id, value);
+                    }
+                    return;
+                }
+            }
+            interpreter.assignField(state.fields, id, value);
+        };
+
+    }
+
+    function compileBinop(e:Expr, op:String, e1:Expr, e2:Expr):Compiled {
+
+        switch op {
+            case "=":
+                return compileAssign(e, e1, e2);
+            case "+=":
+                return compileAssignOp(e, op, e1, e2, (v1:Dynamic, v2:Dynamic) -> v1 + v2);
+            case "-=":
+                return compileAssignOp(e, op, e1, e2, (v1:Float, v2:Float) -> v1 - v2);
+            case "*=":
+                return compileAssignOp(e, op, e1, e2, (v1:Float, v2:Float) -> v1 * v2);
+            case "/=":
+                return compileAssignOp(e, op, e1, e2, (v1:Float, v2:Float) -> v1 / v2);
+            case "%=":
+                return compileAssignOp(e, op, e1, e2, (v1:Float, v2:Float) -> v1 % v2);
+            case "&=":
+                return compileAssignOp(e, op, e1, e2, (v1:Dynamic, v2:Dynamic) -> v1 & v2);
+            case "|=":
+                return compileAssignOp(e, op, e1, e2, (v1:Dynamic, v2:Dynamic) -> v1 | v2);
+            case "^=":
+                return compileAssignOp(e, op, e1, e2, (v1:Dynamic, v2:Dynamic) -> v1 ^ v2);
+            case "<<=":
+                return compileAssignOp(e, op, e1, e2, (v1:Dynamic, v2:Dynamic) -> v1 << v2);
+            case ">>=":
+                return compileAssignOp(e, op, e1, e2, (v1:Dynamic, v2:Dynamic) -> v1 >> v2);
+            case ">>>=":
+                return compileAssignOp(e, op, e1, e2, (v1:Dynamic, v2:Dynamic) -> v1 >>> v2);
+            case _:
+        }
+
+        final a = compile(e1, false, false);
+        final b = compile(e2, false, false);
+
+        return switch op {
+            case "+": frame -> a(frame) + b(frame);
+            case "-": frame -> a(frame) - b(frame);
+            case "*": frame -> a(frame) * b(frame);
+            case "/": frame -> a(frame) / b(frame);
+            case "%": frame -> a(frame) % b(frame);
+            case "&": frame -> a(frame) & b(frame);
+            case "|": frame -> a(frame) | b(frame);
+            case "^": frame -> a(frame) ^ b(frame);
+            case "<<": frame -> a(frame) << b(frame);
+            case ">>": frame -> a(frame) >> b(frame);
+            case ">>>": frame -> a(frame) >>> b(frame);
+            case "==": frame -> a(frame) == b(frame);
+            case "!=": frame -> a(frame) != b(frame);
+            // Temporary variables work around the Haxe C# target quirk described in Interp.initOps()
+            case ">=": frame -> { var v1 = a(frame); var v2 = b(frame); v1 >= v2; };
+            case "<=": frame -> { var v1 = a(frame); var v2 = b(frame); v1 <= v2; };
+            case ">": frame -> { var v1 = a(frame); var v2 = b(frame); v1 > v2; };
+            case "<": frame -> { var v1 = a(frame); var v2 = b(frame); v1 < v2; };
+            case "||": frame -> a(frame) == true || b(frame) == true;
+            case "&&": frame -> a(frame) == true && b(frame) == true;
+            case "...": frame -> new IntIterator(a(frame), b(frame));
+            case "is": frame -> #if (haxe_ver >= 4.2) Std.isOfType #else Std.is #end (a(frame), b(frame));
+            case _: fail();
+        }
+
+    }
+
+    function compileAssign(e:Expr, e1:Expr, e2:Expr):Compiled {
+
+        final value = compile(e2, false, false);
+
+        switch Tools.expr(e1) {
+            case EIdent(id):
+                final write = compileWrite(id);
+                return frame -> {
+                    final v = value(frame);
+                    write(frame, v);
+                    v;
+                };
+            case EField(target, f):
+                final obj = compile(target, false, false);
+                return frame -> {
+                    final v = value(frame);
+                    final o = obj(frame);
+                    frame.interp.curExpr = e;
+                    frame.interp.set(o, f, v);
+                };
+            case EArray(target, index):
+                final arrExpr = compile(target, false, false);
+                final indexExpr = compile(index, false, false);
+                return frame -> {
+                    final v = value(frame);
+                    final arr:Dynamic = arrExpr(frame);
+                    final index:Dynamic = indexExpr(frame);
+                    if (Arrays.isArray(arr)) {
+                        Arrays.arraySet(arr, index, v);
+                    }
+                    else if (Objects.isFields(arr)) {
+                        frame.interp.interpreter.assignField(arr, index, v);
+                    }
+                    else if (frame.interp.isMap(arr)) {
+                        frame.interp.setMapValue(arr, index, v);
+                    }
+                    else {
+                        arr[index] = v;
+                    }
+                    v;
+                };
+            case _:
+                return fail();
+        }
+
+    }
+
+    function compileAssignOp(e:Expr, op:String, e1:Expr, e2:Expr, fop:Dynamic->Dynamic->Dynamic):Compiled {
+
+        final value = compile(e2, false, false);
+
+        switch Tools.expr(e1) {
+            case EIdent(id):
+                final read = compileIdent(e1, id);
+                final write = compileWrite(id);
+                return frame -> {
+                    final v = fop(read(frame), value(frame));
+                    write(frame, v);
+                    v;
+                };
+            case EField(target, f):
+                final obj = compile(target, false, false);
+                return frame -> {
+                    final o = obj(frame);
+                    frame.interp.curExpr = e;
+                    final v = fop(frame.interp.get(o, f), value(frame));
+                    frame.interp.curExpr = e;
+                    frame.interp.set(o, f, v);
+                };
+            case EArray(target, index):
+                final arrExpr = compile(target, false, false);
+                final indexExpr = compile(index, false, false);
+                return frame -> {
+                    final arr:Dynamic = arrExpr(frame);
+                    final index:Dynamic = indexExpr(frame);
+                    var v:Dynamic;
+                    if (Arrays.isArray(arr)) {
+                        v = fop(Arrays.arrayGet(arr, index), value(frame));
+                        Arrays.arraySet(arr, index, v);
+                    }
+                    else if (Objects.isFields(arr)) {
+                        final interpreter = frame.interp.interpreter;
+                        v = fop(Objects.getField(interpreter, arr, index), value(frame));
+                        interpreter.assignField(arr, index, v);
+                    }
+                    else if (frame.interp.isMap(arr)) {
+                        v = fop(frame.interp.getMapValue(arr, index), value(frame));
+                        frame.interp.setMapValue(arr, index, v);
+                    }
+                    else {
+                        v = fop(arr[index], value(frame));
+                        arr[index] = v;
+                    }
+                    v;
+                };
+            case _:
+                return fail();
+        }
+
+    }
+
+    function compileIncrement(target:Expr, prefix:Bool, delta:Int):Compiled {
+
+        switch target.e {
+            case EIdent(id):
+                final read = compileIdent(target, id);
+                final write = compileWrite(id);
+                return frame -> {
+                    var v:Dynamic = read(frame);
+                    if (prefix) {
+                        v += delta;
+                        write(frame, v);
+                    }
+                    else {
+                        write(frame, v + delta);
+                    }
+                    v;
+                };
+            case EField(objExpr, f):
+                final obj = compile(objExpr, false, false);
+                return frame -> {
+                    final o = obj(frame);
+                    frame.interp.curExpr = target;
+                    var v:Dynamic = frame.interp.get(o, f);
+                    if (prefix) {
+                        v += delta;
+                        frame.interp.set(o, f, v);
+                    }
+                    else {
+                        frame.interp.set(o, f, v + delta);
+                    }
+                    v;
+                };
+            case EArray(arrTarget, index):
+                final arrExpr = compile(arrTarget, false, false);
+                final indexExpr = compile(index, false, false);
+                return frame -> {
+                    final arr:Dynamic = arrExpr(frame);
+                    final index:Dynamic = indexExpr(frame);
+                    var v:Dynamic;
+                    if (Arrays.isArray(arr)) {
+                        v = Arrays.arrayGet(arr, index);
+                        Arrays.arraySet(arr, index, v + delta);
+                    }
+                    else if (Objects.isFields(arr)) {
+                        final interpreter = frame.interp.interpreter;
+                        v = Objects.getField(interpreter, arr, index);
+                        interpreter.assignField(arr, index, v + delta);
+                    }
+                    else if (frame.interp.isMap(arr)) {
+                        v = frame.interp.getMapValue(arr, index);
+                        frame.interp.setMapValue(arr, index, v + delta);
+                    }
+                    else {
+                        v = arr[index];
+                        arr[index] = v + delta;
+                    }
+                    prefix ? v + delta : v;
+                };
+            case _:
+                return fail();
+        }
+
+    }
+
+}
@@ -139,7 +139,8 @@ class Interp {
     function setVar( name : String, v : Dynamic ) {
 
         if (!variables.exists(name)) {
-            Objects.setField(interpreter, interpreter.topLevelState.fields, name, v);
+            interpreter.topLevelState.dirty = true;
+            interpreter.assignField(interpreter.topLevelState.fields, name, v);
         }
         else {
             throw "Invalid assign";
@@ -166,7 +167,7 @@ class Interp {
                 Arrays.arraySet(arr, index, v);
             }
             else if (Objects.isFields(arr)) {
-                Objects.setField(interpreter, arr, index, v);
+                interpreter.assignField(arr, index, v);
             }
             else if (isMap(arr)) {
                 setMapValue(arr, index, v);
@@ -209,7 +210,7 @@ class Interp {
             }
             else if (Objects.isFields(arr)) {
                 v = fop(Objects.getField(interpreter, arr, index), expr(e2));
-                Objects.setField(interpreter, arr, index, v);
+                interpreter.assignField(arr, index, v);
             }
             else if (isMap(arr)) {
                 v = fop(getMapValue(arr, index), expr(e2));
@@ -265,10 +266,10 @@ class Interp {
                 var v:Dynamic = Objects.getField(interpreter, arr, index);
                 if (prefix) {
                     v += delta;
-                    Objects.setField(interpreter, arr, index, v);
+                    interpreter.assignField(arr, index, v);
                 }
                 else {
-                    Objects.setField(interpreter, arr, index, v + delta);
+                    interpreter.assignField(arr, index, v + delta);
                 }
                 return v;
             }
@@ -354,12 +355,15 @@ class Interp {
 
             // Look for state fields
             if (Objects.fieldExists(interpreter, interpreter.topLevelState.fields, id)) {
+                interpreter.topLevelState.dirty = true;
                 return Objects.getField(interpreter, interpreter.topLevelState.fields, id);
             }
 
             // Look for characters
             if (interpreter.topLevelCharacters.exists(id)) {
-                return interpreter.topLevelCharacters.get(id).fields;
+                final character = interpreter.topLevelCharacters.get(id);
+                character.dirty = true;
+                return character.fields;
             }
 
             // Look for functions
@@ -767,7 +771,7 @@ class Interp {
         if( o == null ) error(EInvalidAccess(f));
 
         if (Objects.isFields(o)) {
-            Objects.setField(interpreter, o, f, v);
+            interpreter.assignField(o, f, v);
             return v;
         }
 
@@ -0,0 +1,234 @@
+package loreline.lsp;
+
+import loreline.Lexer;
+import loreline.Node;
+import loreline.Parser;
+import loreline.Position;
+import loreline.lsp.TextBuffer;
+
+using loreline.Utf8;
+
+/**
+ * Applies an edit to a parsed document by reparsing only the top level beat
+ * containing it, then splicing the new beat into the existing script and
+ * shifting the positions of everything that follows.
+ *
+ * The reparse is only done when its result is guaranteed to match a full parse:
+ * the edit must stay within a top level beat, the beat must lex and parse without
+ * error into a single beat, and its node ids must fit before the next top level node.
+ * In any other case, nothing is modified and a full parse is needed.
+ */
+class BeatReparser {
+
+    /**
+     * Tries to apply an edit to the given script.
+     * @param script The script parsed from the content before the edit
+     * @param content The content after the edit
+     * @param edit The applied edit
+     * @return `true` if the script has been updated, `false` if it needs a full parse
+     */
+    public static function reparse(script:Script, content:String, edit:TextBufferEdit):Bool {
+
+        final delta = edit.newEnd - edit.oldEnd;
+
+        // Find the top level beat containing the edit
+        var index = -1;
+        for (i in 0...script.body.length) {
+            final node = script.body[i];
+            if (node.pos.offset <= edit.start && edit.oldEnd <= node.pos.offset + node.pos.length) {
+                if (node is NBeatDecl && node.pos.column == 1) {
+                    index = i;
+                }
+                break;
+            }
+        }
+        if (index == -1) return false;
+
+        final beat:NBeatDecl = cast script.body[index];
+        final regionStart = beat.pos.offset;
+        final oldRegionEnd = beat.pos.offset + beat.pos.length;
+        final regionEnd = oldRegionEnd + delta;
+
+        // The beat must end its line, so that what follows keeps its columns
+        final next = content.uCharCodeAt(regionEnd);
+        if (next != -1 && next != '\n'.code && next != '\r'.code) return false;
+
+        final lexer = new Lexer(content.uSubstring(regionStart, regionEnd));
+        lexer.keepOrphanExpressions = true;
+        var tokens:Tokens;
+        try {
+            tokens = lexer.tokenize();
+        }
+        catch (e:LexerError) {
+            return false;
+        }
+        final lexerErrors = lexer.getErrors();
+        if (lexerErrors != null && lexerErrors.length > 0) return false;
+
+        // The region starts at column 1, only lines and offsets need to be shifted
+        shiftTokens(tokens, beat.pos.line - 1, regionStart);
+
+        // Node ids continue from the ones the beat had
+        final parser = new Parser(tokens);
+        @:privateAccess parser.currentNodeId = new NodeId(beat.id.section - 1, 0, 0, 0);
+        final parsed = parser.parse();
+        final parseErrors = parser.getErrors();
+        if (parseErrors != null && parseErrors.length > 0) return false;
+
+        if (parsed.body.length != 1 || !(parsed.body[0] is NBeatDecl)) return false;
+        if (parsed.leadingComments != null && parsed.leadingComments.length > 0) return false;
+        if (parsed.trailingComments != null && parsed.trailingComments.length > 0) return false;
+
+        final newBeat:NBeatDecl = cast parsed.body[0];
+        if (newBeat.pos.offset != regionStart || !(newBeat.id == beat.id)) return false;
+
+        if (index + 1 < script.body.length) {
+            final lastSection = @:privateAccess parser.currentNodeId.section;
+            if (lastSection >= script.body[index + 1].id.section) return false;
+        }
+
+        // Keep the comments the beat had outside of the reparsed region
+        newBeat.leadingComments = mergeComments(
+            beat.leadingComments, comment -> comment.pos.offset < regionStart,
+            newBeat.leadingComments, 0, 0, true
+        );
+        newBeat.trailingComments = mergeComments(
+            beat.trailingComments, comment -> comment.pos.offset >= oldRegionEnd,
+            newBeat.trailingComments, edit.lineDelta, delta, false
+        );
+
+        script.body[index] = newBeat;
+
+        // Shift everything that follows the beat
+        if (delta != 0 || edit.lineDelta != 0) {
+            for (i in index + 1...script.body.length) {
+                shiftTree(script.body[i], edit.lineDelta, delta);
+            }
+            script.leadingComments = shiftComments(script.leadingComments, oldRegionEnd, edit.lineDelta, delta);
+            script.trailingComments = shiftComments(script.trailingComments, oldRegionEnd, edit.lineDelta, delta);
+        }
+
+        return true;
+
+    }
+
+    static function mergeComments(oldComments:Array<Comment>, keep:(comment:Comment)->Bool, newComments:Array<Comment>, lineDelta:Int, delta:Int, before:Bool):Null<Array<Comment>> {
+
+        final kept:Array<Comment> = [];
+        if (oldComments != null) {
+            for (comment in oldComments) {
+                if (keep(comment)) {
+                    comment.pos = shiftPosition(comment.pos, lineDelta, delta);
+                    kept.push(comment);
+                }
+            }
+        }
+
+        if (kept.length == 0) return newComments;
+        if (newComments == null || newComments.length == 0) return kept;
+
+        return before ? kept.concat(newComments) : newComments.concat(kept);
+
+    }
+
+    static function shiftComments(comments:Array<Comment>, from:Int, lineDelta:Int, delta:Int):Null<Array<Comment>> {
+
+        if (comments != null) {
+            for (comment in comments) {
+                if (comment.pos.offset >= from) {
+                    comment.pos = shiftPosition(comment.pos, lineDelta, delta);
+                }
+            }
+        }
+
+        return comments;
+
+    }
+
+    static function shiftTokens(tokens:Tokens, lineDelta:Int, delta:Int):Void {
+
+        for (token in tokens) {
+            token.pos = shiftPosition(token.pos, lineDelta, delta);
+            switch token.type {
+                case LString(_, _, attachments) if (attachments != null):
+                    for (attachment in attachments) {
+                        switch attachment {
+                            case Interpolation(_, _, expr, _, _):
+                                shiftTokens(expr, lineDelta, delta);
+                            case Tag(_, _, _):
+                        }
+                    }
+                case _:
+            }
+        }
+
+    }
+
+    /**
+     * Shifts the positions of a top level node and its children.
+     * Nodes of imported scripts belong to other files and are left untouched.
+     */
+    static function shiftTree(node:AstNode, lineDelta:Int, delta:Int):Void {
+
+        if (node is NImportStatement) {
+            final importNode:NImportStatement = cast node;
+            shiftNode(importNode, lineDelta, delta);
+            if (importNode.path != null) {
+                shiftNode(importNode.path, lineDelta, delta);
+                importNode.path.each((child, _) -> shiftNode(child, lineDelta, delta));
+            }
+            shiftComments(importNode.leadingComments, 0, lineDelta, delta);
+            shiftComments(importNode.trailingComments, 0, lineDelta, delta);
+            return;
+        }
+
+        shiftNode(node, lineDelta, delta);
+        node.each((child, _) -> shiftNode(child, lineDelta, delta));
+
+    }
+
+    /**
+     * Shifts every position field of a node. Positions can be shared between
+     * nodes, so they are replaced with shifted copies instead of being modified.
+     */
+    static function shiftNode(node:Node, lineDelta:Int, delta:Int):Void {
+
+        node.pos = shiftPosition(node.pos, lineDelta, delta);
+
+        if (node is NCharacterDecl) {
+            final character:NCharacterDecl = cast node;
+            character.namePos = shiftPosition(character.namePos, lineDelta, delta);
+        }
+        else if (node is NTextStatement) {
+            final text:NTextStatement = cast node;
+            text.conditionPos = shiftPosition(text.conditionPos, lineDelta, delta);
+        }
+        else if (node is NDialogueStatement) {
+            final dialogue:NDialogueStatement = cast node;
+            dialogue.characterPos = shiftPosition(dialogue.characterPos, lineDelta, delta);
+            dialogue.conditionPos = shiftPosition(dialogue.conditionPos, lineDelta, delta);
+        }
+        else if (node is NChoiceOption) {
+            final option:NChoiceOption = cast node;
+            option.conditionPos = shiftPosition(option.conditionPos, lineDelta, delta);
+        }
+        else if (node is NTransition) {
+            final transition:NTransition = cast node;
+            transition.targetPos = shiftPosition(transition.targetPos, lineDelta, delta);
+        }
+        else if (node is NInsertion) {
+            final insertion:NInsertion = cast node;
+            insertion.targetPos = shiftPosition(insertion.targetPos, lineDelta, delta);
+        }
+
+    }
+
+    static function shiftPosition(pos:Null<Position>, lineDelta:Int, delta:Int):Null<Position> {
+
+        if (pos == null) return null;
+
+        return new Position(pos.line + lineDelta, pos.column, pos.offset + delta, pos.length);
+
+    }
+
+}
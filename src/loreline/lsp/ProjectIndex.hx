@@ -0,0 +1,493 @@
+package loreline.lsp;
+
+import Type as HxType;
+import haxe.Json;
+import haxe.crypto.Md5;
+import loreline.Lens;
+import loreline.Node;
+import loreline.lsp.Protocol;
+
+using StringTools;
+
+/**
+ * Kind of symbol tracked by the project index.
+ */
+enum abstract IndexedSymbolKind(String) from String to String {
+
+    var Beat = "beat";
+
+    var Character = "character";
+
+    var StateField = "state";
+
+    var Function = "function";
+
+    var Tag = "tag";
+
+}
+
+/**
+ * A symbol declared or referenced in an indexed file.
+ */
+typedef IndexedSymbol = {
+
+    /**
+     * The kind of symbol
+     */
+    var kind:IndexedSymbolKind;
+
+    /**
+     * The symbol name (tags are stored without their `#`)
+     */
+    var name:String;
+
+    /**
+     * Name of the beat containing the symbol, if any
+     */
+    var ?container:String;
+
+    /**
+     * Range of the declaration or reference in its file
+     */
+    var range:Range;
+
+}
+
+/**
+ * Index entry of a single file.
+ */
+typedef IndexedFile = {
+
+    /**
+     * Hash of the content that was indexed, used to skip unchanged files
+     */
+    var hash:String;
+
+    /**
+     * Symbols declared in the file
+     */
+    var symbols:Array<IndexedSymbol>;
+
+    /**
+     * References to symbols made from the file
+     */
+    var references:Array<IndexedSymbol>;
+
+}
+
+/**
+ * A symbol or reference, with the URI of the file it belongs to.
+ */
+typedef IndexedLocation = {
+
+    var uri:String;
+
+    var symbol:IndexedSymbol;
+
+}
+
+/**
+ * Project-wide index of the beats, characters, state fields, functions
+ * and tags declared in every file of a workspace, and of the places they are
+ * referenced from.
+ *
+ * Files are indexed one at a time: updating a file only replaces its own entries,
+ * so the index stays current as documents change without walking the rest of
+ * the project. The whole index can be written to a cache file and loaded back,
+ * which lets the server answer workspace queries before it has parsed anything.
+ * Symbols are identified by kind and name, the same way scripts resolve them
+ * across imports.
+ */
+class ProjectIndex {
+
+    /**
+     * Version of the cache file layout. Cache files with another version are ignored.
+     */
+    public static inline final CACHE_VERSION:Int = 1;
+
+    /**
+     * Index entries, by file URI.
+     */
+    final files:Map<String, IndexedFile> = new Map();
+
+    /**
+     * URIs of the files declaring each symbol, by symbol key.
+     */
+    final declaringFiles:Map<String, Map<String, Bool>> = new Map();
+
+    /**
+     * URIs of the files referencing each symbol, by symbol key.
+     */
+    final referencingFiles:Map<String, Map<String, Bool>> = new Map();
+
+    public function new() {}
+
+    /**
+     * Computes the hash used to tell whether a file changed since it was indexed.
+     */
+    public static function hashContent(content:String):String {
+
+        return Md5.encode(content ?? "");
+
+    }
+
+    /**
+     * Tells whether the given content of a file is the one already indexed.
+     */
+    public function isIndexed(uri:String, content:String):Bool {
+
+        final file = files.get(uri);
+        return file != null && file.hash == hashContent(content);
+
+    }
+
+    /**
+     * Indexes (or reindexes) a file from its parsed script.
+     * Only nodes of the file itself are indexed, not the ones of its imports.
+     *
+     * @param uri The URI of the file
+     * @param content The content the script was parsed from
+     * @param script The parsed script
+     */
+    public function updateFile(uri:String, content:String, script:Script):Void {
+
+        final lens = new Lens(script);
+        final symbols:Array<IndexedSymbol> = [];
+        final references:Array<IndexedSymbol> = [];
+
+        script.eachExcludingImported((node, parent) -> {
+
+            switch HxType.getClass(node) {
+
+                case NBeatDecl:
+                    final beat:NBeatDecl = cast node;
+                    symbols.push(makeSymbol(IndexedSymbolKind.Beat, beat.name, lens, beat, beat.pos, content));
+
+                case NCharacterDecl:
+                    final character:NCharacterDecl = cast node;
+                    symbols.push(makeSymbol(IndexedSymbolKind.Character, character.name, lens, character, character.namePos ?? character.pos, content));
+
+                case NStateDecl:
+                    final state:NStateDecl = cast node;
+                    for (field in state.fields) {
+                        symbols.push(makeSymbol(IndexedSymbolKind.StateField, field.name, lens, field, field.pos, content));
+                    }
+
+                case NFunctionDecl:
+                    final func:NFunctionDecl = cast node;
+                    if (func.name != null) {
+                        symbols.push(makeSymbol(IndexedSymbolKind.Function, func.name, lens, func, func.pos, content));
+                    }
+
+                case NTransition | NInsertion | NDialogueStatement | NAccess | Comment:
+                    final ref = symbolOfNode(lens, node);
+                    if (ref != null) {
+                        references.push(makeSymbol(ref.kind, ref.name, lens, node, referencePos(node), content));
+                    }
+
+                case _:
+            }
+
+        });
+
+        setFile(uri, {
+            hash: hashContent(content),
+            symbols: symbols,
+            references: references
+        });
+
+    }
+
+    /**
+     * Removes a file from the index.
+     */
+    public function removeFile(uri:String):Void {
+
+        final previous = files.get(uri);
+        if (previous != null) {
+            unlink(uri, previous);
+            files.remove(uri);
+        }
+
+    }
+
+    /**
+     * The URIs of every indexed file.
+     */
+    public function indexedFiles():Array<String> {
+
+        return [for (uri in files.keys()) uri];
+
+    }
+
+    /**
+     * Finds the declarations of a symbol in the whole project.
+     */
+    public function findDeclarations(kind:IndexedSymbolKind, name:String):Array<IndexedLocation> {
+
+        return collect(declaringFiles, kind, name, file -> file.symbols);
+
+    }
+
+    /**
+     * Finds every reference to a symbol in the whole project.
+     */
+    public function findReferences(kind:IndexedSymbolKind, name:String):Array<IndexedLocation> {
+
+        return collect(referencingFiles, kind, name, file -> file.references);
+
+    }
+
+    /**
+     * Finds the declared symbols whose name contains the given query (case insensitive).
+     * An empty query matches every symbol. Tags, which don't have declarations,
+     * are matched against the places they are used.
+     */
+    public function searchSymbols(query:String):Array<IndexedLocation> {
+
+        final result:Array<IndexedLocation> = [];
+        final lowerQuery = (query ?? "").toLowerCase();
+        final seenTags = new Map<String, Bool>();
+
+        for (uri => file in files) {
+            for (symbol in file.symbols) {
+                if (lowerQuery.length == 0 || symbol.name.toLowerCase().indexOf(lowerQuery) != -1) {
+                    result.push({ uri: uri, symbol: symbol });
+                }
+            }
+            for (ref in file.references) {
+                if (ref.kind == IndexedSymbolKind.Tag && !seenTags.exists(ref.name)) {
+                    if (lowerQuery.length == 0 || ref.name.toLowerCase().indexOf(lowerQuery) != -1) {
+                        seenTags.set(ref.name, true);
+                        result.push({ uri: uri, symbol: ref });
+                    }
+                }
+            }
+        }
+
+        return result;
+
+    }
+
+    /**
+     * Resolves the symbol a node declares or refers to, if it is one tracked by the index.
+     *
+     * @param lens The lens of the script containing the node
+     * @param node The node to resolve
+     * @return The kind and name of the symbol, or null
+     */
+    public static function symbolOfNode(lens:Lens, node:Node):Null<{kind:IndexedSymbolKind, name:String}> {
+
+        switch HxType.getClass(node) {
+
+            case NBeatDecl:
+                return { kind: IndexedSymbolKind.Beat, name: (cast node:NBeatDecl).name };
+
+            case NCharacterDecl:
+                return { kind: IndexedSymbolKind.Character, name: (cast node:NCharacterDecl).name };
+
+            case NFunctionDecl:
+                final func:NFunctionDecl = cast node;
+                return func.name != null ? { kind: IndexedSymbolKind.Function, name: func.name } : null;
+
+            case NObjectField:
+                if (lens.getParentNode(node) is NStateDecl) {
+                    return { kind: IndexedSymbolKind.StateField, name: (cast node:NObjectField).name };
+                }
+
+            case NTransition:
+                final transition:NTransition = cast node;
+                if (transition.target != '.' && lens.findBeatByNameFromNode(transition.target, transition) != null) {
+                    return { kind: IndexedSymbolKind.Beat, name: transition.target };
+                }
+
+            case NInsertion:
+                final insertion:NInsertion = cast node;
+                if (insertion.target != '.' && lens.findBeatByNameFromNode(insertion.target, insertion) != null) {
+                    return { kind: IndexedSymbolKind.Beat, name: insertion.target };
+                }
+
+            case NDialogueStatement:
+                final character = lens.findCharacterFromDialogue(cast node);
+                if (character != null) {
+                    return { kind: IndexedSymbolKind.Character, name: character.name };
+                }
+
+            case NAccess:
+                final resolved = lens.resolveAccess(cast node);
+                if (resolved != null) {
+                    return symbolOfNode(lens, resolved);
+                }
+
+            case Comment:
+                final comment:Comment = cast node;
+                if (comment.isHash) {
+                    return { kind: IndexedSymbolKind.Tag, name: comment.content.trim() };
+                }
+
+            case _:
+        }
+
+        return null;
+
+    }
+
+    /**
+     * Encodes the index to a JSON string, to be written to a cache file.
+     */
+    public function toJson():String {
+
+        final entries:Dynamic = {};
+        for (uri => file in files) {
+            Reflect.setField(entries, uri, file);
+        }
+
+        return Json.stringify({
+            version: CACHE_VERSION,
+            files: entries
+        });
+
+    }
+
+    /**
+     * Loads entries from a JSON string produced by `toJson()`.
+     * Entries of files already indexed are kept as they are,
+     * as they are more recent than the cached ones.
+     *
+     * @param json The cache content
+     * @return `true` if the cache could be loaded
+     */
+    public function loadJson(json:String):Bool {
+
+        final data:Dynamic = try Json.parse(json) catch (e:Any) null;
+        if (data == null || data.version != CACHE_VERSION || data.files == null) {
+            return false;
+        }
+
+        for (uri in Reflect.fields(data.files)) {
+            if (!files.exists(uri)) {
+                final file:IndexedFile = Reflect.field(data.files, uri);
+                if (file != null && file.symbols != null && file.references != null) {
+                    setFile(uri, file);
+                }
+            }
+        }
+
+        return true;
+
+    }
+
+    function setFile(uri:String, file:IndexedFile):Void {
+
+        final previous = files.get(uri);
+        if (previous != null) {
+            unlink(uri, previous);
+        }
+
+        files.set(uri, file);
+
+        for (symbol in file.symbols) {
+            link(declaringFiles, symbolKey(symbol.kind, symbol.name), uri);
+        }
+        for (ref in file.references) {
+            link(referencingFiles, symbolKey(ref.kind, ref.name), uri);
+        }
+
+    }
+
+    function unlink(uri:String, file:IndexedFile):Void {
+
+        for (symbol in file.symbols) {
+            declaringFiles.get(symbolKey(symbol.kind, symbol.name))?.remove(uri);
+        }
+        for (ref in file.references) {
+            referencingFiles.get(symbolKey(ref.kind, ref.name))?.remove(uri);
+        }
+
+    }
+
+    function link(map:Map<String, Map<String, Bool>>, key:String, uri:String):Void {
+
+        var uris = map.get(key);
+        if (uris == null) {
+            uris = new Map();
+            map.set(key, uris);
+        }
+        uris.set(uri, true);
+
+    }
+
+    function collect(map:Map<String, Map<String, Bool>>, kind:IndexedSymbolKind, name:String, entries:(file:IndexedFile)->Array<IndexedSymbol>):Array<IndexedLocation> {
+
+        final result:Array<IndexedLocation> = [];
+        final uris = map.get(symbolKey(kind, name));
+        if (uris == null) return result;
+
+        for (uri in uris.keys()) {
+            final file = files.get(uri);
+            if (file == null) continue;
+            for (symbol in entries(file)) {
+                if (symbol.kind == kind && symbol.name == name) {
+                    result.push({ uri: uri, symbol: symbol });
+                }
+            }
+        }
+
+        return result;
+
+    }
+
+    inline static function symbolKey(kind:IndexedSymbolKind, name:String):String {
+
+        return (kind:String) + ":" + name;
+
+    }
+
+    static function makeSymbol(kind:IndexedSymbolKind, name:String, lens:Lens, node:Node, pos:loreline.Position, content:String):IndexedSymbol {
+
+        final symbol:IndexedSymbol = {
+            kind: kind,
+            name: name,
+            range: rangeOf(pos, content)
+        };
+
+        final beat = lens.getFirstParentOfType(node, NBeatDecl);
+        if (beat != null) {
+            symbol.container = beat.name;
+        }
+
+        return symbol;
+
+    }
+
+    /**
+     * The position of the name a reference node is pointing with.
+     */
+    static function referencePos(node:Node):loreline.Position {
+
+        return switch HxType.getClass(node) {
+            case NTransition: (cast node:NTransition).targetPos ?? node.pos;
+            case NInsertion: (cast node:NInsertion).targetPos ?? node.pos;
+            case NDialogueStatement: (cast node:NDialogueStatement).characterPos ?? node.pos;
+            case _: node.pos;
+        }
+
+    }
+
+    static function rangeOf(pos:loreline.Position, content:String):Range {
+
+        final end = pos.withOffset(content, pos.length);
+        return {
+            start: {
+                line: pos.line - 1,
+                character: pos.column - 1
+            },
+            end: {
+                line: end.line - 1,
+                character: end.column - 1
+            }
+        };
+
+    }
+
+}
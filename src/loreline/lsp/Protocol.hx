@@ -894,6 +894,37 @@ typedef DocumentSymbol = {
 	var ?children:Array<DocumentSymbol>;
 }
 
+/**
+ * Represents a symbol found in the workspace, with the location it is declared at.
+ * Returned by workspace symbol requests.
+ */
+typedef SymbolInformation = {
+	/**
+	 * The name of the symbol
+	 */
+	var name:String;
+
+	/**
+	 * The kind of symbol
+	 */
+	var kind:SymbolKind;
+
+	/**
+	 * Optional tags for this symbol
+	 */
+	var ?tags:Array<SymbolTag>;
+
+	/**
+	 * The location of the symbol
+	 */
+	var location:Location;
+
+	/**
+	 * The name of the symbol containing this symbol, if any
+	 */
+	var ?containerName:String;
+}
+
 /**
  * Code Action support enables IDEs to offer quick fixes and refactorings
  */
@@ -8,6 +8,7 @@ import loreline.Imports;
 import loreline.Lexer;
 import loreline.Node;
 import loreline.Parser;
+import loreline.lsp.ProjectIndex;
 import loreline.lsp.Protocol;
 
 using StringTools;
@@ -39,6 +40,11 @@ class Server {
      */
     final documentContents:Map<String, String> = new Map();
 
+    /**
+     * Maps open document URIs to their text buffers, receiving incremental changes.
+     */
+    final documentBuffers:Map<String, TextBuffer> = new Map();
+
     /**
      * Maps document URIs to their diagnostics.
      */
@@ -50,6 +56,38 @@ class Server {
      */
     final dirtyDocuments:Map<String, Bool> = new Map();
 
+    /**
+     * Project-wide index of symbols and references, kept across documents.
+     */
+    final index:ProjectIndex = new ProjectIndex();
+
+    /**
+     * Maps document URIs whose AST changed since they were last indexed.
+     */
+    final staleIndexDocuments:Map<String, Bool> = new Map();
+
+    /**
+     * Paths of the workspace files waiting to be indexed in the background.
+     */
+    var indexQueue:Array<String> = [];
+
+    /**
+     * Path of the file the index is persisted to, or null if not persisted.
+     */
+    var indexCachePath:Null<String> = null;
+
+    /**
+     * Root path of the workspace, if any.
+     */
+    var workspaceRootPath:Null<String> = null;
+
+    /**
+     * Timer writing the index to its cache file once edits settle, if scheduled.
+     */
+    var indexSaveTimer:Null<haxe.Timer> = null;
+
+    var indexChanged:Bool = false;
+
     /**
      * Client capabilities received from initialize request.
      */
@@ -227,7 +265,10 @@ class Server {
                         handleDocumentSymbol(cast request.params);
 
                     case "textDocument/references":
-                        null; // TODO
+                        handleReferences(cast request.params);
+
+                    case "workspace/symbol":
+                        handleWorkspaceSymbol(cast request.params);
 
                     case "textDocument/formatting":
                         handleDocumentFormatting(cast request.params);
@@ -268,6 +309,7 @@ class Server {
             switch (notification.method) {
                 case "initialized":
                     initialized = true;
+                    startBackgroundIndexing();
 
                 case "textDocument/didOpen":
                     handleDidOpenTextDocument(cast notification.params);
@@ -302,12 +344,14 @@ class Server {
 
         clientCapabilities = params.capabilities;
 
+        configureIndex(params);
+
         return {
             capabilities: {
-                // Full document sync means we'll get the entire document content on changes
+                // Incremental document sync means we'll get range edits on changes
                 textDocumentSync: {
                     openClose: true,
-                    change: TextDocumentSyncKind.Full,
+                    change: TextDocumentSyncKind.Incremental,
                     save: { // Save notification support
                         includeText: true
                     }
@@ -325,7 +369,9 @@ class Server {
                 },
                 definitionProvider: true,    // For go-to-definition
                 hoverProvider: true,         // For hover tooltips
+                referencesProvider: true,    // For find references, across the workspace
                 documentSymbolProvider: true, // For document outline
+                workspaceSymbolProvider: true, // For workspace symbol search
                 documentFormattingProvider: true  // For code formatting
             }
         };
@@ -339,6 +385,11 @@ class Server {
             throw { code: ErrorCodes.InvalidRequest, message: "Server already shut down" };
         }
         shutdown = true;
+        if (indexSaveTimer != null) {
+            indexSaveTimer.stop();
+            indexSaveTimer = null;
+        }
+        saveIndex();
         return null;
     }
 
@@ -356,6 +407,7 @@ class Server {
      */
     function handleDidOpenTextDocument(params:{textDocument:TextDocumentItem}) {
         final doc = params.textDocument;
+        documentBuffers.set(doc.uri, new TextBuffer(doc.text));
         updateDocument(doc.uri, doc.text, true);
     }
 
@@ -365,6 +417,7 @@ class Server {
     }) {
         // Update document and run diagnostics
         if (params.text != null) {
+            documentBuffers.set(params.textDocument.uri, new TextBuffer(params.text));
             updateDocument(params.textDocument.uri, params.text, true);
         } else {
             // If text not included, get it from our cache
@@ -382,9 +435,46 @@ class Server {
         textDocument:VersionedTextDocumentIdentifier,
         contentChanges:Array<TextDocumentContentChangeEvent>
     }) {
-        if (params.contentChanges.length > 0) {
-            final change = params.contentChanges[params.contentChanges.length - 1];
-            updateDocument(params.textDocument.uri, change.text, false);
+        final uri = params.textDocument.uri;
+        if (params.contentChanges.length == 0) return;
+
+        var buffer = documentBuffers.get(uri);
+        if (buffer == null) {
+            buffer = new TextBuffer(documentContents.get(uri) ?? "");
+            documentBuffers.set(uri, buffer);
+        }
+
+        // Range edits are applied to the current AST by reparsing the beat they
+        // are in, as long as that is possible. Otherwise the document is parsed again.
+        var ast = dirtyDocuments.exists(uri) ? null : documents.get(uri);
+        for (change in params.contentChanges) {
+            if (change.range == null) {
+                buffer = new TextBuffer(change.text);
+                documentBuffers.set(uri, buffer);
+                ast = null;
+            }
+            else {
+                final edit = buffer.applyChange(change.range, change.text);
+                if (ast != null && !BeatReparser.reparse(ast, buffer.content, edit)) {
+                    ast = null;
+                }
+            }
+        }
+
+        if (ast != null) {
+            documentContents.set(uri, buffer.content);
+            markDependentDocumentsDirty(uri);
+            setDocument(uri, ast);
+
+            // Notify that document parsing is complete
+            onNotification({
+                jsonrpc: "2.0",
+                method: "loreline/documentReady",
+                params: { uri: uri }
+            });
+        }
+        else {
+            updateDocument(uri, buffer.content, false);
         }
     }
 
@@ -394,12 +484,15 @@ class Server {
     function handleDidCloseTextDocument(params:{textDocument:TextDocumentIdentifier}) {
         documents.remove(params.textDocument.uri);
         documentContents.remove(params.textDocument.uri);
+        documentBuffers.remove(params.textDocument.uri);
         documentDiagnostics.remove(params.textDocument.uri);
     }
 
     function setDocument(uri:String, ast:Script) {
         documents.set(uri, ast);
         dirtyDocuments.remove(uri);
+        staleIndexDocuments.set(uri, true);
+        scheduleIndexSave();
     }
 
     function setDocumentContent(uri:String, content:String) {
@@ -2217,6 +2310,299 @@ class Server {
 
     }
 
+    /**
+     * Handle references request, answered from the project index
+     * so that references in every file of the workspace are included.
+     */
+    function handleReferences(params:{
+        textDocument:TextDocumentIdentifier,
+        position:Position,
+        ?context:{includeDeclaration:Bool}
+    }):Array<Location> {
+        final result:Array<Location> = [];
+
+        final uri = params.textDocument.uri;
+
+        final ast = documents.get(uri);
+        if (ast == null) return result;
+
+        final content = documentContents.get(uri);
+        final lorelinePos = toLorelinePosition(params.position, content);
+
+        // Look for the symbol at this position, going up through
+        // the expressions containing the node if needed
+        final lens = new Lens(ast);
+        var node = lens.getNodeAtPosition(lorelinePos);
+        var symbol = null;
+        while (node != null) {
+            symbol = ProjectIndex.symbolOfNode(lens, node);
+            if (symbol != null || !(node is NExpr)) break;
+            node = lens.getParentNode(node);
+        }
+        if (symbol == null) return result;
+
+        refreshIndex();
+
+        if (params.context?.includeDeclaration == true) {
+            for (location in index.findDeclarations(symbol.kind, symbol.name)) {
+                result.push({ uri: location.uri, range: location.symbol.range });
+            }
+        }
+
+        for (location in index.findReferences(symbol.kind, symbol.name)) {
+            result.push({ uri: location.uri, range: location.symbol.range });
+        }
+
+        return result;
+    }
+
+    /**
+     * Handle workspace symbol request, answered from the project index
+     */
+    function handleWorkspaceSymbol(params:{
+        query:String
+    }):Array<SymbolInformation> {
+
+        refreshIndex();
+
+        return [for (location in index.searchSymbols(params.query)) {
+            final symbol = location.symbol;
+            final info:SymbolInformation = {
+                name: symbol.kind == IndexedSymbolKind.Tag ? '#' + symbol.name : symbol.name,
+                kind: switch symbol.kind {
+                    case IndexedSymbolKind.Beat: SymbolKind.Class;
+                    case IndexedSymbolKind.Character: SymbolKind.Object;
+                    case IndexedSymbolKind.StateField: SymbolKind.Variable;
+                    case IndexedSymbolKind.Function: SymbolKind.Function;
+                    case IndexedSymbolKind.Tag: SymbolKind.Key;
+                    case _: SymbolKind.Null;
+                },
+                location: {
+                    uri: location.uri,
+                    range: symbol.range
+                },
+                containerName: symbol.container
+            };
+            info;
+        }];
+
+    }
+
+    /**
+     * Resolves the workspace root and the file the project index is persisted to,
+     * then loads the index from that file if it exists. The cache file defaults to
+     * one per workspace in the user cache directory, so that nothing is written into
+     * the project, and can be changed (or disabled with `false`) with the
+     * `indexCachePath` initialization option.
+     */
+    function configureIndex(params:InitializeParams) {
+
+        final rootUri:String = params.workspaceFolders != null && params.workspaceFolders.length > 0 ? params.workspaceFolders[0].uri : params.rootUri;
+        if (rootUri != null && rootUri.startsWith('file://')) {
+            workspaceRootPath = pathFromUri(rootUri);
+        }
+        else if (params.rootPath != null) {
+            workspaceRootPath = params.rootPath;
+        }
+
+        final options:Dynamic = params.initializationOptions;
+        final cacheOption:Dynamic = options != null ? options.indexCachePath : null;
+        if (cacheOption == false) {
+            indexCachePath = null;
+        }
+        else if (cacheOption is String) {
+            indexCachePath = cacheOption;
+        }
+        else if (workspaceRootPath != null) {
+            indexCachePath = defaultIndexCachePath(workspaceRootPath);
+        }
+
+        #if (sys || (js && hxnodejs))
+        if (indexCachePath != null) {
+            try {
+                if (sys.FileSystem.exists(indexCachePath) && !index.loadJson(sys.io.File.getContent(indexCachePath))) {
+                    onLog("Ignoring outdated index cache at path: " + indexCachePath);
+                }
+            }
+            catch (e:Any) {
+                onLog("Failed to load index cache at path: " + indexCachePath + ", " + e);
+            }
+        }
+        #end
+
+    }
+
+    /**
+     * Resolves the default index cache file of a workspace: a file named after
+     * the hash of its root path, in the user cache directory (`$XDG_CACHE_HOME`,
+     * `~/Library/Caches`, `%LOCALAPPDATA%` or `~/.cache` depending on the system).
+     *
+     * @param rootPath The root path of the workspace
+     * @return The path of the cache file, or null if there is no user cache directory
+     */
+    function defaultIndexCachePath(rootPath:String):Null<String> {
+
+        #if (sys || (js && hxnodejs))
+        var cacheDir = Sys.getEnv('XDG_CACHE_HOME');
+        if (cacheDir == null || cacheDir.length == 0) {
+            final home = Sys.getEnv('HOME');
+            cacheDir = switch Sys.systemName() {
+                case 'Windows': Sys.getEnv('LOCALAPPDATA');
+                case 'Mac': home != null ? Path.join([home, 'Library', 'Caches']) : null;
+                case _: home != null ? Path.join([home, '.cache']) : null;
+            }
+        }
+        if (cacheDir == null || cacheDir.length == 0) return null;
+
+        return Path.join([cacheDir, 'loreline', 'index', haxe.crypto.Md5.encode(Path.normalize(rootPath)) + '.json']);
+        #else
+        return null;
+        #end
+
+    }
+
+    /**
+     * Lists the Loreline files of the workspace and indexes them in the background,
+     * one file per tick. Files whose content didn't change since they were cached
+     * are not parsed again.
+     */
+    function startBackgroundIndexing() {
+
+        #if (sys || (js && hxnodejs))
+        if (workspaceRootPath == null) return;
+
+        indexQueue = [];
+        try {
+            collectWorkspaceFiles(workspaceRootPath, indexQueue);
+        }
+        catch (e:Any) {
+            onLog("Failed to list workspace files at path: " + workspaceRootPath + ", " + e);
+        }
+
+        // Forget cached files that don't exist anymore
+        for (uri in index.indexedFiles()) {
+            if (!documents.exists(uri) && !sys.FileSystem.exists(pathFromUri(uri))) {
+                index.removeFile(uri);
+                indexChanged = true;
+            }
+        }
+
+        indexNextFile();
+        #end
+
+    }
+
+    #if (sys || (js && hxnodejs))
+    function collectWorkspaceFiles(dir:String, result:Array<String>) {
+
+        for (name in sys.FileSystem.readDirectory(dir)) {
+            if (name.startsWith('.') || name == 'node_modules') continue;
+            final path = Path.join([dir, name]);
+            if (sys.FileSystem.isDirectory(path)) {
+                collectWorkspaceFiles(path, result);
+            }
+            else if (Imports.isLorFilePath(name)) {
+                result.push(path);
+            }
+        }
+
+    }
+
+    function indexNextFile() {
+
+        if (shutdown) return;
+
+        if (indexQueue.length == 0) {
+            scheduleIndexSave();
+            return;
+        }
+
+        final path = indexQueue.shift();
+        final uri = uriFromPath(path);
+
+        // Open documents are indexed from their current AST instead
+        if (!documents.exists(uri)) {
+            try {
+                final content = sys.io.File.getContent(path);
+                if (!index.isIndexed(uri, content)) {
+                    fetchAst(uri, content, (lexer, parser, ast) -> {
+                        if (ast != null) {
+                            index.updateFile(uri, content, ast);
+                            indexChanged = true;
+                        }
+                    });
+                }
+            }
+            catch (e:Any) {
+                onLog("Failed to index file at path: " + path + ", " + e);
+            }
+        }
+
+        haxe.Timer.delay(indexNextFile, 0);
+
+    }
+    #end
+
+    /**
+     * Reindexes the documents whose AST changed since they were last indexed.
+     */
+    function refreshIndex() {
+
+        for (uri in staleIndexDocuments.keys()) {
+            final ast = documents.get(uri);
+            final content = documentContents.get(uri);
+            if (ast != null && content != null) {
+                index.updateFile(uri, content, ast);
+                indexChanged = true;
+            }
+        }
+        staleIndexDocuments.clear();
+
+    }
+
+    /**
+     * Schedules writing the index to its cache file once the workspace is idle:
+     * every call postpones the write, so that it doesn't happen while typing.
+     * The index is written on shutdown as well.
+     */
+    function scheduleIndexSave() {
+
+        if (indexCachePath == null || shutdown) return;
+
+        if (indexSaveTimer != null) {
+            indexSaveTimer.stop();
+        }
+        indexSaveTimer = haxe.Timer.delay(() -> {
+            indexSaveTimer = null;
+            saveIndex();
+        }, 10000);
+
+    }
+
+    /**
+     * Writes the project index to its cache file, if it changed.
+     */
+    function saveIndex() {
+
+        refreshIndex();
+        if (!indexChanged || indexCachePath == null) return;
+
+        #if (sys || (js && hxnodejs))
+        try {
+            final dir = Path.directory(indexCachePath);
+            if (dir.length > 0 && !sys.FileSystem.exists(dir)) {
+                sys.FileSystem.createDirectory(dir);
+            }
+            sys.io.File.saveContent(indexCachePath, index.toJson());
+            indexChanged = false;
+        }
+        catch (e:Any) {
+            onLog("Failed to save index cache at path: " + indexCachePath + ", " + e);
+        }
+        #end
+
+    }
+
     /**
      * Handle document formatting request
      */
@@ -0,0 +1,142 @@
+package loreline.lsp;
+
+import loreline.lsp.Protocol;
+
+using loreline.Utf8;
+
+/**
+ * Describes a range edit applied to a `TextBuffer`, in content offsets.
+ */
+@:structInit
+class TextBufferEdit {
+
+    /** Offset where the replaced range starts */
+    public var start:Int;
+
+    /** Offset where the replaced range ended, before the edit */
+    public var oldEnd:Int;
+
+    /** Offset where the inserted text ends, after the edit */
+    public var newEnd:Int;
+
+    /** Number of lines added (or removed, if negative) by the edit */
+    public var lineDelta:Int;
+
+}
+
+/**
+ * Text of an open document, with an index of line start offsets
+ * so that LSP range edits can be applied without scanning the whole content.
+ */
+class TextBuffer {
+
+    /**
+     * The current content of the document.
+     */
+    public var content(default, null):String;
+
+    /**
+     * Offset of the first character of each line.
+     */
+    var lineStarts:Array<Int>;
+
+    /**
+     * Creates a new buffer with the given content.
+     * @param content The initial content
+     */
+    public function new(content:String) {
+        this.content = content;
+        lineStarts = [0];
+        addLineStarts(content, 0, lineStarts);
+    }
+
+    /**
+     * Converts an LSP position (zero-based line and character) to a content offset.
+     * Positions past the end of a line or of the content are clamped.
+     * @param position The LSP position
+     * @return The matching content offset
+     */
+    public function offsetAt(position:Position):Int {
+        final length = content.uLength();
+
+        if (position.line < 0) return 0;
+        if (position.line >= lineStarts.length) return length;
+
+        final lineStart = lineStarts[position.line];
+        final lineEnd = position.line + 1 < lineStarts.length ? lineStarts[position.line + 1] - 1 : length;
+
+        final offset = lineStart + position.character;
+        return offset < lineEnd ? offset : lineEnd;
+    }
+
+    /**
+     * Replaces the text of the given range.
+     * @param range The LSP range to replace
+     * @param text The new text
+     * @return The applied edit, in content offsets
+     */
+    public function applyChange(range:Range, text:String):TextBufferEdit {
+        final start = offsetAt(range.start);
+        var end = offsetAt(range.end);
+        if (end < start) end = start;
+
+        // Lines starting inside the replaced range are removed
+        final firstLine = lineIndexAfter(start);
+        var lastLine = firstLine;
+        while (lastLine < lineStarts.length && lineStarts[lastLine] <= end) {
+            lastLine++;
+        }
+        final removedLines = lastLine - firstLine;
+
+        final textLength = text.uLength();
+        final delta = textLength - (end - start);
+
+        final addedStarts:Array<Int> = [];
+        addLineStarts(text, start, addedStarts);
+
+        for (i in lastLine...lineStarts.length) {
+            lineStarts[i] += delta;
+        }
+        lineStarts.splice(firstLine, removedLines);
+        for (i in 0...addedStarts.length) {
+            lineStarts.insert(firstLine + i, addedStarts[i]);
+        }
+
+        content = content.uSubstr(0, start) + text + content.uSubstr(end);
+
+        return {
+            start: start,
+            oldEnd: end,
+            newEnd: start + textLength,
+            lineDelta: addedStarts.length - removedLines
+        };
+    }
+
+    /**
+     * Returns the index of the first line starting after the given offset.
+     */
+    function lineIndexAfter(offset:Int):Int {
+        var low = 0;
+        var high = lineStarts.length;
+        while (low < high) {
+            final mid = (low + high) >> 1;
+            if (lineStarts[mid] <= offset) {
+                low = mid + 1;
+            }
+            else {
+                high = mid;
+            }
+        }
+        return low;
+    }
+
+    static function addLineStarts(text:String, baseOffset:Int, result:Array<Int>):Void {
+        final length = text.uLength();
+        for (i in 0...length) {
+            if (text.uCharCodeAt(i) == '\n'.code) {
+                result.push(baseOffset + i + 1);
+            }
+        }
+    }
+
+}